@@ -53,9 +53,9 @@
 // for the battery monitor, hook it up with the + side soldered to Vout on the motor driver (+12)
 // the negative side to ground and the middle to A4.  With the battery attached, 
 // measure the voltage on Vout and divide it by the voltage on A4
-// and enter that as the parameter VOLTAGE_DIVIDER_RATIO (assuming 22K and 10K resistors, the value should be 3.2)
+// and enter that as the parameter voltage_divider_ratio (assuming 22K and 10K resistors, the value should be 3.2)
 // Also measure the fully charged battery value and enter that with the discharged value into the parameters
-// FULL_BATTERY_VOLTAGE and ZERO_PERCENT_BATTERY_VOLTAGE
+// full_battery_voltage and zero_percent_battery_voltage (see u_parameters, or use hostTools/parameterTool)
 
 // command form is a letter for direction:
 // f,b,r,d = move forward, move backward, right turn, left turn.
@@ -76,6 +76,50 @@
 // U2#
 // if there is no number, then the servo will just move by one step (TILT_DELTA)
 // U#
+//
+// for binary telemetry (see m_telemetry for the details)
+// T followed by the rate in Hz, a comma, and the channel mask, T0# turns it off
+// T100,127#
+//
+// for queuing a maneuver (see n_commandQueue for the details)
+// q followed by a command runs it after the previous queued one, w followed by msec and a comma waits too
+// qf200#  qr220,90#  w1500,u#   and o# cancels what is still queued
+//
+// a single ! (no # needed) is an emergency stop: the motors brake at once and stay braked until x# is sent
+// a motor driver fault brakes that motor and is reported as mF<fault mask>,<msec>, x# clears it (see k_motorControl)
+//
+// P# reports the battery percent, load compensated millivolts and estimated minutes left: mP72,12150,48
+// (see the battery estimator in c_sensors)
+//
+// S1# turns on the cliff and obstacle monitor, S0# turns it off, S# reports it (see o_safetyMonitor)
+//
+// K1# turns on the stall detector, K0# turns it off, K# reports it (see q_stallDetector);
+// a stuck wheel stops the robot and is reported as mK<kind>,<wheel mask>
+//
+// with a gyro, a turn slows down as it gets near the degrees asked for and cuts the motors where it
+// expects the coast to end on them; the coast for each turning rate is learned turn by turn and kept in
+// the turn_overshoot_ parameters, learn_turn_overshoot 0 stops the learning (see d_imu and hostTools/turnSim)
+//
+// for tuning (see t_EEPROM for the details), after Z# enables EEPROM writing:
+// W followed by address,value pairs sets many parameters at once, live at once and written in the background,
+// answered when they are written and read back: W102,200,106,10#  ->  mW2,<crc of "102,200,106,10">,0
+//
+// parameters by id rather than EEPROM address (see u_parameters and hostTools/parameterTool):
+// G1# reports one: mG1,220,0   G# reports them all   V1,200# sets one, live at once: mV1,200,0
+// C# writes them all to the EEPROM, after Z#, answered once they are written: mC47,0
+//
+// M# reports the SRAM left for the stack: the most the stack has used since reset, the bytes it has
+// never touched, and the bytes free right now: mM1480,4210,4630 (see hostTools/stackDepth for the worst case)
+//
+// D# reports the cpu cycles of the heading arithmetic in the last goStraight step and the most so far, and
+// whether this is the float free build: mD832,1024,1 (see d_imu; build with ROBOT_FIXED_POINT set to 1
+// to leave out the float code, hostTools/fixedPointCheck compares the two)
+//
+// A# reports the customer number and bluetooth address from the EEPROM: mA0,00:06:66:46:5A:60
+// (hostTools/robotFleet uses it to name the robots it runs)
+//
+// ?# lists every command the robot knows (see commandTable in p_handleCommands; hostTools/sketchHost
+// runs the sketch on the host and sends it every command, see commandTest there)
 
 // for the arduino mega, pin 47 corresponds to pin T5 on the ATMEL 2560
 // ATMEL T0 = arduino mega 38
@@ -98,13 +142,36 @@
 //Pin 46, 45 and 44:: controlled by timer 5
 
 
+// the board and the optional features, see libraries/RobotCommCore for the choices;
+// they can also be given with -D, as hostTools/buildMatrix does
+#ifndef ROBOT_BOARD
+#define ROBOT_BOARD ROBOT_BOARD_PCB
+#endif
+#include <RobotCommCore.h>
+
 // these are used by most of the programs:
 
 // SERIAL_PORT is used to print locally to the serial monitor (diagnostics) and is the port for program updates
-#define SERIAL_PORT Serial  
-// SERIAL_PORT_BLUETOOTH is the port used for comm with the laptop or tablet.  Note that you can set this to the same value as SERIAL_PORT
-// and then the serial monitor I/O will mimic the I/O from a robot.  This is very useful for testing. 
-#define SERIAL_PORT_BLUETOOTH Serial2
+#define SERIAL_PORT Serial
+// the diagnostics on SERIAL_PORT go through logger.message(), see libraries/RobotLog; build with
+// -DROBOT_LOG_IDS=1 to send message ids instead of text, and read them with hostTools/logExpander.
+// Literal text sent anywhere else is wrapped in F() so it stays in flash.
+#include <RobotLog.h>
+robotLog logger(SERIAL_PORT);
+// SERIAL_PORT_BLUETOOTH is the port used for comm with the laptop or tablet.  It is the interrupt driven, buffered
+// replacement for Serial2 from the BufferedUART library, so that commands sent back to back are queued and run in order
+// rather than thrown away.  Serial2 itself must not be used anywhere in the sketch.  Buffer sizes are in p_handleCommands.
+#include <BufferedUART.h>
+#define SERIAL_PORT_BLUETOOTH BufferedSerial2
+
+// set from the bluetooth receive interrupt when the emergency stop character arrives, see k_motorControl
+volatile bool emergencyStopLatched = false;
+// set from the timer interrupt when the bluetooth link goes quiet while moving, see l_timerTick
+volatile bool linkLost = false;
+// set from the timer interrupt while it brings a forward move to a stop for a cliff or obstacle, see o_safetyMonitor
+volatile bool safetyStopping = false;
+// set from the timer interrupt when a drive wheel is stalled, free spinning or slipping, see q_stallDetector
+volatile bool stallStopping = false;
 
 
 unsigned long timeOutCheck;  // if the robot is moving and the arduino has not heard
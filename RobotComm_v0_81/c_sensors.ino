@@ -1,23 +1,68 @@
 // sensors
 #include <Wire.h> // for I2C
+#include <backgroundADC.h>
 
 
 int battery_monitor_pin_default;
 int encoder_ticks_per_cm_default;
 
+// analog inputs
+// The ADC is run by the background scanner (started in startAnalogScan()), so a plain analogRead() would
+// fight with its interrupt.  Pins it scans come back smoothed over a few msec without waiting;
+// anything else gets a one-off conversion with the scan paused.
+int readAnalogSmoothed(byte pin)
+{
+  int8_t slot = backgroundAnalog.slotForPin(pin);
+  if (slot == BACKGROUND_ADC_NO_SLOT || !backgroundAnalog.running()) return backgroundAnalog.analogRead(pin);
+  return backgroundAnalog.readFiltered(slot);
+}
+
 //battery
+// The estimator (batteryEstimator in libraries/RobotCommCore) runs from the 1 msec timer tick every
+// BATTERY_UPDATE_INTERVAL msec, all in integer math, and adds the sag under motor load back onto the
+// measured voltage before it is compared with the zero and full percent voltages.
+// checkBattery(), batteryMilliVolts() and batteryRuntimeMinutes() just read the results.
 
-double zero_percent_battery_voltage_default,full_battery_voltage_default,voltage_divider_ratio_default;
+#define BATTERY_UPDATE_INTERVAL 100     // msec, the voltage filter time constant is then about 0.8 s
+#define BATTERY_CAPACITY_MAH 2200
+#define BATTERY_RESISTANCE_MILLIOHMS 100
+#define BATTERY_IDLE_CURRENT_MA 150     // Mega, bluetooth and gyro, the current sense does not see them
+#define BATTERY_REST_CURRENT_MA 100     // below this the motors count as resting
 
-int checkBattery()
+robotReal zero_percent_battery_voltage_default,full_battery_voltage_default,voltage_divider_ratio_default;
+
+batteryEstimator battery(BATTERY_CAPACITY_MAH, BATTERY_RESISTANCE_MILLIOHMS, BATTERY_IDLE_CURRENT_MA, BATTERY_REST_CURRENT_MA);
+byte batteryTicks = BATTERY_UPDATE_INTERVAL - 2;  // on msec 2 of every 10, see l_timerTick
+
+// the settings are robotReal volts and ratios, kept to tenths, so work out the integer scales once after setDefaults()
+void startBatteryEstimator()
 {
-  double voltage =  (double) ((analogRead(battery_monitor_pin_default) / 1023.) * 5.0 ) * voltage_divider_ratio_default;
-  double batteryRange = full_battery_voltage_default - zero_percent_battery_voltage_default;
-  int batteryPercent =  (int) ( 100. * ( ( voltage - zero_percent_battery_voltage_default) / batteryRange)); // returns percentage
-  if (batteryPercent > 99) batteryPercent = 100;
-  if (batteryPercent < 0) batteryPercent = 0;
-  //batteryPercent = analogRead(BATTERY_MONITOR_PIN);  // for testing 
-  return batteryPercent;
-} 
+  battery.begin(realRound(zero_percent_battery_voltage_default * 10) * 100, realRound(full_battery_voltage_default * 10) * 100,
+                (unsigned long) realRound(voltage_divider_ratio_default * 10) * 500000UL / 1023);
+}
+
+// runs in the timer interrupt every msec
+void batteryEstimatorTick()
+{
+  if (++batteryTicks < BATTERY_UPDATE_INTERVAL) return;
+  batteryTicks = 0;
+  long motorCurrent = ((long) readAnalogSmoothed(FBA) + readAnalogSmoothed(FBB) + readAnalogSmoothed(FBC)) * ROBOT_MILLIAMPS_PER_COUNT;
+  int batteryCount = readAnalogSmoothed(battery_monitor_pin_default);
+  battery.update(batteryCount, motorCurrent, BATTERY_UPDATE_INTERVAL);
+}
+
+// load compensated, filtered pack voltage
+unsigned int batteryMilliVolts()
+{
+  return battery.milliVolts();
+}
 
+unsigned int batteryRuntimeMinutes()
+{
+  return battery.runtimeMinutes();
+}
 
+int checkBattery()
+{
+  return battery.percent(readAnalogSmoothed(battery_monitor_pin_default));
+} 
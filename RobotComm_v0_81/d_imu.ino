@@ -1,20 +1,39 @@
 // gyro
 #include <Wire.h> // for I2C
 #include <L3G.h> // for gyro
+#include <RobotParameters.h>  // for the turn_overshoot_ ids
 
-#define GYRO_GAIN_YAW 0.07 // full scale sensitivity is 2000 dps = 70 mdps/digit
+// full scale sensitivity is 2000 dps = 70 mdps/digit, see gyroRate() in libraries/RobotCommCore/robotMath.h
 #define GYRO_LOOP_PERIOD 20 // this determines how long between readings and also used for 
                         // integrating the degress/sec data to degrees
 
 L3G gyro;
 
-double gyroYaw, gyroZBaseline, totalYaw = 0, gyroBaselinePoints = 0, gyroBaselineMaxLength = 32;
+#define TURN_STORE_CHANGE 5  // tenths of a degree a learned overshoot moves before it is written to the EEPROM
+
+// robotReal is double, or a Fixed with ROBOT_FIXED_POINT (see libraries/RobotCommCore)
+robotReal gyroYaw, gyroZBaseline, totalYaw = 0;
+int gyroBaselinePoints = 0, gyroBaselineMaxLength = 32;
+// the stall detector runs in the timer interrupt, which can't use I2C, so each gyro read leaves the rate here
+volatile int yawRateTenths = 0;  // 0.1 degrees/sec
+volatile unsigned long yawRateMillis = 0;  // when it was read
+
+// the time the heading arithmetic takes in a goStraight step, with the gyro read and the logging left out;
+// D# reports it in cpu cycles, to compare the double build with ROBOT_FIXED_POINT (micros() steps by 4 usec)
+unsigned long controlMathMicros = 0;  // this step so far
+unsigned long controlCyclesLast = 0, controlCyclesMax = 0;
+
+// the overshoot gyroTurnDelay() expects after the cut, by turning rate, learned as it goes
+// (turn_overshoot_0 - 7 in the parameter registry, learn_turn_overshoot turns the learning off)
+byte turnOvershootTenths[TURN_RATE_BINS];
+byte learn_turn_overshoot_default;
+turnController turnControl(turnOvershootTenths);
 
 boolean Gyro_Init()
 {
   if (!gyro.init())
   {
-     SERIAL_PORT.println("Gyro not present");
+     logger.message(LOG_GYRO_MISSING);
      return false;
   }
   gyro.writeReg(L3G_CTRL_REG1, 0x0F); // normal power mode, all axes enabled, 100 Hz
@@ -31,28 +50,41 @@ boolean Gyro_Init()
   return true;
 }
 
-double readGyro()
+robotReal readGyro()
 {
   gyro.read();
-  gyroYaw = (gyro.g.z - gyroZBaseline) * GYRO_GAIN_YAW;
+  gyroYaw = gyroRate(gyro.g.z, gyroZBaseline);
+  publishYawRate();
   return gyroYaw;
 
 }
 
-double updateYaw(unsigned long deltaT)
+robotReal updateYaw(unsigned long deltaT)
 {
-  double integrationTime = ((double) deltaT) / 1000.; // convert long ms to double seconds
   gyro.read();
-  totalYaw += ((gyro.g.z - gyroZBaseline) * GYRO_GAIN_YAW) * integrationTime;
+  unsigned long mathStart = micros();
+  gyroYaw = gyroRate(gyro.g.z, gyroZBaseline);  // keep the latest rate for telemetry
+  totalYaw += yawStep(gyroYaw, deltaT);
+  controlMathMicros = micros() - mathStart;
+  publishYawRate();
   return totalYaw;
 }
 
+void publishYawRate()
+{
+  int tenths = (int) (gyroYaw * 10);
+  noInterrupts();
+  yawRateTenths = tenths;
+  yawRateMillis = millis();
+  interrupts();
+}
+
 // for a single baseline datapoint, this routine takes around 1 to 2 msec
 // for more than one, it takes about 22 msec per point, due to the 20 msec delay time used
 // to space out the data for meaningful variations
 void updateGyroBaseline(int numPoints)
 {
-   double gyroZCumulative = 0;
+   long gyroZCumulative = 0;
    if (numPoints < 1 || numPoints > gyroBaselineMaxLength) numPoints = gyroBaselineMaxLength;
    gyroBaselinePoints -= numPoints;
    if (gyroBaselinePoints < 0) gyroBaselinePoints = 0; // make an entirely new baseline
@@ -62,77 +94,99 @@ void updateGyroBaseline(int numPoints)
     gyroZCumulative += gyro.g.z;
     if (i + 1 < numPoints) delay(20); // don't delay on the last pass through the loop
    }
-   gyroZBaseline = (gyroZCumulative + (gyroZBaseline * gyroBaselinePoints))
-                      / ((double)(numPoints + gyroBaselinePoints));
+   gyroZBaseline = foldBaseline(gyroZBaseline, gyroBaselinePoints, gyroZCumulative, numPoints);
    gyroBaselinePoints = numPoints + gyroBaselinePoints;
    
    //  // dont let the baseline get too old or long
    if (gyroBaselinePoints > gyroBaselineMaxLength) gyroBaselinePoints = gyroBaselineMaxLength;
    if (numPoints > 1)  // don't print the results of the loop updates
    {
-     SERIAL_PORT.print("Gyro baseline yaw = ");
-     SERIAL_PORT.print(gyroZBaseline * GYRO_GAIN_YAW); 
-     SERIAL_PORT.println(" degrees (positive is to the right)");
+     logger.message(LOG_GYRO_BASELINE, gyroDegrees(gyroZBaseline));
    }
 }
 
+void finishControlStep(unsigned long stepMicros)
+{
+  controlCyclesLast = (controlMathMicros + stepMicros) * (F_CPU / 1000000L);
+  if (controlCyclesLast > controlCyclesMax) controlCyclesMax = controlCyclesLast;
+}
+
 void resetYaw()
 {
   totalYaw = 0;
 }
 
-double gyroTurnDelay(int degrees)
+// gyro turns slow down on the way in and cut the motors where the learned coast ends on the target
+// (libraries/RobotCommCore/turnController.h); the overshoot table is in the parameter registry, so
+// what one turn learns is kept, and written to the EEPROM once it has moved TURN_STORE_CHANGE
+robotReal gyroTurnDelay(int degrees, int speed, int floorSpeed)
 {
-      SERIAL_PORT.print("in gyro turn delay for degrees = ");
-      SERIAL_PORT.println(degrees);
-      double cumulativeYaw = 0, timeOut = 5, totalT;
+      logger.message(LOG_GYRO_TURN, degrees);
+      robotReal cumulativeYaw = 0;
+      unsigned long timeOut = 5000, totalT = 0;  // msec
+      unsigned int step = GYRO_LOOP_PERIOD;
+      int pwm = turnControl.begin(degrees * 10L, speed, floorSpeed);
+      bool driving = steerTurn(speed > 0 ? pwm : -pwm);
       long previousTime = millis();
-      // delay until we reach the specified number of degrees
-      // or reach the timeOut value (in seconds)
-      while (abs(cumulativeYaw) < degrees && totalT < timeOut ) 
+      // slow down and cut the motors as we get to the specified number of degrees,
+      // or stop at the timeOut value (in msec)
+      while (driving && totalT < timeOut && !motionInhibited())
       {
-        delay(20);
+        backgroundDelay(step);
         gyro.read();
         long currentTime = millis();
-        double deltaT = ((double) (currentTime - previousTime)) / 1000.; // convert long ms to double seconds
+        unsigned long deltaT = currentTime - previousTime;
         previousTime = currentTime; 
-        cumulativeYaw += (gyro.g.z - gyroZBaseline) * GYRO_GAIN_YAW * deltaT;
+        gyroYaw = gyroRate(gyro.g.z, gyroZBaseline);
+        publishYawRate();
+        cumulativeYaw += yawStep(gyroYaw, deltaT);
         totalT += deltaT;
         //SERIAL_PORT.print("cumulativeYaw, deltaYaw, deltaT = ");
         //SERIAL_PORT.print(cumulativeYaw);
         //SERIAL_PORT.print(", ");
-        //SERIAL_PORT.print((gyro.g.z - gyroZBaseline) * GYRO_GAIN_YAW * deltaT);
+        //SERIAL_PORT.print(yawStep(gyroRate(gyro.g.z, gyroZBaseline), deltaT));
         //SERIAL_PORT.print(", ");
         //SERIAL_PORT.println(deltaT);
+        pwm = turnControl.update(realRound(abs(cumulativeYaw) * 10), realRound(abs(gyroYaw) * 10));
+        if (pwm == 0) break;
+        driving = steerTurn(speed > 0 ? pwm : -pwm);
+        step = turnControl.nextStep(GYRO_LOOP_PERIOD);
       }
       coast();
-      SERIAL_PORT.print("When coast command issued, yaw was = ");
-      SERIAL_PORT.println(cumulativeYaw);
+      logger.message(LOG_GYRO_COAST_YAW, cumulativeYaw);
       // give it a moment to stop, monitor yaw during this time
-      for (int i=0; i < 10; i++)
+      for (int i=0; i < TURN_SETTLE_STEPS; i++)
       {
-        delay(20);
+        backgroundDelay(GYRO_LOOP_PERIOD);
         gyro.read();
         long currentTime = millis();
-        double deltaT = ((double) (currentTime - previousTime)) / 1000.; // convert long ms to double seconds
+        unsigned long deltaT = currentTime - previousTime;
         previousTime = currentTime; 
-        cumulativeYaw += (gyro.g.z - gyroZBaseline) * GYRO_GAIN_YAW * deltaT;
+        gyroYaw = gyroRate(gyro.g.z, gyroZBaseline);
+        publishYawRate();
+        cumulativeYaw += yawStep(gyroYaw, deltaT);
         totalT += deltaT;
         //SERIAL_PORT.print("cumulativeYaw, deltaYaw, deltaT = ");
         //SERIAL_PORT.print(cumulativeYaw);
         //SERIAL_PORT.print(", ");
-        //SERIAL_PORT.print((gyro.g.z - gyroZBaseline) * GYRO_GAIN_YAW * deltaT);
+        //SERIAL_PORT.print(yawStep(gyroRate(gyro.g.z, gyroZBaseline), deltaT));
         //SERIAL_PORT.print(", ");
         //SERIAL_PORT.println(deltaT);
+        if (realRound(abs(gyroYaw) * 10) < TURN_SETTLED_RATE) break;
       }
     
       totalYaw += cumulativeYaw;  // total degrees
-      SERIAL_PORT.print("Yaw this turn, totalYaw = ");
-      SERIAL_PORT.print(cumulativeYaw);
-      SERIAL_PORT.print(", ");
-      SERIAL_PORT.println(totalYaw);
-      SERIAL_PORT.print("Yaw baseline = ");
-      SERIAL_PORT.println(gyroZBaseline * GYRO_GAIN_YAW);
+      logger.message(LOG_GYRO_TURN_YAW, cumulativeYaw, totalYaw);
+      logger.message(LOG_GYRO_YAW_BASELINE, gyroDegrees(gyroZBaseline));
+      if (learn_turn_overshoot_default && turnControl.learn(realRound(abs(cumulativeYaw) * 10)))
+      {
+        byte bin = turnControl.learnedBin();
+        logger.message(LOG_TURN_LEARNED, turnControl.cutRateTenths(), bin, turnOvershootTenths[bin]);
+        for (byte id = PARAM_TURN_OVERSHOOT_0 + bin; id <= PARAM_TURN_OVERSHOOT_0 + bin + 1; id++)  // the two it moved
+        {
+          if (abs(getParameter(id) - storedParameter(id)) >= TURN_STORE_CHANGE) storeParameter(id);
+        }
+      }
      
       return abs(cumulativeYaw); // return absolute value of total degees turned
 }
@@ -1,8 +1,15 @@
 // motor control routines
-#include <threeMotorsDriverPCB.h>
+// the driver class and its pins come from the board selected in the first tab, see libraries/RobotCommCore
 
-threeMotorsDriverPCB motorDriver;
-double goStraight(double initialYaw, double previousYaw, unsigned long previousTime, int mySpeed);
+// The PCB as built ties the left and right bridge status lines together on pin 28, which has no pin change
+// interrupt, so a fault can only be found by polling and can't be pinned on one side; that is the default.
+// A PCB reworked to bring a status line per bridge out to A10 - A12 is built with ROBOT_FAULT_INTERRUPTS 1.
+#if ROBOT_FAULT_INTERRUPTS
+robotMotorDriver motorDriver(ROBOT_FAULT_PIN_A, ROBOT_FAULT_PIN_B, ROBOT_FAULT_PIN_C);
+#else
+robotMotorDriver motorDriver;
+#endif
+robotReal goStraight(robotReal initialYaw, robotReal previousYaw, unsigned long previousTime, int mySpeed);
 
 int currentTopMotor, currentRightMotor, currentLeftMotor, current_limit_enabled_default;
 int bw_reduction_default, ticks_per_degree_of_tilt_default;
@@ -12,80 +19,298 @@ int min_accel_speed_default, min_decel_speed_default, delta_speed_default, accel
 int left_motor_bias_default, left_motor_bw_bias_default, left_motor_stop_delay_default;
 int right_motor_bias_default, right_motor_bw_bias_default, right_motor_stop_delay_default;
 int current_limit_top_motor_default, current_limit_drive_motors_default;
-double previousDeltaYaw = 0;
+robotReal previousDeltaYaw = 0;
 
 int commandForeverSpeed, dampenChangesCounter = 0;
+int commandedLeftSpeed = 0, commandedRightSpeed = 0, commandedTopSpeed = 0;  // last PWM sent to the driver, for telemetry
+volatile int requestedLeftSpeed = 0, requestedRightSpeed = 0;  // what the motion routines asked for, see the power governor
 
 bool Moving = false, Turning = false, Tilting = false, brakesOn, gyroPresent;
+bool movingForever = false;
 
 //bool modify_motor_biases_default;
 bool modify_motor_biases_default = 0; // ************changed for testing *********************************
 
 
-bool checkForFault()
+// emergency stop
+// EMERGENCY_STOP_CHARACTER is caught by the bluetooth receive interrupt itself (see BufferedUART), so it
+// brakes the motors even while a blocking move or turn is running and commands are waiting in the buffer.
+// The stop is latched: nothing will drive the motors, and blocking routines give up, until the
+// operator acknowledges it with x (Stop).  The latch, emergencyStopLatched, is declared in the first tab
+// since the gyro routines check it too.
+#define EMERGENCY_STOP_CHARACTER '!'
+
+bool emergencyStopReported = false;
+
+// runs inside the receive interrupt, so keep it short and don't print
+void emergencyStop()
+{
+  motorDriver.setBrakesAB();
+  requestedLeftSpeed = 0;
+  requestedRightSpeed = 0;
+  motorDriver.setBrakesC();
+  emergencyStopLatched = true;
+  commandedLeftSpeed = 0;
+  commandedRightSpeed = 0;
+  commandedTopSpeed = 0;
+}
+
+// called from loop(), tells both ports once per emergency stop
+void reportEmergencyStop()
 {
-  bool result = false;
-  if (!motorDriver.getStatusA())
+  if (!emergencyStopLatched || emergencyStopReported) return;
+  emergencyStopReported = true;
+  Moving = false;
+  movingForever = false;
+  Turning = false;
+  Tilting = false;
+  brakesOn = true;
+  logger.message(LOG_EMERGENCY_STOP);
+  SERIAL_PORT_BLUETOOTH.println(F("m!"));
+}
+
+// true while something other than the command loop owns the motors; motion routines must not drive them
+// and blocking routines should give up
+bool motionInhibited()
+{
+  return emergencyStopLatched || linkLost || safetyStopping || stallStopping;
+}
+
+void acknowledgeEmergencyStop()
+{
+  if (!emergencyStopLatched) return;
+  emergencyStopLatched = false;
+  emergencyStopReported = false;
+  logger.message(LOG_EMERGENCY_STOP_ACK);
+}
+
+// motor driver faults
+// A bridge pulls its status line low on overcurrent, overtemperature or undervoltage.  The status lines
+// interrupt on any change (or, without ROBOT_FAULT_INTERRUPTS, are polled from the 1 msec timer tick),
+// and the handler brakes the faulting bridge at once, both drive wheels for a fault on either, and
+// latches it in motorFaults with the time of the first fault.  The motion routines only look at that
+// flag word.  loop() reports a fault once as mF<fault mask>,<msec since the fault>, bit 0 the left
+// motor, 1 the right, 2 the top; with the shared status pin a left or right fault sets both bits.
+// x (Stop) clears the latch for bridges whose status line has gone back high.
+
+volatile byte motorFaults = 0;  // MOTOR_FAULT_ bits, latched
+volatile unsigned long motorFaultMillis = 0;
+bool motorFaultInterrupts = false;
+bool motorFaultReported = false;
+
+// runs in an interrupt
+void latchMotorFaults()
+{
+  byte faults = readMotorFaults(motorDriver) & ~motorFaults;
+  if (!faults) return;
+  if (faults & (MOTOR_FAULT_A | MOTOR_FAULT_B))
   {
-      motorDriver.setBrakesAB();
-      SERIAL_PORT.println("Fault detected in left motor ");
-      result = true;
+    motorDriver.setBrakesAB();  // both wheels, one wheel alone would spin the robot
+    requestedLeftSpeed = 0;  // so the power governor does not drive them again
+    requestedRightSpeed = 0;
+    commandedLeftSpeed = 0;
+    commandedRightSpeed = 0;
   }
-  if (!motorDriver.getStatusB())
+  if (faults & MOTOR_FAULT_C)
   {
-      motorDriver.setBrakesAB();
-      SERIAL_PORT.println("Fault detected in right motor ");
-      result = true;
+    motorDriver.setBrakesC();
+    commandedTopSpeed = 0;
   }
-  
-  if (!motorDriver.getStatusC())
+  if (!motorFaults) motorFaultMillis = millis();
+  motorFaults |= faults;
+}
+
+#if ROBOT_FAULT_INTERRUPTS
+ISR(ROBOT_FAULT_vect)
+{
+  latchMotorFaults();
+}
+#endif
+
+void startMotorFaultMonitor()
+{
+#if ROBOT_FAULT_INTERRUPTS
+  motorFaultInterrupts = motorDriver.enableFaultInterrupts();
+#endif
+  latchMotorFaults();  // a bridge may already be faulted
+}
+
+// runs in the timer interrupt every msec
+void motorFaultTick()
+{
+  if (!motorFaultInterrupts) latchMotorFaults();
+}
+
+bool checkForFault()
+{
+  return motorFaults != 0;
+}
+
+// called from loop(), tells both ports once per fault
+void reportMotorFault()
+{
+  if (!motorFaults || motorFaultReported) return;
+  motorFaultReported = true;
+  noInterrupts();
+  byte faults = motorFaults;
+  unsigned long elapsed = millis() - motorFaultMillis;
+  interrupts();
+  if (faults & (MOTOR_FAULT_A | MOTOR_FAULT_B))
   {
-      motorDriver.setBrakesC();
-      SERIAL_PORT.println("Fault detected in top motor ");
-      result = true;
+    Moving = false;
+    movingForever = false;
+    Turning = false;
   }
-  return result;
+  if (faults & MOTOR_FAULT_C) Tilting = false;
+  logger.message(LOG_MOTOR_FAULT, faults);
+  SERIAL_PORT_BLUETOOTH.print(F("mF"));
+  SERIAL_PORT_BLUETOOTH.print(faults);
+  SERIAL_PORT_BLUETOOTH.print(',');
+  SERIAL_PORT_BLUETOOTH.println(elapsed);
+}
+
+void clearMotorFaults()
+{
+  if (!motorFaults) return;
+  noInterrupts();
+  motorFaults = 0;
+  latchMotorFaults();  // anything still faulted latches again, with a new time
+  interrupts();
+  motorFaultReported = false;
+  if (!motorFaults) logger.message(LOG_MOTOR_FAULTS_CLEARED);
 }
 
 void coast()
 {
   //SERIAL_PORT.println("coasting");
-  motorDriver.setCoastAB();
+  requestedLeftSpeed = 0;
+  requestedRightSpeed = 0;
+  if (emergencyStopLatched) motorDriver.setBrakesAB();  // stay braked until the emergency stop is acknowledged
+  // with the link lost, or a cliff ahead, the timer interrupt is ramping the motors down
+  else if (!linkLost && !safetyStopping) motorDriver.setCoastAB();
+  if (!linkLost && !safetyStopping)
+  {
+    commandedLeftSpeed = 0;
+    commandedRightSpeed = 0;
+  }
   brakesOn = false;
   Moving = false;
+  movingForever = false;
   Turning = false;
 }
 
 void coastTilt()
 {
-  motorDriver.setCoastC();
+  if (emergencyStopLatched) motorDriver.setBrakesC();
+  else if (!linkLost)
+  {
+    motorDriver.setCoastC();
+    commandedTopSpeed = 0;
+  }
   Tilting = false;
 }
 
 void brakes()
 {
   //SERIAL_PORT.println("braking");
+  requestedLeftSpeed = 0;
+  requestedRightSpeed = 0;
   motorDriver.setBrakesAB();
+  commandedLeftSpeed = 0;
+  commandedRightSpeed = 0;
   brakesOn = true;
 }
 
 void Stop()
 {
-  SERIAL_PORT.println("stopping");
+  logger.message(LOG_STOPPING);
+  requestedLeftSpeed = 0;
+  requestedRightSpeed = 0;
   motorDriver.setBrakesAB();
+  commandedLeftSpeed = 0;
+  commandedRightSpeed = 0;
   brakesOn = true;
   Moving = false;
+  movingForever = false;
   Turning = false;
 }
 
 
+// power governor
+// The drive wheels are not set directly: the motion routines call setDriveSpeeds() with what they want,
+// and the governor (powerGovernor in libraries/RobotCommCore) passes it on to the driver with the PWM
+// slewed up gently and capped while the bus sags or the battery is nearly empty, so a hard start on a
+// tired pack doesn't reset the Mega or drop the bluetooth link.
+// It runs in the timer tick, so the ramp continues while loop() waits, and it leaves the wheels alone
+// while a watchdog or the safety monitor owns them.  The cap, the bus voltage and the reasons for
+// limiting (TELEMETRY_POWER_* flags) go out on the TELEMETRY_POWER channel.
+
+#define POWER_INTERVAL 10              // msec, the slew then takes about 130 msec from 0 to full
+#define POWER_CURRENT_LIMIT_MA 6000    // both drive motors together
+#define POWER_BUS_MIN_MILLIVOLTS 9000
+
+powerGovernor governor(POWER_BUS_MIN_MILLIVOLTS, POWER_CURRENT_LIMIT_MA);
+byte powerTicks = 6;  // on msec 4 of every 10, see l_timerTick
+
+// called with interrupts off
+void applyPowerLimits()
+{
+  int left = governor.limit(commandedLeftSpeed, requestedLeftSpeed);
+  int right = governor.limit(commandedRightSpeed, requestedRightSpeed);
+  if (left == commandedLeftSpeed && right == commandedRightSpeed) return;
+  commandedLeftSpeed = left;
+  commandedRightSpeed = right;
+  motorDriver.setSpeedAB(left, right);
+}
+
+void setDriveSpeeds(int leftSpeed, int rightSpeed)
+{
+  noInterrupts();
+  requestedLeftSpeed = leftSpeed;
+  requestedRightSpeed = rightSpeed;
+  applyPowerLimits();  // the first step goes out now, the timer tick does the rest
+  interrupts();
+}
+
+// runs in the timer interrupt every msec
+void powerGovernorTick()
+{
+  if (++powerTicks < POWER_INTERVAL) return;
+  powerTicks = 0;
+  if (!motionInhibited() && battery.started())
+  {
+    long headroom = POWER_HEADROOM_UNKNOWN;
+    if (battery.remaining() >= 0) headroom = battery.headroomMilliVolts();
+    long driveCurrent = ((long) readAnalogSmoothed(FBA) + readAnalogSmoothed(FBB)) * ROBOT_MILLIAMPS_PER_COUNT;
+    int batteryCount = readAnalogSmoothed(battery_monitor_pin_default);
+    noInterrupts();
+    int left = requestedLeftSpeed, right = requestedRightSpeed;
+    interrupts();
+    governor.update(battery.busMilliVolts(batteryCount), headroom, driveCurrent, left, right);
+  }
+  noInterrupts();  // a stop may have come in during the update
+  if (motionInhibited())  // the watchdogs own the wheels, and nothing should restart them afterward
+  {
+    requestedLeftSpeed = 0;
+    requestedRightSpeed = 0;
+  }
+  else if (battery.started()) applyPowerLimits();
+  interrupts();
+}
+
+
 // calling moveForward with speed 0 causes motors to coast to stop
 // while calling Stop() causes motors to stop and brake.
 
 void commandMove(int moveSpeed)
 {
   int leftSpeed, rightSpeed;
-  if (moveSpeed != 0 && (!checkForFault()))
+  if (moveSpeed > 0 && forwardBlocked())
+  {
+    logger.message(LOG_SAFETY_BLOCKED);
+    moveSpeed = 0;
+  }
+  if (moveSpeed != 0 && !motionInhibited() && (!checkForFault()))
   {
     if (moveSpeed > 0) 
     {
@@ -101,12 +326,9 @@ void commandMove(int moveSpeed)
       if (leftSpeed < -255) leftSpeed = -255;
       if (rightSpeed < -255) rightSpeed = -255;
     }
-    motorDriver.setSpeedAB(leftSpeed, rightSpeed);
+    setDriveSpeeds(leftSpeed, rightSpeed);
     Moving = true;
-    SERIAL_PORT.print("moving, L, R speeds = ");
-    SERIAL_PORT.print(leftSpeed);
-    SERIAL_PORT.print(", ");
-    SERIAL_PORT.println(rightSpeed);
+    logger.message(LOG_MOVING_SPEEDS, leftSpeed, rightSpeed);
   }
   else coast();
 }
@@ -115,69 +337,66 @@ void commandMove(int moveSpeed)
 void move(int mySpeed, int moveTime)
 {
   if (Moving || Turning) coast(); // protect from reversing a motor abruptly, although this state should never occur
-  SERIAL_PORT.print("moving, speed = ");
-  SERIAL_PORT.println(mySpeed);
+  logger.message(LOG_MOVING, mySpeed);
   int goSpeed = min_accel_speed_default;
-  double initialYaw;
+  robotReal initialYaw = totalYaw;
   long delayTime; // default is move forever;
   if (moveTime == 0) delayTime = move_time_default; // move a normal time
   else delayTime = moveTime;  // move for a specified time, negative 1 means move forever
   
-  SERIAL_PORT.print("move time = ");
-  SERIAL_PORT.println(delayTime);  
+  logger.message(LOG_MOVE_TIME, delayTime);
   timeOutCheck = millis();
+  startBiasLearning();
   if (delayTime < 0)  // go until told to stop
   {
     commandMove(mySpeed);
     commandForeverSpeed = mySpeed;
+    movingForever = Moving;
     return;
   }
 
   if ((!gyroPresent))
   {
-    while ( (long)(millis() - timeOutCheck) < delayTime) // won't loop if delayTime = -1 (move forever)
+    while ( (long)(millis() - timeOutCheck) < delayTime && !motionInhibited()) // won't loop if delayTime = -1 (move forever)
     {
       //accelerate(mySpeed);
       goSpeed += delta_speed_default; // accelerate every 100 msec
       if (goSpeed > abs(mySpeed)) goSpeed = abs(mySpeed);
-      SERIAL_PORT.print("unbiased command speed = ");
-      SERIAL_PORT.println(goSpeed);
+      logger.message(LOG_UNBIASED_SPEED, goSpeed);
       if (mySpeed > 0) commandMove(goSpeed);
       else commandMove(-goSpeed);
-      delay(100);
+      backgroundDelay(100);
     }
   }
   else
   {
     long moveCount = 1;
     unsigned long timePrevious = millis();
-    initialYaw = totalYaw;
-    double previousYaw = initialYaw;
-    while ( (long)(millis() - timeOutCheck) < delayTime) // won't loop if delayTime = 0 (move forever)
+    robotReal previousYaw = initialYaw;
+    while ( (long)(millis() - timeOutCheck) < delayTime && !motionInhibited()) // won't loop if delayTime = 0 (move forever)
     // because millis() returns an unsigned long, when delayTime is negative it is greater than millis() - timeOutCheck
     // because it is treating the comparison as if delayTime is an unsigned long, so the negative value is a
     // very large positive number.
     {
-      delay(30);
+      backgroundDelay(30);
       previousYaw = goStraight(initialYaw, previousYaw, timePrevious,  mySpeed);  // change the bias levels to make straighter path
       if ( !(moveCount % 5)) goSpeed += delta_speed_default; // accelerate every 100 msec
       if (goSpeed > abs(mySpeed)) goSpeed = abs(mySpeed);
-      SERIAL_PORT.print("unbiased, unsigned command speed = ");
-      SERIAL_PORT.println(goSpeed);
+      logger.message(LOG_UNBIASED_UNSIGNED_SPEED, goSpeed);
       if (mySpeed > 0) commandMove(goSpeed);
       else commandMove(-goSpeed);
       timePrevious = millis();
       moveCount++;
     }
-    if (modify_motor_biases_default && (delayTime >= 0) )  // if we are in a learning mode, write the new biases to EEPROM to recall next powerup
+    if (discardBiasLearning()) logger.message(LOG_BIASES_NOT_LEARNED);
+    else if (modify_motor_biases_default && (delayTime >= 0) )  // if we are in a learning mode, write the new biases to EEPROM to recall next powerup
     {
       writeToEEPROM(116, left_motor_bias_default);
       writeToEEPROM(210, right_motor_bias_default);
     }
     if (delayTime >=0)
     {
-      SERIAL_PORT.print("delta Yaw during move = ");
-      SERIAL_PORT.println(totalYaw - initialYaw);
+      logger.message(LOG_MOVE_YAW, totalYaw - initialYaw);
     }    
   } 
   // after the delay, we coast to a stop, unless if moveTime < 0, we move forever until told to stop or current limit exceeded
@@ -186,121 +405,95 @@ void move(int mySpeed, int moveTime)
     //  decelerate(mySpeed);
     coast();
   }
-  SERIAL_PORT.println(totalYaw - initialYaw); 
 }
 
 void turn(int mySpeed, int turnAmount)  // turnAmount is either time (ms) or degrees, depending on if a gyro is present
 {
-  double initialYaw;
+  robotReal initialYaw;
   if (Moving || Turning) coast();  // protect from reversing a motor abruptly, although this state should never occur
-  SERIAL_PORT.print("turning, speed, amount = ");
-  SERIAL_PORT.print(mySpeed);
-  SERIAL_PORT.print(", ");
-  SERIAL_PORT.print(turnAmount);
-  if (gyroPresent) SERIAL_PORT.println(" degrees");
-  else SERIAL_PORT.println(" msec");
+  logger.message(gyroPresent ? LOG_TURNING_DEGREES : LOG_TURNING_MSEC, mySpeed, turnAmount);
   //accelerate(mySpeed);
-  if (mySpeed != 0 && (!checkForFault()))
+  if (mySpeed != 0 && !motionInhibited() && (!checkForFault()))
   {
     timeOutCheck = millis();
-    if (mySpeed > 0) motorDriver.setSpeedAB(mySpeed + left_motor_bias_default, -mySpeed - right_motor_bias_default);
-    else motorDriver.setSpeedAB(mySpeed - left_motor_bias_default, -mySpeed + right_motor_bias_default);
+    setTurnSpeeds(mySpeed);
     Turning = true;
   }
   else Stop();
-  if (gyroPresent) gyroTurnDelay(turnAmount); // turn until we reach turnAmount number of degrees or timeout
-    // the gyro routine stops the turn after the turn completed
+  if (gyroPresent) gyroTurnDelay(turnAmount, mySpeed, min_decel_speed_default); // turn until we reach turnAmount number of degrees or timeout
+    // the gyro routine slows and stops the turn as it gets there
     // so that it can monitor the overshoot due to time needed to stop
   else
   {
-     delay(turnAmount); // without a gyro, just turn for a specified time
+     backgroundDelay(turnAmount); // without a gyro, just turn for a specified time
      coast();
   }
 }
 
+// spins in place, positive to the right, with the motor biases
+void setTurnSpeeds(int mySpeed)
+{
+  if (mySpeed > 0) setDriveSpeeds(mySpeed + left_motor_bias_default, -mySpeed - right_motor_bias_default);
+  else setDriveSpeeds(mySpeed - left_motor_bias_default, -mySpeed + right_motor_bias_default);
+}
+
+// a new speed for a turn under way; false once something else has stopped it
+bool steerTurn(int mySpeed)
+{
+  if (!Turning) return false;
+  setTurnSpeeds(mySpeed);
+  return true;
+}
+
 void tilt(int mySpeed, int tiltTime)
 {
-  SERIAL_PORT.print("tilting, speed = ");
-  SERIAL_PORT.println(mySpeed);
-  if (mySpeed != 0 && (!checkForFault()))
+  logger.message(LOG_TILTING, mySpeed);
+  if (mySpeed != 0 && !motionInhibited() && (!checkForFault()))
   {
     motorDriver.setSpeedC(mySpeed);
+    commandedTopSpeed = mySpeed;
     Tilting = true;
   }
-  else motorDriver.setCoastC(); 
+  else coastTilt(); 
   timeOutCheck = millis();
   
-  if (tiltTime == 0) delay(tilt_time_default); // tilt a normal amount
-  else if (tiltTime > 0) delay(tiltTime);  // tilt a specified amount. 
+  if (tiltTime == 0) backgroundDelay(tilt_time_default); // tilt a normal amount
+  else if (tiltTime > 0) backgroundDelay(tiltTime);  // tilt a specified amount. 
   // after delay, coast to a stop or, if tiltTime < 0, we tilt forever until told to stop
-  if (tiltTime >= 0) motorDriver.setCoastC();  // don't set Moving = false, since base might be moving
+  if (tiltTime >= 0) coastTilt();  // don't set Moving = false, since base might be moving
 }
 
 
 // monitor the yaw and change motor biases to make moving go straight
 // don't allow the changes to get too big, as this routine could get fooled by a stuck wheel
-double goStraight(double initialYaw, double previousYaw, unsigned long previousTime, int mySpeed)
+robotReal goStraight(robotReal initialYaw, robotReal previousYaw, unsigned long previousTime, int mySpeed)
 {
   unsigned long deltaTime = millis() - previousTime;
-  double currentYaw = updateYaw(deltaTime);
-  double integratedYaw = currentYaw - initialYaw;
-  double deltaYaw = currentYaw - previousYaw;
+  robotReal currentYaw = updateYaw(deltaTime);
+  robotReal integratedYaw = currentYaw - initialYaw;
+  robotReal deltaYaw = currentYaw - previousYaw;
   int MAX_BIAS = 30;
-  double deltaLeft = 0., deltaRight = 0.;
+  robotReal deltaLeft = 0, deltaRight = 0;
+  
+  if (biasLearningFrozen())  // a wheel looks stuck, so the yaw says nothing about the biases
+  {
+    previousDeltaYaw = deltaYaw;
+    return currentYaw;
+  }
   
-  SERIAL_PORT.print("initial left_motor_bias_default, right_motor_bias_default = ");
-  SERIAL_PORT.print(left_motor_bias_default);
-  SERIAL_PORT.print(", ");
-  SERIAL_PORT.println(right_motor_bias_default);
+  logger.message(LOG_INITIAL_BIASES, left_motor_bias_default, right_motor_bias_default);
   
   if (dampenChangesCounter > 0)
   {
-    SERIAL_PORT.print("dampenChangesCounter = ");
-    SERIAL_PORT.println(dampenChangesCounter);
+    logger.message(LOG_DAMPEN_COUNTER, dampenChangesCounter);
     dampenChangesCounter--;
     previousDeltaYaw = deltaYaw;
     return currentYaw;
   }
   
-  if (deltaYaw * previousDeltaYaw < 0) // sign change-- we are getting near the right numbers
-  {
+  unsigned long mathStart = micros();
+  if (straightCorrection(deltaYaw, previousDeltaYaw, integratedYaw, deltaLeft, deltaRight))  // see libraries/RobotCommCore/robotMath.h
     dampenChangesCounter = 5;
-    if (deltaYaw > 0)  // we want to dampen the last few changes
-    {
-      deltaLeft = -10;
-      deltaRight = 10;
-    }
-  }
-  
-  else
-  {
-    boolean sameSignBias = false;
-    if (deltaYaw * integratedYaw > 0) sameSignBias = true;  // if delta and integrated values have the same sign, double the bias change.
-    
-    //derivative, fast immediate correction
-    if (deltaYaw > 0.2 || (sameSignBias && (deltaYaw > 0.)) ) // this means we have turn to the left, so make right motor stronger, left motor weaker
-    {
-      deltaLeft = -4 - (deltaYaw * 10.); //* sameSignBias;
-      deltaRight = 4 + (deltaYaw * 10.); // * sameSignBias;
-    }
-    if (deltaYaw < -0.2 || (sameSignBias && (deltaYaw < 0.)) )  // we have turn to the right, so make left motor stronger, right motor weaker
-    {
-      deltaLeft = 4 - (deltaYaw * 10.); // * sameSignBias;
-      deltaRight= -4 + (deltaYaw * 10.); // * sameSignBias;   
-    } 
-    
-    //integrative, slowly come back to original heading
-    if (integratedYaw > 2 || (sameSignBias && (integratedYaw > 0.)) ) // this means we have turn to the left, so make right motor stronger, left motor weaker
-    {
-      deltaLeft -= 1 + integratedYaw; // -= sameSignBias;
-      deltaRight += 1 + integratedYaw; // += sameSignBias;  
-    }
-    if (integratedYaw < -2 || (sameSignBias && (integratedYaw < 0.)) )  // we have turn to the right, so make left motor stronger, right motor weaker
-    {
-      deltaLeft += 1 - integratedYaw; //sameSignBias;
-      deltaRight -= 1 - integratedYaw; //sameSignBias;  
-    }
-  }
   
   if (mySpeed > 0)
   {
@@ -340,68 +533,41 @@ double goStraight(double initialYaw, double previousYaw, unsigned long previousT
       if (right_motor_bias_default < MAX_BIAS) right_motor_bias_default -= (int) deltaRight;
     }      
   }    
+  finishControlStep(micros() - mathStart);
   
-  SERIAL_PORT.print("integratedYaw, deltaYaw, deltaTime, left_motor_bias_default, right_motor_bias_default =  ");
-  SERIAL_PORT.print(integratedYaw);
-  SERIAL_PORT.print(", ");
-  SERIAL_PORT.print(deltaYaw);
-  SERIAL_PORT.print(", ");
-  SERIAL_PORT.print( (unsigned int) deltaTime);
-  SERIAL_PORT.print(", ");
-  SERIAL_PORT.print(left_motor_bias_default);
-  SERIAL_PORT.print(", ");
-  SERIAL_PORT.println(right_motor_bias_default);
-  SERIAL_PORT.print("speed, deltaLeft, deltaRight =  ");
-  SERIAL_PORT.print(mySpeed);
-  SERIAL_PORT.print(", ");
-  SERIAL_PORT.print(deltaLeft);
-  SERIAL_PORT.print(", ");
-  SERIAL_PORT.println(deltaRight);
+  logger.message(LOG_STRAIGHT_YAW, integratedYaw, deltaYaw, (unsigned int) deltaTime,
+                 left_motor_bias_default, right_motor_bias_default);
+  logger.message(LOG_STRAIGHT_DELTAS, mySpeed, deltaLeft, deltaRight);
   return currentYaw;
 }
 
 void getMotorCurrents()
 {
-  currentLeftMotor = motorDriver.getCurrentA();
-  currentRightMotor = motorDriver.getCurrentB();
-  currentTopMotor = motorDriver.getCurrentC();
+  currentLeftMotor = readAnalogSmoothed(FBA) * ROBOT_MILLIAMPS_PER_COUNT;
+  currentRightMotor = readAnalogSmoothed(FBB) * ROBOT_MILLIAMPS_PER_COUNT;
+  currentTopMotor = readAnalogSmoothed(FBC) * ROBOT_MILLIAMPS_PER_COUNT;
   if ((currentLeftMotor > current_limit_drive_motors_default
     || currentRightMotor > current_limit_drive_motors_default) && current_limit_enabled_default)
   {
     coast();
-    SERIAL_PORT.print("Excessive motor current detected = ");
-    SERIAL_PORT.print(currentLeftMotor);
-    SERIAL_PORT.print(", ");
-    SERIAL_PORT.println(currentRightMotor);
+    logger.message(LOG_OVER_CURRENT, currentLeftMotor, currentRightMotor);
   }
   if (currentTopMotor > current_limit_top_motor_default && current_limit_enabled_default) 
   {
     motorDriver.setCoastC();  
-    SERIAL_PORT.print("Excessive tilt motor current detected = ");
-    SERIAL_PORT.println(currentTopMotor);
+    logger.message(LOG_TILT_OVER_CURRENT, currentTopMotor);
   }
 }
   
 void monitorMotorCurrents()
 {
-  currentLeftMotor = 0;
-  currentRightMotor = 0;
-  currentTopMotor = 0;
-  // average over 2 ms to include one full duty cycle; each point takes about 0.1 ms to return
-  for (int i=0; i < 20; i++)currentLeftMotor += motorDriver.getCurrentA();
-  for (int i=0; i < 20; i++)currentRightMotor += motorDriver.getCurrentB();
-  for (int i=0; i < 20; i++)currentTopMotor += motorDriver.getCurrentC();
-  currentLeftMotor /= 20.;
-  currentRightMotor /= 20.;
-  currentTopMotor /= 20.;
+  // the background ADC scanner already averages over a few msec, which covers a full PWM duty cycle
+  currentLeftMotor = readAnalogSmoothed(FBA) * ROBOT_MILLIAMPS_PER_COUNT;
+  currentRightMotor = readAnalogSmoothed(FBB) * ROBOT_MILLIAMPS_PER_COUNT;
+  currentTopMotor = readAnalogSmoothed(FBC) * ROBOT_MILLIAMPS_PER_COUNT;
   if (currentLeftMotor > 50 || currentRightMotor > 50 || currentTopMotor > 50)
   {
-    SERIAL_PORT.print("Motor current Left, Right, Top = ");
-    SERIAL_PORT.print(currentLeftMotor);
-    SERIAL_PORT.print(", ");
-    SERIAL_PORT.print(currentRightMotor);
-    SERIAL_PORT.print(", ");
-    SERIAL_PORT.println(currentTopMotor);
+    logger.message(LOG_MOTOR_CURRENTS, currentLeftMotor, currentRightMotor, currentTopMotor);
   }
 }
  
@@ -0,0 +1,202 @@
+// 1 msec timer tick
+// Timer5 runs in CTC mode and interrupts once a msec.  It keeps running while loop() is stuck in a
+// blocking move or turn.  Timer5 drives PWM on pins 44 - 46, which are not used on this board.
+//
+// The emergency stop byte (see k_motorControl) is caught by the bluetooth receive interrupt, and is meant
+// to reach the brakes within 100 usec; it can't while an interrupt runs with the others kept out.  So
+// the tick lets them in for all of its jobs, keeping only itself out (tickInterruptsOn()), and a job
+// keeps the others out just while it works out a motor speed and writes it: an emergency stop or a
+// driver fault zeroes the speeds of what it brakes, so a ramp step taken with them kept out can't undo
+// the brakes.  The longest wait for the receive interrupt is then one motor driver call, not a tick.
+// The jobs that run every 10 msec or slower start their counts at different points, so no two land on
+// the same tick: the safety monitor polls on msec 0 of every 10, the battery estimate (every 100 msec)
+// on 2, the power governor on 4 and the stall detector on 7.
+// hostTools/sketchHost/latencyTest times the byte to the brakes on the board model, with the cost of
+// the Arduino core's pin calls counted, at every point of the tick's busiest 10 msec; the worst is 75
+// usec with the PCB driver and 64 with the others, 95 and 84 with the arithmetic the model does not count
+// added.  It is the model's count, not a Mega's.  hostTools/stackDepth counts the interrupts nesting
+// inside the tick.
+
+#include <avr/wdt.h>
+
+#define TICKS_PER_SECOND 1000
+
+void startTimerTick()
+{
+  noInterrupts();
+  TCCR5A = 0;
+  TCCR5B = (1 << WGM52) | (1 << CS51) | (1 << CS50);  // CTC, prescaler 64 = 250 kHz
+  OCR5A = F_CPU / 64 / TICKS_PER_SECOND - 1;
+  TCNT5 = 0;
+  TIMSK5 |= 1 << OCIE5A;
+  interrupts();
+}
+
+// lets the other interrupts in for the tick's jobs; the tick can't start again meanwhile, a compare
+// match that comes in the meantime waits for tickInterruptsOff()
+void tickInterruptsOn()
+{
+  TIMSK5 &= ~(1 << OCIE5A);
+  interrupts();
+}
+
+void tickInterruptsOff()
+{
+  noInterrupts();
+  TIMSK5 |= 1 << OCIE5A;
+}
+
+ISR(TIMER5_COMPA_vect)
+{
+  tickInterruptsOn();
+  motorFaultTick();
+  linkWatchdogTick();
+  safetyMonitorTick();
+  batteryEstimatorTick();
+  stallDetectorTick();
+  powerGovernorTick();
+  tickInterruptsOff();
+}
+
+// a step of a ramp down from the tick, with the other interrupts kept out while it is worked out and
+// written; true while either wheel still turns
+bool rampDriveWheels(int step)
+{
+  noInterrupts();
+  int left = rampTowardZero(commandedLeftSpeed, step), right = rampTowardZero(commandedRightSpeed, step);
+  if (left != commandedLeftSpeed || right != commandedRightSpeed) motorDriver.setSpeedAB(left, right);
+  commandedLeftSpeed = left;
+  commandedRightSpeed = right;
+  interrupts();
+  return left != 0 || right != 0;
+}
+
+
+// link watchdog
+// If the laptop or tablet goes quiet for timed_out_default msec while the robot is moving, the robot
+// ramps the motors down and then brakes, on its own, without needing loop() to run.  Any complete
+// command frame arriving on the bluetooth port counts as a sign of life, even if loop() has not read
+// it yet, and so does every command loop() accepts.  Once the link is lost, nothing will drive the
+// motors again until the next frame comes in; one that comes in during the ramp brakes the motors at
+// once, since a move or tilt that ended meanwhile has left its motor to the ramp.
+// A queued maneuver (n_commandQueue) comes in all at once, and the sender may well be quiet while it
+// runs, so each queued step refreshes the deadline as it starts, as if it had just been sent: the
+// maneuver can run longer than timed_out_default, but no single step can, the same as for a command
+// sent on its own, and a step that moves forever is watched from when it started.  A lost link
+// cancels whatever is still queued.
+//
+// The AVR hardware watchdog is armed as well, so that a firmware hang resets the board.
+// Note that old Mega bootloaders hang after a watchdog reset instead of restarting; reflash the
+// bootloader if the robot goes dead rather than rebooting.
+
+#define LINK_DECEL_INTERVAL 10  // msec between speed reductions while ramping down
+#define LINK_DECEL_STEP 25      // PWM reduction per interval, so full speed is down in about 100 msec
+#define LINK_OK 0
+#define LINK_DECELERATING 1
+#define LINK_BRAKED 2
+
+int timed_out_default;  // msec, from EEPROM
+volatile unsigned int linkIdleTicks = 0;
+volatile byte linkState = LINK_OK;
+uint16_t linkFramesSeen = 0;
+byte linkDecelTicks = 0;
+bool linkLossReported = false;
+
+// called for every command loop() accepts
+void refreshLinkDeadline()
+{
+  noInterrupts();
+  linkIdleTicks = 0;
+  interrupts();
+}
+
+// at the end of the ramp, and when a frame comes in before it is over: by then coast() and coastTilt()
+// have left the motors to the ramp, and once the link is back nothing else would stop them
+void linkBrake()
+{
+  commandedLeftSpeed = 0;
+  commandedRightSpeed = 0;
+  commandedTopSpeed = 0;
+  requestedLeftSpeed = 0;
+  requestedRightSpeed = 0;
+  motorDriver.setBrakesAB();
+  motorDriver.setBrakesC();
+}
+
+// runs in the timer interrupt
+void linkWatchdogTick()
+{
+  noInterrupts();  // the receive interrupt counts them
+  uint16_t frames = SERIAL_PORT_BLUETOOTH.framesReceived();
+  interrupts();
+  if (frames != linkFramesSeen)
+  {
+    linkFramesSeen = frames;
+    linkIdleTicks = 0;
+    if (linkState == LINK_DECELERATING)  // the stop is finished rather than left half done
+    {
+      linkBrake();
+      Moving = false;
+      movingForever = false;
+      Turning = false;
+      Tilting = false;
+      brakesOn = true;
+    }
+    linkState = LINK_OK;
+    linkLost = false;
+    return;
+  }
+  if (linkIdleTicks < 0xFFFF) linkIdleTicks++;
+  if (linkState == LINK_OK)
+  {
+    if (linkIdleTicks < (unsigned int) timed_out_default || !(Moving || Turning || Tilting)) return;
+    linkState = LINK_DECELERATING;
+    linkLost = true;  // from here on the motion routines leave the motors to us
+    linkDecelTicks = 0;
+  }
+  if (linkState == LINK_DECELERATING)
+  {
+    if (++linkDecelTicks < LINK_DECEL_INTERVAL) return;
+    linkDecelTicks = 0;
+    bool wheels = rampDriveWheels(LINK_DECEL_STEP);
+    noInterrupts();
+    int top = rampTowardZero(commandedTopSpeed, LINK_DECEL_STEP);
+    if (top != commandedTopSpeed) motorDriver.setSpeedC(top);
+    commandedTopSpeed = top;
+    interrupts();
+    if (wheels || top != 0) return;
+    linkBrake();
+    linkState = LINK_BRAKED;
+  }
+}
+
+// called from loop(), tidies up the motion flags and says what happened
+void reportLinkLoss()
+{
+  if (linkLost && !linkLossReported)
+  {
+    linkLossReported = true;
+    logger.message(LOG_LINK_LOST);
+    cancelQueuedCommands(0);  // the rest of a maneuver must not start once the link is back
+  }
+  if (linkState == LINK_BRAKED)
+  {
+    Moving = false;
+    movingForever = false;
+    Turning = false;
+    Tilting = false;
+    brakesOn = true;
+  }
+  if (!linkLost && linkLossReported)
+  {
+    linkLossReported = false;
+    logger.message(LOG_LINK_RESTORED);
+  }
+}
+
+void startWatchdogs()
+{
+  refreshLinkDeadline();
+  startTimerTick();
+  wdt_enable(WDTO_2S);  // every wait in the sketch goes through backgroundDelay() or loop(), which reset it
+}
@@ -0,0 +1,124 @@
+// binary telemetry stream
+// when enabled with the 'T' command, fixed layout binary frames are sent at a set rate
+// so that a host can log and plot what the controller is doing.  The frame layout is defined in
+// libraries/RobotTelemetry/RobotTelemetry.h, which the host decoder in hostTools/telemetryDecoder also uses.
+// Frames start with non-ASCII sync bytes, so they can share the bluetooth link with the text replies,
+// but a host that does not understand them should not turn them on.
+//
+// command form is T followed by the rate in Hz, then a comma, then the channel mask, e.g.
+// T100,127#  100 frames per second, all channels
+// T50,9#     50 frames per second, timestamp and yaw only
+// T#         default rate, all channels
+// T0#        telemetry off
+
+#include <RobotTelemetry.h>
+
+#define TELEMETRY_PORT SERIAL_PORT_BLUETOOTH
+#define TELEMETRY_DEFAULT_RATE 50  // Hz
+#define TELEMETRY_MAX_RATE 200     // Hz
+
+uint8_t telemetryMask = 0;  // 0 means telemetry is off
+uint8_t telemetrySequence = 0;
+unsigned long telemetryPeriod = 0, previousTelemetryTime = 0;  // msec
+uint8_t telemetryFrame[TELEMETRY_MAX_FRAME_LENGTH];
+
+void setTelemetry(int rate, int mask)
+{
+  if (rate <= 0 || mask <= 0)
+  {
+    telemetryMask = 0;
+    logger.message(LOG_TELEMETRY_OFF);
+    return;
+  }
+  if (rate > TELEMETRY_MAX_RATE) rate = TELEMETRY_MAX_RATE;
+  telemetryMask = mask & TELEMETRY_ALL_CHANNELS;
+  telemetryPeriod = 1000 / rate;
+  previousTelemetryTime = millis();
+  logger.message(LOG_TELEMETRY_RATE, rate, telemetryMask);
+}
+
+uint8_t* telemetryPut16(uint8_t* p, int value)
+{
+  *p++ = lowByte(value);
+  *p++ = highByte(value);
+  return p;
+}
+
+// fills telemetryFrame for the current mask and returns its length
+// everything comes from globals the motor and gyro code already keep up to date
+uint8_t encodeTelemetryFrame()
+{
+  uint8_t* p = telemetryFrame;
+  *p++ = TELEMETRY_SYNC_0;
+  *p++ = TELEMETRY_SYNC_1;
+  *p++ = telemetryMask;
+  *p++ = telemetrySequence++;
+  if (telemetryMask & TELEMETRY_TIMESTAMP)
+  {
+    unsigned long now = millis();
+    p = telemetryPut16(p, (int) (now & 0xFFFF));
+    p = telemetryPut16(p, (int) (now >> 16));
+  }
+  if (telemetryMask & TELEMETRY_WHEEL_PWM)
+  {
+    p = telemetryPut16(p, commandedLeftSpeed);
+    p = telemetryPut16(p, commandedRightSpeed);
+    p = telemetryPut16(p, commandedTopSpeed);
+  }
+  if (telemetryMask & TELEMETRY_CURRENTS)
+  {
+    p = telemetryPut16(p, currentLeftMotor);
+    p = telemetryPut16(p, currentRightMotor);
+    p = telemetryPut16(p, currentTopMotor);
+  }
+  if (telemetryMask & TELEMETRY_YAW)
+  {
+    p = telemetryPut16(p, (int) (totalYaw * 10));
+    p = telemetryPut16(p, (int) (gyroYaw * 10));
+  }
+  if (telemetryMask & TELEMETRY_BATTERY)
+  {
+    p = telemetryPut16(p, readAnalogSmoothed(battery_monitor_pin_default));
+  }
+  if (telemetryMask & TELEMETRY_STATE)
+  {
+    uint8_t state = 0;
+    if (Moving) state |= TELEMETRY_STATE_MOVING;
+    if (Turning) state |= TELEMETRY_STATE_TURNING;
+    if (Tilting) state |= TELEMETRY_STATE_TILTING;
+    if (brakesOn) state |= TELEMETRY_STATE_BRAKES;
+    if (gyroPresent) state |= TELEMETRY_STATE_GYRO;
+    if (movingForever) state |= TELEMETRY_STATE_FOREVER;
+    if (forwardBlocked()) state |= TELEMETRY_STATE_SAFETY;
+    if (stallSuspected()) state |= TELEMETRY_STATE_STALL;
+    *p++ = state;
+  }
+  if (telemetryMask & TELEMETRY_POWER)
+  {
+    p = telemetryPut16(p, governor.busMilliVolts());
+    *p++ = governor.cap();
+    *p++ = governor.flags();
+  }
+  uint16_t checksum = telemetryChecksum(&telemetryFrame[2], p - &telemetryFrame[2]);
+  p = telemetryPut16(p, checksum);
+  return p - telemetryFrame;
+}
+
+// called whenever we are waiting, see backgroundDelay()
+// a frame is skipped, rather than blocking, if the serial transmit buffer cannot take all of it;
+// the host sees the gap in the sequence numbers
+void serviceTelemetry()
+{
+  if (telemetryMask == 0) return;
+  unsigned long now = millis();
+  if (now - previousTelemetryTime < telemetryPeriod) return;
+  previousTelemetryTime += telemetryPeriod;
+  if (now - previousTelemetryTime >= telemetryPeriod) previousTelemetryTime = now;  // fell behind, don't try to catch up
+  if (TELEMETRY_PORT.availableForWrite() < telemetryFrameLength(telemetryMask))
+  {
+    telemetrySequence++;
+    return;
+  }
+  uint8_t length = encodeTelemetryFrame();
+  TELEMETRY_PORT.write(telemetryFrame, length);
+}
@@ -0,0 +1,120 @@
+// command queue
+// lets the laptop or tablet send a whole maneuver at once, e.g. forward, turn right, tilt up,
+// so the steps run back to back on the robot instead of each one waiting for a bluetooth round trip.
+//
+// q followed by any normal command queues it to run as soon as the previous queued command completes:
+// qf200#  qr220,90#  qu#
+// w followed by a delay in msec, a comma, and a command queues it to start that long after it was received,
+// but never before the previous queued command completes:
+// w1500,f200#
+// o# cancels everything still waiting in the queue, o followed by an id cancels just that entry: o3#
+// x (stop) also empties the queue.
+//
+// replies: mQ<id> when a command is queued, mq<id> when it completes, mo<id> when it is cancelled,
+// and mQ-1 if the queue is full.
+// A queued command is complete when its routine returns and the robot is not left moving forever or turning;
+// so F, B and friends in the queue hold up everything after them until they are stopped.
+// Each step gives the link watchdog a fresh deadline as it starts, and a lost link cancels the rest
+// (see l_timerTick), as does a cliff or obstacle stop (o_safetyMonitor) or a stuck wheel (q_stallDetector).
+// hostTools/sketchHost/queueTest runs the queue on the host against a simulated clock.
+
+#define COMMAND_QUEUE_LENGTH 8
+#define QUEUED_COMMAND_LENGTH 16
+
+struct queuedCommand
+{
+  char text[QUEUED_COMMAND_LENGTH];
+  byte length;
+  byte id;
+  unsigned long startTime;  // millis() at or after which it may start, 0 means right after the previous one
+};
+
+queuedCommand commandQueue[COMMAND_QUEUE_LENGTH];
+byte commandQueueHead = 0, commandQueueCount = 0, nextQueuedCommandId = 1;
+int runningQueuedCommandId = -1;  // queued command that was started but has not completed yet
+
+void sendQueueEvent(char event, int id)
+{
+  SERIAL_PORT_BLUETOOTH.print('m');
+  SERIAL_PORT_BLUETOOTH.print(event);
+  SERIAL_PORT_BLUETOOTH.println(id);
+}
+
+// input is the whole q or w command, without the end character
+void enqueueCommand(const BufferedFrame& input)
+{
+  int length = input.length();
+  unsigned long startTime = 0;
+  int start = 1;
+  if (input[0] == 'w')
+  {
+    unsigned long delayTime = 0;
+    while (start < length && input[start] >= '0' && input[start] <= '9')
+    {
+      delayTime = delayTime * 10 + (input[start] - '0');
+      start++;
+    }
+    if (start < length && input[start] == ',') start++;
+    startTime = millis() + delayTime;
+    if (startTime == 0) startTime = 1;  // 0 is reserved for chained commands
+  }
+  if (length - start < 1 || length - start >= QUEUED_COMMAND_LENGTH || commandQueueCount >= COMMAND_QUEUE_LENGTH)
+  {
+    logger.message(LOG_QUEUE_REJECTED);
+    sendQueueEvent('Q', -1);
+    return;
+  }
+  queuedCommand* entry = &commandQueue[(commandQueueHead + commandQueueCount) % COMMAND_QUEUE_LENGTH];
+  entry->length = input.copyTo(entry->text, start, QUEUED_COMMAND_LENGTH);
+  entry->id = nextQueuedCommandId++;
+  if (nextQueuedCommandId == 0) nextQueuedCommandId = 1;
+  entry->startTime = startTime;
+  commandQueueCount++;
+  logger.message(LOG_QUEUED, entry->text, entry->id);
+  sendQueueEvent('Q', entry->id);
+}
+
+// cancels a single waiting entry, or all of them if id is 0
+void cancelQueuedCommands(int id)
+{
+  byte kept = 0;
+  for (byte i = 0; i < commandQueueCount; i++)
+  {
+    queuedCommand* entry = &commandQueue[(commandQueueHead + i) % COMMAND_QUEUE_LENGTH];
+    if (id == 0 || entry->id == id)
+    {
+      sendQueueEvent('o', entry->id);
+    }
+    else
+    {
+      if (kept != i) commandQueue[(commandQueueHead + kept) % COMMAND_QUEUE_LENGTH] = *entry;
+      kept++;
+    }
+  }
+  commandQueueCount = kept;
+}
+
+// called from loop() while it waits for input.  Not from backgroundDelay(), since the queued
+// command itself is run from here and may block in move(), turn() or tilt().
+void serviceCommandQueue()
+{
+  if (runningQueuedCommandId >= 0)
+  {
+    if (movingForever || Turning) return;  // still going
+    sendQueueEvent('q', runningQueuedCommandId);
+    runningQueuedCommandId = -1;
+  }
+  if (commandQueueCount == 0) return;
+  queuedCommand* entry = &commandQueue[commandQueueHead];
+  if (entry->startTime != 0 && (long) (millis() - entry->startTime) < 0) return;
+
+  char text[QUEUED_COMMAND_LENGTH];
+  byte length = entry->length;
+  memcpy(text, entry->text, length + 1);
+  runningQueuedCommandId = entry->id;
+  commandQueueHead = (commandQueueHead + 1) % COMMAND_QUEUE_LENGTH;
+  commandQueueCount--;
+  logger.message(LOG_QUEUE_RUNNING, text);
+  refreshLinkDeadline();  // as if the step had just been sent, see l_timerTick
+  HandleCommand(BufferedFrame(text, length));
+}
@@ -0,0 +1,155 @@
+// cliff and obstacle safety monitor
+// The IR sensors at the front (see libraries/irLibrary) are polled from the 1 msec timer tick every
+// SAFETY_POLL_INTERVAL msec, so they are watched even while loop() is stuck in a blocking move.
+// A sensor trips once it reports danger on SAFETY_DEBOUNCE polls in a row, which filters out single bad
+// readings; note that this also means a sudden drop in distance only counts if the object stays close.
+// While any sensor is tripped, forward moves are refused; backing up and turning are still allowed so the
+// robot can get itself out.  If a sensor trips while the robot is driving forward, the timer interrupt
+// ramps the wheels down by SAFETY_DECEL_STEP per poll, starting on the poll that trips, and then brakes,
+// so from full speed the robot is braked
+//   (SAFETY_DEBOUNCE - 1 + (255 + SAFETY_DECEL_STEP - 1) / SAFETY_DECEL_STEP - 1) * SAFETY_POLL_INTERVAL  = 50 msec
+// after the poll that first sees the danger, provided every poll has a new sample (the ADC scanner brings
+// one every msec or so), and at most one SAFETY_POLL_INTERVAL more after the danger appears.
+// The stop is reported as mS<sensor mask>,<msec>, where bit 0 of the mask is the first sensor in
+// safetySensors, and the time is counted from the first dangerous poll of the sensor that tripped to the
+// brakes.  hostTools/sketchHost/safetyTest measures both on the host.
+//
+// command form is S followed by 1 to turn the monitor on or 0 to turn it off, S# just reports:
+// mS?<enabled>,<tripped mask>,<distance of each sensor in mm>...
+// The monitor starts off (SAFETY_MONITOR_ENABLED_DEFAULT), since a robot without the sensors fitted would
+// read floating inputs, and can't be turned on at all in a build without ROBOT_SAFETY_SENSORS.
+//
+// All analog inputs now go through the background ADC scanner the sensors use, see readAnalogSmoothed().
+
+#include <irSensor.h>
+
+#define SAFETY_MONITOR_ENABLED_DEFAULT false
+#define SAFETY_POLL_INTERVAL 10  // msec, 100 Hz
+#define SAFETY_DEBOUNCE 3        // dangerous polls in a row before a sensor trips
+#define SAFETY_DECEL_STEP 64     // PWM reduction per poll while stopping
+#define SAFETY_IDLE 0
+#define SAFETY_STOPPING 1
+#define SAFETY_BRAKED 2
+
+// pin, height above the ground in mm, sine of the angle between the beam and the vertical times 10000
+// (8415 is 1 radian); measure these on the robot, flat ground must read above 15 cm or the sensor trips all the time
+irSensor safetySensors[] =
+{
+  irSensor(ROBOT_SAFETY_PIN_LEFT, irMounting{ 100, 8415 }),  // front left
+  irSensor(ROBOT_SAFETY_PIN_RIGHT, irMounting{ 100, 8415 }),  // front right
+};
+#define SAFETY_SENSOR_COUNT (sizeof(safetySensors) / sizeof(safetySensors[0]))
+
+volatile bool safetyMonitorEnabled = SAFETY_MONITOR_ENABLED_DEFAULT;
+volatile byte safetyTripped = 0;  // bit per sensor, debounced
+volatile byte safetyState = SAFETY_IDLE;
+volatile byte safetyFiredMask = 0;  // sensors that caused the last stop
+volatile unsigned int safetyStopTicks = 0;  // msec from the first dangerous reading to the brakes
+byte safetyDangerCount[SAFETY_SENSOR_COUNT];
+byte safetyDangerPolls[SAFETY_SENSOR_COUNT];  // polls since the current run of danger was first seen, 0 for none
+byte safetyPollTicks = 0;  // on msec 0 of every 10, see l_timerTick
+
+// runs in the timer interrupt every msec
+void safetyMonitorTick()
+{
+  if (safetyState == SAFETY_STOPPING && safetyStopTicks < 0xFFFF) safetyStopTicks++;
+  if (++safetyPollTicks < SAFETY_POLL_INTERVAL) return;
+  safetyPollTicks = 0;
+  if (!safetyMonitorEnabled)
+  {
+    safetyTripped = 0;
+    return;
+  }
+
+  byte tripped = 0;
+  for (byte i = 0; i < SAFETY_SENSOR_COUNT; i++)
+  {
+    if (safetySensors[i].update())  // otherwise no new sample, keep the count as it is
+    {
+      if (!safetySensors[i].danger()) safetyDangerCount[i] = 0;
+      else if (safetyDangerCount[i] < SAFETY_DEBOUNCE) safetyDangerCount[i]++;
+    }
+    if (safetyDangerCount[i] == 0) safetyDangerPolls[i] = 0;
+    else if (safetyDangerPolls[i] < 0xFF) safetyDangerPolls[i]++;
+    if (safetyDangerCount[i] >= SAFETY_DEBOUNCE) tripped |= 1 << i;
+  }
+  safetyTripped = tripped;
+
+  if (safetyState == SAFETY_IDLE)
+  {
+    if (!tripped || commandedLeftSpeed <= 0 || commandedRightSpeed <= 0) return;  // only forward motion is stopped
+    safetyState = SAFETY_STOPPING;
+    safetyStopping = true;  // from here on the motion routines leave the wheels to us
+    safetyFiredMask = tripped;
+    byte polls = 0;
+    for (byte i = 0; i < SAFETY_SENSOR_COUNT; i++)
+    {
+      if ((tripped & (1 << i)) && safetyDangerPolls[i] > polls) polls = safetyDangerPolls[i];
+    }
+    safetyStopTicks = (polls - 1) * SAFETY_POLL_INTERVAL;  // msec since the first dangerous poll
+  }
+  if (safetyState == SAFETY_STOPPING)
+  {
+    if (rampDriveWheels(SAFETY_DECEL_STEP)) return;
+    motorDriver.setBrakesAB();
+    safetyState = SAFETY_BRAKED;
+  }
+}
+
+// forward moves are refused while a sensor is tripped
+bool forwardBlocked()
+{
+  return safetyTripped != 0;
+}
+
+// called from loop(), tidies up the motion flags once the robot is braked and says which sensor stopped it.
+// The rest of a queued maneuver is cancelled: its turns and back-ups were planned without the cliff.
+void reportSafetyStop()
+{
+  if (safetyState != SAFETY_BRAKED) return;
+  Moving = false;
+  movingForever = false;
+  brakesOn = true;
+  logger.message(LOG_SAFETY_STOP, safetyFiredMask, safetyStopTicks);
+  SERIAL_PORT_BLUETOOTH.print(F("mS"));
+  SERIAL_PORT_BLUETOOTH.print(safetyFiredMask);
+  SERIAL_PORT_BLUETOOTH.print(',');
+  SERIAL_PORT_BLUETOOTH.println(safetyStopTicks);
+  cancelQueuedCommands(0);
+  noInterrupts();
+  safetyState = SAFETY_IDLE;
+  safetyStopping = false;
+  interrupts();
+}
+
+void setSafetyMonitor(int enable)
+{
+  if (enable >= 0) safetyMonitorEnabled = enable != 0 && ROBOT_SAFETY_SENSORS;
+  logger.message(LOG_SAFETY_ENABLED, safetyMonitorEnabled, safetyTripped);
+  SERIAL_PORT_BLUETOOTH.print(F("mS?"));
+  SERIAL_PORT_BLUETOOTH.print(safetyMonitorEnabled);
+  SERIAL_PORT_BLUETOOTH.print(',');
+  SERIAL_PORT_BLUETOOTH.print(safetyTripped);
+  for (byte i = 0; i < SAFETY_SENSOR_COUNT; i++)
+  {
+    SERIAL_PORT_BLUETOOTH.print(',');
+    SERIAL_PORT_BLUETOOTH.print(safetySensors[i].distanceMM());
+  }
+  SERIAL_PORT_BLUETOOTH.println();
+}
+
+// registers every analog input with the background scanner and starts it; call before any analog reads
+void startAnalogScan()
+{
+  backgroundAnalog.addChannel(battery_monitor_pin_default);
+  backgroundAnalog.addChannel(FBA);
+  backgroundAnalog.addChannel(FBB);
+  backgroundAnalog.addChannel(FBC);
+#if ROBOT_SAFETY_SENSORS
+  for (byte i = 0; i < SAFETY_SENSOR_COUNT; i++)
+  {
+    if (!safetySensors[i].begin()) logger.message(LOG_SAFETY_NO_ADC_SLOT);
+  }
+#endif
+  backgroundAnalog.start();
+}
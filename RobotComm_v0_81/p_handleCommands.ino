@@ -1,235 +1,390 @@
 #define SERIAL_SPEED 115200
 #define BLUETOOTH_SPEED 115200
-#define INPUT_BUFFER_SIZE 256
+#define BLUETOOTH_RX_BUFFER_SIZE 512  // must be a power of 2, holds several queued commands
+#define BLUETOOTH_TX_BUFFER_SIZE 256  // must be a power of 2
+#define BLUETOOTH_RTS_PIN 23  // to the bluetooth module's CTS, goes high when the receive buffer is nearly full
+#define BLUETOOTH_XON_XOFF false  // software flow control, the android app does not expect XON/XOFF characters
 #define COMMAND_END_CHARACTER '#'
 #define COMM_CHECK_CHARACTER 'c'
 #define COMMAND_ECHO_CHARACTER 'e'
 #define MAX_PARAMETERS 3
 
-char inputBuffer[INPUT_BUFFER_SIZE], charIn;
-int inputLength;
+uint8_t bluetoothRxBuffer[BLUETOOTH_RX_BUFFER_SIZE], bluetoothTxBuffer[BLUETOOTH_TX_BUFFER_SIZE];
 bool exceededCurrentLimitC = false, enableEEPROMwrite = false;
 
 
 int program_version;
-int timed_out_default, speed_default;
+int speed_default;
 int nudge_turn_time_default, nudge_move_time_default, nudge_tilt_time_default;
 int tilt_up_speed_default;
 int tilt_down_speed_default, degrees_default; 
 
-// process a command string
-void HandleCommand(char* input, int length)
+// command dispatch
+// Every command is described by one entry in commandTable: its opcode, how its parameters are parsed,
+// where missing parameters get their defaults, some flags, and the routine that carries it out.
+// The table is indexed directly by the opcode, so finding a command is a single lookup, and
+// commands that take no parameters skip the parsing altogether.
+// A command is parsed where it lies in the bluetooth receive buffer: the handlers get it as a
+// BufferedFrame, which indexes like a char array across the wrap of the ring, without its end character.
+// To add a command, fill in the slot for its letter (the slots run in ASCII order from '?' to 'z')
+// and write its handler.  The '?' command lists the table over the link.
+
+// parameter schemas
+#define PARAMS_NONE 0     // no parameters, parsing is skipped
+#define PARAMS_NUMBERS 1  // up to MAX_PARAMETERS comma separated numbers
+#define PARAMS_TEXT 2     // the rest of the command is passed on untouched (queued commands)
+
+// where a parameter that was not sent gets its value
+#define FROM_ZERO 0
+#define FROM_SPEED_DEFAULT 1   // speed_default
+#define FROM_TURN_DEFAULT 2    // degrees_default with a gyro, turn_time_default without one
+#define FROM_TELEMETRY_RATE 3  // TELEMETRY_DEFAULT_RATE
+#define FROM_TELEMETRY_MASK 4  // TELEMETRY_ALL_CHANNELS
+#define FROM_NOT_SENT 5        // -1, for commands that only report when called without a parameter
+
+// flags
+#define CMD_PREEMPTS_MOTION 0x01      // takes over the drive wheels, so coast first if they are moving
+#define CMD_NEEDS_EEPROM_ENABLE 0x02  // refused unless EEPROM writing was enabled with 'Z'
+
+#define FIRST_OPCODE '?'
+#define LAST_OPCODE 'z'
+
+typedef void (*commandHandler)(const BufferedFrame& input, long* parameter);
+
+struct commandDescriptor
 {
-  int speedToGo = speed_default, turnTime = turn_time_default;
-  int degreesToTurn = degrees_default;
-  long EEPROMaddress, EEPROMvalue;
-  // evaluate parameters following command
-  long powerOf10;
-  long parameter[MAX_PARAMETERS];
+  char opcode;  // 0 for an unused slot
+  byte schema;
+  byte defaults[2];  // default source for the first two parameters, any others default to 0
+  byte flags;
+  commandHandler handler;
+};
+
+// move forward
+void commandNudgeForward(const BufferedFrame& input, long* parameter) { move(parameter[0], nudge_move_time_default); }
+void commandForward(const BufferedFrame& input, long* parameter) { move(parameter[0], 0); }  // for the default time
+void commandForwardForever(const BufferedFrame& input, long* parameter) { move(parameter[0], -1); }
+
+// move backward
+void commandNudgeBackward(const BufferedFrame& input, long* parameter) { move(-parameter[0], nudge_move_time_default); }
+void commandBackward(const BufferedFrame& input, long* parameter) { move(-parameter[0], 0); }
+void commandBackwardForever(const BufferedFrame& input, long* parameter) { move(-parameter[0], -1); }
+
+// turn right
+void commandNudgeRight(const BufferedFrame& input, long* parameter)
+{
+  if (gyroPresent) turn(parameter[0], degrees_default / 2);  // turn right for half the default number of degrees
+  else turn(parameter[0], nudge_turn_time_default);  // turn right a little
+}
+void commandRight(const BufferedFrame& input, long* parameter)
+{
+  turn(parameter[0], parameter[1]);  // degrees with a gyro, msec without one
+}
+void commandRightDefault(const BufferedFrame& input, long* parameter)
+{
+  if (gyroPresent) turn(parameter[0], degrees_default);  // turn right for the default number of degrees
+  else turn(parameter[0], -1);    // turn right forever
+}
+
+// turn left
+void commandNudgeLeft(const BufferedFrame& input, long* parameter)
+{
+  if (gyroPresent) turn(-parameter[0], degrees_default / 2);
+  else turn(-parameter[0], nudge_turn_time_default);
+}
+void commandLeft(const BufferedFrame& input, long* parameter)
+{
+  turn(-parameter[0], parameter[1]);
+}
+void commandLeftDefault(const BufferedFrame& input, long* parameter)
+{
+  if (gyroPresent) turn(-parameter[0], degrees_default);
+  else turn(-parameter[0], -1);
+}
+
+// tilt
+void commandNudgeTiltUp(const BufferedFrame& input, long* parameter) { tilt(tilt_up_speed_default, nudge_tilt_time_default); }
+void commandTiltUp(const BufferedFrame& input, long* parameter) { tilt(tilt_up_speed_default, 0); }
+void commandTiltUpForever(const BufferedFrame& input, long* parameter) { tilt(tilt_up_speed_default, -1); }
+void commandNudgeTiltDown(const BufferedFrame& input, long* parameter) { tilt(-tilt_down_speed_default, nudge_tilt_time_default); }
+void commandTiltDown(const BufferedFrame& input, long* parameter) { tilt(-tilt_down_speed_default, 0); }
+void commandTiltDownForever(const BufferedFrame& input, long* parameter) { tilt(-tilt_down_speed_default, -1); }
+
+void commandStop(const BufferedFrame& input, long* parameter)
+{
+  acknowledgeEmergencyStop();
+  Stop();
+  clearMotorFaults();
+  cancelQueuedCommands(0);  // and don't carry on with a queued maneuver
+}
+
+void commandBatteryPercent(const BufferedFrame& input, long* parameter)
+{
+  SERIAL_PORT_BLUETOOTH.print(F("MESSAGE_BATTERY_PERCENT"));  // lead with "mb"  
+                                  // 'm' indicates that this is a message for the server
+                                  // 'b' indicates that it is a battery percent messsage
+  SERIAL_PORT_BLUETOOTH.println(checkBattery()); 
+}
+
+// mP followed by percent, load compensated millivolts, and minutes left at the last half hour's mean current
+void commandBatteryDetail(const BufferedFrame& input, long* parameter)
+{
+  SERIAL_PORT_BLUETOOTH.print(F("mP"));
+  SERIAL_PORT_BLUETOOTH.print(checkBattery());
+  SERIAL_PORT_BLUETOOTH.print(',');
+  SERIAL_PORT_BLUETOOTH.print(batteryMilliVolts());
+  SERIAL_PORT_BLUETOOTH.print(',');
+  SERIAL_PORT_BLUETOOTH.println(batteryRuntimeMinutes());
+}
+
+// EEPROM commands
+void commandReadEEPROM(const BufferedFrame& input, long* parameter)
+{
+  long EEPROMvalue = readFromEEPROM(parameter[0]);
+  SERIAL_PORT_BLUETOOTH.print(F("MESSAGE_EEPROM_VALUE"));  // lead with "mE"  
+                                  // 'm' indicates that this is a message for the server
+                                  // 'E' indicates that it is an EEPROM value
+  SERIAL_PORT_BLUETOOTH.println(EEPROMvalue); 
+  logger.message(LOG_EEPROM_READ, parameter[0], EEPROMvalue);
+}
+
+void commandEnableEEPROMwrite(const BufferedFrame& input, long* parameter)
+{
+  enableEEPROMwrite = true;
+  logger.message(LOG_EEPROM_WRITE_ENABLED);
+  SERIAL_PORT_BLUETOOTH.println(F("EEPROM writing enabled."));
+}
+
+void commandDisableEEPROMwrite(const BufferedFrame& input, long* parameter)
+{
+  enableEEPROMwrite = false;
+  logger.message(LOG_EEPROM_WRITE_DISABLED);
+  SERIAL_PORT_BLUETOOTH.println(F("EEPROM writing disabled."));
+}
+
+// the parameter is address * 1000 + value, the value has to be < 256
+void commandWriteEEPROM(const BufferedFrame& input, long* parameter)
+{
+  long EEPROMvalue = parameter[0] % 1000;  // the lower three digits are the value
+  long EEPROMaddress = parameter[0] / 1000; // the upper digits are the address
+  writeToEEPROM(EEPROMaddress, EEPROMvalue);
+  reloadParameterAt(EEPROMaddress);  // a parameter it holds takes the new value now, as with W
+  logger.message(LOG_EEPROM_WRITTEN, EEPROMvalue, EEPROMaddress);
+}
+
+void commandWriteBatch(const BufferedFrame& input, long* parameter) { writeParameterBatch(input); }
+
+void commandGetParameter(const BufferedFrame& input, long* parameter) { reportParameters(parameter[0]); }
+void commandSetParameter(const BufferedFrame& input, long* parameter) { changeParameter(parameter[0], parameter[1]); }
+void commandCommitParameters(const BufferedFrame& input, long* parameter) { commitParameters(); }
+
+void commandReadBTaddress(const BufferedFrame& input, long* parameter) { readBTaddress(); }
+
+void commandTelemetry(const BufferedFrame& input, long* parameter) { setTelemetry(parameter[0], parameter[1]); }
+
+void commandSafetyMonitor(const BufferedFrame& input, long* parameter) { setSafetyMonitor(parameter[0]); }
+void commandStallDetector(const BufferedFrame& input, long* parameter) { setStallDetector(parameter[0]); }
+
+// mM followed by the stack high water mark, the bytes it has never reached, and the bytes free now
+void commandMemory(const BufferedFrame& input, long* parameter)
+{
+  SERIAL_PORT_BLUETOOTH.print(F("mM"));
+  SERIAL_PORT_BLUETOOTH.print(stackHighWater());
+  SERIAL_PORT_BLUETOOTH.print(',');
+  SERIAL_PORT_BLUETOOTH.print(stackNeverUsed());
+  SERIAL_PORT_BLUETOOTH.print(',');
+  SERIAL_PORT_BLUETOOTH.println(stackFree());
+}
+
+// mD followed by the cpu cycles the heading arithmetic took in the last goStraight step, the most it has
+// taken, and 1 for the fixed point build or 0 for the double one (see d_imu)
+void commandControlCycles(const BufferedFrame& input, long* parameter)
+{
+  SERIAL_PORT_BLUETOOTH.print(F("mD"));
+  SERIAL_PORT_BLUETOOTH.print(controlCyclesLast);
+  SERIAL_PORT_BLUETOOTH.print(',');
+  SERIAL_PORT_BLUETOOTH.print(controlCyclesMax);
+  SERIAL_PORT_BLUETOOTH.print(',');
+  SERIAL_PORT_BLUETOOTH.println(ROBOT_FIXED_POINT);
+}
+
+void commandEnqueue(const BufferedFrame& input, long* parameter) { enqueueCommand(input); }
+void commandCancelQueued(const BufferedFrame& input, long* parameter) { cancelQueuedCommands(parameter[0]); }
+
+void commandListCommands(const BufferedFrame& input, long* parameter);
+
+#define NO_COMMAND { 0, 0, { 0, 0 }, 0, 0 }
+
+const commandDescriptor commandTable[LAST_OPCODE - FIRST_OPCODE + 1] PROGMEM =
+{
+  { '?', PARAMS_NONE, { FROM_ZERO, FROM_ZERO }, 0, commandListCommands },
+  NO_COMMAND,  // @
+  { 'A', PARAMS_NONE, { FROM_ZERO, FROM_ZERO }, 0, commandReadBTaddress },
+  { 'B', PARAMS_NUMBERS, { FROM_SPEED_DEFAULT, FROM_ZERO }, CMD_PREEMPTS_MOTION, commandBackwardForever },
+  { 'C', PARAMS_NONE, { FROM_ZERO, FROM_ZERO }, CMD_NEEDS_EEPROM_ENABLE, commandCommitParameters },
+  { 'D', PARAMS_NONE, { FROM_ZERO, FROM_ZERO }, 0, commandControlCycles },
+  { 'E', PARAMS_NUMBERS, { FROM_ZERO, FROM_ZERO }, 0, commandReadEEPROM },
+  { 'F', PARAMS_NUMBERS, { FROM_SPEED_DEFAULT, FROM_ZERO }, CMD_PREEMPTS_MOTION, commandForwardForever },
+  { 'G', PARAMS_NUMBERS, { FROM_NOT_SENT, FROM_ZERO }, 0, commandGetParameter },
+  NO_COMMAND,  // H
+  NO_COMMAND,  // I
+  NO_COMMAND,  // J
+  { 'K', PARAMS_NUMBERS, { FROM_NOT_SENT, FROM_ZERO }, 0, commandStallDetector },
+  { 'L', PARAMS_NUMBERS, { FROM_SPEED_DEFAULT, FROM_ZERO }, CMD_PREEMPTS_MOTION, commandLeftDefault },
+  { 'M', PARAMS_NONE, { FROM_ZERO, FROM_ZERO }, 0, commandMemory },
+  { 'N', PARAMS_NONE, { FROM_ZERO, FROM_ZERO }, 0, commandTiltDownForever },
+  NO_COMMAND,  // O
+  { 'P', PARAMS_NONE, { FROM_ZERO, FROM_ZERO }, 0, commandBatteryDetail },
+  NO_COMMAND,  // Q
+  { 'R', PARAMS_NUMBERS, { FROM_SPEED_DEFAULT, FROM_ZERO }, CMD_PREEMPTS_MOTION, commandRightDefault },
+  { 'S', PARAMS_NUMBERS, { FROM_NOT_SENT, FROM_ZERO }, 0, commandSafetyMonitor },
+  { 'T', PARAMS_NUMBERS, { FROM_TELEMETRY_RATE, FROM_TELEMETRY_MASK }, 0, commandTelemetry },
+  { 'U', PARAMS_NONE, { FROM_ZERO, FROM_ZERO }, 0, commandTiltUpForever },
+  { 'V', PARAMS_NUMBERS, { FROM_NOT_SENT, FROM_ZERO }, 0, commandSetParameter },
+  { 'W', PARAMS_TEXT, { FROM_ZERO, FROM_ZERO }, CMD_NEEDS_EEPROM_ENABLE, commandWriteBatch },
+  { 'X', PARAMS_NONE, { FROM_ZERO, FROM_ZERO }, CMD_PREEMPTS_MOTION, commandStop },
+  NO_COMMAND,  // Y
+  { 'Z', PARAMS_NONE, { FROM_ZERO, FROM_ZERO }, 0, commandEnableEEPROMwrite },
+  NO_COMMAND,  // [
+  NO_COMMAND,  // backslash
+  NO_COMMAND,  // ]
+  NO_COMMAND,  // ^
+  NO_COMMAND,  // _
+  NO_COMMAND,  // `
+  { 'a', PARAMS_NONE, { FROM_ZERO, FROM_ZERO }, 0, commandReadBTaddress },
+  { 'b', PARAMS_NUMBERS, { FROM_SPEED_DEFAULT, FROM_ZERO }, CMD_PREEMPTS_MOTION, commandBackward },
+  NO_COMMAND,  // c, the comm check is answered in loop()
+  NO_COMMAND,  // d
+  NO_COMMAND,  // e
+  { 'f', PARAMS_NUMBERS, { FROM_SPEED_DEFAULT, FROM_ZERO }, CMD_PREEMPTS_MOTION, commandForward },
+  { 'g', PARAMS_NUMBERS, { FROM_SPEED_DEFAULT, FROM_ZERO }, CMD_PREEMPTS_MOTION, commandNudgeBackward },
+  { 'h', PARAMS_NUMBERS, { FROM_SPEED_DEFAULT, FROM_ZERO }, CMD_PREEMPTS_MOTION, commandNudgeLeft },
+  { 'i', PARAMS_NONE, { FROM_ZERO, FROM_ZERO }, 0, commandNudgeTiltUp },
+  NO_COMMAND,  // j
+  { 'k', PARAMS_NONE, { FROM_ZERO, FROM_ZERO }, 0, commandNudgeTiltDown },
+  { 'l', PARAMS_NUMBERS, { FROM_SPEED_DEFAULT, FROM_TURN_DEFAULT }, CMD_PREEMPTS_MOTION, commandLeft },
+  NO_COMMAND,  // m
+  { 'n', PARAMS_NONE, { FROM_ZERO, FROM_ZERO }, 0, commandTiltDown },
+  { 'o', PARAMS_NUMBERS, { FROM_ZERO, FROM_ZERO }, 0, commandCancelQueued },
+  { 'p', PARAMS_NONE, { FROM_ZERO, FROM_ZERO }, 0, commandBatteryPercent },
+  { 'q', PARAMS_TEXT, { FROM_ZERO, FROM_ZERO }, 0, commandEnqueue },
+  { 'r', PARAMS_NUMBERS, { FROM_SPEED_DEFAULT, FROM_TURN_DEFAULT }, CMD_PREEMPTS_MOTION, commandRight },
+  NO_COMMAND,  // s
+  { 't', PARAMS_NUMBERS, { FROM_SPEED_DEFAULT, FROM_ZERO }, CMD_PREEMPTS_MOTION, commandNudgeForward },
+  { 'u', PARAMS_NONE, { FROM_ZERO, FROM_ZERO }, 0, commandTiltUp },
+  { 'v', PARAMS_NUMBERS, { FROM_ZERO, FROM_ZERO }, CMD_NEEDS_EEPROM_ENABLE, commandWriteEEPROM },
+  { 'w', PARAMS_TEXT, { FROM_ZERO, FROM_ZERO }, 0, commandEnqueue },
+  { 'x', PARAMS_NONE, { FROM_ZERO, FROM_ZERO }, CMD_PREEMPTS_MOTION, commandStop },
+  { 'y', PARAMS_NUMBERS, { FROM_SPEED_DEFAULT, FROM_ZERO }, CMD_PREEMPTS_MOTION, commandNudgeRight },
+  { 'z', PARAMS_NONE, { FROM_ZERO, FROM_ZERO }, 0, commandDisableEEPROMwrite },
+};
+
+long parameterDefault(byte source)
+{
+  switch (source)
+  {
+    case FROM_SPEED_DEFAULT: return speed_default;
+    case FROM_TURN_DEFAULT: return gyroPresent ? degrees_default : turn_time_default;
+    case FROM_TELEMETRY_RATE: return TELEMETRY_DEFAULT_RATE;
+    case FROM_TELEMETRY_MASK: return TELEMETRY_ALL_CHANNELS;
+    case FROM_NOT_SENT: return -1;
+  }
+  return 0;
+}
+
+// reads up to MAX_PARAMETERS comma separated numbers following the command letter
+// returns the number of parameters found
+int parseParameters(const BufferedFrame& input, long* parameter)
+{
+  int length = input.length();
   int numParameters = 0;
-  for (int i=0; i < MAX_PARAMETERS; i++) parameter[i] = 0;
-      
-  SERIAL_PORT.print("length = ");
-  SERIAL_PORT.println(length);
-  if (length > 1)
+  bool negative = false, haveDigits = false;
+  long value = 0;
+  for (int i = 1; i <= length; i++)
   {
-     for (int i = 1; i < length; i++) // start with 2nd character, since the first is the command, followed by parameters
-     {
-       if (i == 1 || input[i] == ',')  // new parameter
-       {
-         if (input[i] == ',') i++;  // move past the comma
-         if (numParameters < MAX_PARAMETERS) numParameters++;
-         else SERIAL_PORT.println("***ERROR:  Maximum number of parameters exceeded");
-         powerOf10 = 1;
-         for (int k = i + 1; k < length; k++)
-         {
-           if (input[k] != ',') powerOf10 *= 10;
-           else break;
-         }
-       }
-  
-       char singlechar[2];
-       singlechar[0] = input[i];
-       singlechar[1] = 0;
-       parameter[numParameters - 1] += atoi(&singlechar[0]) * powerOf10;
-       SERIAL_PORT.print("parameter number, powerof10, input[i], i, value = ");
-       SERIAL_PORT.print(numParameters);
-       SERIAL_PORT.print(", ");
-       SERIAL_PORT.print(powerOf10);
-       SERIAL_PORT.print(", ");
-       SERIAL_PORT.print(input[i]);
-       SERIAL_PORT.print(", ");
-       SERIAL_PORT.print(i);
-       SERIAL_PORT.print(", ");
-       SERIAL_PORT.println(parameter[numParameters]);
-       powerOf10 /= 10;
-     }
-       
-    //  {value = atoi(&input[1]);  // doesn't work for large numbers, as we have for EEPROM writes.
-    SERIAL_PORT.println("parameter values:");
-    for (int i = 0; i < numParameters; i++) SERIAL_PORT.println(parameter[i]);    
- 
-      // speed or turn specified or eeprom address to read
-    if (parameter[0] > 256)  // means we are writing to the EEPROM
+    if (i == length || input[i] == ',')  // end of a parameter
     {
-      SERIAL_PORT.print("EEPROM command string parameter is ");
-      SERIAL_PORT.println(parameter[0]);
-      EEPROMvalue=  parameter[0]%1000;  // the lower three digits are the value
-      SERIAL_PORT.print("EEPROM command value is ");
-      SERIAL_PORT.println(EEPROMvalue);
-      EEPROMaddress = (parameter[0] - EEPROMvalue) / 1000; // the upper three digits are the address
-      SERIAL_PORT.print("EEPROM command address is ");
-      SERIAL_PORT.println(EEPROMaddress);
+      if (numParameters < MAX_PARAMETERS) parameter[numParameters] = negative ? -value : value;
+      else logger.message(LOG_TOO_MANY_PARAMETERS);
+      if (haveDigits || i < length) numParameters++;  // an empty last parameter does not count
+      value = 0;
+      negative = false;
+      haveDigits = false;
     }
     else
-    {     
-      speedToGo = parameter[0];      
-      EEPROMaddress = parameter[0];
-      if (gyroPresent) degreesToTurn = parameter[1];
-      else turnTime = parameter[1];
+    {
+      char c = input[i];
+      if (c == '-' && !haveDigits) negative = true;
+      else if (c >= '0' && c <= '9')
+      {
+        value = value * 10 + (c - '0');
+        haveDigits = true;
+      }
     }
   }
+  if (numParameters > MAX_PARAMETERS) numParameters = MAX_PARAMETERS;
+  return numParameters;
+}
 
-  // check commands
-  // ************note that if you use more than one character here
-  // the bytes are swapped, ie 'FM' means command MF *****************
-  // you can use this stmt to get the command:
-  // int* command = (int*)input;
-  // but not needed when we just have a single character command format
-  switch(input[0]) {
-    
-    // move forward
-    case 't':
-      move(speedToGo, nudge_move_time_default);  // forward a little
-      break;
-    case 'f':    
-      move(speedToGo, 0);  // forward for the default time
-      break;
-    case 'F':
-      move(speedToGo, -1);  // forward forever
-      break;
-      
-    // move backward
-    case 'g':
-      move(-speedToGo, nudge_move_time_default);  // backward a little
-      break;
-    case 'b':
-      move(-speedToGo, 0);  // backward for the default time
-      break;
-    case 'B':
-      move(-speedToGo, -1);  // backward forever
-      break;
-      
-    // turn right
-    case 'y':
-      if (gyroPresent) turn(speedToGo, degrees_default / 2);  // turn right for half the default number of degrees
-      else turn(speedToGo, nudge_turn_time_default);  // turn right a little
-      break;
-    case 'r':    
-      if (gyroPresent) turn(speedToGo, degreesToTurn);  // turn right for the specified number of degrees
-      else turn(speedToGo, turnTime);  // turn right for the specfied time
-      break;
-    case 'R':    
-      if (gyroPresent) turn(speedToGo, degrees_default);  // turn right for the default number of degrees
-      else turn(speedToGo, -1);    // turn right forever
-      break;
-      
-    // turn left
-    case 'h':
-      if (gyroPresent) turn(-speedToGo, degrees_default / 2);  // turn left for half the default number of degrees
-      else turn(-speedToGo, nudge_turn_time_default);  // turn left a little
-      break;
-    case 'l':   // turn left
-      if (gyroPresent) turn(-speedToGo, degreesToTurn);  // turn left for the specified number of degrees
-      else turn(-speedToGo, turnTime);  // turn left for the specified time
-      break;
-    case 'L':
-      if (gyroPresent) turn(-speedToGo, degrees_default);  // turn left the default number of degrees
-      else turn(-speedToGo, -1);    // turn left forever
-      break;    
-      
-    // tilt up
-    case 'i':
-      tilt(tilt_up_speed_default, nudge_tilt_time_default);  // nudge tilt up
-      break;
-    case 'u':    // tilt up
-      tilt(tilt_up_speed_default, 0);  // tilt up for the default time
-      break;
-    case 'U':    // tilt up forever
-      tilt(tilt_up_speed_default, -1);  // tilt up forever
-      break;
-      
-    // tilt down
-    case 'k':
-      tilt(-tilt_down_speed_default, nudge_tilt_time_default);  // nudge tilt down
-      break;
-    case 'n':    // tilt down
-      tilt(-tilt_down_speed_default, 0);  // tilt down for the default time
-      break;
-    case 'N':    // tilt down forever
-      tilt(-tilt_down_speed_default, -1);  // tilt down forever
-      break;
-      
-      
-    case 'x':    // stop drive wheels
-    case 'X':
-      Stop();
-      break;
-      
-    case 'p':
-      SERIAL_PORT_BLUETOOTH.print("MESSAGE_BATTERY_PERCENT");  // lead with "mb"  
-                                      // 'm' indicates that this is a message for the server
-                                      // 'b' indicates that it is a battery percent messsage
-      SERIAL_PORT_BLUETOOTH.println(checkBattery()); 
-      break;
-      
-    // EEPROM commands
-    case 'E':
-      EEPROMvalue = readFromEEPROM(EEPROMaddress);
-      SERIAL_PORT_BLUETOOTH.print("MESSAGE_EEPROM_VALUE");  // lead with "mE"  
-                                      // 'm' indicates that this is a message for the server
-                                      // 'E' indicates that it is an EEPROM value
-      SERIAL_PORT_BLUETOOTH.println(EEPROMvalue); 
-      SERIAL_PORT.print("EEPROM requested:  address, value: ");
-      SERIAL_PORT.print(EEPROMaddress);
-      SERIAL_PORT.print(", ");
-      SERIAL_PORT.println(EEPROMvalue); 
-      break;
-    case 'Z':
-      enableEEPROMwrite = true;
-      SERIAL_PORT.println("EEPROM writing enabled.");
-      SERIAL_PORT_BLUETOOTH.println("EEPROM writing enabled.");
-      break;
-    case 'z':
-      enableEEPROMwrite = false;
-      SERIAL_PORT.println("EEPROM writing disabled.");
-      SERIAL_PORT_BLUETOOTH.println("EEPROM writing disabled.");
-      break;
-    case 'v':
-      if (enableEEPROMwrite)
-      {
-        writeToEEPROM(EEPROMaddress, EEPROMvalue);
-        SERIAL_PORT.print("Value = ");
-        SERIAL_PORT.print(EEPROMvalue);
-        SERIAL_PORT.print(" was written to EEPROM address = ");
-        SERIAL_PORT.print(EEPROMaddress);
-      }
-      else SERIAL_PORT.print("EEPROM write requested when writing not enabled");
-      break;
-    case 'a':
-    case 'A':
-      readBTaddress();
-      break;
-        
-    default:
-      SERIAL_PORT.print("did not recognize command: ");
-       if (input[0] == 13) SERIAL_PORT.print(" 13 ");
-       else if (input[0] == 10) SERIAL_PORT.print(" 10 ");
-       else if (input[0] == 32) SERIAL_PORT.print(" 32 ");
-       else if (input[0] == 0) SERIAL_PORT.print(" 0 ");
-       else SERIAL_PORT.print(input[0]);
-      Stop();
-      break;
+// process a command string
+void HandleCommand(const BufferedFrame& input)
+{
+  commandDescriptor command;
+  long parameter[MAX_PARAMETERS];
+  int numParameters = 0;
+  char opcode = input[0];
+
+  command.opcode = 0;
+  if (opcode >= FIRST_OPCODE && opcode <= LAST_OPCODE)
+    memcpy_P(&command, &commandTable[opcode - FIRST_OPCODE], sizeof(command));
+  if (command.opcode == 0)
+  {
+    logger.message(LOG_UNKNOWN_COMMAND, (int) opcode);
+    Stop();
+    return;
   }
-} 
 
+  if (command.schema == PARAMS_NUMBERS && input.length() > 1)
+  {
+    numParameters = parseParameters(input, parameter);
+    SERIAL_PORT.print(F("parameter values:"));
+    for (int i = 0; i < numParameters; i++)
+    {
+      SERIAL_PORT.print(' ');
+      SERIAL_PORT.print(parameter[i]);
+    }
+    SERIAL_PORT.println();
+  }
+  for (int i = numParameters; i < MAX_PARAMETERS; i++)
+    parameter[i] = i < 2 ? parameterDefault(command.defaults[i]) : 0;
+
+  if ((command.flags & CMD_NEEDS_EEPROM_ENABLE) && !enableEEPROMwrite)
+  {
+    logger.message(LOG_EEPROM_NOT_ENABLED);
+    return;
+  }
+  if ((command.flags & CMD_PREEMPTS_MOTION) && (Moving || Turning)) coast();  // protect from reversing a motor abruptly
+
+  command.handler(input, parameter);
+}
+
+// '?' sends one line per command: m? opcode, schema, default sources, flags
+void commandListCommands(const BufferedFrame& input, long* parameter)
+{
+  commandDescriptor command;
+  for (int i = 0; i <= LAST_OPCODE - FIRST_OPCODE; i++)
+  {
+    memcpy_P(&command, &commandTable[i], sizeof(command));
+    if (command.opcode == 0) continue;
+    SERIAL_PORT_BLUETOOTH.print(F("m?"));
+    SERIAL_PORT_BLUETOOTH.print(command.opcode);
+    SERIAL_PORT_BLUETOOTH.print(',');
+    SERIAL_PORT_BLUETOOTH.print(command.schema);
+    SERIAL_PORT_BLUETOOTH.print(',');
+    SERIAL_PORT_BLUETOOTH.print(command.defaults[0]);
+    SERIAL_PORT_BLUETOOTH.print(',');
+    SERIAL_PORT_BLUETOOTH.print(command.defaults[1]);
+    SERIAL_PORT_BLUETOOTH.print(',');
+    SERIAL_PORT_BLUETOOTH.println(command.flags);
+  }
+}
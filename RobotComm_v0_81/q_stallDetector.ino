@@ -0,0 +1,211 @@
+// stall and stuck wheel detection
+// Every STALL_INTERVAL msec the timer tick compares what each drive wheel is given (its PWM) with what it
+// is doing (its current, and its encoder count if ROBOT_ENCODERS), and the turn rate the gyro last saw
+// with what the wheels should be doing.  A wheel is
+//   stalled: drawing more than stall_current_default at a PWM of at least stall_min_pwm_default, and not
+//     turning if there is an encoder; it is jammed, or the robot is pushing against something
+//   free spinning: drawing less than stall_free_current_default at that PWM; it is off the ground or the
+//     gearbox has let go
+//   slipping: the wheels are driven in opposite directions for a turn at normal currents, but the gyro says
+//     the robot is turning slower than stall_min_turn_rate_default; the wheels are spinning in place
+// A wheel is not judged for STALL_SETTLE samples after its PWM changes by more than STALL_PWM_TOLERANCE,
+// so the inrush of a start, or the back EMF while slowing down, is not taken for a stall or a free wheel.
+// The small changes goStraight() makes to the biases don't count as changes.
+// A classification has to hold for STALL_DEBOUNCE samples in a row, 50 msec, before the detector acts:
+// it lets the drive wheels coast, blocks motion until loop() reports it, and freezes the motor bias
+// learning in goStraight() so a stuck wheel can't teach it a bad bias; the biases learned during the move
+// are thrown away.  The report is mK<kind>,<wheel mask>, kind 1 stalled, 2 free spinning, 3 slipping,
+// and bit 0 of the mask is the left wheel.
+//
+// The gyro is read over I2C from loop(), which the timer interrupt can't do, so the detector uses the rate
+// loop() last left in yawRateTenths (see publishYawRate() in d_imu) and ignores it once it is older than
+// STALL_YAW_MAX_AGE, e.g. when there is no gyro.
+//
+// The thresholds are in EEPROM at 130 - 134 (see t_EEPROM) and can be changed with the v command.
+// command form is K followed by 1 to turn the detector on or 0 to turn it off, K# just reports:
+// mK?<enabled>,<left current mA>,<right current mA>,<yaw rate in 0.1 degrees/sec>
+// hostTools/sketchHost/stallTest runs the detector on noisy current and gyro traces and counts its false
+// stops and missed faults.
+
+#define STALL_INTERVAL 10        // msec
+#define STALL_DEBOUNCE 5         // samples in a row before the detector acts, 50 msec
+#define STALL_SETTLE 5           // samples ignored after a PWM change
+#define STALL_PWM_TOLERANCE 16   // bigger PWM changes than this start STALL_SETTLE, the slew steps are 20
+#define STALL_YAW_MAX_AGE 60     // msec
+#define STALL_WHEELS 2           // left, right
+#define STALL_NONE 0
+#define STALL_STALLED 1
+#define STALL_FREE_SPINNING 2
+#define STALL_SLIPPING 3
+
+// from EEPROM
+int stall_current_default, stall_free_current_default;  // mA
+int stall_min_pwm_default;
+int stall_min_turn_rate_default;  // degrees/sec
+volatile bool stall_detect_enabled_default;
+
+volatile byte stallKind = STALL_NONE;  // what the detector found last, kept for the report
+volatile byte stallMask = 0;
+volatile bool stallSuspect = false;  // a wheel looks wrong, but not yet for long enough
+volatile bool stallBiasFrozen = false;  // a wheel was found stuck since the move started
+int stallSavedLeftBias, stallSavedRightBias;
+byte stallCandidate[STALL_WHEELS];
+byte stallCount[STALL_WHEELS];
+byte stallSettle[STALL_WHEELS];
+int stallPreviousPWM[STALL_WHEELS];
+byte stallTicks = 3;  // on msec 7 of every 10, see l_timerTick
+
+#if ROBOT_ENCODERS
+volatile unsigned int encoderTicks[STALL_WHEELS];
+unsigned int stallPreviousTicks[STALL_WHEELS];
+
+void leftEncoderTick() { encoderTicks[0]++; }
+void rightEncoderTick() { encoderTicks[1]++; }
+#endif
+
+void startStallDetector()
+{
+#if ROBOT_ENCODERS
+  attachInterrupt(digitalPinToInterrupt(ROBOT_ENCODER_PIN_A), leftEncoderTick, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(ROBOT_ENCODER_PIN_B), rightEncoderTick, CHANGE);
+#endif
+}
+
+// ticks is the encoder count over the last interval, -1 without encoders
+byte classifyWheel(int pwm, long milliAmps, bool turnTooSlow, int ticks)
+{
+  if (abs(pwm) < stall_min_pwm_default) return STALL_NONE;
+  if (milliAmps > stall_current_default && ticks <= 0) return STALL_STALLED;
+  if (milliAmps < stall_free_current_default && ticks != 0) return STALL_FREE_SPINNING;
+  if (turnTooSlow) return STALL_SLIPPING;
+  return STALL_NONE;
+}
+
+// runs in the timer interrupt every msec
+void stallDetectorTick()
+{
+  if (++stallTicks < STALL_INTERVAL) return;
+  stallTicks = 0;
+  if (!stall_detect_enabled_default || motionInhibited())
+  {
+    for (byte i = 0; i < STALL_WHEELS; i++) stallCount[i] = 0;
+    stallSuspect = false;
+    return;
+  }
+
+  int pwm[STALL_WHEELS] = { commandedLeftSpeed, commandedRightSpeed };
+  long milliAmps[STALL_WHEELS] = { (long) readAnalogSmoothed(FBA) * ROBOT_MILLIAMPS_PER_COUNT,
+                                   (long) readAnalogSmoothed(FBB) * ROBOT_MILLIAMPS_PER_COUNT };
+  bool turning = (pwm[0] > 0 && pwm[1] < 0) || (pwm[0] < 0 && pwm[1] > 0);
+  bool turnTooSlow = false;
+  if (turning && millis() - yawRateMillis < STALL_YAW_MAX_AGE)
+    turnTooSlow = abs(yawRateTenths) < stall_min_turn_rate_default * 10;
+
+  byte tripped = 0, kind = STALL_NONE;
+  bool suspect = false;
+  for (byte i = 0; i < STALL_WHEELS; i++)
+  {
+    int ticks = -1;
+#if ROBOT_ENCODERS
+    noInterrupts();  // the encoder interrupts count them
+    ticks = encoderTicks[i] - stallPreviousTicks[i];
+    interrupts();
+    stallPreviousTicks[i] += ticks;
+#endif
+    if (abs(pwm[i] - stallPreviousPWM[i]) > STALL_PWM_TOLERANCE) stallSettle[i] = STALL_SETTLE;
+    stallPreviousPWM[i] = pwm[i];
+    byte candidate = STALL_NONE;
+    if (stallSettle[i] > 0) stallSettle[i]--;
+    else candidate = classifyWheel(pwm[i], milliAmps[i], turnTooSlow, ticks);
+
+    if (candidate != stallCandidate[i]) stallCount[i] = 0;
+    stallCandidate[i] = candidate;
+    if (candidate == STALL_NONE) continue;
+    suspect = true;
+    if (++stallCount[i] >= STALL_DEBOUNCE)
+    {
+      tripped |= 1 << i;
+      kind = candidate;
+    }
+  }
+  stallSuspect = suspect;
+  if (!tripped) return;
+
+  stallKind = kind;
+  stallMask = tripped;
+  stallBiasFrozen = true;
+  stallStopping = true;  // from here on nothing drives the wheels until reportStall()
+  noInterrupts();
+  requestedLeftSpeed = 0;
+  requestedRightSpeed = 0;
+  commandedLeftSpeed = 0;
+  commandedRightSpeed = 0;
+  if (!emergencyStopLatched) motorDriver.setCoastAB();  // an emergency stop that came in meanwhile keeps its brakes
+  interrupts();
+  for (byte i = 0; i < STALL_WHEELS; i++) stallCount[i] = 0;
+  stallSuspect = false;
+}
+
+// for telemetry
+bool stallSuspected()
+{
+  return stallSuspect || stallStopping;
+}
+
+// move() calls this as each move starts, goStraight() learns from here on
+void startBiasLearning()
+{
+  stallSavedLeftBias = left_motor_bias_default;
+  stallSavedRightBias = right_motor_bias_default;
+  stallBiasFrozen = false;
+}
+
+bool biasLearningFrozen()
+{
+  return stallBiasFrozen || stallSuspect;
+}
+
+// puts back the biases from the start of the move if a wheel got stuck during it; true if it did
+bool discardBiasLearning()
+{
+  if (!stallBiasFrozen) return false;
+  left_motor_bias_default = stallSavedLeftBias;
+  right_motor_bias_default = stallSavedRightBias;
+  return true;
+}
+
+// called from loop(), tidies up the motion flags and says which wheel was stuck.  The rest of a queued
+// maneuver is cancelled, it would drive on with the wheel still stuck.
+void reportStall()
+{
+  if (!stallStopping) return;
+  if (movingForever) discardBiasLearning();  // a timed move has already done this itself
+  Moving = false;
+  movingForever = false;
+  Turning = false;
+  brakesOn = false;
+  logger.message(LOG_STALL, stallKind, stallMask);
+  SERIAL_PORT_BLUETOOTH.print(F("mK"));
+  SERIAL_PORT_BLUETOOTH.print(stallKind);
+  SERIAL_PORT_BLUETOOTH.print(',');
+  SERIAL_PORT_BLUETOOTH.println(stallMask);
+  cancelQueuedCommands(0);
+  stallStopping = false;
+}
+
+void setStallDetector(int enable)
+{
+  if (enable >= 0) stall_detect_enabled_default = enable != 0;
+  noInterrupts();
+  int yawRate = yawRateTenths;
+  interrupts();
+  logger.message(LOG_STALL_ENABLED, stall_detect_enabled_default);
+  SERIAL_PORT_BLUETOOTH.print(F("mK?"));
+  SERIAL_PORT_BLUETOOTH.print(stall_detect_enabled_default);
+  SERIAL_PORT_BLUETOOTH.print(',');
+  SERIAL_PORT_BLUETOOTH.print((long) readAnalogSmoothed(FBA) * ROBOT_MILLIAMPS_PER_COUNT);
+  SERIAL_PORT_BLUETOOTH.print(',');
+  SERIAL_PORT_BLUETOOTH.print((long) readAnalogSmoothed(FBB) * ROBOT_MILLIAMPS_PER_COUNT);
+  SERIAL_PORT_BLUETOOTH.print(',');
+  SERIAL_PORT_BLUETOOTH.println(yawRate);
+}
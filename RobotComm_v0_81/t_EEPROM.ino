@@ -1,158 +1,154 @@
 //writes and reads to/from EEPROM
 //to hold parameters and default values
+// Every read and write goes through backgroundEEPROM (libraries/RobotCommCore), which queues the
+// writes and does them from the EEPROM ready interrupt, so none of them hold up the loop.
 
-#include <EEPROM.h>
+#include <util/crc16.h>
 
 //long EEPROMvalue, EEPROMaddress;
 
 // standard defines
 
-#define BATTERY_MONITOR_PIN 4  // note that this refers to arduino pin A4, since it is an analog read
 #define MESSAGE_BATTERY_PERCENT mb
 #define MESSAGE_EEPROM_VALUE mE
-#define EEPROM_TEST_VALUE_10 2
-#define EEPROM_TEST_VALUE_11 4
-#define EEPROM_TEST_VALUE_12 8
-
-// EEPROM written defines
-#define TIMED_OUT 30  // this gets multiplied by 100 in actual use.  have to keep parameters < 256
-#define DEFAULT_SPEED 220
-#define BW_REDUCTION 50
-#define DEFAULT_TILT_UP_SPEED 180
-#define DEFAULT_TILT_DOWN_SPEED 135
-#define DEFAULT_DEGREES 5
-#define TICKS_PER_DEGREE_OF_TILT 30
-#define DEFAULT_TURN_FOREVER_SPEED 150
-#define TURN_TIME 500
-#define MOVE_TIME 1000
-#define TILT_TIME 500
-#define NUDGE_TURN_TIME 200
-#define NUDGE_MOVE_TIME 300
-#define NUDGE_TILT_TIME 200
-#define MIN_ACCEL_SPEED 120
-#define MIN_DECEL_SPEED 60
-#define DELTA_SPEED 60
-#define ACCEL_DELAY 200
-#define LEFT_MOTOR_BIAS 0
-#define LEFT_MOTOR_BW_BIAS 23
-#define RIGHT_MOTOR_BIAS 0
-#define RIGHT_MOTOR_BW_BIAS 0
-#define LEFT_MOTOR_STOP_DELAY 0
-#define RIGHT_MOTOR_STOP_DELAY 0
-#define MODIFY_MOTOR_BIASES 1  // this is a boolean
-
-
-// next two are modified so that they stay under 255
-#define CURRENT_LIMIT_TOP_MOTOR 20  // this gets multiplied by 100 in actual use
-#define CURRENT_LIMIT_DRIVE_MOTORS 40 // this gets multiplied by 100 in actual use
-#define CURRENT_LIMIT_ENABLED 1
-
-#define ZERO_PERCENT_BATTERY_VOLTAGE 10.5
-#define FULL_BATTERY_VOLTAGE 13.0
-#define VOLTAGE_DIVIDER_RATIO 3.2
 
+// the parameters, their EEPROM addresses and their defaults are listed in libraries/RobotParameters,
+// see u_parameters
 void setDefaults()
 {
- if (EEPROM.read(10) == EEPROM_TEST_VALUE_10 &&
-    EEPROM.read(11) == EEPROM_TEST_VALUE_11 &&
-    EEPROM.read(12) == EEPROM_TEST_VALUE_12)  // test to see if we have written to the EEPROM
-  {
-    timed_out_default = EEPROM.read(101)* 100;  // needs to be mult by 100 to keep the original parameter < 256
-    speed_default = EEPROM.read(102);
-    bw_reduction_default = EEPROM.read(103);
-    tilt_up_speed_default = EEPROM.read(104);
-    tilt_down_speed_default = EEPROM.read(105);
-    degrees_default = EEPROM.read(106);
-    ticks_per_degree_of_tilt_default = EEPROM.read(107);
-    turn_forever_speed_default = EEPROM.read(108);
-    turn_time_default = EEPROM.read(109) * 10;  // needs to be mult by 10 to keep the original parameter < 256
-    move_time_default = EEPROM.read(110) * 10;
-    tilt_time_default = EEPROM.read(111) * 10;
-    nudge_turn_time_default = EEPROM.read(201) * 10;
-    nudge_move_time_default = EEPROM.read(202) * 10;
-    nudge_tilt_time_default = EEPROM.read(203);
-    min_accel_speed_default = EEPROM.read(112);
-    min_decel_speed_default = EEPROM.read(113);
-    delta_speed_default = EEPROM.read(114);
-    accel_delay_default = EEPROM.read(115) * 10;  // needs to be mult by 10 to keep the original parameter < 256
-    left_motor_bias_default = EEPROM.read(116);
-    if (left_motor_bias_default > 128) left_motor_bias_default -= 256;  // negative numbers encoded as counting back from 256
-    left_motor_bw_bias_default = EEPROM.read(117);
-    left_motor_stop_delay_default = EEPROM.read(118) * 10; // needs to be mult by 10 to keep the original parameter < 256
-    right_motor_bias_default = EEPROM.read(210);
-    if (right_motor_bias_default > 128) right_motor_bias_default -= 256;
-    right_motor_bw_bias_default = EEPROM.read(211);
-    right_motor_stop_delay_default = EEPROM.read(212) * 10;  // needs to be mult by 10 to keep the original parameter < 256
-    current_limit_top_motor_default = EEPROM.read(119)*100;     // multiply to keep the eeprom parameter < 255
-    current_limit_drive_motors_default = EEPROM.read(120)*100; // multiply to keep the eeprom parameter < 255
-    current_limit_enabled_default = EEPROM.read(204);
-    encoder_ticks_per_cm_default = EEPROM.read(121);
-    zero_percent_battery_voltage_default = ((double) EEPROM.read(122)) + (( (double) EEPROM.read(123)) / 10.);
-    full_battery_voltage_default = ((double) EEPROM.read(124)) + ( ((double) EEPROM.read(125)) / 10.);
-    voltage_divider_ratio_default = ((double) EEPROM.read(126)) + ( ((double) EEPROM.read(127)) / 10.);  
-    battery_monitor_pin_default = EEPROM.read(128);  
-    modify_motor_biases_default = EEPROM.read(129);
-  }
-  else
-  {
-    timed_out_default =  TIMED_OUT * 100;
-    speed_default = DEFAULT_SPEED;
-    bw_reduction_default = BW_REDUCTION;
-    tilt_up_speed_default = DEFAULT_TILT_UP_SPEED;
-    tilt_down_speed_default = DEFAULT_TILT_DOWN_SPEED;
-    degrees_default = DEFAULT_DEGREES;
-    ticks_per_degree_of_tilt_default = TICKS_PER_DEGREE_OF_TILT;
-    turn_forever_speed_default = DEFAULT_TURN_FOREVER_SPEED;
-    turn_time_default = TURN_TIME;
-    move_time_default = MOVE_TIME;
-    tilt_time_default = TILT_TIME;
-    nudge_turn_time_default = NUDGE_TURN_TIME;
-    nudge_move_time_default = NUDGE_MOVE_TIME;
-    nudge_tilt_time_default = NUDGE_TILT_TIME;
-    min_accel_speed_default = MIN_ACCEL_SPEED;
-    min_decel_speed_default = MIN_DECEL_SPEED;
-    delta_speed_default = DELTA_SPEED;
-    accel_delay_default = ACCEL_DELAY;
-    left_motor_bias_default = LEFT_MOTOR_BIAS;
-    left_motor_bw_bias_default = LEFT_MOTOR_BW_BIAS;
-    left_motor_stop_delay_default = LEFT_MOTOR_STOP_DELAY;
-    right_motor_bias_default = RIGHT_MOTOR_BIAS;
-    right_motor_bw_bias_default = RIGHT_MOTOR_BW_BIAS;
-    right_motor_stop_delay_default = RIGHT_MOTOR_STOP_DELAY;    
-    current_limit_top_motor_default = CURRENT_LIMIT_TOP_MOTOR * 100; // multiply to keep the eeprom parameter < 255
-    current_limit_drive_motors_default = CURRENT_LIMIT_DRIVE_MOTORS * 100; // multiply to keep the eeprom parameter < 255
-    current_limit_enabled_default = CURRENT_LIMIT_ENABLED;
-    battery_monitor_pin_default = BATTERY_MONITOR_PIN;
-    zero_percent_battery_voltage_default = ZERO_PERCENT_BATTERY_VOLTAGE;
-    full_battery_voltage_default = FULL_BATTERY_VOLTAGE;
-    voltage_divider_ratio_default = VOLTAGE_DIVIDER_RATIO;
-    battery_monitor_pin_default = BATTERY_MONITOR_PIN; 
-    modify_motor_biases_default = MODIFY_MOTOR_BIASES;
-  }
+  loadParameters();
 }
 
 void writeToEEPROM(int address, byte value)
 {
   if (address > 4095 || address < 0) return;
-  EEPROM.write(address, value);
+  while (!backgroundEEPROM.write(address, value)) ;  // only waits when the queue is full
 }
 
 int readFromEEPROM(int address)
 {
   if (address > 4095 || address < 0) return -1;
-  return EEPROM.read(address);
+  return backgroundEEPROM.read(address);
+}
+
+// batched parameter writes, the W command
+// W followed by address,value pairs, e.g. W102,200,106,10,116,3#, sets many parameters in one round trip.
+// Every pair is checked before any is queued, so a batch goes in whole or not at all.  The parameters
+// the batch writes are live at once, read back from the queued values (see reloadParameterAt() in u_parameters).
+// Once the last byte is written and read back, the robot answers mW<pairs>,<crc>,<status>, where crc is
+// the CRC-16 of the text between W and # (_crc_ccitt_update from util/crc16.h, starting at 0xFFFF), so
+// the sender can tell which batch the answer is for.  A batch is refused while the last one is still
+// being written.
+
+#define BATCH_WRITTEN 0
+#define BATCH_VERIFY_FAILED 1  // a byte did not read back as written
+#define BATCH_BAD_PAIR 2       // not address,value pairs, or out of range
+#define BATCH_NO_ROOM 3        // more pairs than the write queue holds, or the last batch is not done
+
+bool batchWaiting = false;
+char batchOpcode;  // W for a batch, C for a commit of every parameter (u_parameters)
+int batchPairs;
+uint16_t batchCrc, batchFailures;
+
+// reads the next "address,value" from input, starting at *position, and moves past it
+bool nextBatchPair(const BufferedFrame& input, int* position, long* address, long* value)
+{
+  int length = input.length();
+  long number[2];
+  for (int n = 0; n < 2; n++)
+  {
+    int digits = 0;
+    number[n] = 0;
+    while (*position < length && input[*position] >= '0' && input[*position] <= '9' && digits < 5)
+    {
+      number[n] = number[n] * 10 + input[(*position)++] - '0';
+      digits++;
+    }
+    if (digits == 0) return false;
+    if (*position < length && input[(*position)++] != ',') return false;
+    if (n == 0 && *position == length) return false;  // an address without a value
+  }
+  *address = number[0];
+  *value = number[1];
+  return *address < 4096 && *value < 256;
+}
+
+void answerParameterBatch(int pairs, uint16_t crc, byte status)
+{
+  SERIAL_PORT_BLUETOOTH.print(F("mW"));
+  SERIAL_PORT_BLUETOOTH.print(pairs);
+  SERIAL_PORT_BLUETOOTH.print(',');
+  SERIAL_PORT_BLUETOOTH.print(crc);
+  SERIAL_PORT_BLUETOOTH.print(',');
+  SERIAL_PORT_BLUETOOTH.println(status);
+  logger.message(LOG_PARAMETER_BATCH, pairs, crc, status);
+}
+
+void writeParameterBatch(const BufferedFrame& input)
+{
+  int length = input.length();
+  uint16_t crc = 0xFFFF;
+  for (int i = 1; i < length; i++) crc = _crc_ccitt_update(crc, input[i]);
+
+  long address, value;
+  int pairs = 0, position = 1;
+  while (position < length)
+  {
+    if (!nextBatchPair(input, &position, &address, &value))
+    {
+      answerParameterBatch(pairs, crc, BATCH_BAD_PAIR);
+      return;
+    }
+    pairs++;
+  }
+  if (batchWaiting || pairs > backgroundEEPROM.space())
+  {
+    answerParameterBatch(pairs, crc, BATCH_NO_ROOM);
+    return;
+  }
+
+  noInterrupts();
+  batchFailures = backgroundEEPROM.verifyFailures();
+  interrupts();
+  position = 1;
+  for (int i = 0; i < pairs; i++)
+  {
+    nextBatchPair(input, &position, &address, &value);
+    writeToEEPROM(address, value);
+    reloadParameterAt(address);
+  }
+  batchOpcode = 'W';
+  batchPairs = pairs;
+  batchCrc = crc;
+  batchWaiting = true;
+}
+
+// called from the loop, answers once the batch or commit is in the EEPROM
+void reportParameterBatch()
+{
+  if (!batchWaiting || backgroundEEPROM.busy()) return;
+  batchWaiting = false;
+  noInterrupts();
+  bool failed = backgroundEEPROM.verifyFailures() != batchFailures;
+  interrupts();
+  byte status = failed ? BATCH_VERIFY_FAILED : BATCH_WRITTEN;
+  if (batchOpcode == 'C') answerParameterCommit(batchPairs, status);
+  else answerParameterBatch(batchPairs, batchCrc, status);
 }
 
+// A# answers mA<customer number>,<bluetooth address>, so a host running several robots can tell them apart
+// (both are written by write_robot_defaults_to_EEPROM)
 void readBTaddress()
 {
-  char buffer[18];
+  SERIAL_PORT_BLUETOOTH.print(F("mA"));
+  SERIAL_PORT_BLUETOOTH.print(backgroundEEPROM.read(0));  // customer_number
+  SERIAL_PORT_BLUETOOTH.print(',');
   for (int i= 0; i < 17; i++)
   {
-    buffer[i] = EEPROM.read(300 + i);
+    char c = backgroundEEPROM.read(300 + i);
+    if (c >= ' ' && c <= '~') SERIAL_PORT_BLUETOOTH.print(c);  // an unwritten byte reads 255
   }
-  //SERIAL_PORT.print("Bluetooth address is: ");
-  //for (int i=0; i < 17; i++) SERIAL_PORT.print(buffer[i]);
-  //SERIAL_PORT.println();
+  SERIAL_PORT_BLUETOOTH.println();
 }
 
 /*
@@ -0,0 +1,214 @@
+// live parameter registry
+// Every tunable parameter is described once, in libraries/RobotParameters/RobotParameters.h: the global
+// that holds it, its range, its EEPROM slot and its default.  Everything here is generated from that
+// list, so a parameter is read or set by its id with one table lookup, and a new one needs only a line there.
+// A set is live at once and stays in RAM; C# writes them all to the EEPROM (after Z#).
+//   G<id># reports one parameter as mG<id>,<value>,<status>, G# reports every one, a line each
+//   V<id>,<value># sets one and answers mV<id>,<value>,<status> with the value it now has
+//   C# queues every parameter for the EEPROM and answers mC<parameters>,<status> once they are written
+// Values are in the units of the variable, tenths for the battery voltages (105 is 10.5 V).
+// hostTools/parameterTool does all this by name.
+
+#include <RobotParameters.h>
+
+#define PARAM_OK 0
+#define PARAM_UNKNOWN 1       // no parameter with that id
+#define PARAM_OUT_OF_RANGE 2  // the value was not changed
+
+struct parameterInfo
+{
+  byte kind;
+  long minimum, maximum;
+  int scale;
+  int address;
+  long fallback;
+};
+
+#define PARAMETER_INFO(id, name, variable, kind, minimum, maximum, scale, address, fallback) \
+  { kind, minimum, maximum, scale, address, fallback },
+const parameterInfo parameterTable[ROBOT_PARAMETER_COUNT] PROGMEM = { ROBOT_PARAMETERS(PARAMETER_INFO) };
+#undef PARAMETER_INFO
+
+// the robotReal parameters hold volts and the like, the link and the EEPROM carry tenths;
+// the kind is pasted onto these names, so every case only does the conversion its variable needs
+#define PARAMETER_VALUE_PARAM_UNSIGNED(variable) (long) variable
+#define PARAMETER_VALUE_PARAM_SIGNED(variable) (long) variable
+#define PARAMETER_VALUE_PARAM_OPTIONAL(variable) (long) variable
+#define PARAMETER_VALUE_PARAM_TENTHS(variable) realRound(variable * 10)
+#define PARAMETER_PUT_PARAM_UNSIGNED(variable) variable = value
+#define PARAMETER_PUT_PARAM_SIGNED(variable) variable = value
+#define PARAMETER_PUT_PARAM_OPTIONAL(variable) variable = value
+#define PARAMETER_PUT_PARAM_TENTHS(variable) variable = realRatio(value, 10)
+
+long getParameter(byte id)
+{
+  switch (id)
+  {
+#define PARAMETER_GET(id, name, variable, kind, minimum, maximum, scale, address, fallback) \
+    case id: return PARAMETER_VALUE_##kind(variable);
+    ROBOT_PARAMETERS(PARAMETER_GET)
+#undef PARAMETER_GET
+  }
+  return 0;
+}
+
+// no range check, for values from the table or the EEPROM
+void putParameter(byte id, long value)
+{
+  noInterrupts();  // some are used by the timer interrupt
+  switch (id)
+  {
+#define PARAMETER_PUT(id, name, variable, kind, minimum, maximum, scale, address, fallback) \
+    case id: PARAMETER_PUT_##kind(variable); break;
+    ROBOT_PARAMETERS(PARAMETER_PUT)
+#undef PARAMETER_PUT
+  }
+  interrupts();
+}
+
+// anything worked out from a parameter once, rather than read each time it is used
+void parameterChanged(byte id)
+{
+  switch (id)
+  {
+    case PARAM_BATTERY_MONITOR_PIN:
+      backgroundAnalog.addChannel(battery_monitor_pin_default);  // nothing if it is already scanned
+      // fall through
+    case PARAM_ZERO_PERCENT_BATTERY_VOLTAGE:
+    case PARAM_FULL_BATTERY_VOLTAGE:
+    case PARAM_VOLTAGE_DIVIDER_RATIO:
+      startBatteryEstimator();
+      break;
+  }
+}
+
+byte setParameter(byte id, long value)
+{
+  if (id >= ROBOT_PARAMETER_COUNT) return PARAM_UNKNOWN;
+  parameterInfo info;
+  memcpy_P(&info, &parameterTable[id], sizeof(info));
+  if (value < info.minimum || value > info.maximum) return PARAM_OUT_OF_RANGE;
+  putParameter(id, value / info.scale * info.scale);  // only what the EEPROM can hold
+  parameterChanged(id);
+  return PARAM_OK;
+}
+
+// what the EEPROM holds for a parameter, counting writes still queued
+long storedParameter(byte id)
+{
+  parameterInfo info;
+  memcpy_P(&info, &parameterTable[id], sizeof(info));
+  int stored = backgroundEEPROM.read(info.address);
+  switch (info.kind)
+  {
+    case PARAM_SIGNED:
+      if (stored > 128) stored -= 256;  // negative numbers encoded as counting back from 256
+      break;
+    case PARAM_TENTHS:
+      return stored * 10L + backgroundEEPROM.read(info.address + 1);
+    case PARAM_OPTIONAL:
+      if (stored == 255) return info.fallback;
+      break;
+  }
+  return (long) stored * info.scale;
+}
+
+// at startup: the EEPROM values once they have been written, the defaults in the list until then
+void loadParameters()
+{
+  bool written = backgroundEEPROM.read(PARAM_EEPROM_MARK_ADDRESS) == PARAM_EEPROM_MARK_0 &&
+                 backgroundEEPROM.read(PARAM_EEPROM_MARK_ADDRESS + 1) == PARAM_EEPROM_MARK_1 &&
+                 backgroundEEPROM.read(PARAM_EEPROM_MARK_ADDRESS + 2) == PARAM_EEPROM_MARK_2;
+  for (byte id = 0; id < ROBOT_PARAMETER_COUNT; id++)
+  {
+    long fallback = pgm_read_dword(&parameterTable[id].fallback);
+    putParameter(id, written ? storedParameter(id) : fallback);
+  }
+}
+
+// after a raw EEPROM write, picks up the parameter that lives at the address, if any
+void reloadParameterAt(int address)
+{
+  parameterInfo info;
+  for (byte id = 0; id < ROBOT_PARAMETER_COUNT; id++)
+  {
+    memcpy_P(&info, &parameterTable[id], sizeof(info));
+    if (address != info.address && !(info.kind == PARAM_TENTHS && address == info.address + 1)) continue;
+    putParameter(id, storedParameter(id));
+    parameterChanged(id);
+  }
+}
+
+// queues the live value of a parameter for the EEPROM
+void storeParameter(byte id)
+{
+  parameterInfo info;
+  memcpy_P(&info, &parameterTable[id], sizeof(info));
+  long value = getParameter(id);
+  if (info.kind == PARAM_TENTHS)
+  {
+    writeToEEPROM(info.address, value / 10);
+    writeToEEPROM(info.address + 1, value % 10);
+  }
+  else writeToEEPROM(info.address, value / info.scale);  // a negative value wraps to count back from 256
+}
+
+void answerParameter(char opcode, byte id, byte status)
+{
+  SERIAL_PORT_BLUETOOTH.print('m');
+  SERIAL_PORT_BLUETOOTH.print(opcode);
+  SERIAL_PORT_BLUETOOTH.print(id);
+  SERIAL_PORT_BLUETOOTH.print(',');
+  SERIAL_PORT_BLUETOOTH.print(status == PARAM_UNKNOWN ? 0 : getParameter(id));
+  SERIAL_PORT_BLUETOOTH.print(',');
+  SERIAL_PORT_BLUETOOTH.println(status);
+}
+
+// G, a negative id (none sent) reports them all
+void reportParameters(long id)
+{
+  if (id >= 0)
+  {
+    answerParameter('G', id, id < ROBOT_PARAMETER_COUNT ? PARAM_OK : PARAM_UNKNOWN);
+    return;
+  }
+  for (byte i = 0; i < ROBOT_PARAMETER_COUNT; i++) answerParameter('G', i, PARAM_OK);
+}
+
+// V
+void changeParameter(long id, long value)
+{
+  if (id < 0 || id >= ROBOT_PARAMETER_COUNT) id = ROBOT_PARAMETER_COUNT;
+  byte status = setParameter(id, value);
+  answerParameter('V', id, status);
+  logger.message(LOG_PARAMETER_SET, id, value, status);
+}
+
+// C, answered from reportParameterBatch() once it is written
+void commitParameters()
+{
+  if (batchWaiting || backgroundEEPROM.space() < ROBOT_PARAMETER_COUNT + 6)  // the tenths take two bytes
+  {
+    answerParameterCommit(ROBOT_PARAMETER_COUNT, BATCH_NO_ROOM);
+    return;
+  }
+  noInterrupts();
+  batchFailures = backgroundEEPROM.verifyFailures();
+  interrupts();
+  for (byte id = 0; id < ROBOT_PARAMETER_COUNT; id++) storeParameter(id);
+  writeToEEPROM(PARAM_EEPROM_MARK_ADDRESS, PARAM_EEPROM_MARK_0);
+  writeToEEPROM(PARAM_EEPROM_MARK_ADDRESS + 1, PARAM_EEPROM_MARK_1);
+  writeToEEPROM(PARAM_EEPROM_MARK_ADDRESS + 2, PARAM_EEPROM_MARK_2);
+  batchOpcode = 'C';
+  batchPairs = ROBOT_PARAMETER_COUNT;
+  batchWaiting = true;
+}
+
+void answerParameterCommit(int parameters, byte status)
+{
+  SERIAL_PORT_BLUETOOTH.print(F("mC"));
+  SERIAL_PORT_BLUETOOTH.print(parameters);
+  SERIAL_PORT_BLUETOOTH.print(',');
+  SERIAL_PORT_BLUETOOTH.println(status);
+  logger.message(LOG_PARAMETERS_COMMITTED, parameters, status);
+}
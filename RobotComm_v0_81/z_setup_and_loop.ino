@@ -1,7 +1,7 @@
 
 bool firstTimeThroughMoveForever = true;
 unsigned long previousMovingForwardForeverTime = 0;  // prevents weird error if there is a bug and this is used before being set to millis()
-double initialMovingForwardForeverYaw, previousMovingForwardForeverYaw;
+robotReal initialMovingForwardForeverYaw, previousMovingForwardForeverYaw;
 
 void baselineGyro()
 {
@@ -15,6 +15,18 @@ void baselineGyro()
    }
 }
        
+// use in place of delay() in anything that blocks, so that the background jobs
+// (telemetry for now) keep running while we wait
+void backgroundDelay(unsigned long waitTime)
+{
+  unsigned long startTime = millis();
+  do
+  {
+    wdt_reset();
+    serviceTelemetry();
+  } while (millis() - startTime < waitTime && !motionInhibited());  // an emergency stop or lost link cuts the wait short
+}
+       
 void checkMovingForwardForever()
 {
     // implies that we got a move forever command
@@ -45,108 +57,85 @@ void checkMovingForwardForever()
 void setup()  
 {
   setDefaults();
+  startAnalogScan();  // before anything reads an analog input
+  startBatteryEstimator();
   // get currents at the start, since the first value seems to often be a large number
   getMotorCurrents();
   
   SERIAL_PORT.begin(SERIAL_SPEED);
-  SERIAL_PORT_BLUETOOTH.begin(BLUETOOTH_SPEED);   // usually connect to bluetooth on serial2
-  SERIAL_PORT.println("Serial ports initialized, ready for commands");
+  SERIAL_PORT_BLUETOOTH.begin(BLUETOOTH_SPEED, bluetoothRxBuffer, BLUETOOTH_RX_BUFFER_SIZE,
+                               bluetoothTxBuffer, BLUETOOTH_TX_BUFFER_SIZE);   // usually connect to bluetooth on serial2
+  SERIAL_PORT_BLUETOOTH.setFrameEnd(COMMAND_END_CHARACTER);
+  SERIAL_PORT_BLUETOOTH.setRTSpin(BLUETOOTH_RTS_PIN);
+  SERIAL_PORT_BLUETOOTH.setXonXoff(BLUETOOTH_XON_XOFF);
+  SERIAL_PORT_BLUETOOTH.setEmergencyByte(EMERGENCY_STOP_CHARACTER, emergencyStop);
+  SERIAL_PORT_BLUETOOTH.setSkipWhitespace(true);  // commands are parsed in place, so filter as they arrive
+  logger.message(LOG_READY);
   
   coast();
   coastTilt();
   
   Wire.begin();
   gyroPresent = Gyro_Init();
+  startStallDetector();
+  startMotorFaultMonitor();
   
   monitorMotorCurrents();  // should be 0
-  SERIAL_PORT.print("left_motor_bias_default, right_motor_bias_default =  ");
-  SERIAL_PORT.print(left_motor_bias_default);
-  SERIAL_PORT.print(", ");
-  SERIAL_PORT.println(right_motor_bias_default);
+  logger.message(LOG_MOTOR_BIASES, left_motor_bias_default, right_motor_bias_default);
   
-  SERIAL_PORT.println("website does not yet support specifying turn degrees, so we just use ");
-  SERIAL_PORT.print("degrees_default =  ");
-  SERIAL_PORT.println(degrees_default);  
+  logger.message(LOG_DEFAULT_DEGREES, degrees_default);  
   
-  // clear the input buffer
-  for (int i=0; i< INPUT_BUFFER_SIZE; i++) inputBuffer[i] = 0; 
+  startWatchdogs();  // link watchdog and hardware watchdog, after the slow gyro baseline in Gyro_Init()
   
 }
 
 void loop()
 {
-  double initialYaw;
+  robotReal initialYaw;
   long previousTime;
   bool firstTimeThroughMoveForever;
   
-  inputLength = 0;
-  charIn = 0;
-  while (charIn != COMMAND_END_CHARACTER && inputLength < INPUT_BUFFER_SIZE)
+  while (!SERIAL_PORT_BLUETOOTH.framesAvailable()) // wait for a complete command
   {
-    while (!SERIAL_PORT_BLUETOOTH.available()) // wait for input
-    {
-      /*if ((millis() - timeOutCheck > timed_out_default) && (Moving || Turning || Tilting))
-      {
-        SERIAL_PORT.println("timed out");
-        Stop();  //if we are moving and haven't heard anything in a long time, stop moving
-        coastTilt();  // stop tilting too        
-      }*/
-      // some things to do while waiting for serial inputs
-      //getMotorCurrents();
-      monitorMotorCurrents();
-      if ((!Moving) && gyroPresent) baselineGyro();
-      if (Moving && gyroPresent) checkMovingForwardForever();    
-      delay(20);
-    }
-    // got a character on the bluetooth port
-    charIn = SERIAL_PORT_BLUETOOTH.read(); // read it in
-    if (charIn != 13 && charIn != 10 && charIn != 32)  // ignore carriage returns, line feeds, and spaces
-    {
-       inputBuffer[inputLength] = charIn;  // building the command string
-       inputLength++;
-       //SERIAL_PORT.print(charIn);
-    }
-  } // this loop keeps going until the COMMAND_END_CHARACTER is received or the string gets too long
-  
-  //now flush anything that came after the COMMAND_END_CHARACTER
-  if (SERIAL_PORT_BLUETOOTH.available())
-  {
-    SERIAL_PORT.print("Extra character(s) received have ASCII values = ");  // this is usually the null char end string (0)
-    while (SERIAL_PORT_BLUETOOTH.available())
-    {
-       charIn = SERIAL_PORT_BLUETOOTH.read(); // read it in so we can see what is really getting sent
-       if (charIn == 13) SERIAL_PORT.print(" 13 ");
-       else if (charIn == 10) SERIAL_PORT.print(" 10 ");
-       else if (charIn == 32) SERIAL_PORT.print(" 32 ");
-       else if (charIn == 0) SERIAL_PORT.print(" 0 (NULL character) ");
-       else SERIAL_PORT.print(charIn);
-       SERIAL_PORT.print(" ");
-    }
-    SERIAL_PORT.println();
+    // some things to do while waiting for serial inputs
+    // (if we are moving and haven't heard anything in a long time, the link watchdog in l_timerTick stops us)
+    wdt_reset();
+    reportEmergencyStop();
+    reportMotorFault();
+    reportLinkLoss();
+    reportSafetyStop();
+    reportStall();
+    reportParameterBatch();
+    //getMotorCurrents();
+    monitorMotorCurrents();
+    if ((!Moving) && gyroPresent) baselineGyro();
+    if (Moving && gyroPresent) checkMovingForwardForever();    
+    serviceCommandQueue();
+    backgroundDelay(20);
   }
+  // at least one command is in the buffer; take just that one, anything after it stays queued for the next pass.
+  // It is read where it lies in the receive buffer (the receive interrupt has already left out the
+  // carriage returns, line feeds, spaces and nulls), and only let go of once it has been handled.
+  BufferedFrame input;
+  SERIAL_PORT_BLUETOOTH.peekFrame(input);
+  refreshLinkDeadline();
   
-  // throw away the command end character
-  inputLength -= 1;  // -1 because it is incremented after the last character
-  inputBuffer[inputLength] = 0;  // change COMMAND_END_CHARACTER to a 0 (remember, index is one behind inputLength)
-  
- SERIAL_PORT.print("commanded: ");
- SERIAL_PORT.println(inputBuffer);
+ logger.message(LOG_COMMANDED, input);
 
   // if the command == COMM_CHECK_CHARACTER it is just a local bluetooth comm check
-  if (inputBuffer[0] != COMM_CHECK_CHARACTER && inputLength > 0)
+  if (input.length() > 0 && input[0] != COMM_CHECK_CHARACTER)
   {
       // echo the command, so that the android app knows we are alive
     SERIAL_PORT_BLUETOOTH.print(COMMAND_ECHO_CHARACTER); // lead with this character to indicate just a command echo
-    SERIAL_PORT_BLUETOOTH.println(inputBuffer); // need to println because android uses the CR as a delimiter
-    HandleCommand(inputBuffer, inputLength);  // this goes after the echo, so that responses will show up on the details screen
+    SERIAL_PORT_BLUETOOTH.println(input); // need to println because android uses the CR as a delimiter
+    HandleCommand(input);  // this goes after the echo, so that responses will show up on the details screen
   }
   else  // just a comm check
   {
-    SERIAL_PORT_BLUETOOTH.print("c");  // this indicates it is just a response to a comm check
+    SERIAL_PORT_BLUETOOTH.print('c');  // this indicates it is just a response to a comm check
     SERIAL_PORT_BLUETOOTH.println(checkBattery()); // might as well send along the battery state
   } 
     
-  // clear the buffer for the next command
-  for (int i = 0; i < inputLength; i++) inputBuffer[i] = 0;
+  SERIAL_PORT_BLUETOOTH.dropFrame();  // its space in the receive buffer can take the next command
 }
 
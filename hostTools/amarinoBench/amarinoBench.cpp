@@ -0,0 +1,254 @@
+// amarinoBench - messages/sec through old_libraries/MeetAndroid, against the way it used to work
+//
+// Builds the real library against the Arduino shim in hostTools/arduino (only its headers), feeds it a mix of Amarino
+// messages (a flag, values separated by ';', the ack byte) from a memory stream that lets a few bytes
+// "arrive" before each call to receive(), the way loop() sees a UART, and has the registered
+// functions read every value with getIntValues() or getFloatValues().
+//
+// The old library is modelled alongside: receive() spun waitTime usec (30) every time the port ran
+// dry, getArrayLength() counted the delimiters again for every message, and each value was copied out
+// and handed to atoi() or atof().  It is run with waitTime 30 and 0, so the cost of the wait and the
+// cost of the parsing show up separately.
+//
+// build:
+//   g++ -O2 -DARDUINO=100 -I../arduino -I../../old_libraries/MeetAndroid -o amarinoBench amarinoBench.cpp ../../old_libraries/MeetAndroid/MeetAndroid.cpp
+// use:
+//   amarinoBench [-n passes] [-b bytes per loop] [-r]
+//     -n  passes over the message mix (20000)
+//     -b  bytes that arrive between calls to receive() (8, about 0.7 msec at 115200 baud)
+//     -r  one line for scripts: old msgs/sec (wait 30), old (wait 0), new
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <string>
+#include "Arduino.h"
+#include "MeetAndroid.h"
+
+#define ACK 19
+#define ABORT 27
+#define DELIMITER ';'
+#define MAX_VALUES 8
+
+HardwareSerial Serial;
+
+static volatile double sink;
+static long handled;
+
+static double seconds()
+{
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+void delayMicroseconds(unsigned int us)
+{
+  double end = seconds() + us / 1e6;
+  while (seconds() < end) {}
+}
+
+// what a phone running Amarino sends: sensor events as float arrays, control values as ints
+static const char* messageMix[] =
+{
+  "A0.4375;-9.80665;1.2E-4", "i120;-45;3", "f200", "c", "A12.5;0.0;-3.25", "i7;8",
+  "B1024", "A-0.001;9.81;0.5", "i255;255;0;1", "f-140",
+};
+
+static std::string buildStream()
+{
+  std::string s;
+  for (size_t i = 0; i < sizeof(messageMix) / sizeof(messageMix[0]); i++)
+  {
+    s += messageMix[i];
+    s += (char) ACK;
+  }
+  return s;
+}
+
+// ---- the library as it is now ----
+
+static MeetAndroid meetAndroid(Serial);
+
+static void floatEvent(uint8_t, uint8_t values)
+{
+  float v[MAX_VALUES];
+  if (values > MAX_VALUES) return;
+  meetAndroid.getFloatValues(v);
+  for (int i = 0; i < values; i++) sink = sink + v[i];
+  handled++;
+}
+
+static void intEvent(uint8_t, uint8_t values)
+{
+  int v[MAX_VALUES];
+  if (values > MAX_VALUES) return;
+  meetAndroid.getIntValues(v);
+  for (int i = 0; i < values; i++) sink = sink + v[i];
+  handled++;
+}
+
+// ---- the library as it was ----
+
+struct oldMeetAndroid
+{
+  uint8_t bufferCount;
+  uint8_t buffer[64];
+  uint16_t waitTime;
+  void (*intFunc[75])(uint8_t, uint8_t);
+
+  int getArrayLength()
+  {
+    if (bufferCount == 1) return 0;
+    int numberOfValues = 1;
+    for (int a = 1; a < bufferCount; a++)
+      if (buffer[a] == DELIMITER) numberOfValues++;
+    return numberOfValues;
+  }
+  void flush()
+  {
+    for (uint8_t a = 0; a < 64; a++) buffer[a] = 0;
+    bufferCount = 0;
+  }
+  bool receive()
+  {
+    bool timeout = false;
+    while (!timeout)
+    {
+      while (Serial.available() > 0)
+      {
+        uint8_t lastByte = Serial.read();
+        if (lastByte == ABORT) flush();
+        else if (lastByte == ACK)
+        {
+          void (*f)(uint8_t, uint8_t) = intFunc[buffer[0] - 48];
+          if (f) f(buffer[0], getArrayLength());
+          flush();
+        }
+        else if (bufferCount < 64) buffer[bufferCount++] = lastByte;
+        else return false;
+      }
+      if (Serial.available() <= 0)
+      {
+        if (waitTime > 0) delayMicroseconds(waitTime);
+        if (Serial.available() <= 0) timeout = true;
+      }
+    }
+    return timeout;
+  }
+  // getFloatValues and getIntValues were the same loop around atof() and atoi()
+  template <typename T> void getValues(T values[], bool asFloat)
+  {
+    int pos = 0, start = 1;
+    for (int end = 1; end <= bufferCount; end++)
+    {
+      if (end < bufferCount && buffer[end] != DELIMITER) continue;
+      char b[(end - start) + 1];
+      int t = 0;
+      for (int i = start; i < end; i++) b[t++] = (char) buffer[i];
+      b[t] = '\0';
+      values[pos++] = asFloat ? (T) atof(b) : (T) atoi(b);
+      start = end + 1;
+    }
+  }
+};
+
+static oldMeetAndroid oldAndroid;
+
+static void oldFloatEvent(uint8_t, uint8_t values)
+{
+  float v[MAX_VALUES];
+  if (values > MAX_VALUES) return;
+  oldAndroid.getValues(v, true);
+  for (int i = 0; i < values; i++) sink = sink + v[i];
+  handled++;
+}
+
+static void oldIntEvent(uint8_t, uint8_t values)
+{
+  int v[MAX_VALUES];
+  if (values > MAX_VALUES) return;
+  oldAndroid.getValues(v, false);
+  for (int i = 0; i < values; i++) sink = sink + v[i];
+  handled++;
+}
+
+// ---- the bench ----
+
+static double run(const std::string& stream, long passes, int bytesPerLoop, int oldWait)
+{
+  handled = 0;
+  double start = seconds();
+  for (long pass = 0; pass < passes; pass++)
+  {
+    Serial.load((const uint8_t*) stream.data(), stream.size());
+    while (!Serial.done())
+    {
+      Serial.arrive(bytesPerLoop);
+      if (oldWait < 0) meetAndroid.receive();
+      else oldAndroid.receive();
+    }
+  }
+  return handled / (seconds() - start);
+}
+
+int main(int argc, char** argv)
+{
+  long passes = 20000;
+  int bytesPerLoop = 8, option;
+  bool raw = false;
+  while ((option = getopt(argc, argv, "n:b:r")) != -1)
+  {
+    switch (option)
+    {
+      case 'n': passes = atol(optarg); break;
+      case 'b': bytesPerLoop = atoi(optarg); break;
+      case 'r': raw = true; break;
+      default: passes = 0; break;
+    }
+  }
+  if (passes < 1 || bytesPerLoop < 1)
+  {
+    fprintf(stderr, "use: amarinoBench [-n passes] [-b bytes per loop] [-r]\n");
+    return 1;
+  }
+  std::string stream = buildStream();
+  long expected = sizeof(messageMix) / sizeof(messageMix[0]);
+
+  meetAndroid.registerFunction(floatEvent, 'A');
+  meetAndroid.registerFunction(intEvent, 'B');
+  meetAndroid.registerFunction(intEvent, 'c');
+  meetAndroid.registerFunction(intEvent, 'f');
+  meetAndroid.registerFunction(intEvent, 'i');
+  memset(&oldAndroid, 0, sizeof(oldAndroid));
+  oldAndroid.intFunc['A' - 48] = oldFloatEvent;
+  oldAndroid.intFunc['B' - 48] = oldIntEvent;
+  oldAndroid.intFunc['c' - 48] = oldIntEvent;
+  oldAndroid.intFunc['f' - 48] = oldIntEvent;
+  oldAndroid.intFunc['i' - 48] = oldIntEvent;
+
+  // the blocking wait makes the old library slow, so it gets fewer passes
+  long waitPasses = passes / 100 + 1;
+  oldAndroid.waitTime = 30;
+  double waiting = run(stream, waitPasses, bytesPerLoop, 30);
+  bool allHandled = handled == waitPasses * expected;
+  oldAndroid.waitTime = 0;
+  double parsing = run(stream, passes, bytesPerLoop, 0);
+  allHandled = allHandled && handled == passes * expected;
+  double now = run(stream, passes, bytesPerLoop, -1);
+  allHandled = allHandled && handled == passes * expected;
+
+  if (raw)
+  {
+    printf("%.0f %.0f %.0f\n", waiting, parsing, now);
+    return allHandled ? 0 : 2;
+  }
+  printf("%ld messages per pass, %d bytes arrive per receive()\n", expected, bytesPerLoop);
+  printf("old, waitTime 30   %12.0f messages/sec\n", waiting);
+  printf("old, waitTime 0    %12.0f messages/sec\n", parsing);
+  printf("non-blocking       %12.0f messages/sec  (%.1fx the old parsing)\n", now, now / parsing);
+  if (!allHandled) printf("not every message reached its function\n");
+  return allHandled ? 0 : 2;
+}
@@ -0,0 +1,36 @@
+#ifndef HardwareSerial_h
+#define HardwareSerial_h
+
+#include "Stream.h"
+
+// a memory stream stands in for the UART: load() gives it the bytes that will come in, arrive() lets
+// some of them through, and what is written is counted, and copied to a file if echo() names one
+class HardwareSerial : public Stream
+{
+  public:
+    HardwareSerial() : _data(0), _length(0), _arrived(0), _read(0), _written(0), _echo(0) {}
+    void begin(unsigned long) {}
+    void end() {}
+    void load(const uint8_t *data, size_t length) { _data = data; _length = length; _arrived = _read = 0; }
+    void arrive(size_t bytes) { _arrived = _arrived + bytes < _length ? _arrived + bytes : _length; }
+    bool done() const { return _read == _length; }
+    void echo(FILE *file) { _echo = file; }
+    size_t written() const { return _written; }
+
+    virtual int available() { return (int) (_arrived - _read); }
+    virtual int read() { return _read < _arrived ? _data[_read++] : -1; }
+    virtual int peek() { return _read < _arrived ? _data[_read] : -1; }
+    virtual size_t write(uint8_t c) { if (_echo) fputc(c, _echo); _written++; return 1; }
+    virtual int availableForWrite() { return 64; }
+    using Print::write;
+    operator bool() { return true; }
+
+  private:
+    const uint8_t *_data;
+    size_t _length, _arrived, _read, _written;
+    FILE *_echo;
+};
+
+extern HardwareSerial Serial;
+
+#endif
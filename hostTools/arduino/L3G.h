@@ -0,0 +1,19 @@
+#ifndef L3G_h
+#define L3G_h
+
+// the Pololu L3G gyro library, for a robot without the gyro fitted
+#define L3G_CTRL_REG1 0x20
+#define L3G_CTRL_REG4 0x23
+
+class L3G
+{
+  public:
+    struct vector { int x, y, z; } g;
+    L3G() { g.x = g.y = g.z = 0; }
+    bool init() { return false; }
+    void enableDefault() {}
+    void writeReg(int, int) {}
+    void read() {}
+};
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef Print_h
+#define Print_h
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+// F() strings are plain strings on the host, there is no separate flash
+class __FlashStringHelper;
+
+class Print;
+
+class Printable
+{
+  public:
+    virtual ~Printable() {}
+    virtual size_t printTo(Print& p) const = 0;
+};
+
+class Print
+{
+  public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size) { size_t n = 0; while (size--) n += write(*buffer++); return n; }
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+    size_t write(const char *s) { return s ? write((const uint8_t*) s, strlen(s)) : 0; }
+    size_t write(const char *buffer, size_t size) { return write((const uint8_t*) buffer, size); }
+
+    size_t print(const __FlashStringHelper *s) { return write((const char*) s); }
+    size_t print(const char *s) { return write(s); }
+    size_t print(char c) { return write((uint8_t) c); }
+    size_t print(unsigned char n, int base = DEC) { return print((unsigned long) n, base); }
+    size_t print(int n, int base = DEC) { return print((long) n, base); }
+    size_t print(unsigned int n, int base = DEC) { return print((unsigned long) n, base); }
+    size_t print(long n, int base = DEC)
+    {
+      if (base != DEC) return print((unsigned long) n, base);
+      if (n >= 0) return print((unsigned long) n, DEC);
+      return print('-') + print((unsigned long) -n, DEC);
+    }
+    size_t print(unsigned long n, int base = DEC)
+    {
+      char text[8 * sizeof(long) + 1];
+      char *p = text + sizeof(text) - 1;
+      *p = 0;
+      if (base < 2) base = DEC;
+      do
+      {
+        int digit = n % base;
+        *--p = digit < 10 ? '0' + digit : 'A' + digit - 10;
+        n /= base;
+      } while (n);
+      return write(p);
+    }
+    size_t print(double n, int digits = 2)
+    {
+      char text[40];
+      snprintf(text, sizeof(text), "%.*f", digits, n);
+      return write(text);
+    }
+    size_t print(const Printable& p) { return p.printTo(*this); }
+
+    size_t println() { return write("\r\n"); }
+    template <typename T> size_t println(T value) { size_t n = print(value); return n + println(); }
+    template <typename T> size_t println(T value, int format) { size_t n = print(value, format); return n + println(); }
+    size_t println(const Printable& p) { size_t n = print(p); return n + println(); }
+};
+
+#endif
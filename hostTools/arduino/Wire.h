@@ -0,0 +1,21 @@
+#ifndef TwoWire_h
+#define TwoWire_h
+
+#include <stdint.h>
+
+// an I2C bus with nothing on it
+class TwoWire
+{
+  public:
+    void begin() {}
+    void beginTransmission(uint8_t) {}
+    uint8_t endTransmission() { return 2; }  // address not acknowledged
+    uint8_t requestFrom(uint8_t, uint8_t) { return 0; }
+    int available() { return 0; }
+    int read() { return -1; }
+    size_t write(uint8_t) { return 1; }
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef _AVR_INTERRUPT_H_
+#define _AVR_INTERRUPT_H_
+
+#include <avr/io.h>
+
+// an interrupt service routine is a plain function the board model calls when its interrupt is due,
+// with SREG's I bit cleared as the hardware does; the model ignores ISR_NOBLOCK, an ISR that lets
+// other interrupts in has to sei() itself
+#define ISR_BLOCK
+#define ISR_NOBLOCK
+#define ISR(vector, ...) extern "C" void vector(void)
+
+#define sei() (SREG |= 1 << SREG_I)
+#define cli() (SREG &= (uint8_t) ~(1 << SREG_I))
+
+#endif
@@ -0,0 +1,137 @@
+// the ATmega2560 registers the repository's code uses, see hostArduino.cpp for what they do.
+// Most are plain bytes the board model looks at as time passes.  The ones code waits on, or whose
+// writes start something (SREG, ADCSRA, EECR, the TIFRn flags cleared by writing a 1) are
+// hostRegisters: every access takes a couple of cycles, so a loop that polls one lets time, and the
+// interrupts due in it, go by.
+#ifndef _AVR_IO_H_
+#define _AVR_IO_H_
+
+#include <stdint.h>
+
+class hostRegister
+{
+  public:
+    hostRegister(void (*written)(uint8_t before)) : value(0), _written(written) {}
+    operator uint8_t();
+    hostRegister& operator=(uint8_t v);
+    hostRegister& operator|=(uint8_t v) { return *this = value | v; }
+    hostRegister& operator&=(uint8_t v) { return *this = value & v; }
+    hostRegister& operator^=(uint8_t v) { return *this = value ^ v; }
+    uint8_t value;  // for the board model, no time goes by
+
+  private:
+    hostRegister(const hostRegister&);
+    void (*_written)(uint8_t before);
+};
+
+extern hostRegister SREG, ADCSRA, EECR, TIFR1, TIFR3, TIFR4, TIFR5;
+extern volatile uint16_t SP;
+
+// timers, CTC mode on OCRnA is all that is modelled
+extern volatile uint8_t TCCR1A, TCCR1B, TCCR1C, TIMSK1;
+extern volatile uint16_t TCNT1, OCR1A, OCR1B, OCR1C;
+extern volatile uint8_t TCCR3A, TCCR3B, TCCR3C, TIMSK3;
+extern volatile uint16_t TCNT3, OCR3A, OCR3B, OCR3C;
+extern volatile uint8_t TCCR4A, TCCR4B, TCCR4C, TIMSK4;
+extern volatile uint16_t TCNT4, OCR4A, OCR4B, OCR4C;
+extern volatile uint8_t TCCR5A, TCCR5B, TCCR5C, TIMSK5;
+extern volatile uint16_t TCNT5, OCR5A, OCR5B, OCR5C;
+
+// ADC
+extern volatile uint8_t ADCSRB, ADMUX, ADCL, ADCH, DIDR0, DIDR2;
+
+// EEPROM
+extern volatile uint8_t EEDR;
+extern volatile uint16_t EEAR;
+
+// pin change interrupts
+extern volatile uint8_t PCICR, PCIFR, PCMSK0, PCMSK1, PCMSK2;
+
+// USART2, the bluetooth port
+extern volatile uint8_t UCSR2A, UCSR2B, UCSR2C, UDR2, UBRR2H, UBRR2L;
+#define UBRR2H UBRR2H
+
+extern volatile uint8_t MCUSR;
+
+#define SREG_I 7
+
+#define WGM12 3
+#define WGM32 3
+#define WGM42 3
+#define WGM52 3
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define CS30 0
+#define CS31 1
+#define CS32 2
+#define CS40 0
+#define CS41 1
+#define CS42 2
+#define CS50 0
+#define CS51 1
+#define CS52 2
+#define OCIE1A 1
+#define OCIE3A 1
+#define OCIE4A 1
+#define OCIE5A 1
+#define OCF1A 1
+#define OCF3A 1
+#define OCF4A 1
+#define OCF5A 1
+
+#define ADEN 7
+#define ADSC 6
+#define ADATE 5
+#define ADIF 4
+#define ADIE 3
+#define ADPS2 2
+#define ADPS1 1
+#define ADPS0 0
+#define REFS1 7
+#define REFS0 6
+#define ADLAR 5
+#define MUX5 3
+
+#define EERIE 3
+#define EEMPE 2
+#define EEPE 1
+#define EERE 0
+
+#define PCIE0 0
+#define PCIE1 1
+#define PCIE2 2
+
+#define RXC0 7
+#define TXC0 6
+#define UDRE0 5
+#define FE0 4
+#define DOR0 3
+#define UPE0 2
+#define U2X0 1
+#define RXCIE0 7
+#define TXCIE0 6
+#define UDRIE0 5
+#define RXEN0 4
+#define TXEN0 3
+#define UCSZ01 2
+#define UCSZ00 1
+#define RXC2 7
+#define TXC2 6
+#define UDRE2 5
+#define FE2 4
+#define DOR2 3
+#define UPE2 2
+#define U2X2 1
+#define RXCIE2 7
+#define TXCIE2 6
+#define UDRIE2 5
+#define RXEN2 4
+#define TXEN2 3
+#define UCSZ21 2
+#define UCSZ20 1
+
+#define WDRF 3
+#define RAMEND 0x21FF
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef _AVR_PGMSPACE_H_
+#define _AVR_PGMSPACE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+// there is one address space on the host, flash is read like anything else
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+
+static inline uint8_t pgm_read_byte(const void *p) { uint8_t v; memcpy(&v, p, sizeof(v)); return v; }
+static inline uint16_t pgm_read_word(const void *p) { uint16_t v; memcpy(&v, p, sizeof(v)); return v; }
+static inline uint32_t pgm_read_dword(const void *p) { uint32_t v; memcpy(&v, p, sizeof(v)); return v; }
+static inline float pgm_read_float(const void *p) { float v; memcpy(&v, p, sizeof(v)); return v; }
+static inline void *pgm_read_ptr(const void *p) { void *v; memcpy(&v, p, sizeof(v)); return v; }
+
+#define memcpy_P memcpy
+#define strlen_P strlen
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+
+#endif
@@ -0,0 +1,670 @@
+// the board model behind hostArduino.h: the clock, the pins, and the ATmega2560 peripherals the
+// repository's code drives through registers
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ucontext.h>
+#include <string>
+#include "Arduino.h"
+#include "Wire.h"
+#include "hostArduino.h"
+#include <avr/wdt.h>
+
+#define CYCLES_PER_USEC 16
+#define CLOCK_READ_CYCLES 32       // millis() and micros()
+#define REGISTER_CYCLES 2
+// into the vector, the prologue and epilogue that save the call-clobbered registers (every ISR here
+// calls out), and back out with reti
+#define ISR_CYCLES 80
+// the Arduino core's wiring_digital.c and wiring_analog.c for the Mega as avr-gcc -Os builds them, counted
+// by hand and rounded up: the call and return, the PROGMEM lookups of the pin's timer, bit and port (7
+// cycles each) and of the port's register (11), the register read and written under cli() (10).
+// digitalWrite() and digitalRead() on a pin with a timer first go through turnOffPWM()'s switch.
+#define PIN_CALL_CYCLES 60         // digitalWrite(), digitalRead(), pinMode()
+#define TURN_OFF_PWM_CYCLES 30
+#define ANALOG_WRITE_CYCLES 45     // after pinMode(): the timer lookup and switch, the COM bit, the compare register
+#define EEPROM_WRITE_CYCLES (3400UL * CYCLES_PER_USEC)
+#define ANALOG_READ_USEC 112
+#define RX_QUEUE 4096
+#define SKETCH_STACK (1024 * 1024)
+#define NO_EVENT (~(uint64_t) 0)
+
+// the sketch's, hostRun() is only for programs that have one
+void setup() __attribute__((weak));
+void loop() __attribute__((weak));
+
+// the interrupt vectors, defined by whichever code uses them
+extern "C"
+{
+void TIMER1_COMPA_vect() __attribute__((weak));
+void TIMER3_COMPA_vect() __attribute__((weak));
+void TIMER4_COMPA_vect() __attribute__((weak));
+void TIMER5_COMPA_vect() __attribute__((weak));
+void ADC_vect() __attribute__((weak));
+void EE_READY_vect() __attribute__((weak));
+void PCINT2_vect() __attribute__((weak));
+void USART2_RX_vect() __attribute__((weak));
+void USART2_UDRE_vect() __attribute__((weak));
+}
+
+static uint64_t now;
+
+HardwareSerial Serial;
+TwoWire Wire;
+uint8_t hostEEPROM[4096];
+
+// ---- registers ----
+
+static void sregWritten(uint8_t) {}
+static void adcControlWritten(uint8_t before);
+static void eepromControlWritten(uint8_t before);
+static void tifr1Written(uint8_t before) { TIFR1.value = before & ~TIFR1.value; }
+static void tifr3Written(uint8_t before) { TIFR3.value = before & ~TIFR3.value; }
+static void tifr4Written(uint8_t before) { TIFR4.value = before & ~TIFR4.value; }
+static void tifr5Written(uint8_t before) { TIFR5.value = before & ~TIFR5.value; }
+
+hostRegister SREG(sregWritten), ADCSRA(adcControlWritten), EECR(eepromControlWritten);
+hostRegister TIFR1(tifr1Written), TIFR3(tifr3Written), TIFR4(tifr4Written), TIFR5(tifr5Written);
+volatile uint16_t SP = RAMEND;
+volatile uint8_t TCCR1A, TCCR1B, TCCR1C, TIMSK1;
+volatile uint16_t TCNT1, OCR1A, OCR1B, OCR1C;
+volatile uint8_t TCCR3A, TCCR3B, TCCR3C, TIMSK3;
+volatile uint16_t TCNT3, OCR3A, OCR3B, OCR3C;
+volatile uint8_t TCCR4A, TCCR4B, TCCR4C, TIMSK4;
+volatile uint16_t TCNT4, OCR4A, OCR4B, OCR4C;
+volatile uint8_t TCCR5A, TCCR5B, TCCR5C, TIMSK5;
+volatile uint16_t TCNT5, OCR5A, OCR5B, OCR5C;
+volatile uint8_t ADCSRB, ADMUX, ADCL, ADCH, DIDR0, DIDR2;
+volatile uint8_t EEDR;
+volatile uint16_t EEAR;
+volatile uint8_t PCICR, PCIFR, PCMSK0, PCMSK1, PCMSK2;
+volatile uint8_t UCSR2A, UCSR2B, UCSR2C, UDR2, UBRR2H, UBRR2L;
+volatile uint8_t MCUSR;
+
+static void service();
+
+hostRegister::operator uint8_t()
+{
+  now += REGISTER_CYCLES;
+  service();
+  return value;
+}
+
+hostRegister& hostRegister::operator=(uint8_t v)
+{
+  uint8_t before = value;
+  value = v;
+  _written(before);
+  now += REGISTER_CYCLES;
+  service();
+  return *this;
+}
+
+// ---- timers ----
+
+struct hostTimer
+{
+  volatile uint8_t *control;  // TCCRnB, the clock select
+  volatile uint16_t *count, *compare;
+  volatile uint8_t *mask;
+  hostRegister *flags;
+  void (*vector)();
+  bool running;
+  uint64_t lastMatch;         // when the count was last 0
+  uint16_t countSeen;         // TCNTn as the model left it, anything else was written
+};
+
+static hostTimer timers[] =
+{
+  { &TCCR1B, &TCNT1, &OCR1A, &TIMSK1, &TIFR1, TIMER1_COMPA_vect, false, 0, 0 },
+  { &TCCR3B, &TCNT3, &OCR3A, &TIMSK3, &TIFR3, TIMER3_COMPA_vect, false, 0, 0 },
+  { &TCCR4B, &TCNT4, &OCR4A, &TIMSK4, &TIFR4, TIMER4_COMPA_vect, false, 0, 0 },
+  { &TCCR5B, &TCNT5, &OCR5A, &TIMSK5, &TIFR5, TIMER5_COMPA_vect, false, 0, 0 },
+};
+#define TIMERS (sizeof(timers) / sizeof(timers[0]))
+#define OCFA 1   // OCFnA and OCIEnA are bit 1 for every timer
+
+static const uint16_t prescalers[8] = { 0, 1, 8, 64, 256, 1024, 0, 0 };  // 6 and 7 are external clocks
+
+static uint64_t timerTick(hostTimer& t) { return prescalers[*t.control & 7]; }
+static uint64_t timerPeriod(hostTimer& t) { return timerTick(t) * ((uint64_t) *t.compare + 1); }
+
+static void updateTimer(hostTimer& t)
+{
+  bool running = timerTick(t) != 0;
+  if (running && (!t.running || *t.count != t.countSeen)) t.lastMatch = now - *t.count * timerTick(t);
+  t.running = running;
+  if (!running) return;
+  while (t.lastMatch + timerPeriod(t) <= now)
+  {
+    t.lastMatch += timerPeriod(t);
+    t.flags->value |= 1 << OCFA;
+  }
+  t.countSeen = *t.count = (now - t.lastMatch) / timerTick(t);
+}
+
+// ---- ADC ----
+
+static uint16_t analogValues[16];
+static uint64_t conversionEnd = NO_EVENT;
+static uint8_t conversionChannel;
+
+// ADSC can't be cleared by writing, ADIF is cleared by writing a 1, a conversion starts on ADSC
+static void adcControlWritten(uint8_t before)
+{
+  uint8_t written = ADCSRA.value;
+  ADCSRA.value = (written & ~(1 << ADIF)) | (before & (1 << ADSC)) | (before & ~written & (1 << ADIF));
+  if (!(before & (1 << ADSC)) && (written & (1 << ADSC)) && (written & (1 << ADEN)))
+  {
+    uint64_t adcClock = 2UL << ((written & 7) ? (written & 7) - 1 : 0);
+    conversionChannel = (ADMUX & 7) | ((ADCSRB >> MUX5) & 1) << 3;
+    conversionEnd = now + 13 * adcClock;
+  }
+}
+
+static void updateADC()
+{
+  if (conversionEnd > now) return;
+  conversionEnd = NO_EVENT;
+  uint16_t value = analogValues[conversionChannel];
+  ADCL = value & 0xFF;
+  ADCH = value >> 8;
+  ADCSRA.value = (ADCSRA.value & ~(1 << ADSC)) | (1 << ADIF);
+}
+
+// ---- EEPROM ----
+
+static uint64_t eepromWriteEnd = NO_EVENT;
+
+// EERE reads the byte at EEAR at once, EEPE within 4 cycles of EEMPE starts a write
+static void eepromControlWritten(uint8_t before)
+{
+  uint8_t written = EECR.value;
+  uint8_t value = written & ~((1 << EERE) | (1 << EEPE));
+  if (before & (1 << EEPE)) value |= 1 << EEPE;  // busy, nothing else can start
+  else if ((written & (1 << EEPE)) && (before & (1 << EEMPE)))
+  {
+    hostEEPROM[EEAR & 4095] = EEDR;
+    eepromWriteEnd = now + EEPROM_WRITE_CYCLES;
+    value = (value | (1 << EEPE)) & ~(1 << EEMPE);
+  }
+  else if (written & (1 << EERE)) EEDR = hostEEPROM[EEAR & 4095];
+  EECR.value = value;
+}
+
+static void updateEEPROM()
+{
+  if (eepromWriteEnd > now) return;
+  eepromWriteEnd = NO_EVENT;
+  EECR.value &= ~(1 << EEPE);
+}
+
+// ---- USART2 ----
+
+static uint8_t rxData[RX_QUEUE];
+static uint64_t rxTime[RX_QUEUE];
+static unsigned rxHead, rxTail;
+static uint64_t txFree;
+static std::string transmitted;
+
+static uint64_t byteCycles()
+{
+  uint64_t ubrr = ((uint64_t) UBRR2H << 8 | UBRR2L) + 1;
+  return 10 * ubrr * (UCSR2A & (1 << U2X2) ? 8 : 16);  // start, 8 data, stop
+}
+
+void hostReceive2(const uint8_t *data, size_t length)
+{
+  uint64_t time = now;
+  if (rxHead != rxTail && rxTime[(rxHead - 1) % RX_QUEUE] > time) time = rxTime[(rxHead - 1) % RX_QUEUE];
+  for (size_t i = 0; i < length && (rxHead + 1) % RX_QUEUE != rxTail; i++)
+  {
+    time += byteCycles();
+    rxData[rxHead] = data[i];
+    rxTime[rxHead] = time;
+    rxHead = (rxHead + 1) % RX_QUEUE;
+  }
+}
+
+void hostReceive2(const char *text)
+{
+  hostReceive2((const uint8_t*) text, strlen(text));
+}
+
+size_t hostTransmitted2(char *text, size_t size)
+{
+  size_t n = transmitted.copy(text, size - 1);
+  text[n] = 0;
+  transmitted.erase(0, n);
+  return n;
+}
+
+// ---- pins ----
+
+static uint8_t pinModes[NUM_DIGITAL_PINS];
+static uint8_t pinOutputs[NUM_DIGITAL_PINS];
+static int pinDriven[NUM_DIGITAL_PINS];  // -1 when nothing outside drives it
+static int pinPWM[NUM_DIGITAL_PINS];
+static volatile uint8_t ports[12];
+static void (*externalHandlers[6])(void);
+static int externalModes[6];
+static bool externalPending[6];
+
+static const uint8_t externalPins[6] = { 2, 3, 21, 20, 19, 18 };
+static void (*pinWatcher)(uint8_t pin, int value, bool pwm);
+
+// ---- watchdog ----
+
+static uint64_t watchdogTimeout;  // 0 while off
+static uint64_t watchdogReset;
+
+// ---- what is due ----
+
+static void updateAll()
+{
+  for (unsigned i = 0; i < TIMERS; i++) updateTimer(timers[i]);
+  updateADC();
+  updateEEPROM();
+  UCSR2A |= 1 << UDRE2;  // read only, the transmitter is modelled by txFree
+  if (watchdogTimeout && now - watchdogReset > watchdogTimeout)
+  {
+    fprintf(stderr, "watchdog reset at %llu msec\n", (unsigned long long) (now / (1000 * CYCLES_PER_USEC)));
+    exit(3);
+  }
+}
+
+// ---- the sketch, on a stack of its own ----
+
+static ucontext_t hostContext, sketchContext;
+static char *sketchStack;
+static bool sketchStarted, inSketch;
+static uint64_t runEnd;
+static int isrDepth;
+
+static void runSketch()
+{
+  setup();
+  while (true) loop();
+}
+
+// back to hostRun() once its time is up, at a point where the sketch itself looks at the board
+static void pauseSketch()
+{
+  if (!inSketch || isrDepth > 0 || now < runEnd) return;
+  inSketch = false;
+  swapcontext(&sketchContext, &hostContext);
+  inSketch = true;
+}
+
+void hostRun(unsigned long usec)
+{
+  if (!setup || !loop)
+  {
+    fprintf(stderr, "hostRun() without a sketch\n");
+    exit(3);
+  }
+  runEnd = now + (uint64_t) usec * CYCLES_PER_USEC;
+  if (!sketchStarted)
+  {
+    if (!sketchStack) sketchStack = (char*) malloc(SKETCH_STACK);
+    getcontext(&sketchContext);
+    sketchContext.uc_stack.ss_sp = sketchStack;
+    sketchContext.uc_stack.ss_size = SKETCH_STACK;
+    sketchContext.uc_link = 0;
+    makecontext(&sketchContext, runSketch, 0);
+    sketchStarted = true;
+  }
+  inSketch = true;
+  swapcontext(&hostContext, &sketchContext);
+}
+
+static void runISR(void (*vector)(), const char *name)
+{
+  if (!vector)
+  {
+    fprintf(stderr, "%s enabled without an ISR\n", name);
+    exit(3);
+  }
+  now += ISR_CYCLES;
+  SREG.value &= ~(1 << SREG_I);
+  isrDepth++;
+  vector();
+  isrDepth--;
+  SREG.value |= 1 << SREG_I;
+}
+
+// runs the most urgent interrupt that is due, in the order of the vector table; false if none is
+static bool runNextInterrupt()
+{
+  for (int i = 0; i < 6; i++)
+  {
+    if (!externalPending[i]) continue;
+    externalPending[i] = false;
+    if (externalHandlers[i]) runISR(externalHandlers[i], "INT");
+    return true;
+  }
+  if ((PCIFR & PCICR) & (1 << PCIE2))
+  {
+    PCIFR &= ~(1 << PCIE2);
+    runISR(PCINT2_vect, "PCINT2");
+    return true;
+  }
+  if (timers[0].flags->value & *timers[0].mask & (1 << OCFA))
+  {
+    timers[0].flags->value &= ~(1 << OCFA);
+    runISR(timers[0].vector, "TIMER1_COMPA");
+    return true;
+  }
+  if ((ADCSRA.value & (1 << ADIF)) && (ADCSRA.value & (1 << ADIE)))
+  {
+    ADCSRA.value &= ~(1 << ADIF);
+    runISR(ADC_vect, "ADC");
+    return true;
+  }
+  if ((EECR.value & (1 << EERIE)) && !(EECR.value & (1 << EEPE)))
+  {
+    runISR(EE_READY_vect, "EE_READY");
+    if ((EECR.value & (1 << EERIE)) && !(EECR.value & (1 << EEPE)))
+    {
+      fprintf(stderr, "EE_READY left on with nothing to write\n");  // it would run forever
+      exit(3);
+    }
+    return true;
+  }
+  for (unsigned i = 1; i < TIMERS; i++)
+  {
+    if (!(timers[i].flags->value & *timers[i].mask & (1 << OCFA))) continue;
+    timers[i].flags->value &= ~(1 << OCFA);
+    runISR(timers[i].vector, "TIMER_COMPA");
+    return true;
+  }
+  if (rxHead != rxTail && rxTime[rxTail] <= now && (UCSR2B & (1 << RXCIE2)))
+  {
+    UDR2 = rxData[rxTail];
+    rxTail = (rxTail + 1) % RX_QUEUE;
+    runISR(USART2_RX_vect, "USART2_RX");
+    return true;
+  }
+  if ((UCSR2B & (1 << UDRIE2)) && txFree <= now)
+  {
+    // the library only turns UDRIE on with a byte waiting, so every UDRE interrupt sends one
+    runISR(USART2_UDRE_vect, "USART2_UDRE");
+    transmitted += (char) UDR2;
+    txFree = now + byteCycles();
+    return true;
+  }
+  return false;
+}
+
+static void service()
+{
+  updateAll();
+  while ((SREG.value & (1 << SREG_I)) && runNextInterrupt()) updateAll();
+  pauseSketch();
+}
+
+// the next time something happens, after now
+static uint64_t nextEvent()
+{
+  uint64_t next = NO_EVENT;
+  for (unsigned i = 0; i < TIMERS; i++)
+    if (timers[i].running && timers[i].lastMatch + timerPeriod(timers[i]) < next) next = timers[i].lastMatch + timerPeriod(timers[i]);
+  if (conversionEnd < next) next = conversionEnd;
+  if (eepromWriteEnd < next) next = eepromWriteEnd;
+  if (rxHead != rxTail && rxTime[rxTail] > now && rxTime[rxTail] < next) next = rxTime[rxTail];
+  if ((UCSR2B & (1 << UDRIE2)) && txFree > now && txFree < next) next = txFree;
+  if (watchdogTimeout && watchdogReset + watchdogTimeout + 1 < next) next = watchdogReset + watchdogTimeout + 1;
+  if (inSketch && runEnd > now && runEnd < next) next = runEnd;  // where hostRun() stops it
+  return next;
+}
+
+void hostAdvance(unsigned long usec)
+{
+  uint64_t end = now + (uint64_t) usec * CYCLES_PER_USEC;
+  while (true)
+  {
+    uint64_t next = nextEvent();
+    if (next > end) break;
+    if (next > now) now = next;
+    service();
+  }
+  if (end > now) now = end;
+  service();
+}
+
+uint64_t hostCycles()
+{
+  return now;
+}
+
+void hostReset()
+{
+  now = 0;
+  SREG.value = 1 << SREG_I;  // init() in the Arduino core turns them on before setup()
+  ADCSRA.value = (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);  // the core's prescaler of 128
+  EECR.value = 0;
+  for (unsigned i = 0; i < TIMERS; i++)
+  {
+    *timers[i].control = 0;
+    *timers[i].count = 0;
+    *timers[i].compare = 0;
+    *timers[i].mask = 0;
+    timers[i].flags->value = 0;
+    timers[i].running = false;
+    timers[i].countSeen = 0;
+  }
+  ADCSRB = ADMUX = 0;
+  conversionEnd = eepromWriteEnd = NO_EVENT;
+  PCICR = PCIFR = PCMSK0 = PCMSK1 = PCMSK2 = 0;
+  UCSR2A = 1 << UDRE2;
+  UCSR2B = UCSR2C = UBRR2H = UBRR2L = 0;
+  rxHead = rxTail = 0;
+  txFree = 0;
+  transmitted.clear();
+  memset(hostEEPROM, 0xFF, sizeof(hostEEPROM));
+  memset(analogValues, 0, sizeof(analogValues));
+  for (int i = 0; i < NUM_DIGITAL_PINS; i++)
+  {
+    pinDriven[i] = -1;
+    pinPWM[i] = -1;
+  }
+  for (int i = 0; i < 6; i++)
+  {
+    externalHandlers[i] = 0;
+    externalPending[i] = false;
+  }
+  watchdogTimeout = 0;
+  sketchStarted = false;
+  pinWatcher = 0;
+}
+
+// ---- the Arduino core ----
+
+unsigned long millis()
+{
+  now += CLOCK_READ_CYCLES;
+  service();
+  return now / (1000 * CYCLES_PER_USEC);
+}
+
+unsigned long micros()
+{
+  now += CLOCK_READ_CYCLES;
+  service();
+  return now / CYCLES_PER_USEC;
+}
+
+void delay(unsigned long ms)
+{
+  hostAdvance(ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us)
+{
+  hostAdvance(us);
+}
+
+void wdt_enable(int timeout)
+{
+  watchdogTimeout = (uint64_t) (16 << timeout) * 1000 * CYCLES_PER_USEC;
+  watchdogReset = now;
+}
+
+void wdt_disable()
+{
+  watchdogTimeout = 0;
+}
+
+void wdt_reset()
+{
+  watchdogReset = now;
+}
+
+// a pin call takes its time before the pin changes, the port is written at the end of it
+static void pinCall(uint64_t cycles)
+{
+  now += cycles;
+  service();
+}
+
+// the Mega's pins with a timer output on them
+static bool timerPin(uint8_t pin)
+{
+  return (pin >= 2 && pin <= 13) || (pin >= 44 && pin <= 46);
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+  pinCall(PIN_CALL_CYCLES);
+  if (pin < NUM_DIGITAL_PINS) pinModes[pin] = mode;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+  pinCall(PIN_CALL_CYCLES + (timerPin(pin) ? TURN_OFF_PWM_CYCLES : 0));
+  if (pin >= NUM_DIGITAL_PINS) return;
+  pinOutputs[pin] = value ? HIGH : LOW;
+  pinPWM[pin] = -1;
+  if (pinWatcher) pinWatcher(pin, pinOutputs[pin], false);
+}
+
+uint8_t hostPin(uint8_t pin)
+{
+  if (pin >= NUM_DIGITAL_PINS) return LOW;
+  if (pinModes[pin] == OUTPUT) return pinOutputs[pin];
+  if (pinDriven[pin] >= 0) return pinDriven[pin];
+  return pinModes[pin] == INPUT_PULLUP ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin)
+{
+  pinCall(PIN_CALL_CYCLES + (timerPin(pin) ? TURN_OFF_PWM_CYCLES : 0));
+  return hostPin(pin);
+}
+
+// pinMode() first, then 0 and 255 are a digitalWrite(), anything else goes to the timer
+void analogWrite(uint8_t pin, int value)
+{
+  pinCall(PIN_CALL_CYCLES);
+  if (value <= 0 || value >= 255) pinCall(PIN_CALL_CYCLES + (timerPin(pin) ? TURN_OFF_PWM_CYCLES : 0));
+  else pinCall(ANALOG_WRITE_CYCLES);
+  if (pin >= NUM_DIGITAL_PINS) return;
+  pinModes[pin] = OUTPUT;
+  pinOutputs[pin] = value >= 128 ? HIGH : LOW;
+  pinPWM[pin] = value;
+  if (pinWatcher) pinWatcher(pin, value, true);
+}
+
+int hostPWM(uint8_t pin)
+{
+  return pin < NUM_DIGITAL_PINS ? pinPWM[pin] : -1;
+}
+
+void hostWatchPins(void (*written)(uint8_t pin, int value, bool pwm))
+{
+  pinWatcher = written;
+}
+
+void hostSetAnalog(uint8_t pin, uint16_t value)
+{
+  if (pin >= A0) pin -= A0;
+  if (pin < 16) analogValues[pin] = value > 1023 ? 1023 : value;
+}
+
+int analogRead(uint8_t pin)
+{
+  if (pin >= A0) pin -= A0;
+  hostAdvance(ANALOG_READ_USEC);
+  return pin < 16 ? analogValues[pin] : 0;
+}
+
+void hostSetPin(uint8_t pin, uint8_t level)
+{
+  if (pin >= NUM_DIGITAL_PINS) return;
+  uint8_t before = hostPin(pin);
+  pinDriven[pin] = level ? HIGH : LOW;
+  uint8_t after = hostPin(pin);
+  if (after == before) return;
+  if (pin >= A8 && pin <= A15 && (PCMSK2 & (1 << (pin - A8)))) PCIFR |= 1 << PCIE2;
+  for (int i = 0; i < 6; i++)
+  {
+    if (externalPins[i] != pin || !externalHandlers[i]) continue;
+    if (externalModes[i] == CHANGE || (externalModes[i] == RISING && after) || (externalModes[i] == FALLING && !after))
+      externalPending[i] = true;
+  }
+  service();
+}
+
+int digitalPinToInterrupt(uint8_t pin)
+{
+  for (int i = 0; i < 6; i++)
+    if (externalPins[i] == pin) return i;
+  return -1;
+}
+
+void attachInterrupt(uint8_t interrupt, void (*handler)(void), int mode)
+{
+  if (interrupt >= 6) return;
+  externalHandlers[interrupt] = handler;
+  externalModes[interrupt] = mode;
+}
+
+void detachInterrupt(uint8_t interrupt)
+{
+  if (interrupt < 6) externalHandlers[interrupt] = 0;
+}
+
+uint8_t digitalPinToPort(uint8_t pin)
+{
+  return pin / 8 + 1;
+}
+
+uint8_t digitalPinToBitMask(uint8_t pin)
+{
+  return 1 << (pin % 8);
+}
+
+volatile uint8_t *portOutputRegister(uint8_t port)
+{
+  return port < sizeof(ports) ? &ports[port] : 0;
+}
+
+volatile uint8_t *digitalPinToPCICR(uint8_t pin)
+{
+  return pin >= A8 && pin <= A15 ? &PCICR : 0;
+}
+
+uint8_t digitalPinToPCICRbit(uint8_t pin)
+{
+  return pin >= A8 && pin <= A15 ? PCIE2 : 0;
+}
+
+volatile uint8_t *digitalPinToPCMSK(uint8_t pin)
+{
+  return pin >= A8 && pin <= A15 ? &PCMSK2 : 0;
+}
+
+uint8_t digitalPinToPCMSKbit(uint8_t pin)
+{
+  return pin >= A8 && pin <= A15 ? pin - A8 : 0;
+}
@@ -0,0 +1,46 @@
+#ifndef hostArduino_h
+#define hostArduino_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// The board under a sketch run on the host (hostArduino.cpp), for the program driving it.
+// Time is counted in CPU cycles, 16 per usec, and only goes by when the code looks at it: millis()
+// and micros() take 2 usec, an access to a hostRegister 2 cycles, delay() what it is asked for, the
+// core's pin calls what they take on the Mega (PIN_CALL_CYCLES and the rest in hostArduino.cpp) and an
+// interrupt ISR_CYCLES on top of its body.  The code's own arithmetic takes none.
+// Whenever time goes by, whatever came due meanwhile happens in order: the timer compare matches
+// (Timer1, 3, 4 and 5 in CTC mode on OCRnA), ADC conversions (13 ADC clocks at the prescaler set in
+// ADCSRA), bytes arriving on USART2 and the transmitter taking the next one (at the rate in UBRR2), the
+// end of an EEPROM write (3.4 msec), and their interrupts run, one at a time, while SREG's I bit is set.
+// The watchdog is checked the same way; if it runs out the program stops with a message.
+// Not modelled: overruns of the USART receiver, timer overflows and PWM modes, the other USARTs
+// (Serial is a memory stream, see HardwareSerial.h).
+
+// power on: time 0, registers, inputs undriven, EEPROM erased (0xFF).  Pin modes and outputs are left
+// as they are: the global constructors, which run first on the board too, may have set them already.
+void hostReset();
+uint64_t hostCycles();                           // since hostReset()
+void hostAdvance(unsigned long usec);            // lets time go by, with the interrupts due in it
+
+// Runs the sketch, setup() the first time and then loop() over and over as the core does, until usec
+// more have gone by, then comes back with the sketch stopped where it was (it runs on a stack of its
+// own, so it can be stopped inside a loop() that never returns).  It stops when it next looks at the
+// clock or a hostRegister, never inside an interrupt.  After hostReset() it starts over from setup(),
+// with the globals as the last run left them.
+void hostRun(unsigned long usec);
+
+void hostSetAnalog(uint8_t pin, uint16_t value); // what the ADC reads on A0..A15 (or 0..15), 0..1023
+void hostSetPin(uint8_t pin, uint8_t level);     // drives an input; pin change and external interrupts follow
+uint8_t hostPin(uint8_t pin);                    // an output as last written, an input as driven or pulled up
+int hostPWM(uint8_t pin);                        // the last analogWrite(), -1 if none since it was a digital pin
+// every digitalWrite() and analogWrite() from now on is passed to written (0 for none), as it happens
+void hostWatchPins(void (*written)(uint8_t pin, int value, bool pwm));
+
+void hostReceive2(const uint8_t *data, size_t length);  // bytes for USART2, arriving one after the other from now
+void hostReceive2(const char *text);
+size_t hostTransmitted2(char *text, size_t size);       // what USART2 sent since the last call, 0 terminated
+
+extern uint8_t hostEEPROM[4096];
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef _UTIL_ATOMIC_H_
+#define _UTIL_ATOMIC_H_
+
+#include <avr/interrupt.h>
+
+// as avr-libc does it: the state is put back however the block is left, return included
+static inline uint8_t __iCliRetVal() { cli(); return 1; }
+static inline void __iRestore(const uint8_t *state) { SREG = *state; }
+static inline void __iSeiParam(const uint8_t *) { sei(); }
+
+#define ATOMIC_BLOCK(type) for (type, __ToDo = __iCliRetVal(); __ToDo; __ToDo = 0)
+#define ATOMIC_RESTORESTATE uint8_t sreg_save __attribute__((__cleanup__(__iRestore))) = SREG
+#define ATOMIC_FORCEON uint8_t sreg_save __attribute__((__cleanup__(__iSeiParam))) = 0
+
+#endif
@@ -0,0 +1,10 @@
+#!/bin/sh
+# avrTool - stands in for avr-objdump, avr-nm or avr-size on the fixture: prints tick.objdump,
+# tick.nm or tick.size for tick.elf, whatever the options
+#
+# use: AVR_OBJDUMP="avrTool.sh objdump" AVR_NM="avrTool.sh nm" AVR_SIZE="avrTool.sh size"
+
+KIND=$1
+shift
+for ELF; do :; done
+exec cat "${ELF%.elf}.$KIND"
@@ -0,0 +1,54 @@
+#!/bin/sh
+# fixtureTest - run hostTools/stackDepth and hostTools/sramReport on a small AVR build and compare
+# their reports with the ones checked in here
+#
+# The fixture is what the tools read from a Mega build: the disassembly (avr-objdump -d -C,
+# tick.objdump), the symbols (avr-nm -S -l -t d, tick.nm), the sections (avr-size -A, tick.size)
+# and the .su files gcc writes with -fstack-usage, laid out as arduino-cli lays out a build
+# (tick/sketch, tick/libraries, tick/core).  There is no tick.elf; avrTool.sh stands in for the
+# three binutils and prints the file for what was asked.
+# It is a cut down RobotComm with the shapes the tools have to get right, and the numbers worked
+# out by hand are these:
+#   main            144 bytes, loop() through a queued command down to BufferedUART::write(),
+#                   through the command table (icall), a tail jump (commandMove() to move()) and
+#                   a template (robotLog::message<int>), with commandRepeat() recursing
+#   __vector_47     55 bytes, the timer tick, down to analogWrite() and its pinMode()
+#   __vector_51     31 bytes, the bluetooth receive interrupt's emergency stop (icall) down to
+#                   digitalWrite(), nested in the tick: worst case 144 + 55 + 31 = 230
+#   libgcc's __divmodsi4 and __udivmodsi4 have no .su entry
+#   sramReport: the sketch's globals under their tabs, a static buffer (b) under its library, a
+#   vtable without line information and a weak one (V) in .data, 8 bytes of unnamed strings
+# The fixture was written for this test in the binutils' formats, with the instructions encoded by
+# hand; it is not the output of a real avr-gcc build.  To check the tools against one, run
+#   hostTools/stackDepth/stackDepth.sh -e build/RobotComm_v0_81.ino.elf build
+#   hostTools/sramReport/sramReport build/RobotComm_v0_81.ino.elf build
+# on an arduino-cli build made with -fstack-usage (hostTools/buildMatrix makes them), or replace the
+# fixture with the output of one and its reports, from avr-objdump -d -C, avr-nm -S -l -t d, avr-size -A.
+#
+# needs g++
+# use (from anywhere in the repository):
+#   hostTools/avrFixture/fixtureTest.sh [-u]      -u writes the reports as the expected ones
+# exits with status 1 when a report differs from the expected one.
+
+REPO=$(cd "$(dirname "$0")/../.." && pwd)
+HERE=$REPO/hostTools/avrFixture
+BUILD=${TMPDIR:-/tmp}/robotAvrFixture
+STATUS=0
+
+mkdir -p "$BUILD" || exit 1
+g++ -O2 -o "$BUILD/sramReport" "$REPO/hostTools/sramReport/sramReport.cpp" || exit 1
+export AVR_OBJDUMP="$HERE/avrTool.sh objdump" AVR_NM="$HERE/avrTool.sh nm" AVR_SIZE="$HERE/avrTool.sh size"
+TMPDIR=$BUILD "$REPO/hostTools/stackDepth/stackDepth.sh" -e "$HERE/tick.elf" "$HERE/tick" > "$BUILD/stackDepth.out"
+"$BUILD/sramReport" "$HERE/tick.elf" "$HERE/tick" > "$BUILD/sramReport.out"
+
+for report in stackDepth sramReport; do
+  if [ "$1" = "-u" ]; then
+    cp "$BUILD/$report.out" "$HERE/$report.expected"
+  elif diff -u "$HERE/$report.expected" "$BUILD/$report.out"; then
+    echo "$report: passed"
+  else
+    echo "$report: FAILED"
+    STATUS=1
+  fi
+done
+exit $STATUS
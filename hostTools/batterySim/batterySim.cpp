@@ -0,0 +1,274 @@
+// batterySim - the battery estimator (libraries/RobotCommCore) against model packs run flat by a model robot
+//
+// Each model pack (a seed) has its own capacity, internal resistance and electronics load, off from the
+// numbers c_sensors gives the estimator, and a resting voltage that follows DISCHARGE_CURVE between the
+// empty and full voltages with a little bow of its own.  The resistance rises as the pack empties.  The
+// robot drives in bursts with an inrush at every start, turns, and rests in between, until the pack is
+// flat.  Every BATTERY_UPDATE_INTERVAL msec the estimator gets what the firmware would read: the bus
+// voltage through the divider and the ADC, with noise, and the motor current sense at its 38 mA steps.
+// Once a second the 'c' reply is read, from the estimator and the old way (one reading mapped linearly
+// from empty to full), and compared with the charge really left.
+//
+// Reported per pack, once the first STARTUP_SECONDS are over: the mean and worst error of the percent
+// against the truth and the biggest change between two 'c' replies a second apart, old and new, the
+// mean error of the load compensated voltage against the resting voltage, and of the runtime estimate
+// against the time the pack really lasted, while it had over RUNTIME_FROM minutes left.
+// Exits 1 if a percent is ever off by more than PERCENT_GOAL or jumps by more than JUMP_GOAL, if a
+// pack's runtime is off by more than RUNTIME_GOAL on average, or the packs' by more than
+// RUNTIME_MEAN_GOAL on average.  The runtime goals are loose because the estimator can't know a pack's
+// capacity or idle current (see batteryEstimator.h).
+//
+// build:
+//   g++ -O2 -DARDUINO=100 -I../arduino -I../../libraries/RobotCommCore -o batterySim batterySim.cpp
+//     ../arduino/hostArduino.cpp ../../libraries/RobotCommCore/batteryEstimator.cpp
+// use:
+//   batterySim [-n packs] [-s seed] [-c charge] [-v]
+//     -n  model packs (20)
+//     -s  first seed (1)
+//     -c  percent charged at the start (100), each pack gets up to 20 less
+//     -v  a line a minute for each pack
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "Arduino.h"
+#include "batteryEstimator.h"
+
+// as c_sensors sets up the estimator, with the EEPROM fallbacks for the voltages
+#define UPDATE_MSEC 100
+#define CAPACITY_MAH 2200
+#define RESISTANCE_MILLIOHMS 100
+#define IDLE_MILLIAMPS 150
+#define REST_MILLIAMPS 100
+#define EMPTY_VOLTS 10.5
+#define FULL_VOLTS 13.0
+#define DIVIDER 3.2
+#define MILLIAMPS_PER_COUNT 38   // per motor
+
+#define ADC_NOISE 2              // counts
+#define STARTUP_SECONDS 60       // the filters settling, not held to the goals
+#define RUNTIME_FROM 10          // minutes left
+#define PERCENT_GOAL 15          // a big pack with a high resistance and the curve a little off reads 12 low
+#define JUMP_GOAL 2
+#define RUNTIME_GOAL 65          // percent, a small pack read a few percent high is off by 62 on average
+#define RUNTIME_MEAN_GOAL 17     // percent, 13 to 16 over 200 packs from any start
+
+// the resting voltage at every 10% of charge, as a share of the way from empty to full: steep at
+// both ends and flat in the middle, as NiMH and lithium packs are
+static const double DISCHARGE_CURVE[] = { 0, 0.28, 0.40, 0.46, 0.51, 0.55, 0.59, 0.64, 0.71, 0.82, 1 };
+
+static unsigned long state;
+static double uniform()  // 0 .. 1, the same everywhere for a seed
+{
+  state = state * 1103515245UL + 12345UL;
+  return ((state >> 8) & 0xFFFFFF) / (double) 0x1000000;
+}
+static double between(double low, double high) { return low + (high - low) * uniform(); }
+
+struct packModel
+{
+  double capacity;      // mA sec
+  double charge;        // mA sec left
+  double resistance;    // ohms when full
+  double idleMilliAmps;
+  double bow;           // how far the middle of the curve is off the nominal one, share of the span
+
+  void randomize(double chargedShare)
+  {
+    capacity = CAPACITY_MAH * 3600.0 * between(0.8, 1.1);
+    charge = capacity * chargedShare;
+    resistance = RESISTANCE_MILLIOHMS / 1000.0 * between(0.7, 1.5);
+    idleMilliAmps = IDLE_MILLIAMPS * between(0.8, 1.3);
+    bow = between(-0.04, 0.04);
+  }
+
+  double share() { return charge / capacity; }
+
+  double restingVolts()
+  {
+    double at = share() * 10;
+    int below = at >= 10 ? 9 : (int) at;
+    double curve = DISCHARGE_CURVE[below] + (DISCHARGE_CURVE[below + 1] - DISCHARGE_CURVE[below]) * (at - below);
+    curve += bow * sin(M_PI * share());
+    return EMPTY_VOLTS + (FULL_VOLTS - EMPTY_VOLTS) * curve;
+  }
+
+  // the bus under a load of motorMilliAmps, which runs the pack down for msec
+  double drain(double motorMilliAmps, int msec)
+  {
+    double milliAmps = motorMilliAmps + idleMilliAmps;
+    double ohms = resistance * (1.5 - 0.5 * share());
+    double volts = restingVolts() - milliAmps / 1000 * ohms;
+    charge -= milliAmps * msec / 1000;
+    if (charge < 0) charge = 0;
+    return volts;
+  }
+};
+
+// the robot's load: drives and turns of a few seconds with an inrush as the wheels start, and rests
+struct robotModel
+{
+  double milliAmps;        // both drive wheels, steady
+  int msecLeft, msecIn;
+  bool moving;
+
+  void next()
+  {
+    moving = !moving;
+    msecIn = 0;
+    if (moving)
+    {
+      milliAmps = between(500, 2400);
+      msecLeft = (int) between(1000, 20000);
+    }
+    else
+    {
+      milliAmps = 0;
+      msecLeft = (int) between(2000, 40000);
+    }
+  }
+
+  // the current of each wheel for the next msec
+  void run(int msec, double& left, double& right)
+  {
+    if (msecLeft <= 0) next();
+    double load = milliAmps;
+    if (moving && msecIn < 150) load = 4500;
+    else if (moving) load *= between(0.85, 1.15);
+    left = right = load / 2;
+    msecLeft -= msec;
+    msecIn += msec;
+  }
+};
+
+// the old checkBattery(): one reading mapped from empty to full
+static int oldPercent(int count)
+{
+  double volts = count / 1023.0 * 5.0 * DIVIDER;
+  int percent = (int) (100 * (volts - EMPTY_VOLTS) / (FULL_VOLTS - EMPTY_VOLTS));
+  if (percent > 99) percent = 100;
+  if (percent < 0) percent = 0;
+  return percent;
+}
+
+static long senseMilliAmps(double milliAmps)
+{
+  return lround(milliAmps / MILLIAMPS_PER_COUNT) * MILLIAMPS_PER_COUNT;
+}
+
+struct result
+{
+  long samples;
+  double sumError, worstError;
+  int worstJump;
+  void add(double error, int jump)
+  {
+    samples++;
+    sumError += fabs(error);
+    if (fabs(error) > worstError) worstError = fabs(error);
+    if (jump > worstJump) worstJump = jump;
+  }
+};
+
+int main(int argc, char** argv)
+{
+  int packs = 20, charged = 100, option;
+  unsigned long seed = 1;
+  bool verbose = false;
+  while ((option = getopt(argc, argv, "n:s:c:v")) != -1)
+  {
+    switch (option)
+    {
+      case 'n': packs = atoi(optarg); break;
+      case 's': seed = strtoul(optarg, 0, 10); break;
+      case 'c': charged = atoi(optarg); break;
+      case 'v': verbose = true; break;
+      default:
+        fprintf(stderr, "use: batterySim [-n packs] [-s seed] [-c charge] [-v]\n");
+        return 1;
+    }
+  }
+
+  bool pass = true, runtimePass = true;
+  double sumPackRuntimeError = 0;
+  unsigned long microVoltsPerCount = (unsigned long) lround(DIVIDER * 10) * 500000UL / 1023;
+  printf("%d packs from about %d%%; percent errors against the charge really left, jumps between replies a second apart\n",
+         packs, charged);
+  printf(" pack  minutes   old: mean  worst  jump  |  new: mean  worst  jump  |  mV error  runtime error\n");
+  for (int p = 0; p < packs; p++)
+  {
+    state = seed + p;
+    packModel pack;
+    pack.randomize(between(charged - 20, charged) / 100.0);
+    robotModel robot = { 0, 0, 0, true };
+    batteryEstimator battery(CAPACITY_MAH, RESISTANCE_MILLIOHMS, IDLE_MILLIAMPS, REST_MILLIAMPS);
+    battery.begin(lround(EMPTY_VOLTS * 1000), lround(FULL_VOLTS * 1000), microVoltsPerCount);
+
+    // the estimates a minute apart, to hold against when the pack really went flat
+    static unsigned int runtimes[24 * 60];
+    int minutes = 0;
+    result oldResult = { 0 }, newResult = { 0 };
+    double sumMilliVoltError = 0;
+    long milliVoltSamples = 0;
+    int oldLast = -1, newLast = -1;
+    long msec = 0;
+    while (pack.charge > 0 && minutes < 24 * 60)
+    {
+      double left, right;
+      robot.run(UPDATE_MSEC, left, right);
+      double volts = pack.drain(left + right, UPDATE_MSEC);
+      int count = (int) lround(volts * 1e6 / microVoltsPerCount + between(-ADC_NOISE, ADC_NOISE));
+      if (count < 0) count = 0;
+      if (count > 1023) count = 1023;
+      battery.update(count, senseMilliAmps(left) + senseMilliAmps(right), UPDATE_MSEC);
+      msec += UPDATE_MSEC;
+
+      if (msec % 1000) continue;
+      int oldReply = oldPercent(count), newReply = battery.percent(count);
+      double truth = pack.share() * 100;
+      if (msec > STARTUP_SECONDS * 1000L)
+      {
+        oldResult.add(oldReply - truth, oldLast < 0 ? 0 : abs(oldReply - oldLast));
+        newResult.add(newReply - truth, newLast < 0 ? 0 : abs(newReply - newLast));
+        sumMilliVoltError += fabs(battery.milliVolts() - pack.restingVolts() * 1000);
+        milliVoltSamples++;
+      }
+      oldLast = oldReply;
+      newLast = newReply;
+      if (msec % 60000) continue;
+      runtimes[minutes++] = battery.runtimeMinutes();
+      if (verbose)
+        printf("    %3d min  truth %5.1f%%  old %3d%%  new %3d%%  %5u mV, resting %5.0f  runtime %u min\n", minutes,
+               truth, oldReply, newReply, battery.milliVolts(), pack.restingVolts() * 1000, battery.runtimeMinutes());
+    }
+
+    double sumRuntimeError = 0;
+    int runtimeSamples = 0;
+    for (int m = 0; m < minutes - RUNTIME_FROM; m++)
+    {
+      double actual = msec / 60000.0 - (m + 1);
+      sumRuntimeError += fabs(runtimes[m] - actual) / actual;
+      runtimeSamples++;
+    }
+    double runtimeError = runtimeSamples ? 100 * sumRuntimeError / runtimeSamples : 0;
+    printf("%5lu  %7.0f  %10.1f %6.1f %5d  | %10.1f %6.1f %5d  | %9.0f %13.0f%%\n", seed + p, msec / 60000.0,
+           oldResult.sumError / oldResult.samples, oldResult.worstError, oldResult.worstJump,
+           newResult.sumError / newResult.samples, newResult.worstError, newResult.worstJump,
+           sumMilliVoltError / milliVoltSamples, runtimeError);
+    if (newResult.worstError > PERCENT_GOAL || newResult.worstJump > JUMP_GOAL) pass = false;
+    if (runtimeError > RUNTIME_GOAL) runtimePass = false;
+    sumPackRuntimeError += runtimeError;
+  }
+  double runtimeMeanError = sumPackRuntimeError / packs;
+  if (runtimeMeanError > RUNTIME_MEAN_GOAL) runtimePass = false;
+  if (pass) printf("every estimate within %d%% and no jump over %d\n", PERCENT_GOAL, JUMP_GOAL);
+  else printf("FAIL: an estimate was off by more than %d%% or jumped by more than %d\n", PERCENT_GOAL, JUMP_GOAL);
+  if (runtimePass)
+    printf("runtime off by %.0f%% on average, no pack by more than %d%%\n", runtimeMeanError, RUNTIME_GOAL);
+  else
+    printf("FAIL: runtime off by %.0f%% on average (goal %d%%), or a pack by more than %d%%\n", runtimeMeanError,
+           RUNTIME_MEAN_GOAL, RUNTIME_GOAL);
+  return pass && runtimePass ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+#!/bin/sh
+# buildMatrix - compile RobotComm for every board and feature set in libraries/RobotCommCore,
+# and a few of the forked sketches it replaced for comparison, and list the flash and SRAM each one
+# takes.  The forks are no longer in the tree; they are taken from the last commit that had them.
+#
+# needs arduino-cli with the arduino:avr core installed, and git
+# use (from anywhere in the repository):
+#   hostTools/buildMatrix/buildMatrix.sh [sketch]      default sketch is RobotComm_v0_81
+#   hostTools/buildMatrix/buildMatrix.sh --host
+# a configuration that fails to build is listed as FAILED, and the script exits with status 1.
+# the builds are kept in $TMPDIR/robotBuildMatrix/<configuration>, with the stack usage of every
+# function (-fstack-usage), for hostTools/sramReport to break the SRAM down by module.
+#
+# --host, where there is no AVR toolchain, compiles and links each configuration of RobotComm_v0_81
+# with g++ on the board model instead (hostTools/sketchHost, needs only g++).  That catches what does
+# not compile for a board or feature set, but says nothing of flash or SRAM, and the old sketches
+# are not built; a configuration is listed as built or FAILED.
+
+REPO=$(cd "$(dirname "$0")/../.." && pwd)
+HOST=
+if [ "$1" = "--host" ]; then
+  HOST=1
+  shift
+fi
+SKETCH=${1:-RobotComm_v0_81}
+FQBN=arduino:avr:mega:cpu=atmega2560
+BUILD=${TMPDIR:-/tmp}/robotBuildMatrix
+STATUS=0
+
+# name, then the -D flags
+CONFIGURATIONS="
+pcb|-DROBOT_BOARD=1
+pcb-fault-interrupts|-DROBOT_BOARD=1 -DROBOT_FAULT_INTERRUPTS=1
+pcb-encoders|-DROBOT_BOARD=1 -DROBOT_ENCODERS=1
+pcb-no-safety-sensors|-DROBOT_BOARD=1 -DROBOT_SAFETY_SENSORS=0
+pcb-log-ids|-DROBOT_BOARD=1 -DROBOT_LOG_IDS=1
+pcb-fixed-point|-DROBOT_BOARD=1 -DROBOT_FIXED_POINT=1
+original|-DROBOT_BOARD=2
+reverse|-DROBOT_BOARD=3
+calypso|-DROBOT_BOARD=4
+pololu-big|-DROBOT_BOARD=5
+"
+
+# the forked sketches, built as they were, to see what the shared core costs or saves
+OLD_SKETCHES="
+RobotComm_v0_80
+threeMotorsRobotCommPCBsimple_v_074
+threeMotorsRobotCommCalypso_v0_60
+threeMotorsRobotCommDemobot
+threeMotorsRobotComm_v0_62
+"
+
+# the commit before the forks were removed
+OLD_COMMIT=$(git -C "$REPO" rev-list -n 1 HEAD -- RobotComm_v0_80)^
+
+# prints "<flash> <sram>" for one build of the sketch folder $2, or nothing if it failed
+build()
+{
+  arduino-cli compile --fqbn "$FQBN" --libraries "$REPO/libraries" --build-path "$BUILD/$1" \
+    --build-property "compiler.cpp.extra_flags=$3 -fstack-usage" --build-property "compiler.c.extra_flags=$3 -fstack-usage" \
+    "$2" 2>&1 |
+  sed -n -e 's/^Sketch uses \([0-9]*\) bytes.*/\1/p' -e 's/^Global variables use \([0-9]*\) bytes.*/\1/p' |
+  tr '\n' ' '
+}
+
+report()
+{
+  if [ -z "$2" ]; then
+    printf '%-40s FAILED\n' "$1"
+    STATUS=1
+  else
+    set -- "$1" $2
+    printf '%-40s %8s %8s\n' "$1" "$2" "$3"
+  fi
+}
+
+# builds one configuration with sketchHost, the compiler's complaints go to its log
+hostBuild()
+{
+  mkdir -p "$BUILD/$1" || return 1
+  TMPDIR=$BUILD/$1 "$REPO/hostTools/sketchHost/sketchHost.sh" -c $2 > "$BUILD/$1/host.log" 2>&1
+}
+
+if [ -n "$HOST" ]; then
+  printf '%-40s %s\n' configuration host
+  while IFS='|' read -r name flags; do
+    [ -z "$name" ] && continue
+    if hostBuild "$name" "$flags"; then
+      printf '%-40s built\n' "RobotComm_v0_81/$name"
+    else
+      printf '%-40s FAILED, see %s\n' "RobotComm_v0_81/$name" "$BUILD/$name/host.log"
+      STATUS=1
+    fi
+  done <<END
+$CONFIGURATIONS
+END
+  exit $STATUS
+fi
+
+printf '%-40s %8s %8s\n' configuration flash sram
+while IFS='|' read -r name flags; do
+  [ -z "$name" ] && continue
+  report "$SKETCH/$name" "$(build "$name" "$REPO/$SKETCH" "$flags")"
+done <<END
+$CONFIGURATIONS
+END
+mkdir -p "$BUILD/old"
+for old in $OLD_SKETCHES; do
+  rm -rf "${BUILD:?}/old/$old"
+  git -C "$REPO" archive "$OLD_COMMIT" "$old" | tar -x -C "$BUILD/old"
+  report "$old" "$(build "$old" "$BUILD/old/$old" "")"
+done
+exit $STATUS
@@ -0,0 +1,197 @@
+// fixedPointCheck - the float free build's arithmetic against the double build's, on the same inputs
+//
+// RobotComm built with ROBOT_FIXED_POINT does the gyro and heading arithmetic (libraries/RobotCommCore/
+// robotMath.h) in Fixed<int32_t, 16> instead of double.  This runs those kernels both ways on seeded
+// synthetic gyro traces: a baseline gathered the way Gyro_Init() and the idle loop do it, then moves
+// with drift, noise and the odd bump, integrated at goStraight's 30 msec step, and the turns of
+// gyroTurnDelay at 20 msec.  It reports the worst difference in yaw, in the baseline, and in the bias
+// changes goStraight makes (as the ints they end up as), and checks the tenths parameters and the
+// battery scales startBatteryEstimator() works out over their whole range.  Exits 1 if anything is
+// outside the tolerances below.
+//
+// build:
+//   g++ -O2 -I../../libraries/RobotCommCore -o fixedPointCheck fixedPointCheck.cpp
+// use:
+//   fixedPointCheck [-n traces] [-s seed] [-v]
+//     -n  number of traces (200)
+//     -s  first seed (1)
+//     -v  a line per trace
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "robotMath.h"
+
+typedef Fixed<int32_t, 16> fixed;
+
+#define YAW_TOLERANCE 0.001       // of the degrees turned, far inside the L3G's own sensitivity tolerance
+#define YAW_FLOOR 0.01            // degrees, for moves that hardly turn
+#define BASELINE_TOLERANCE 0.001  // counts
+#define BIAS_MISMATCH_LIMIT 0.01  // share of goStraight steps whose int bias changes differ
+
+static double asDouble(fixed value) { return value.raw() / 65536.0; }
+
+// a small deterministic generator, so a seed gives the same trace everywhere
+static unsigned long state;
+static long nextRandom(long range)
+{
+  state = state * 1103515245UL + 12345UL;
+  return (long) ((state >> 8) % (unsigned long) range);
+}
+
+struct worst
+{
+  double yaw, yawShare, baseline;
+  long biasSteps, biasMismatches;
+};
+
+// one robot: its gyro bias, its drift while moving and the noise on each reading
+struct gyroTrace
+{
+  int bias, drift, noise;
+  int read(bool moving) { return bias + (moving ? drift : 0) + (int) nextRandom(2 * noise + 1) - noise; }
+};
+
+template <class Real> struct model
+{
+  Real baseline, totalYaw, previousDeltaYaw;
+  int points;
+
+  void gatherBaseline(gyroTrace& gyro, int numPoints, int maxLength)
+  {
+    long sum = 0;
+    points -= numPoints;
+    if (points < 0) points = 0;
+    for (int i = 0; i < numPoints; i++) sum += gyro.read(false);
+    baseline = foldBaseline(baseline, points, sum, numPoints);
+    points += numPoints;
+    if (points > maxLength) points = maxLength;
+  }
+};
+
+static void checkTrace(unsigned long seed, worst& w, bool verbose)
+{
+  state = seed;
+  gyroTrace gyro;
+  gyro.bias = (int) nextRandom(81) - 40;
+  gyro.drift = (int) nextRandom(61) - 30;
+  gyro.noise = (int) nextRandom(12) + 1;
+
+  model<double> d = { 0, 0, 0, 0 };
+  model<fixed> f = { 0, 0, 0, 0 };
+  unsigned long saved = state;
+  d.gatherBaseline(gyro, 32, 32);
+  state = saved;
+  f.gatherBaseline(gyro, 32, 32);
+  // the idle loop folds in one reading at a time
+  for (int i = 0; i < 100; i++)
+  {
+    saved = state;
+    d.gatherBaseline(gyro, 1, 32);
+    state = saved;
+    f.gatherBaseline(gyro, 1, 32);
+  }
+  double baselineError = fabs(d.baseline - asDouble(f.baseline));
+  if (baselineError > w.baseline) w.baseline = baselineError;
+
+  // a move of a few seconds, goStraight every 30 msec or so
+  double initialD = d.totalYaw, previousD = initialD;
+  fixed initialF = f.totalYaw, previousF = initialF;
+  int steps = 100 + (int) nextRandom(200);
+  for (int i = 0; i < steps; i++)
+  {
+    unsigned long msec = 28 + nextRandom(6);
+    int raw = gyro.read(true);
+    if (nextRandom(100) == 0) raw += (int) nextRandom(2001) - 1000;  // a bump
+    d.totalYaw += yawStep(gyroRate(raw, d.baseline), msec);
+    f.totalYaw += yawStep(gyroRate(raw, f.baseline), msec);
+
+    double deltaD = d.totalYaw - previousD, leftD, rightD;
+    fixed deltaF = f.totalYaw - previousF, leftF, rightF;
+    straightCorrection(deltaD, d.previousDeltaYaw, d.totalYaw - initialD, leftD, rightD);
+    straightCorrection(deltaF, f.previousDeltaYaw, f.totalYaw - initialF, leftF, rightF);
+    w.biasSteps++;
+    if ((int) leftD != (int) leftF || (int) rightD != (int) rightF) w.biasMismatches++;
+    d.previousDeltaYaw = deltaD;
+    f.previousDeltaYaw = deltaF;
+    previousD = d.totalYaw;
+    previousF = f.totalYaw;
+  }
+
+  // a turn, gyroTurnDelay's 20 msec steps at a turning rate
+  int turnRate = (int) nextRandom(4001) - 2000;
+  for (int i = 0; i < 100; i++)
+  {
+    int raw = gyro.read(false) + turnRate;
+    d.totalYaw += yawStep(gyroRate(raw, d.baseline), 20);
+    f.totalYaw += yawStep(gyroRate(raw, f.baseline), 20);
+  }
+
+  double yawError = fabs(d.totalYaw - asDouble(f.totalYaw));
+  if (yawError > w.yaw) w.yaw = yawError;
+  double yawShare = yawError <= YAW_FLOOR ? 0 : yawError / fabs(d.totalYaw);
+  if (yawShare > w.yawShare) w.yawShare = yawShare;
+  if (verbose)
+    printf("seed %lu  bias %d drift %d noise %d  yaw %.3f / %.3f  baseline %.4f / %.4f\n", seed, gyro.bias,
+           gyro.drift, gyro.noise, d.totalYaw, asDouble(f.totalYaw), d.baseline, asDouble(f.baseline));
+}
+
+// what u_parameters and startBatteryEstimator() do with the tenths parameters, both ways
+static int checkTenths()
+{
+  int failures = 0;
+  for (long tenths = 0; tenths <= 2559; tenths++)
+  {
+    double d = tenths / 10.;
+    fixed f = fixed::ratio(tenths, 10);
+    long backD = (long) (d * 10 + 0.5), backF = realOps<fixed>::nearest(f * 10);
+    unsigned long scaleD = (unsigned long) (5000000. * d / 1023);
+    unsigned long scaleF = (unsigned long) realOps<fixed>::nearest(f * 10) * 500000UL / 1023;
+    long milliVoltsD = (long) (d * 1000 + 0.5), milliVoltsF = realOps<fixed>::nearest(f * 10) * 100;
+    if (backD != tenths || backF != tenths || scaleD != scaleF || milliVoltsD != milliVoltsF)
+    {
+      if (failures < 5) printf("tenths %ld: read back %ld / %ld, divider scale %lu / %lu, mV %ld / %ld\n",
+                               tenths, backD, backF, scaleD, scaleF, milliVoltsD, milliVoltsF);
+      failures++;
+    }
+  }
+  return failures;
+}
+
+int main(int argc, char** argv)
+{
+  long traces = 200;
+  unsigned long seed = 1;
+  bool verbose = false;
+  int option;
+  while ((option = getopt(argc, argv, "n:s:v")) != -1)
+  {
+    switch (option)
+    {
+      case 'n': traces = atol(optarg); break;
+      case 's': seed = strtoul(optarg, 0, 10); break;
+      case 'v': verbose = true; break;
+      default:
+        fprintf(stderr, "use: fixedPointCheck [-n traces] [-s seed] [-v]\n");
+        return 1;
+    }
+  }
+
+  worst w = { 0, 0, 0, 0, 0 };
+  for (long i = 0; i < traces; i++) checkTrace(seed + i, w, verbose);
+  int tenthsFailures = checkTenths();
+  double biasShare = w.biasSteps ? (double) w.biasMismatches / w.biasSteps : 0;
+
+  bool pass = w.yawShare <= YAW_TOLERANCE && w.baseline <= BASELINE_TOLERANCE && biasShare <= BIAS_MISMATCH_LIMIT
+              && tenthsFailures == 0;
+  printf("%ld traces\n", traces);
+  printf("worst yaw difference       %.4f degrees, %.3f%% of the turn (limit %.1f%%)\n", w.yaw, w.yawShare * 100,
+         YAW_TOLERANCE * 100);
+  printf("worst baseline difference  %.5f counts (limit %.3f)\n", w.baseline, BASELINE_TOLERANCE);
+  printf("bias changes that differ   %ld of %ld steps (limit %.0f%%)\n", w.biasMismatches, w.biasSteps,
+         BIAS_MISMATCH_LIMIT * 100);
+  printf("tenths parameters 0..2559  %d differ\n", tenthsFailures);
+  printf("%s\n", pass ? "pass" : "FAIL");
+  return pass ? 0 : 1;
+}
@@ -0,0 +1,201 @@
+// ingestBench - host model of the firmware's command ingest path, old and new, in bytes/sec
+//
+// loop() used to read each command byte by byte out of the BufferedUART receive buffer into
+// inputBuffer[256], dropping carriage returns, line feeds, spaces and nulls on the way, then echo the
+// copy, parse it, and zero the buffer again.  Now the receive interrupt drops those bytes as they
+// arrive, loop() takes the command as a span of the receive buffer (BufferedFrame), parses and echoes
+// it from there, and lets go of it with dropFrame().  Both paths are modelled here with the same ring
+// buffers and the same command mix, the interrupt's work included, so the ratio is a fair picture of
+// what the change saves per byte; the absolute numbers are the host's, not the Mega's.
+//
+// build:
+//   g++ -O2 -o ingestBench ingestBench.cpp
+// use:
+//   ingestBench [-n passes] [-r]
+//     -n  passes over the command mix (20000)
+//     -r  one line for scripts: old bytes/sec, new bytes/sec
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RX_SIZE 512  // BLUETOOTH_RX_BUFFER_SIZE
+#define TX_SIZE 256  // BLUETOOTH_TX_BUFFER_SIZE
+#define INPUT_BUFFER_SIZE 256
+#define FRAME_END '#'
+#define MAX_PARAMETERS 3
+
+// what the android app and the host tools send, line ends and all
+static const char* commandMix[] =
+{
+  "c#", "f200#\r\n", "r220,90#", "G1#", "V7,180#", "T100,63#\r\n", "W20,1,21,44,30,200#",
+  "qf200#", "w1500,r150,45#", "x#", "p#", "E300#", " c #\n", "K1#", "S0#",
+};
+
+static uint8_t rx[RX_SIZE], tx[TX_SIZE];
+static volatile uint16_t rxHead, rxTail, txHead, txTail, frames;
+static volatile long sink;  // keeps the parsed values alive
+
+static bool isSkipped(uint8_t c) { return c == '\r' || c == '\n' || c == ' ' || c == 0; }
+
+// the receive interrupt, with or without the whitespace filter
+static void __attribute__((noinline)) receive(uint8_t c, bool skip)
+{
+  if (skip && isSkipped(c)) return;
+  uint16_t next = (rxHead + 1) & (RX_SIZE - 1);
+  if (next == rxTail) return;
+  rx[rxHead] = c;
+  rxHead = next;
+  if (c == FRAME_END) frames++;
+}
+
+// the transmit side, Print::write a byte at a time; the bytes go out at once, as if the UART kept up
+static void __attribute__((noinline)) transmit(uint8_t c)
+{
+  tx[txHead] = c;
+  txHead = (txHead + 1) & (TX_SIZE - 1);
+  txTail = txHead;
+}
+
+static int __attribute__((noinline)) readByte()
+{
+  if (rxHead == rxTail) return -1;
+  uint8_t c = rx[rxTail];
+  rxTail = (rxTail + 1) & (RX_SIZE - 1);
+  if (c == FRAME_END && frames) frames--;
+  return c;
+}
+
+// the old way: copy, echo the copy, parse the copy, clear it
+static char inputBuffer[INPUT_BUFFER_SIZE];
+
+static void oldCommand()
+{
+  int inputLength = 0;
+  int charIn = 0;
+  while (charIn != FRAME_END)
+  {
+    charIn = readByte();
+    if (charIn != FRAME_END && !isSkipped(charIn) && inputLength < INPUT_BUFFER_SIZE - 1)
+      inputBuffer[inputLength++] = charIn;
+  }
+  inputBuffer[inputLength] = 0;
+  if (inputLength > 0 && inputBuffer[0] != 'c')
+  {
+    transmit('e');
+    for (const char* p = inputBuffer; *p; p++) transmit(*p);
+    transmit('\r');
+    transmit('\n');
+    long parameter[MAX_PARAMETERS] = { 0 }, value = 0;
+    int n = 0;
+    for (int i = 1; i <= inputLength; i++)
+    {
+      if (i == inputLength || inputBuffer[i] == ',')
+      {
+        if (n < MAX_PARAMETERS) parameter[n++] = value;
+        value = 0;
+      }
+      else if (inputBuffer[i] >= '0' && inputBuffer[i] <= '9') value = value * 10 + inputBuffer[i] - '0';
+    }
+    sink = parameter[0] + parameter[1];
+  }
+  for (int i = 0; i < inputLength; i++) inputBuffer[i] = 0;
+}
+
+// the new way: a span of the receive buffer, echoed and parsed where it lies, then dropped
+struct frame
+{
+  uint16_t start, length;
+  char operator[](uint16_t i) const { return rx[(start + i) & (RX_SIZE - 1)]; }
+};
+
+static void newCommand()
+{
+  frame input = { rxTail, 0 };
+  while (input[input.length] != FRAME_END) input.length++;
+  if (input.length > 0 && input[0] != 'c')
+  {
+    transmit('e');
+    for (uint16_t i = 0; i < input.length; i++) transmit(input[i]);
+    transmit('\r');
+    transmit('\n');
+    long parameter[MAX_PARAMETERS] = { 0 }, value = 0;
+    int n = 0;
+    for (int i = 1; i <= input.length; i++)
+    {
+      char c = i < input.length ? input[i] : ',';
+      if (c == ',')
+      {
+        if (n < MAX_PARAMETERS) parameter[n++] = value;
+        value = 0;
+      }
+      else if (c >= '0' && c <= '9') value = value * 10 + c - '0';
+    }
+    sink = parameter[0] + parameter[1];
+  }
+  rxTail = (input.start + input.length + 1) & (RX_SIZE - 1);
+  frames--;
+}
+
+static double seconds()
+{
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// feeds the mix through the receive interrupt and the command loop, returns bytes/sec received
+static double run(bool zeroCopy, long passes)
+{
+  size_t commands = sizeof(commandMix) / sizeof(commandMix[0]);
+  double bytes = 0;
+  rxHead = rxTail = frames = 0;
+  double start = seconds();
+  for (long pass = 0; pass < passes; pass++)
+  {
+    for (size_t i = 0; i < commands; i++)
+    {
+      for (const char* p = commandMix[i]; *p; p++) receive(*p, zeroCopy);
+      bytes += strlen(commandMix[i]);
+      while (frames)
+      {
+        if (zeroCopy) newCommand();
+        else oldCommand();
+      }
+    }
+  }
+  return bytes / (seconds() - start);
+}
+
+int main(int argc, char** argv)
+{
+  long passes = 20000;
+  bool raw = false;
+  int option;
+  while ((option = getopt(argc, argv, "n:r")) != -1)
+  {
+    switch (option)
+    {
+      case 'n': passes = atol(optarg); break;
+      case 'r': raw = true; break;
+      default:
+        fprintf(stderr, "use: ingestBench [-n passes] [-r]\n");
+        return 1;
+    }
+  }
+  run(false, passes / 10 + 1);  // warm up
+  double copied = run(false, passes);
+  double inPlace = run(true, passes);
+  if (raw)
+  {
+    printf("%.0f %.0f\n", copied, inPlace);
+    return 0;
+  }
+  printf("copy into inputBuffer  %12.0f bytes/sec\n", copied);
+  printf("parse in place         %12.0f bytes/sec  (%.2fx)\n", inPlace, inPlace / copied);
+  printf("SRAM: inputBuffer[%d] is gone\n", INPUT_BUFFER_SIZE);
+  return 0;
+}
@@ -0,0 +1,164 @@
+// irSensorCheck - irSensor's calibration table and danger checks (libraries/irLibrary) on the host
+//
+// The table is checked against the calibration curve it was made from, d(cm) = V^-2.0202 / 0.0079566725761
+// with V = raw * 5 / 1024: its entries to the mm, and the linear interpolation between them over every
+// ADC reading, reported as the worst error in each distance band.  Then a sensor is run on the board
+// model in hostTools/arduino, fed through the background ADC scanner the way the safety monitor's are,
+// through each danger check: too near, a sudden drop, too far for the ground (a cliff), and the first
+// sample, which has nothing to have dropped from.  Both constructors are checked to put the cliff at
+// the same distance.  Exits 1 if anything is off by more than the limits below.
+//
+// build:
+//   g++ -O2 -DARDUINO=100 -I../arduino -I../../libraries/irLibrary -I../../libraries/backgroundADC
+//     -o irSensorCheck irSensorCheck.cpp ../arduino/hostArduino.cpp ../../libraries/irLibrary/irSensor.cpp
+//     ../../libraries/backgroundADC/backgroundADC.cpp
+// use:
+//   irSensorCheck [-v]
+//     -v  the table against the curve halfway between its entries, and each danger check as it runs
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "Arduino.h"
+#include "hostArduino.h"
+#include "irSensor.h"
+
+#define TABLE_TOLERANCE 1          // mm, a table entry against the curve
+#define INTERPOLATION_LIMIT 0.01   // of the distance, between IR_NEAR_MM and 1000 mm
+#define SETTLE_USEC 20000          // for the scanner's filter to follow a new reading
+#define MOUNT_HEIGHT 100           // mm, as o_safetyMonitor mounts them
+#define MOUNT_SIN 8415             // 1 radian
+
+static bool verbose;
+static int failures;
+
+static void check(bool ok, const char *what)
+{
+  if (verbose || !ok) printf("  %-60s %s\n", what, ok ? "ok" : "FAIL");
+  if (!ok) failures++;
+}
+
+static double curveMM(int raw)
+{
+  if (raw == 0) return IR_MAX_MM;
+  double mm = pow(raw * 5.0 / 1024, -2.0202) / 0.0079566725761 * 10;
+  return mm > IR_MAX_MM ? IR_MAX_MM : mm;
+}
+
+// the worst interpolation error in each band, and whether the table ever goes up with the reading
+static void checkTable()
+{
+  static const int bands[] = { 0, IR_NEAR_MM, 300, 600, 1000, IR_MAX_MM + 1 };
+  const int bandCount = sizeof(bands) / sizeof(bands[0]) - 1;
+  double worst[bandCount] = { 0 }, worstShare[bandCount] = { 0 };
+  int worstRaw[bandCount] = { 0 };
+  int entryErrors = 0;
+  bool monotonic = true;
+  for (int raw = 0; raw < 1024; raw++)
+  {
+    double curve = curveMM(raw);
+    int table = irRawToMM(raw);
+    if (raw % 16 == 0 && fabs(table - curve) > TABLE_TOLERANCE) entryErrors++;
+    if (raw > 0 && table > irRawToMM(raw - 1)) monotonic = false;
+    if (verbose && raw % 16 == 8) printf("  raw %4d  table %4d mm  curve %7.1f mm\n", raw, table, curve);
+    for (int b = 0; b < bandCount; b++)
+    {
+      if (curve < bands[b] || curve >= bands[b + 1]) continue;
+      double error = fabs(table - curve);
+      if (error > worst[b])
+      {
+        worst[b] = error;
+        worstShare[b] = error / curve;
+        worstRaw[b] = raw;
+      }
+    }
+  }
+  printf("table against the curve, worst interpolation error:\n");
+  for (int b = 0; b < bandCount; b++)
+    printf("  %4d - %4d mm  %5.1f mm, %4.1f%%  at raw %d\n", bands[b], bands[b + 1] - 1, worst[b], worstShare[b] * 100, worstRaw[b]);
+  char what[100];
+  snprintf(what, sizeof(what), "table entries within %d mm of the curve (%d off)", TABLE_TOLERANCE, entryErrors);
+  check(entryErrors == 0, what);
+  check(monotonic, "distance never rises with the reading");
+  for (int b = 0; b < bandCount; b++)
+  {
+    if (bands[b] < IR_NEAR_MM || bands[b + 1] > 1001) continue;
+    snprintf(what, sizeof(what), "interpolation within %.0f%% in %d - %d mm", INTERPOLATION_LIMIT * 100, bands[b], bands[b + 1] - 1);
+    check(worstShare[b] <= INTERPOLATION_LIMIT, what);
+  }
+}
+
+// the reading that gives mm, the last one at or beyond it
+static int rawFor(int mm)
+{
+  int raw = 0;
+  while (raw < 1023 && irRawToMM(raw + 1) >= mm) raw++;
+  return raw;
+}
+
+// the sensor on pin sees mm from now on; true if update() found a new sample, with danger in *danger
+static bool sense(irSensor& sensor, uint8_t pin, int mm, bool *danger)
+{
+  hostSetAnalog(pin, rawFor(mm));
+  hostAdvance(SETTLE_USEC);
+  bool fresh = sensor.update();
+  *danger = sensor.danger();
+  if (verbose) printf("  sees %4d mm: reads %4u mm, %s\n", mm, sensor.distanceMM(), *danger ? "danger" : "clear");
+  return fresh;
+}
+
+static void checkDanger()
+{
+  // flat ground is MOUNT_HEIGHT / cos(1 radian) away; the cliff is where the ground angle gets too shallow
+  int ground = (int) (MOUNT_HEIGHT / cos(1.0));
+  int cliff = (int) ((long) MOUNT_HEIGHT * MOUNT_SIN / 1564) + 1;  // irSensor.cpp's IR_MIN_GROUND_SIN
+  printf("danger checks, ground %d mm, cliff beyond %d mm:\n", ground, cliff - 1);
+
+  hostReset();
+  irSensor sensor(A8, irMounting{ MOUNT_HEIGHT, MOUNT_SIN });
+  check(sensor.begin(), "begin() gets a scanner slot");
+  bool danger;
+  check(sense(sensor, A8, ground, &danger) && !danger, "the first sample, on flat ground, is clear");
+  check(!sensor.update(), "update() without a new sample reports none");
+  check(sense(sensor, A8, ground, &danger) && !danger, "flat ground stays clear");
+  check(sense(sensor, A8, IR_NEAR_MM - 20, &danger) && danger, "under IR_NEAR_MM is danger");
+  check(sense(sensor, A8, ground, &danger) && !danger, "back on the ground is clear");
+  check(sense(sensor, A8, cliff + 20, &danger) && danger, "beyond the ground limit is a cliff");
+  check(sense(sensor, A8, cliff - 20, &danger) && !danger, "just inside the ground limit is clear");
+  check(sense(sensor, A8, cliff - 20 - IR_DROP_MM - 30, &danger) && danger, "a drop of more than IR_DROP_MM is danger");
+  check(sense(sensor, A8, cliff - 20 - IR_DROP_MM - 30, &danger) && !danger, "and clear once it stays there");
+  check(sense(sensor, A8, cliff - 20 - IR_DROP_MM - 30 - IR_DROP_MM / 2, &danger) && !danger, "a drop of less than IR_DROP_MM is clear");
+
+  // a sensor whose first sample is already close is in danger, without a drop to find
+  irSensor nearSensor(A9, irMounting{ MOUNT_HEIGHT, MOUNT_SIN });
+  nearSensor.begin();
+  check(sense(nearSensor, A9, IR_NEAR_MM - 20, &danger) && danger, "a first sample under IR_NEAR_MM is danger");
+
+  // the float constructor (cm and radians) puts the cliff where the irMounting one does
+  irSensor floatSensor(A10, MOUNT_HEIGHT / 10.0, asin(MOUNT_SIN / 10000.0));
+  floatSensor.begin();
+  sense(floatSensor, A10, cliff - 20, &danger);
+  bool inside = !danger;
+  sense(floatSensor, A10, cliff + 20, &danger);
+  check(inside && danger, "the float constructor's cliff is the same");
+}
+
+int main(int argc, char** argv)
+{
+  int option;
+  while ((option = getopt(argc, argv, "v")) != -1)
+  {
+    if (option == 'v') verbose = true;
+    else
+    {
+      fprintf(stderr, "use: irSensorCheck [-v]\n");
+      return 1;
+    }
+  }
+  checkTable();
+  checkDanger();
+  printf("%s\n", failures ? "FAIL" : "pass");
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,74 @@
+// logExpander - host side expander for the RobotComm diagnostic log
+//
+// The firmware built with ROBOT_LOG_IDS sends each diagnostic as '~', the message id and its
+// arguments, separated by ','.  This puts the message text from libraries/RobotLog/RobotLogMessages.h
+// back, so the output reads the same as the firmware built without it.  Every other line is copied
+// through as it is; a line with an id this build of the tool does not know is copied through with a
+// note, which usually means the firmware and the tool were built from different message lists.
+//
+// build:
+//   g++ -O2 -I../../libraries/RobotLog -o logExpander logExpander.cpp
+// use:
+//   logExpander [monitor.log]           reads stdin when no file is named, e.g.
+//   cat /dev/ttyACM0 | logExpander
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "RobotLogMessages.h"
+
+#define ROBOT_LOG_TEXT(id, text) text,
+static const char* messageText[] = { ROBOT_LOG_MESSAGES(ROBOT_LOG_TEXT) };
+
+// writes one line, without its end of line, expanded when it is an id line
+static void expand(char* line, FILE* out)
+{
+  if (line[0] != ROBOT_LOG_ID_MARK)
+  {
+    fputs(line, out);
+    return;
+  }
+  char* end;
+  long id = strtol(line + 1, &end, 10);
+  if (end == line + 1 || (*end != ',' && *end != 0) || id < 0 || id >= ROBOT_LOG_MESSAGE_COUNT)
+  {
+    fprintf(out, "%s  (unknown message id)", line);
+    return;
+  }
+  fputs(messageText[id], out);
+  for (bool first = true; *end == ','; first = false)
+  {
+    char* argument = end + 1;
+    end = strchr(argument, ',');
+    if (!end) end = argument + strlen(argument);
+    fprintf(out, "%s%.*s", first ? "" : ", ", (int) (end - argument), argument);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  FILE* in = stdin;
+  if (argc > 2)
+  {
+    fprintf(stderr, "use: logExpander [monitor.log]\n");
+    return 1;
+  }
+  if (argc == 2 && !(in = fopen(argv[1], "r")))
+  {
+    perror(argv[1]);
+    return 1;
+  }
+
+  char line[512];
+  while (fgets(line, sizeof(line), in))
+  {
+    size_t length = strlen(line);
+    bool endOfLine = length > 0 && line[length - 1] == '\n';
+    // the monitor lines end in "\r\n"
+    while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r')) line[--length] = 0;
+    expand(line, stdout);
+    if (endOfLine) putchar('\n');
+  }
+  fflush(stdout);
+  return 0;
+}
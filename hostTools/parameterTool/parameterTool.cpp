@@ -0,0 +1,316 @@
+// parameterTool - lists and sets the RobotComm parameters by name
+//
+// The names, ranges and EEPROM slots come from libraries/RobotParameters/RobotParameters.h, the same
+// list the firmware is built from, and the robot is spoken to with G (get), V (set) and C (commit),
+// see u_parameters in the sketch.  A set is live at once; it is only kept over a reset after commit.
+// Values are in the units of the parameter: msec, mA, PWM, volts for the battery voltages.
+//
+// build:
+//   g++ -O2 -I../../libraries/RobotParameters -o parameterTool parameterTool.cpp
+// use:
+//   parameterTool list                               the registry, no robot needed
+//   parameterTool -p /dev/rfcomm0 list               with the robot's live values
+//   parameterTool -p /dev/rfcomm0 get speed ...
+//   parameterTool -p /dev/rfcomm0 set speed=200 full_battery_voltage=12.8 ...
+//   parameterTool -p /dev/rfcomm0 commit             writes every live value to the EEPROM
+
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/select.h>
+#include <termios.h>
+#include <unistd.h>
+#include "RobotParameters.h"
+
+#define REPLY_TIMEOUT_MSEC 2000
+#define COMMIT_TIMEOUT_MSEC 5000  // 44 bytes at 3.3 msec each, with room to spare
+
+struct parameter
+{
+  const char* name;
+  int kind;
+  long minimum, maximum;
+  int scale;
+  int address;
+  long fallback;
+};
+
+#define PARAMETER_ENTRY(id, name, variable, kind, minimum, maximum, scale, address, fallback) \
+  { name, kind, minimum, maximum, scale, address, fallback },
+static const parameter parameters[ROBOT_PARAMETER_COUNT] = { ROBOT_PARAMETERS(PARAMETER_ENTRY) };
+
+static const char* statusText[] = { "ok", "unknown id", "out of range" };
+
+static int findParameter(const char* name, size_t length)
+{
+  for (int id = 0; id < ROBOT_PARAMETER_COUNT; id++)
+  {
+    if (strlen(parameters[id].name) == length && strncmp(parameters[id].name, name, length) == 0) return id;
+  }
+  return -1;
+}
+
+// the link carries tenths for PARAM_TENTHS, the user sees volts
+static void formatValue(int id, long value, char* text, size_t size)
+{
+  if (parameters[id].kind == PARAM_TENTHS) snprintf(text, size, "%ld.%ld", value / 10, labs(value % 10));
+  else snprintf(text, size, "%ld", value);
+}
+
+static bool parseValue(int id, const char* text, long* value)
+{
+  char* end;
+  double number = strtod(text, &end);
+  if (end == text || *end) return false;
+  if (parameters[id].kind == PARAM_TENTHS) number *= 10;
+  *value = lround(number);
+  return true;
+}
+
+static int openPort(const char* path)
+{
+  int fd = open(path, O_RDWR | O_NOCTTY);
+  if (fd < 0)
+  {
+    perror(path);
+    return -1;
+  }
+  termios settings;
+  if (tcgetattr(fd, &settings) == 0)  // a pty or a pipe from a simulator is fine as it is
+  {
+    cfmakeraw(&settings);
+    cfsetispeed(&settings, B115200);
+    cfsetospeed(&settings, B115200);
+    settings.c_cflag |= CLOCAL | CREAD;
+    tcsetattr(fd, TCSANOW, &settings);
+    tcflush(fd, TCIFLUSH);
+  }
+  return fd;
+}
+
+static bool sendCommand(int fd, const char* command)
+{
+  size_t length = strlen(command);
+  while (length > 0)
+  {
+    ssize_t sent = write(fd, command, length);
+    if (sent < 0 && errno == EINTR) continue;
+    if (sent <= 0)
+    {
+      perror("write");
+      return false;
+    }
+    command += sent;
+    length -= sent;
+  }
+  return true;
+}
+
+// reads lines until one starts with prefix, skipping the rest (diagnostics, telemetry)
+static bool readReply(int fd, const char* prefix, char* line, size_t size, int timeoutMsec)
+{
+  size_t length = 0;
+  while (true)
+  {
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(fd, &readable);
+    timeval timeout = { timeoutMsec / 1000, (timeoutMsec % 1000) * 1000 };
+    int ready = select(fd + 1, &readable, 0, 0, &timeout);
+    if (ready < 0 && errno == EINTR) continue;
+    if (ready <= 0) return false;
+    char c;
+    if (read(fd, &c, 1) != 1) return false;
+    if (c == '\r') continue;
+    if (c != '\n')
+    {
+      if (length < size - 1) line[length++] = c;
+      continue;
+    }
+    line[length] = 0;
+    length = 0;
+    if (strncmp(line, prefix, strlen(prefix)) == 0) return true;
+  }
+}
+
+// the fields of mG<id>,<value>,<status> or mV<id>,<value>,<status>
+static bool parseAnswer(const char* line, long* id, long* value, long* status)
+{
+  return sscanf(line + 2, "%ld,%ld,%ld", id, value, status) == 3;
+}
+
+static void printParameter(int id, const long* value)
+{
+  const parameter& p = parameters[id];
+  char text[24], minimum[24], maximum[24], fallback[24];
+  formatValue(id, p.minimum, minimum, sizeof(minimum));
+  formatValue(id, p.maximum, maximum, sizeof(maximum));
+  formatValue(id, p.fallback, fallback, sizeof(fallback));
+  if (value) formatValue(id, *value, text, sizeof(text));
+  else strcpy(text, "-");
+  printf("%3d  %-30s %8s   %s..%s step %d, default %s, EEPROM %d\n",
+         id, p.name, text, minimum, maximum, p.scale, fallback, p.address);
+}
+
+static int list(int fd)
+{
+  if (fd < 0)
+  {
+    for (int id = 0; id < ROBOT_PARAMETER_COUNT; id++) printParameter(id, 0);
+    return 0;
+  }
+  if (!sendCommand(fd, "G#")) return 1;
+  char line[128];
+  for (int i = 0; i < ROBOT_PARAMETER_COUNT; i++)
+  {
+    long id, value, status;
+    if (!readReply(fd, "mG", line, sizeof(line), REPLY_TIMEOUT_MSEC))
+    {
+      fprintf(stderr, "no answer from the robot after %d parameters\n", i);
+      return 1;
+    }
+    if (!parseAnswer(line, &id, &value, &status) || id < 0 || id >= ROBOT_PARAMETER_COUNT) continue;
+    printParameter(id, &value);
+  }
+  return 0;
+}
+
+static int get(int fd, int count, char** names)
+{
+  int failures = 0;
+  for (int i = 0; i < count; i++)
+  {
+    int id = findParameter(names[i], strlen(names[i]));
+    if (id < 0)
+    {
+      fprintf(stderr, "%s: no such parameter\n", names[i]);
+      failures++;
+      continue;
+    }
+    char command[16], line[128];
+    snprintf(command, sizeof(command), "G%d#", id);
+    long answeredId, value, status;
+    if (!sendCommand(fd, command) || !readReply(fd, "mG", line, sizeof(line), REPLY_TIMEOUT_MSEC) ||
+        !parseAnswer(line, &answeredId, &value, &status) || answeredId != id || status != 0)
+    {
+      fprintf(stderr, "%s: no answer from the robot\n", names[i]);
+      failures++;
+      continue;
+    }
+    printParameter(id, &value);
+  }
+  return failures ? 1 : 0;
+}
+
+// name=value pairs, all checked against the ranges before any is sent
+static int set(int fd, int count, char** assignments)
+{
+  int ids[ROBOT_PARAMETER_COUNT];
+  long values[ROBOT_PARAMETER_COUNT];
+  if (count > ROBOT_PARAMETER_COUNT)
+  {
+    fprintf(stderr, "too many parameters\n");
+    return 1;
+  }
+  for (int i = 0; i < count; i++)
+  {
+    const char* equals = strchr(assignments[i], '=');
+    if (!equals)
+    {
+      fprintf(stderr, "%s: expected name=value\n", assignments[i]);
+      return 1;
+    }
+    ids[i] = findParameter(assignments[i], equals - assignments[i]);
+    if (ids[i] < 0)
+    {
+      fprintf(stderr, "%s: no such parameter\n", assignments[i]);
+      return 1;
+    }
+    const parameter& p = parameters[ids[i]];
+    if (!parseValue(ids[i], equals + 1, &values[i]) || values[i] < p.minimum || values[i] > p.maximum)
+    {
+      char minimum[24], maximum[24];
+      formatValue(ids[i], p.minimum, minimum, sizeof(minimum));
+      formatValue(ids[i], p.maximum, maximum, sizeof(maximum));
+      fprintf(stderr, "%s: %s takes %s to %s\n", assignments[i], p.name, minimum, maximum);
+      return 1;
+    }
+  }
+
+  int failures = 0;
+  for (int i = 0; i < count; i++)
+  {
+    char command[32], line[128];
+    snprintf(command, sizeof(command), "V%d,%ld#", ids[i], values[i]);
+    long id, value, status;
+    if (!sendCommand(fd, command) || !readReply(fd, "mV", line, sizeof(line), REPLY_TIMEOUT_MSEC) ||
+        !parseAnswer(line, &id, &value, &status) || id != ids[i])
+    {
+      fprintf(stderr, "%s: no answer from the robot\n", parameters[ids[i]].name);
+      failures++;
+      continue;
+    }
+    if (status != 0)
+    {
+      fprintf(stderr, "%s: %s\n", parameters[id].name, status < 3 ? statusText[status] : "refused");
+      failures++;
+    }
+    printParameter(id, &value);
+  }
+  return failures ? 1 : 0;
+}
+
+static int commit(int fd)
+{
+  char line[128];
+  if (!sendCommand(fd, "Z#C#")) return 1;
+  bool answered = readReply(fd, "mC", line, sizeof(line), COMMIT_TIMEOUT_MSEC);
+  sendCommand(fd, "z#");
+  long count, status;
+  if (!answered || sscanf(line + 2, "%ld,%ld", &count, &status) != 2)
+  {
+    fprintf(stderr, "no answer from the robot\n");
+    return 1;
+  }
+  static const char* commitText[] = { "written", "a byte did not read back as written", "not written", "busy, try again" };
+  printf("%ld parameters %s\n", count, status >= 0 && status < 4 ? commitText[status] : "not written");
+  return status == 0 ? 0 : 1;
+}
+
+static int usage()
+{
+  fprintf(stderr, "use: parameterTool [-p port] list\n"
+                  "     parameterTool -p port get name...\n"
+                  "     parameterTool -p port set name=value...\n"
+                  "     parameterTool -p port commit\n");
+  return 1;
+}
+
+int main(int argc, char** argv)
+{
+  const char* port = 0;
+  int argument = 1;
+  if (argument + 1 < argc && strcmp(argv[argument], "-p") == 0)
+  {
+    port = argv[argument + 1];
+    argument += 2;
+  }
+  if (argument >= argc) return usage();
+  const char* action = argv[argument++];
+  if (strcmp(action, "list") != 0 && !port) return usage();
+
+  int fd = -1;
+  if (port && (fd = openPort(port)) < 0) return 1;
+
+  int result;
+  if (strcmp(action, "list") == 0) result = list(fd);
+  else if (strcmp(action, "get") == 0) result = get(fd, argc - argument, argv + argument);
+  else if (strcmp(action, "set") == 0) result = set(fd, argc - argument, argv + argument);
+  else if (strcmp(action, "commit") == 0) result = commit(fd);
+  else result = usage();
+  if (fd >= 0) close(fd);
+  return result;
+}
@@ -0,0 +1,274 @@
+// powerSim - the power governor (libraries/RobotCommCore) against a model pack that sags under the drive motors
+//
+// The pack is a resting voltage behind an internal resistance, for a grid of charge levels and tired
+// packs.  Each drive motor is a winding resistance and a back EMF that follows the wheel's speed, which
+// the motor's torque against friction and inertia moves; the driver puts the bus voltage times the PWM
+// across it, so the pack supplies the PWM times the motor current, and a motor slowed harder than it
+// coasts brakes back into the pack.  The firmware's view is the board's: the bus and the current sense
+// through the ADC and its smoothing, the battery estimator every BATTERY_MSEC and the governor every
+// GOVERNOR_MSEC, as c_sensors and k_motorControl run them.
+// Each pack runs the same moves with the wheels set straight to the PWM asked for (the old way) and
+// through the governor: a full speed start, a full speed reversal, a spin on the spot, and backing out
+// of a stall, where both wheels are stuck while driving forward.
+//
+// Reported per move and pack, old and new: the lowest the bus went, the msec it spent under
+// POWER_BUS_MIN_MILLIVOLTS, and the msec until the wheels were at 90% of the speed they ended up at (or
+// turning backward, after a stall; the wheels come free STALL_BACK_MSEC / 2 into the move).  Exits 1 if through the governor the bus ever fell under
+// RESET_VOLTS, where the Mega's regulator drops out, or a stall could not be backed out of within
+// STALL_BACK_MSEC.
+//
+// build:
+//   g++ -O2 -DARDUINO=100 -I../arduino -I../../libraries/RobotCommCore -I../../libraries/RobotTelemetry
+//     -o powerSim powerSim.cpp ../arduino/hostArduino.cpp ../../libraries/RobotCommCore/powerGovernor.cpp
+//     ../../libraries/RobotCommCore/batteryEstimator.cpp
+// use:
+//   powerSim [-v]
+//     -v  the bus, PWM, current and the governor's cap and flags every GOVERNOR_MSEC of each move
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "Arduino.h"
+#include "batteryEstimator.h"
+#include "powerGovernor.h"
+
+// as c_sensors and k_motorControl set them up, with the EEPROM fallbacks for the voltages
+#define GOVERNOR_MSEC 10
+#define BATTERY_MSEC 100
+#define BUS_MIN_MILLIVOLTS 9000
+#define CURRENT_LIMIT_MA 6000
+#define CAPACITY_MAH 2200
+#define RESISTANCE_MILLIOHMS 100
+#define IDLE_MILLIAMPS 150
+#define REST_MILLIAMPS 100
+#define EMPTY_VOLTS 10.5
+#define FULL_VOLTS 13.0
+#define DIVIDER 3.2
+#define MILLIAMPS_PER_COUNT 38
+
+#define PHYSICS_USEC 100
+#define ADC_SMOOTHING 2.0        // msec, the background scanner's average
+#define MOTOR_OHMS 2.0           // a stall draws 6 A at 12 V
+#define MOTOR_EMF 11.4           // volts at full speed
+#define MOTOR_INERTIA 0.9        // amp seconds to reach full speed
+#define MOTOR_FRICTION 0.3       // amps
+#define MOTOR_DRAG 0.5           // amps at full speed
+#define IDLE_AMPS 0.15           // the Mega, bluetooth and gyro
+#define RESET_VOLTS 7.0
+#define MOVE_MSEC 1500
+#define STALL_BACK_MSEC 100
+
+static bool verbose;
+
+struct motorModel
+{
+  double speed;    // share of full speed, negative backward
+  double amps;     // through the winding, positive forward
+  bool stuck;
+
+  // the motor with volts across it for dt
+  void run(double volts, double dt)
+  {
+    amps = (volts - MOTOR_EMF * speed) / MOTOR_OHMS;
+    if (stuck)
+    {
+      speed = 0;
+      return;
+    }
+    double load = MOTOR_DRAG * speed;
+    if (speed != 0 || fabs(amps) > MOTOR_FRICTION) load += speed > 0 || (speed == 0 && amps > 0) ? MOTOR_FRICTION : -MOTOR_FRICTION;
+    double next = speed + (amps - load) * dt / MOTOR_INERTIA;
+    if ((speed > 0 && next < 0) || (speed < 0 && next > 0)) next = 0;  // friction stops it, not reverses it
+    speed = next;
+  }
+};
+
+struct boardModel
+{
+  double restingVolts, packOhms;
+  motorModel left, right;
+  int pwmLeft, pwmRight;
+  double bus, measuredBus, measuredLeft, measuredRight;  // volts and amps, the measured ones smoothed
+
+  // the bus with the motors where they are: the pack's voltage less its drop at the current the motors
+  // draw at that bus voltage
+  double solveBus()
+  {
+    double dl = pwmLeft / 255.0, dr = pwmRight / 255.0;
+    double numerator = restingVolts - packOhms * IDLE_AMPS
+                       + packOhms * (dl * MOTOR_EMF * left.speed + dr * MOTOR_EMF * right.speed) / MOTOR_OHMS;
+    return numerator / (1 + packOhms * (dl * dl + dr * dr) / MOTOR_OHMS);
+  }
+
+  void run(double dt)
+  {
+    bus = solveBus();
+    left.run(bus * pwmLeft / 255.0, dt);
+    right.run(bus * pwmRight / 255.0, dt);
+    double share = dt * 1000 / ADC_SMOOTHING;
+    measuredBus += (bus - measuredBus) * share;
+    measuredLeft += (fabs(left.amps) - measuredLeft) * share;
+    measuredRight += (fabs(right.amps) - measuredRight) * share;
+  }
+
+  int busCount() { return constrain((int) lround(measuredBus / DIVIDER / 5.0 * 1023), 0, 1023); }
+  long senseMilliAmps(double amps) { return lround(amps * 1000 / MILLIAMPS_PER_COUNT) * MILLIAMPS_PER_COUNT; }
+};
+
+struct move
+{
+  const char *name;
+  int fromLeft, fromRight;     // where the wheels were asked to go first, for MOVE_MSEC
+  bool stuck;                  // both wheels stuck until STALL_BACK_MSEC / 2 into the move
+  int requestLeft, requestRight;
+};
+
+struct moveResult
+{
+  double lowest;      // volts
+  int msecUnder;      // under BUS_MIN_MILLIVOLTS
+  int msecToSpeed;    // to 90% of where the wheels end up, or for a stall until both turn backward; -1 if never
+};
+
+struct firmware
+{
+  bool governed;
+  powerGovernor governor;
+  batteryEstimator battery;
+
+  firmware(bool governed) : governed(governed), governor(BUS_MIN_MILLIVOLTS, CURRENT_LIMIT_MA),
+    battery(CAPACITY_MAH, RESISTANCE_MILLIOHMS, IDLE_MILLIAMPS, REST_MILLIAMPS)
+  {
+    battery.begin(lround(EMPTY_VOLTS * 1000), lround(FULL_VOLTS * 1000), (unsigned long) lround(DIVIDER * 10) * 500000UL / 1023);
+  }
+
+  // what the firmware does at msec, with the motion routines asking for requestLeft, requestRight
+  void tick(boardModel& board, long msec, int requestLeft, int requestRight)
+  {
+    if (!governed)
+    {
+      board.pwmLeft = requestLeft;
+      board.pwmRight = requestRight;
+      return;
+    }
+    long driveMilliAmps = board.senseMilliAmps(board.measuredLeft) + board.senseMilliAmps(board.measuredRight);
+    if (msec % BATTERY_MSEC == 0) battery.update(board.busCount(), driveMilliAmps, BATTERY_MSEC);
+    governor.update(battery.busMilliVolts(board.busCount()), battery.headroomMilliVolts(), driveMilliAmps,
+                    requestLeft, requestRight);
+    board.pwmLeft = governor.limit(board.pwmLeft, requestLeft);
+    board.pwmRight = governor.limit(board.pwmRight, requestRight);
+  }
+};
+
+// the wheels are asked for the move's first speeds, then the ones measured; the result is for the second
+static moveResult runMove(boardModel& board, bool governed, const move& mv)
+{
+  firmware robot(governed);
+  robot.battery.update(board.busCount(), 0, BATTERY_MSEC);  // powered on at rest
+  board.left.stuck = board.right.stuck = mv.stuck;
+  for (long usec = 0; usec < MOVE_MSEC * 1000L; usec += PHYSICS_USEC)
+  {
+    if (usec % (GOVERNOR_MSEC * 1000L) == 0) robot.tick(board, usec / 1000, mv.fromLeft, mv.fromRight);
+    board.run(PHYSICS_USEC / 1e6);
+  }
+
+  moveResult result = { board.bus, 0, -1 };
+  static double leftSpeeds[MOVE_MSEC], rightSpeeds[MOVE_MSEC];
+  int usecUnder = 0;
+  for (long usec = 0; usec < MOVE_MSEC * 1000L; usec += PHYSICS_USEC)
+  {
+    long msec = usec / 1000;
+    if (usec % (GOVERNOR_MSEC * 1000L) == 0)
+    {
+      robot.tick(board, MOVE_MSEC + msec, mv.requestLeft, mv.requestRight);
+      if (verbose && governed)
+        printf("      %4ld msec  bus %5.2f V  pwm %4d %4d  %6.2f %6.2f A  cap %3d  flags %x\n", msec, board.bus,
+               board.pwmLeft, board.pwmRight, board.left.amps, board.right.amps, robot.governor.cap(), robot.governor.flags());
+    }
+    if (mv.stuck && usec == STALL_BACK_MSEC * 1000L / 2) board.left.stuck = board.right.stuck = false;
+    board.run(PHYSICS_USEC / 1e6);
+    if (board.bus < result.lowest) result.lowest = board.bus;
+    if (board.bus * 1000 < BUS_MIN_MILLIVOLTS) usecUnder += PHYSICS_USEC;
+    leftSpeeds[msec] = board.left.speed;
+    rightSpeeds[msec] = board.right.speed;
+  }
+  result.msecUnder = usecUnder / 1000;
+  for (int msec = 0; msec < MOVE_MSEC && result.msecToSpeed < 0; msec++)
+  {
+    bool there;
+    if (mv.stuck) there = leftSpeeds[msec] < 0 && rightSpeeds[msec] < 0;
+    else there = leftSpeeds[msec] * leftSpeeds[MOVE_MSEC - 1] > 0 && rightSpeeds[msec] * rightSpeeds[MOVE_MSEC - 1] > 0
+                 && fabs(leftSpeeds[msec]) >= 0.9 * fabs(leftSpeeds[MOVE_MSEC - 1])
+                 && fabs(rightSpeeds[msec]) >= 0.9 * fabs(rightSpeeds[MOVE_MSEC - 1]);
+    if (there) result.msecToSpeed = msec;
+  }
+  return result;
+}
+
+// a board powered on with the wheels still
+static boardModel boardAt(double restingVolts, double packOhms)
+{
+  boardModel board;
+  memset(&board, 0, sizeof(board));
+  board.restingVolts = restingVolts;
+  board.packOhms = packOhms;
+  board.bus = board.measuredBus = board.solveBus();
+  return board;
+}
+
+static const move moves[] =
+{
+  { "start", 0, 0, false, 255, 255 },
+  { "reverse", 255, 255, false, -255, -255 },
+  { "spin", 0, 0, false, 255, -255 },
+  { "back out of a stall", 255, 255, true, -255, -255 },
+};
+#define MOVE_COUNT (int) (sizeof(moves) / sizeof(moves[0]))
+static const double restingVolts[] = { 12.6, 11.8, 11.2, 10.8 };
+static const double packOhms[] = { 0.1, 0.25, 0.4, 0.6 };
+
+int main(int argc, char** argv)
+{
+  int option;
+  while ((option = getopt(argc, argv, "v")) != -1)
+  {
+    if (option == 'v') verbose = true;
+    else
+    {
+      fprintf(stderr, "use: powerSim [-v]\n");
+      return 1;
+    }
+  }
+
+  bool pass = true;
+  printf("the bus at its lowest, msec under %.1f V, msec to 90%% of the final speed\n", BUS_MIN_MILLIVOLTS / 1000.0);
+  for (int m = 0; m < MOVE_COUNT; m++)
+  {
+    const move& mv = moves[m];
+    printf("%s\n  pack           old: lowest  under  to speed  |  new: lowest  under  to speed\n", mv.name);
+    for (size_t v = 0; v < sizeof(restingVolts) / sizeof(restingVolts[0]); v++)
+      for (size_t o = 0; o < sizeof(packOhms) / sizeof(packOhms[0]); o++)
+      {
+        boardModel oldBoard = boardAt(restingVolts[v], packOhms[o]), newBoard = oldBoard;
+        moveResult before = runMove(oldBoard, false, mv);
+        if (verbose) printf("    %.1f V %.2f ohm through the governor:\n", restingVolts[v], packOhms[o]);
+        moveResult after = runMove(newBoard, true, mv);
+        printf("  %4.1f V %.2f ohm  %9.2f V %6d %9d  | %9.2f V %6d %9d\n", restingVolts[v], packOhms[o],
+               before.lowest, before.msecUnder, before.msecToSpeed, after.lowest, after.msecUnder, after.msecToSpeed);
+        if (after.lowest < RESET_VOLTS)
+        {
+          printf("    FAIL: the bus fell to %.2f V, the Mega resets under %.1f V\n", after.lowest, RESET_VOLTS);
+          pass = false;
+        }
+        if (mv.stuck && (after.msecToSpeed < 0 || after.msecToSpeed > STALL_BACK_MSEC))
+        {
+          printf("    FAIL: still not backing out of the stall after %d msec\n", after.msecToSpeed < 0 ? MOVE_MSEC : after.msecToSpeed);
+          pass = false;
+        }
+      }
+  }
+  printf("%s\n", pass ? "pass" : "FAIL");
+  return pass ? 0 : 1;
+}
@@ -0,0 +1,294 @@
+// rampStepperSim - the tilt stepper's ramps (libraries/rampStepper) on the board model's Timer1
+//
+// rampStepper runs on the board model in hostTools/arduino, whose Timer1 fires the library's own
+// interrupt routine at the compare matches it sets up, and each step is timed from the match it came at.
+// Each move is checked against the profile it should follow: the speed never above the top speed,
+// the acceleration and deceleration between steps within ACCEL_TOLERANCE of the one asked for (but for
+// the ACCEL_SKIP steps nearest a standstill, where AVR446's approximation is rough), the cruise at exactly
+// the top speed's interval, the stop exactly on the target with the driver disabled, and the whole move
+// within TIME_TOLERANCE of the ideal trapezoid or triangle.  moveTo() during a move must slow down to a
+// stop before turning round, and stop() must slow down rather than stop dead.
+// Reported per move: steps, time against the ideal, the worst acceleration error and the top speed.
+// Exits 1 if any move is off.
+//
+// build:
+//   g++ -O2 -DARDUINO=100 -I../arduino -I../../libraries/rampStepper -o rampStepperSim rampStepperSim.cpp
+//     ../arduino/hostArduino.cpp ../../libraries/rampStepper/rampStepper.cpp
+// use:
+//   rampStepperSim [-s top speed] [-a acceleration] [-v]
+//     -s  steps/sec (500, the firmware's)
+//     -a  steps/sec^2 (2000)
+//     -v  every step's time and speed
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <vector>
+#include "Arduino.h"
+#include "hostArduino.h"
+#include "rampStepper.h"
+
+#define STEP_PIN 6
+#define DIR_PIN 7
+#define DISABLE_PIN 8
+#define POLL_USEC 2              // no step comes sooner after another
+#define MOVE_TIMEOUT_USEC 20000000UL
+#define ACCEL_SKIP 4             // steps from a standstill not held to the tolerance
+#define ACCEL_TOLERANCE 0.15     // of the acceleration asked for, step to step
+#define TIME_TOLERANCE 0.05      // of the ideal move time
+#define SPEED_TOLERANCE 0.005    // over the top speed
+
+static bool verbose;
+static int failures;
+static double topSpeed = 500, acceleration = 2000;
+
+struct step
+{
+  double usec;
+  int direction;
+};
+
+static void check(bool ok, const char *format, double a, double b)
+{
+  if (ok) return;
+  printf("    FAIL: ");
+  printf(format, a, b);
+  printf("\n");
+  failures++;
+}
+
+// lets the stepper run until its timer stops or usec have gone by, and adds its steps to steps; the
+// timer keeps going for the last step's interval, after which it disables the driver or starts the
+// move a moveTo() left waiting
+static void runSteps(rampStepper& stepper, std::vector<step>& steps, unsigned long usec)
+{
+  long position = stepper.position();
+  for (unsigned long t = 0; t < usec; t += POLL_USEC)
+  {
+    hostAdvance(POLL_USEC);
+    long now = stepper.position();
+    if (now != position)
+    {
+      // the step came at the compare match, which restarted Timer1 from 0 (8 cycles a count)
+      step s = { (hostCycles() - TCNT1 * 8.0) / 16.0, now > position ? 1 : -1 };
+      steps.push_back(s);
+      if (verbose)
+      {
+        double interval = steps.size() > 1 ? s.usec - steps[steps.size() - 2].usec : 0;
+        printf("      %10.0f usec  position %5ld  %7.1f steps/sec\n", s.usec, now, interval > 0 ? 1e6 / interval : 0);
+      }
+      position = now;
+    }
+    if (!(TIMSK1 & (1 << OCIE1A))) return;
+  }
+}
+
+// the time a move of distance steps should take from standstill to standstill
+static double idealSeconds(long distance)
+{
+  double rampSteps = topSpeed * topSpeed / (2 * acceleration);
+  if (distance <= 2 * rampSteps) return 2 * sqrt(distance / acceleration);  // a triangle
+  return topSpeed / acceleration + distance / topSpeed;
+}
+
+// the speed between steps i - 1 and i, steps/sec
+static double speedAt(const std::vector<step>& steps, size_t i)
+{
+  return 1e6 / (steps[i].usec - steps[i - 1].usec);
+}
+
+// checks one leg of steps, all in one direction from standstill to standstill
+static void checkLeg(const char *name, const std::vector<step>& steps, size_t from, size_t to, bool whole)
+{
+  long distance = to - from;
+  double seconds = (steps[to - 1].usec - steps[from].usec) / 1e6;
+  double fastest = 0, worstAccel = 0;
+  size_t cruiseSteps = 0, cruiseOff = 0;
+  for (size_t i = from + 1; i < to; i++)
+  {
+    double speed = speedAt(steps, i);
+    if (speed > fastest) fastest = speed;
+    if (fabs(speed - topSpeed) < topSpeed * SPEED_TOLERANCE) cruiseSteps++;
+    if (i < from + 2) continue;
+    // speed change per second between the middles of the two intervals
+    double previous = speedAt(steps, i - 1);
+    double accel = fabs(speed - previous) / ((steps[i].usec - steps[i - 2].usec) / 2e6);
+    bool ramping = fabs(speed - previous) > topSpeed * SPEED_TOLERANCE;
+    if (!ramping) continue;
+    // near a standstill AVR446's steps are rough, and at a triangle's peak one step is traded between
+    // the ramps
+    if (fmin(speed, previous) < sqrt(2 * acceleration * ACCEL_SKIP)) continue;
+    if (i >= from + 3 && (speed > previous) != (previous > speedAt(steps, i - 2))) continue;
+    double error = fabs(accel - acceleration) / acceleration;
+    if (error > worstAccel) worstAccel = error;
+    if (error > ACCEL_TOLERANCE) cruiseOff++;
+  }
+  // AVR446 puts the steps where the ideal profile is half a step on, so the first comes half a step
+  // after the start and the last half a step before the end
+  double ideal = idealSeconds(distance) - idealSeconds(1);
+  printf("  %-24s %5ld steps  %.3f sec, ideal %.3f  worst accel error %4.1f%%  top %.1f steps/sec\n", name,
+         steps[to - 1].direction * distance, seconds, ideal, worstAccel * 100, fastest);
+  check(fastest <= topSpeed * (1 + SPEED_TOLERANCE), "faster than %.0f steps/sec: %.1f", topSpeed, fastest);
+  check(worstAccel <= ACCEL_TOLERANCE, "acceleration off by %.1f%%, more than %.0f%%", worstAccel * 100, ACCEL_TOLERANCE * 100);
+  if (whole) check(fabs(seconds - ideal) <= ideal * TIME_TOLERANCE + 0.002, "took %.3f sec, not %.3f", seconds, ideal);
+  if (whole && distance > 2 * topSpeed * topSpeed / (2 * acceleration) + 4)
+    check(cruiseSteps > 0, "never cruised at %.0f steps/sec (%.0f)", topSpeed, fastest);
+}
+
+// splits steps at each turn round and checks each leg; true if every turn round came from a stop
+static void checkLegs(const char *name, const std::vector<step>& steps, bool whole)
+{
+  size_t from = 0;
+  for (size_t i = 1; i <= steps.size(); i++)
+  {
+    if (i < steps.size() && steps[i].direction == steps[from].direction) continue;
+    if (i < steps.size())
+    {
+      // the last steps before turning round must be slow, as slow as a start
+      double speed = speedAt(steps, i - 1);
+      check(speed < sqrt(2 * acceleration * 4) * 1.5, "turned round from %.1f steps/sec, not from a stop (%.0f)", speed, 0);
+    }
+    if (i - from >= 2) checkLeg(name, steps, from, i, whole);
+    from = i;
+  }
+}
+
+static void checkStopped(rampStepper& stepper, long target)
+{
+  check(!stepper.running(), "still running %.0f%.0f", 0, 0);
+  check(stepper.position() == target, "stopped at %.0f, not %.0f", stepper.position(), target);
+  check(stepper.target() == target, "target left at %.0f, not %.0f", stepper.target(), target);
+  check(hostPin(DISABLE_PIN) == HIGH, "driver left enabled %.0f%.0f", 0, 0);
+}
+
+static rampStepper *start()
+{
+  hostReset();
+  static rampStepper stepper(STEP_PIN, DIR_PIN, DISABLE_PIN);
+  stepper.begin();
+  stepper.setMaxSpeed(topSpeed);
+  stepper.setAcceleration(acceleration);
+  stepper.setPosition(0);
+  return &stepper;
+}
+
+// from standstill to standstill: up to speed, a cruise, and down onto the target; and back
+static void longMoves()
+{
+  rampStepper& stepper = *start();
+  long targets[] = { 500, -300, 120 };
+  for (size_t t = 0; t < sizeof(targets) / sizeof(targets[0]); t++)
+  {
+    std::vector<step> steps;
+    long from = stepper.position();
+    stepper.moveTo(targets[t]);
+    check(hostPin(DISABLE_PIN) == LOW, "driver not enabled for the move %.0f%.0f", 0, 0);
+    check(hostPin(DIR_PIN) == (targets[t] < from ? HIGH : LOW), "direction pin %.0f for a move toward %.0f", hostPin(DIR_PIN), targets[t]);
+    runSteps(stepper, steps, MOVE_TIMEOUT_USEC);
+    check((long) steps.size() == labs(targets[t] - from), "%.0f steps for a move of %.0f", steps.size(), labs(targets[t] - from));
+    checkLegs("long move", steps, true);
+    checkStopped(stepper, targets[t]);
+  }
+}
+
+// too short to reach the top speed, so straight from speeding up to slowing down
+static void shortMoves()
+{
+  rampStepper& stepper = *start();
+  long distances[] = { 1, 2, 3, 10, 40 };
+  for (size_t d = 0; d < sizeof(distances) / sizeof(distances[0]); d++)
+  {
+    std::vector<step> steps;
+    long target = stepper.position() + distances[d];
+    stepper.moveTo(target);
+    runSteps(stepper, steps, MOVE_TIMEOUT_USEC);
+    check((long) steps.size() == distances[d], "%.0f steps for a move of %.0f", steps.size(), distances[d]);
+    if (steps.size() >= 2) checkLegs("short move", steps, distances[d] >= 10);
+    else printf("  %-24s %5ld steps\n", "short move", distances[d]);
+    checkStopped(stepper, target);
+  }
+}
+
+// a new target behind while cruising: slow down, stop, then go back
+static void preemptCruising()
+{
+  rampStepper& stepper = *start();
+  std::vector<step> steps;
+  stepper.moveTo(600);
+  while (stepper.position() < 300 && stepper.running()) runSteps(stepper, steps, 1000);
+  stepper.moveTo(100);
+  check(stepper.running(), "moveTo() stopped dead %.0f%.0f", 0, 0);
+  runSteps(stepper, steps, MOVE_TIMEOUT_USEC);
+  checkLegs("moveTo back, cruising", steps, false);
+  checkStopped(stepper, 100);
+}
+
+// a new target behind while still speeding up
+static void preemptAccelerating()
+{
+  rampStepper& stepper = *start();
+  std::vector<step> steps;
+  stepper.moveTo(600);
+  while (stepper.position() < 20 && stepper.running()) runSteps(stepper, steps, 100);
+  stepper.moveTo(-50);
+  runSteps(stepper, steps, MOVE_TIMEOUT_USEC);
+  checkLegs("moveTo back, speeding up", steps, false);
+  checkStopped(stepper, -50);
+}
+
+// a new target further on while cruising: slow down to a stop, then the rest as a move of its own
+static void preemptAhead()
+{
+  rampStepper& stepper = *start();
+  std::vector<step> steps;
+  stepper.moveTo(300);
+  while (stepper.position() < 150 && stepper.running()) runSteps(stepper, steps, 1000);
+  stepper.moveTo(700);
+  runSteps(stepper, steps, MOVE_TIMEOUT_USEC);
+  checkLegs("moveTo further on", steps, false);
+  checkStopped(stepper, 700);
+}
+
+// stop() slows down and stops short, with the target moved to where it stopped
+static void stopWhileCruising()
+{
+  rampStepper& stepper = *start();
+  std::vector<step> steps;
+  stepper.moveTo(1000);
+  while (stepper.position() < 300 && stepper.running()) runSteps(stepper, steps, 1000);
+  long stoppedFrom = stepper.position();
+  stepper.stop();
+  runSteps(stepper, steps, MOVE_TIMEOUT_USEC);
+  long rampSteps = (long) (topSpeed * topSpeed / (2 * acceleration));
+  checkLegs("stop() while cruising", steps, false);
+  check(labs(stepper.position() - stoppedFrom - rampSteps) <= 2, "stop() took %.0f steps to stop, not %.0f",
+        stepper.position() - stoppedFrom, rampSteps);
+  checkStopped(stepper, stepper.position());
+}
+
+int main(int argc, char** argv)
+{
+  int option;
+  while ((option = getopt(argc, argv, "s:a:v")) != -1)
+  {
+    switch (option)
+    {
+      case 's': topSpeed = atof(optarg); break;
+      case 'a': acceleration = atof(optarg); break;
+      case 'v': verbose = true; break;
+      default:
+        fprintf(stderr, "use: rampStepperSim [-s top speed] [-a acceleration] [-v]\n");
+        return 1;
+    }
+  }
+  printf("top speed %.0f steps/sec, acceleration %.0f steps/sec^2\n", topSpeed, acceleration);
+  longMoves();
+  shortMoves();
+  preemptCruising();
+  preemptAccelerating();
+  preemptAhead();
+  stopWhileCruising();
+  printf("%s\n", failures ? "FAIL" : "pass");
+  return failures ? 1 : 0;
+}
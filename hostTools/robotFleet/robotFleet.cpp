@@ -0,0 +1,617 @@
+// robotFleet - runs the links to many RobotComm robots from one program
+//
+// Every robot is on its own serial device (a bluetooth port, or a robotSim pty).  One epoll loop
+// drives all of them through robotLink, so a slow or dead robot never holds up the others.  Per robot:
+//   - a queue of commands from the clients, fed into the link's window (pipelined) in order;
+//     a full queue refuses the command at once rather than letting the delay grow
+//   - a health check: a comm check ('c') when the robot has been quiet for the check interval;
+//     after MISSED_CHECKS without an answer the robot is down, and the device is reopened every
+//     RECONNECT_MSEC until it answers again
+//   - its identity, from A# (customer number and bluetooth address), which becomes its name
+//   - the latest telemetry frame and the frame counts, when telemetry is turned on with -t
+//
+// Clients connect to a unix socket and send lines:
+//   <robot> <command>   queue a command; robot is an index, a name (bluetooth address), a device or *
+//   <robot> !           emergency stop, ahead of anything queued
+//   list                one line per robot: state, queue, round trips, battery
+//   telemetry           one line per robot with its latest frame, and a fleet total (with the frames
+//                       a second since the last time it was asked)
+//   watch               also send this client everything the robots report by themselves
+// and get back, for their own commands, "<name> e<command> <round trip usec>", every line the command
+// brings back as "<name> <line>", "<name> lost <command>" if it was never echoed, or "<name> busy"
+// or "<name> down" if it was not queued.  list and telemetry end with a line holding only ".".
+//
+// build:
+//   g++ -O2 -I../robotLink -I../../libraries/RobotTelemetry -o robotFleet robotFleet.cpp ../robotLink/robotLink.cpp
+// use:
+//   robotFleet [-s socket] [-c check msec] [-t rate,mask] device ...
+//   robotSim -n 24 -l /tmp/robot & robotFleet -t 10,127 /tmp/robot{0..23}
+//   socat - UNIX-CONNECT:/tmp/robotFleet     then type "list", "3 f200", "* x" ...
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+#include "robotLink.h"
+
+#define MAX_ROBOTS 256
+#define QUEUE_LIMIT 32             // commands waiting for a robot beyond its window
+#define TICK_MSEC 5                // how often the timers are looked at
+#define CHECK_MSEC 1000            // a robot quiet for this long gets a comm check
+#define MISSED_CHECKS 3
+#define ECHO_TIMEOUT_MICROS 1500000
+#define RECONNECT_MSEC 2000
+#define ROUND_TRIPS_KEPT 64        // for the percentiles in list
+#define CLIENT_OUTPUT_LIMIT (1 << 20)  // a client this far behind is dropped
+#define NO_CLIENT -1               // the fleet's own commands: checks, identity, telemetry setup
+
+// what an epoll event is for, in the top half of its data
+#define EVENT_LISTEN 0
+#define EVENT_TIMER 1
+#define EVENT_ROBOT 2
+#define EVENT_CLIENT 3
+
+struct queuedCommand
+{
+  std::string text;
+  int client;
+};
+
+struct fleetRobot
+{
+  std::string device, name;
+  robotLink link;
+  bool up;
+  uint32_t events;                   // what epoll is watching for now
+  int64_t lastHeard, nextReconnect;
+  int missedChecks;
+  long checkSequence;
+  std::vector<queuedCommand> queue;  // oldest first
+  std::map<long, int> owner;         // sequence number to the client that sent it
+  long lastOwnedSequence;
+  int lastOwner;
+  unsigned long commands, lost;
+  std::vector<long> roundTrips;      // the last ROUND_TRIPS_KEPT, a ring
+  size_t nextRoundTrip;
+  int battery;                       // percent, from the comm checks
+  unsigned long frames;
+  int64_t lastFrameMicros;
+  uint8_t frame[TELEMETRY_MAX_FRAME_LENGTH];
+  int frameLength;
+};
+
+struct fleetClient
+{
+  int fd;
+  bool watching, writing;
+  std::string in, out;
+};
+
+static std::vector<fleetRobot*> robots;
+static std::map<int, fleetClient*> clients;
+static int epoll, checkMsec = CHECK_MSEC;
+static const char* telemetrySetup = 0;
+static volatile sig_atomic_t stopping = 0;
+
+static void onSignal(int)
+{
+  stopping = 1;
+}
+
+static uint64_t tag(int kind, int index)
+{
+  return ((uint64_t) kind << 32) | (uint32_t) index;
+}
+
+static void toClient(int client, const std::string& line)
+{
+  std::map<int, fleetClient*>::iterator c = clients.find(client);
+  if (c == clients.end()) return;
+  c->second->out += line;
+  c->second->out += '\n';
+}
+
+static void toWatchers(const std::string& line)
+{
+  for (std::map<int, fleetClient*>::iterator c = clients.begin(); c != clients.end(); ++c)
+  {
+    if (c->second->watching) toClient(c->first, line);
+  }
+}
+
+static void logEvent(const fleetRobot& r, const char* what)
+{
+  printf("%s %s %s\n", r.name.c_str(), r.device.c_str(), what);
+  fflush(stdout);
+  toWatchers(r.name + " " + what);
+}
+
+// epoll watches for writable only while there is something to write
+static void watch(int index)
+{
+  fleetRobot& r = *robots[index];
+  uint32_t events = r.link.fd() < 0 ? 0 : EPOLLIN | (r.link.wantsWrite() ? (uint32_t) EPOLLOUT : 0);
+  if (events == r.events) return;
+  epoll_event e;
+  e.events = events;
+  e.data.u64 = tag(EVENT_ROBOT, index);
+  if (r.events == 0) epoll_ctl(epoll, EPOLL_CTL_ADD, r.link.fd(), &e);
+  else if (events == 0) epoll_ctl(epoll, EPOLL_CTL_DEL, r.link.fd(), &e);
+  else epoll_ctl(epoll, EPOLL_CTL_MOD, r.link.fd(), &e);
+  r.events = events;
+}
+
+static long sendOwned(fleetRobot& r, const std::string& text, int client)
+{
+  long sequence = r.link.send(text.c_str());
+  if (sequence >= 0) r.owner[sequence] = client;
+  return sequence;
+}
+
+static void connect(int index, int64_t now)
+{
+  fleetRobot& r = *robots[index];
+  r.nextReconnect = now + RECONNECT_MSEC * 1000L;
+  r.events = 0;
+  if (access(r.device.c_str(), R_OK | W_OK) != 0) return;  // quietly, until the device is back
+  if (!r.link.open(r.device.c_str())) return;
+  r.up = true;
+  r.lastHeard = now;
+  r.missedChecks = 0;
+  r.checkSequence = -1;
+  r.owner.clear();
+  sendOwned(r, "A", NO_CLIENT);
+  if (telemetrySetup) sendOwned(r, std::string("T") + telemetrySetup, NO_CLIENT);
+  logEvent(r, "up");
+  watch(index);
+}
+
+static void disconnect(int index, int64_t now)
+{
+  fleetRobot& r = *robots[index];
+  if (r.events) epoll_ctl(epoll, EPOLL_CTL_DEL, r.link.fd(), 0);
+  r.events = 0;
+  r.link.close();
+  for (size_t i = 0; i < r.queue.size(); i++) toClient(r.queue[i].client, r.name + " down " + r.queue[i].text);
+  r.queue.clear();
+  r.owner.clear();
+  r.nextReconnect = now + RECONNECT_MSEC * 1000L;
+  if (r.up) logEvent(r, "down");
+  r.up = false;
+}
+
+// the window is refilled from the queue, in order
+static void feed(fleetRobot& r)
+{
+  size_t taken = 0;
+  while (taken < r.queue.size() && r.link.canSend())
+  {
+    sendOwned(r, r.queue[taken].text, r.queue[taken].client);
+    taken++;
+  }
+  r.queue.erase(r.queue.begin(), r.queue.begin() + taken);
+}
+
+static void takeReplies(int index, int64_t now)
+{
+  fleetRobot& r = *robots[index];
+  robotReply reply;
+  char text[64];
+  while (r.link.nextReply(reply))
+  {
+    int client = NO_CLIENT;
+    std::map<long, int>::iterator o = r.owner.find(reply.sequence);
+    if (o != r.owner.end()) client = o->second;
+    else if (reply.sequence == r.lastOwnedSequence) client = r.lastOwner;  // more lines for the same command
+    if (reply.type != ROBOT_REPLY_LOST) r.lastHeard = now;
+    switch (reply.type)
+    {
+      case ROBOT_REPLY_ECHO:
+        r.commands++;
+        if (r.roundTrips.size() < ROUND_TRIPS_KEPT) r.roundTrips.push_back(reply.roundTripMicros);
+        else r.roundTrips[r.nextRoundTrip++ % ROUND_TRIPS_KEPT] = reply.roundTripMicros;
+        if (reply.text[0] == 'c') r.battery = atoi(reply.text.c_str() + 1);
+        if (reply.sequence == r.checkSequence)
+        {
+          r.missedChecks = 0;
+          r.checkSequence = -1;
+        }
+        if (o != r.owner.end()) r.owner.erase(o);
+        r.lastOwnedSequence = reply.sequence;
+        r.lastOwner = client;
+        snprintf(text, sizeof(text), " %ld", reply.roundTripMicros);
+        toClient(client, r.name + " e" + reply.text + text);
+        break;
+      case ROBOT_REPLY_LINE:
+        if (reply.text.compare(0, 2, "mA") == 0)  // identity: customer number, bluetooth address
+        {
+          size_t comma = reply.text.find(',');
+          if (comma != std::string::npos && comma + 1 < reply.text.size())
+          {
+            std::string name = reply.text.substr(comma + 1);
+            if (name != r.name)
+            {
+              logEvent(r, ("is " + name).c_str());
+              r.name = name;
+            }
+          }
+        }
+        if (client != NO_CLIENT) toClient(client, r.name + " " + reply.text);
+        else toWatchers(r.name + " " + reply.text);
+        break;
+      case ROBOT_REPLY_FRAME:
+        r.frames++;
+        r.lastFrameMicros = now;
+        memcpy(r.frame, reply.frame, reply.frameLength);
+        r.frameLength = reply.frameLength;
+        break;
+      case ROBOT_REPLY_LOST:
+        r.lost++;
+        if (reply.sequence == r.checkSequence)
+        {
+          r.missedChecks++;
+          r.checkSequence = -1;
+        }
+        if (o != r.owner.end()) r.owner.erase(o);
+        toClient(client, r.name + " lost " + reply.text);
+        break;
+    }
+  }
+}
+
+static void serviceRobot(int index, int64_t now)
+{
+  fleetRobot& r = *robots[index];
+  if (!r.up)
+  {
+    if (now >= r.nextReconnect) connect(index, now);
+    return;
+  }
+  r.link.expire(ECHO_TIMEOUT_MICROS);
+  takeReplies(index, now);
+  if (r.missedChecks >= MISSED_CHECKS)
+  {
+    disconnect(index, now);
+    return;
+  }
+  feed(r);
+  if (r.checkSequence < 0 && r.link.inFlight() == 0 && now - r.lastHeard >= checkMsec * 1000L)
+  {
+    r.checkSequence = sendOwned(r, "c", NO_CLIENT);
+    r.lastHeard = now;  // the next check is an interval after this one
+  }
+  if (!r.link.flush()) disconnect(index, now);
+  else watch(index);
+}
+
+static void readRobot(int index, uint32_t events, int64_t now)
+{
+  fleetRobot& r = *robots[index];
+  if (!r.up) return;  // went down earlier in this pass
+  if ((events & EPOLLOUT) && !r.link.flush())
+  {
+    disconnect(index, now);
+    return;
+  }
+  if ((events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && !r.link.receive())
+  {
+    disconnect(index, now);
+    return;
+  }
+  serviceRobot(index, now);
+}
+
+// a percentile of the round trips kept
+static long roundTrip(const fleetRobot& r, double fraction)
+{
+  if (r.roundTrips.empty()) return 0;
+  std::vector<long> sorted(r.roundTrips);
+  std::sort(sorted.begin(), sorted.end());
+  return sorted[(size_t) (fraction * (sorted.size() - 1) + 0.5)];
+}
+
+static void list(int client)
+{
+  char line[256];
+  for (size_t i = 0; i < robots.size(); i++)
+  {
+    const fleetRobot& r = *robots[i];
+    snprintf(line, sizeof(line), "%zu %s %s %s queued %zu in flight %d commands %lu lost %lu round trip p50 %ld max %ld battery %d",
+             i, r.name.c_str(), r.device.c_str(), r.up ? "up" : "down", r.queue.size(), r.link.inFlight(),
+             r.commands, r.lost, roundTrip(r, 0.5), roundTrip(r, 1), r.battery);
+    toClient(client, line);
+  }
+  toClient(client, ".");
+}
+
+static unsigned fieldAt(const fleetRobot& r, uint8_t channel, int offset, int bytes)
+{
+  uint8_t mask = r.frame[2];
+  if (!(mask & channel)) return 0;
+  const uint8_t* p = &r.frame[TELEMETRY_HEADER_LENGTH];
+  for (uint8_t bit = 1; bit < channel; bit <<= 1)
+  {
+    if (mask & bit) p += telemetryChannelLength(bit);
+  }
+  unsigned value = 0;
+  for (int i = bytes - 1; i >= 0; i--) value = (value << 8) | p[offset + i];
+  return value;
+}
+
+static void telemetry(int client, int64_t now)
+{
+  static int64_t lastAsked = 0;
+  static unsigned long lastFrames = 0;
+  char line[256];
+  unsigned long frames = 0, lost = 0;
+  int up = 0;
+  for (size_t i = 0; i < robots.size(); i++)
+  {
+    const fleetRobot& r = *robots[i];
+    frames += r.frames;
+    lost += r.link.framesLost();
+    if (r.up) up++;
+    if (r.frameLength == 0) continue;
+    snprintf(line, sizeof(line), "%zu %s millis %u battery %u bus %u state 0x%02X frames %lu lost %lu age %ld",
+             i, r.name.c_str(), fieldAt(r, TELEMETRY_TIMESTAMP, 0, 4), fieldAt(r, TELEMETRY_BATTERY, 0, 2),
+             fieldAt(r, TELEMETRY_POWER, 0, 2), fieldAt(r, TELEMETRY_STATE, 0, 1), r.frames, r.link.framesLost(),
+             (long) ((now - r.lastFrameMicros) / 1000));
+    toClient(client, line);
+  }
+  double seconds = lastAsked ? (now - lastAsked) / 1e6 : 0;
+  snprintf(line, sizeof(line), "fleet up %d of %zu frames %lu lost %lu frames/sec %.1f", up, robots.size(), frames,
+           lost, seconds > 0 ? (frames - lastFrames) / seconds : 0);
+  lastAsked = now;
+  lastFrames = frames;
+  toClient(client, line);
+  toClient(client, ".");
+}
+
+static bool matches(const fleetRobot& r, size_t index, const std::string& target)
+{
+  if (target == "*") return true;
+  if (!target.empty() && target.find_first_not_of("0123456789") == std::string::npos) return (size_t) atoi(target.c_str()) == index;
+  return target == r.name || target == r.device;
+}
+
+static void clientLine(int client, const std::string& line, int64_t now)
+{
+  if (line.empty()) return;
+  if (line == "list") return list(client);
+  if (line == "telemetry") return telemetry(client, now);
+  if (line == "watch")
+  {
+    clients[client]->watching = !clients[client]->watching;
+    return;
+  }
+  size_t space = line.find(' ');
+  if (space == std::string::npos)
+  {
+    toClient(client, "? " + line);
+    return;
+  }
+  std::string target = line.substr(0, space), command;
+  for (size_t i = space + 1; i < line.size(); i++)
+  {
+    if (line[i] != ' ' && line[i] != '#' && line[i] != '\r') command += line[i];
+  }
+  bool found = false;
+  for (size_t i = 0; i < robots.size(); i++)
+  {
+    fleetRobot& r = *robots[i];
+    if (!matches(r, i, target)) continue;
+    found = true;
+    if (!r.up) toClient(client, r.name + " down " + command);
+    else if (command == "!")
+    {
+      r.queue.clear();  // anything still waiting would undo the stop
+      r.link.emergencyStop();
+    }
+    else if (r.queue.size() >= QUEUE_LIMIT) toClient(client, r.name + " busy " + command);
+    else
+    {
+      queuedCommand q = { command, client };
+      r.queue.push_back(q);
+      serviceRobot(i, now);
+    }
+  }
+  if (!found) toClient(client, "? " + target);
+}
+
+static void dropClient(int fd)
+{
+  std::map<int, fleetClient*>::iterator c = clients.find(fd);
+  if (c == clients.end()) return;
+  epoll_ctl(epoll, EPOLL_CTL_DEL, fd, 0);
+  close(fd);
+  delete c->second;
+  clients.erase(c);
+  for (size_t i = 0; i < robots.size(); i++)  // its commands still run, the answers go nowhere
+  {
+    for (std::map<long, int>::iterator o = robots[i]->owner.begin(); o != robots[i]->owner.end(); ++o)
+    {
+      if (o->second == fd) o->second = NO_CLIENT;
+    }
+    for (size_t q = 0; q < robots[i]->queue.size(); q++)
+    {
+      if (robots[i]->queue[q].client == fd) robots[i]->queue[q].client = NO_CLIENT;
+    }
+    if (robots[i]->lastOwner == fd) robots[i]->lastOwner = NO_CLIENT;
+  }
+}
+
+static void readClient(int fd, int64_t now)
+{
+  fleetClient& c = *clients[fd];
+  char buffer[1024];
+  ssize_t count = read(fd, buffer, sizeof(buffer));
+  if (count <= 0)
+  {
+    if (count < 0 && (errno == EAGAIN || errno == EINTR)) return;
+    dropClient(fd);
+    return;
+  }
+  c.in.append(buffer, count);
+  size_t end;
+  while (clients.count(fd) && (end = c.in.find('\n')) != std::string::npos)
+  {
+    std::string line = c.in.substr(0, end);
+    c.in.erase(0, end + 1);
+    if (!line.empty() && line[line.size() - 1] == '\r') line.erase(line.size() - 1);
+    clientLine(fd, line, now);
+  }
+}
+
+// client output goes out after every pass of the loop
+static void flushClients()
+{
+  std::vector<int> dead;
+  for (std::map<int, fleetClient*>::iterator i = clients.begin(); i != clients.end(); ++i)
+  {
+    fleetClient& c = *i->second;
+    while (!c.out.empty())
+    {
+      ssize_t written = write(c.fd, c.out.data(), c.out.size());
+      if (written < 0 && errno == EINTR) continue;
+      if (written < 0 && errno == EAGAIN) break;
+      if (written <= 0)
+      {
+        dead.push_back(c.fd);
+        break;
+      }
+      c.out.erase(0, written);
+    }
+    if (c.writing != !c.out.empty())  // epoll watches for writable only while there is something to write
+    {
+      c.writing = !c.out.empty();
+      epoll_event e;
+      e.events = EPOLLIN | (c.writing ? (uint32_t) EPOLLOUT : 0);
+      e.data.u64 = tag(EVENT_CLIENT, c.fd);
+      epoll_ctl(epoll, EPOLL_CTL_MOD, c.fd, &e);
+    }
+    if (c.out.size() > CLIENT_OUTPUT_LIMIT) dead.push_back(c.fd);
+  }
+  for (size_t i = 0; i < dead.size(); i++) dropClient(dead[i]);
+}
+
+static int listenOn(const char* path)
+{
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  snprintf(address.sun_path, sizeof(address.sun_path), "%s", path);
+  unlink(path);
+  if (fd < 0 || bind(fd, (sockaddr*) &address, sizeof(address)) < 0 || listen(fd, 16) < 0)
+  {
+    perror(path);
+    return -1;
+  }
+  return fd;
+}
+
+int main(int argc, char** argv)
+{
+  const char* socketPath = "/tmp/robotFleet";
+  int option;
+  while ((option = getopt(argc, argv, "s:c:t:")) != -1)
+  {
+    switch (option)
+    {
+      case 's': socketPath = optarg; break;
+      case 'c': checkMsec = atoi(optarg); break;
+      case 't': telemetrySetup = optarg; break;
+      default: optind = argc + 1; break;
+    }
+  }
+  if (optind >= argc || argc - optind > MAX_ROBOTS)
+  {
+    fprintf(stderr, "use: robotFleet [-s socket] [-c check msec] [-t rate,mask] device ...  (up to %d)\n", MAX_ROBOTS);
+    return 1;
+  }
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+  signal(SIGPIPE, SIG_IGN);
+
+  epoll = epoll_create1(EPOLL_CLOEXEC);
+  int listener = listenOn(socketPath);
+  if (epoll < 0 || listener < 0) return 1;
+  int timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  itimerspec tick = { { 0, TICK_MSEC * 1000000L }, { 0, TICK_MSEC * 1000000L } };
+  timerfd_settime(timer, 0, &tick, 0);
+  epoll_event e;
+  e.events = EPOLLIN;
+  e.data.u64 = tag(EVENT_LISTEN, 0);
+  epoll_ctl(epoll, EPOLL_CTL_ADD, listener, &e);
+  e.data.u64 = tag(EVENT_TIMER, 0);
+  epoll_ctl(epoll, EPOLL_CTL_ADD, timer, &e);
+
+  int64_t now = robotLink::micros();
+  for (int i = optind; i < argc; i++)
+  {
+    fleetRobot* r = new fleetRobot();
+    r->device = r->name = argv[i];
+    r->up = false;
+    r->events = 0;
+    r->nextReconnect = now;
+    r->checkSequence = r->lastOwnedSequence = -1;
+    r->lastOwner = NO_CLIENT;
+    r->commands = r->lost = r->frames = 0;
+    r->nextRoundTrip = 0;
+    r->battery = -1;
+    r->frameLength = 0;
+    robots.push_back(r);
+    connect(robots.size() - 1, now);
+  }
+
+  epoll_event ready[64];
+  while (!stopping)
+  {
+    int count = epoll_wait(epoll, ready, 64, -1);
+    if (count < 0 && errno != EINTR) break;
+    now = robotLink::micros();
+    for (int i = 0; i < count; i++)
+    {
+      int kind = ready[i].data.u64 >> 32, index = (uint32_t) ready[i].data.u64;
+      if (kind == EVENT_ROBOT) readRobot(index, ready[i].events, now);
+      else if (kind == EVENT_CLIENT)
+      {
+        if (clients.count(index) && (ready[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))) readClient(index, now);
+      }
+      else if (kind == EVENT_LISTEN)
+      {
+        int fd;
+        while ((fd = accept4(listener, 0, 0, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+        {
+          fleetClient* c = new fleetClient();
+          c->fd = fd;
+          c->watching = c->writing = false;
+          clients[fd] = c;
+          e.events = EPOLLIN;
+          e.data.u64 = tag(EVENT_CLIENT, fd);
+          epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &e);
+        }
+      }
+      else if (kind == EVENT_TIMER)
+      {
+        uint64_t expirations;
+        if (read(timer, &expirations, sizeof(expirations)) < 0) continue;
+        for (size_t r = 0; r < robots.size(); r++) serviceRobot(r, now);
+      }
+    }
+    flushClients();
+  }
+
+  unlink(socketPath);
+  return 0;
+}
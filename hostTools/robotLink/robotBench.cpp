@@ -0,0 +1,104 @@
+// robotBench - round trip latency and throughput of the RobotComm link
+//
+// Sends the same command over and over through robotLink, keeping the window full, and times every
+// echo.  Reports the round trip percentiles and the commands per second sustained.  A window of 1
+// is the old send and wait way of talking to the robot, so running both shows what pipelining buys.
+// Run against robotSim this is the standard benchmark for the link and for the firmware's command
+// loop (robotBench.sh does both windows); run against a robot it measures the real thing.
+//
+// build:
+//   g++ -O2 -I../../libraries/RobotTelemetry -o robotBench robotBench.cpp robotLink.cpp
+// use:
+//   robotBench -p port [-n commands] [-w window] [-c command] [-r]
+//     -n  commands to time (500), after 10 that are not counted
+//     -c  the command (G1, which reads a parameter and changes nothing)
+//     -r  one line for scripts: window commands lost p50 p90 p99 max (usec) commands/sec
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <vector>
+#include "robotLink.h"
+
+#define WARMUP_COMMANDS 10
+#define LOST_MICROS 2000000
+
+static long percentile(const std::vector<long>& sorted, double fraction)
+{
+  if (sorted.empty()) return 0;
+  size_t index = (size_t) (fraction * (sorted.size() - 1) + 0.5);
+  return sorted[index];
+}
+
+int main(int argc, char** argv)
+{
+  const char* port = 0;
+  const char* command = "G1";
+  int count = 500, window = ROBOT_LINK_WINDOW, option;
+  bool raw = false;
+  while ((option = getopt(argc, argv, "p:n:w:c:r")) != -1)
+  {
+    switch (option)
+    {
+      case 'p': port = optarg; break;
+      case 'n': count = atoi(optarg); break;
+      case 'w': window = atoi(optarg); break;
+      case 'c': command = optarg; break;
+      case 'r': raw = true; break;
+      default: port = 0; break;
+    }
+  }
+  if (!port || count < 1 || window < 1)
+  {
+    fprintf(stderr, "use: robotBench -p port [-n commands] [-w window] [-c command] [-r]\n");
+    return 1;
+  }
+  robotLink link;
+  if (!link.open(port)) return 1;
+  link.setWindow(window);
+
+  std::vector<long> roundTrips;
+  roundTrips.reserve(count);
+  int sent = 0, done = 0, lost = 0, total = count + WARMUP_COMMANDS;
+  int64_t start = 0;
+  while (done < total)
+  {
+    while (sent < total && link.canSend())
+    {
+      if (link.send(command) < 0) return 1;
+      sent++;
+    }
+    if (!link.wait(LOST_MICROS / 1000) && link.expire(0) == 0)
+    {
+      fprintf(stderr, "the link closed\n");
+      return 1;
+    }
+    link.expire(LOST_MICROS);
+    robotReply reply;
+    while (link.nextReply(reply))
+    {
+      if (reply.type != ROBOT_REPLY_ECHO && reply.type != ROBOT_REPLY_LOST) continue;
+      done++;
+      if (done == WARMUP_COMMANDS) start = robotLink::micros();  // the window is full from here on
+      if (done <= WARMUP_COMMANDS) continue;
+      if (reply.type == ROBOT_REPLY_LOST) lost++;
+      else roundTrips.push_back(reply.roundTripMicros);
+    }
+  }
+  double seconds = (robotLink::micros() - start) / 1e6;
+
+  std::sort(roundTrips.begin(), roundTrips.end());
+  double rate = seconds > 0 ? count / seconds : 0;
+  if (raw)
+  {
+    printf("%d %d %d %ld %ld %ld %ld %.1f\n", window, count, lost, percentile(roundTrips, 0.5),
+           percentile(roundTrips, 0.9), percentile(roundTrips, 0.99), percentile(roundTrips, 1), rate);
+    return lost ? 2 : 0;
+  }
+  printf("%d x %s#, window %d, %d lost\n", count, command, window, lost);
+  printf("round trip msec  p50 %.2f  p90 %.2f  p99 %.2f  max %.2f\n", percentile(roundTrips, 0.5) / 1000.,
+         percentile(roundTrips, 0.9) / 1000., percentile(roundTrips, 0.99) / 1000., percentile(roundTrips, 1) / 1000.);
+  printf("%.1f commands/sec\n", rate);
+  return lost ? 2 : 0;
+}
@@ -0,0 +1,30 @@
+#!/bin/sh
+# robotBench.sh - the standard link benchmark: robotBench against robotSim, send and wait against pipelined
+#
+# Builds the tools into a temporary directory, starts one simulated robot with the firmware's
+# timing, and times the same commands with a window of 1 and with the default window.
+# use:
+#   robotBench.sh [commands] [robotSim options]      e.g. robotBench.sh 1000 -b 0 -i 0 for the host side alone
+
+set -e
+here=$(cd "$(dirname "$0")" && pwd)
+libraries="$here/../../libraries"
+build=$(mktemp -d)
+trap 'kill $sim 2>/dev/null; rm -rf "$build"' EXIT
+
+count=${1:-500}
+[ $# -gt 0 ] && shift
+
+g++ -O2 -I"$libraries/RobotParameters" -I"$libraries/RobotTelemetry" -o "$build/robotSim" "$here/robotSim.cpp"
+g++ -O2 -I"$libraries/RobotTelemetry" -o "$build/robotBench" "$here/robotBench.cpp" "$here/robotLink.cpp"
+
+"$build/robotSim" "$@" > "$build/ptys" &
+sim=$!
+while [ ! -s "$build/ptys" ]; do sleep 0.1; done
+pty=$(awk '{ print $3; exit }' "$build/ptys")
+
+echo "window  commands  lost  p50 usec  p90 usec  p99 usec  max usec  commands/sec"
+for window in 1 8; do
+  "$build/robotBench" -p "$pty" -n "$count" -w "$window" -r |
+    awk '{ printf "%6d  %8d  %4d  %8d  %8d  %8d  %8d  %12.1f\n", $1, $2, $3, $4, $5, $6, $7, $8 }'
+done
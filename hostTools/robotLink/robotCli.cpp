@@ -0,0 +1,153 @@
+// robotCli - sends RobotComm commands from the command line or stdin, and shows what comes back
+//
+// Commands are sent pipelined through robotLink, up to the window at a time, and each echo is shown
+// with its round trip; the replies that follow it are shown under it, telemetry frames as one line
+// each.  A command of "!" is the emergency stop.  With no commands on the command line they are read
+// from stdin, one per line, so it can be used by hand or fed a script.
+//
+// build:
+//   g++ -O2 -I../../libraries/RobotTelemetry -o robotCli robotCli.cpp robotLink.cpp
+// use:
+//   robotCli -p port [-w window] [-q quiet msec] [command ...]
+//   robotCli -p /dev/rfcomm0 Z# V1,200# G1# C#
+//   robotCli -p /dev/rfcomm0 < tuning.txt
+
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "robotLink.h"
+
+#define QUIET_MSEC 300   // after the last command, how long to wait for more replies
+#define LOST_MICROS 2000000
+
+static void show(robotLink& link)
+{
+  robotReply reply;
+  while (link.nextReply(reply))
+  {
+    switch (reply.type)
+    {
+      case ROBOT_REPLY_ECHO:
+        printf("[%ld] %s  (%.1f msec)\n", reply.sequence, reply.text.c_str(), reply.roundTripMicros / 1000.);
+        break;
+      case ROBOT_REPLY_LINE:
+        printf("     %s\n", reply.text.c_str());
+        break;
+      case ROBOT_REPLY_FRAME:
+        printf("     telemetry mask 0x%02X sequence %d, %d bytes\n", reply.frame[2], reply.frame[3], reply.frameLength);
+        break;
+      case ROBOT_REPLY_LOST:
+        printf("[%ld] %s  lost, no echo\n", reply.sequence, reply.text.c_str());
+        break;
+    }
+  }
+  fflush(stdout);
+}
+
+// the command without its '#', false for a blank line
+static bool trim(const char* text, char* command, size_t size)
+{
+  size_t length = 0;
+  for (; *text && *text != '#' && length < size - 1; text++)
+  {
+    if (*text != ' ' && *text != '\t' && *text != '\r' && *text != '\n') command[length++] = *text;
+  }
+  command[length] = 0;
+  return length > 0;
+}
+
+static bool sendOne(robotLink& link, const char* text)
+{
+  char command[ROBOT_LINK_MAX_COMMAND + 1];
+  if (!trim(text, command, sizeof(command))) return true;
+  if (strcmp(command, "!") == 0) return link.emergencyStop();
+  while (!link.canSend())  // the window is full, wait for an echo
+  {
+    link.wait(100);
+    link.expire(LOST_MICROS);
+    show(link);
+  }
+  return link.send(command) >= 0;
+}
+
+int main(int argc, char** argv)
+{
+  const char* port = 0;
+  int quietMsec = QUIET_MSEC, option;
+  robotLink link;
+  while ((option = getopt(argc, argv, "p:w:q:")) != -1)
+  {
+    switch (option)
+    {
+      case 'p': port = optarg; break;
+      case 'w': link.setWindow(atoi(optarg)); break;
+      case 'q': quietMsec = atoi(optarg); break;
+      default: port = 0; optind = argc + 1; break;
+    }
+  }
+  if (!port || optind > argc)
+  {
+    fprintf(stderr, "use: robotCli -p port [-w window] [-q quiet msec] [command ...]\n");
+    return 1;
+  }
+  if (!link.open(port)) return 1;
+
+  if (optind < argc)
+  {
+    for (int i = optind; i < argc; i++)
+    {
+      if (!sendOne(link, argv[i])) return 1;
+    }
+  }
+  else
+  {
+    char line[512];
+    size_t length = 0;
+    bool reading = true;
+    pollfd input[2] = { { 0, POLLIN, 0 }, { link.fd(), POLLIN, 0 } };
+    while (reading)  // replies keep showing while waiting at the keyboard
+    {
+      input[1].events = POLLIN | (link.wantsWrite() ? POLLOUT : 0);
+      if (poll(input, 2, -1) < 0) break;
+      if (input[1].revents)
+      {
+        if ((input[1].revents & POLLOUT) && !link.flush()) break;
+        if ((input[1].revents & (POLLIN | POLLHUP | POLLERR)) && !link.receive()) break;
+        show(link);
+      }
+      if (input[0].revents)
+      {
+        ssize_t count = read(0, line + length, sizeof(line) - 1 - length);  // not stdio, its buffer would hide lines from poll
+        if (count <= 0)
+        {
+          line[length] = 0;  // a last line without its end
+          sendOne(link, line);
+          break;
+        }
+        length += count;
+        char* end;
+        while ((end = (char*) memchr(line, '\n', length)) != 0 || length == sizeof(line) - 1)
+        {
+          if (!end) end = line + length - 1;
+          *end = 0;
+          if (!sendOne(link, line)) reading = false;
+          length -= end + 1 - line;
+          memmove(line, end + 1, length);
+        }
+      }
+    }
+  }
+
+  while (link.inFlight() > 0)  // wait for the last echoes, then a little longer
+  {
+    bool more = link.wait(LOST_MICROS / 1000);
+    if (!more) link.expire(0);
+    show(link);
+    if (!more) break;
+  }
+  while (link.wait(quietMsec)) show(link);
+  show(link);
+  return 0;
+}
@@ -0,0 +1,253 @@
+#include "robotLink.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+// CONSTRUCTOR
+robotLink::robotLink()
+{
+  _fd = -1;
+  _window = ROBOT_LINK_WINDOW;
+  _nextSequence = 0;
+  _lastEchoed = -1;
+  _lineLength = 0;
+  _frameCount = 0;
+  _frameExpected = 0;
+  _haveFrameSequence = false;
+  _lastFrameSequence = 0;
+  _framesLost = 0;
+  _badChecksums = 0;
+}
+
+robotLink::~robotLink()
+{
+  close();
+}
+
+// PUBLIC METHODS
+int64_t robotLink::micros()
+{
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (int64_t) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+bool robotLink::open(const char* path)
+{
+  int fd = ::open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if (fd < 0)
+  {
+    perror(path);
+    return false;
+  }
+  termios settings;
+  if (tcgetattr(fd, &settings) == 0)
+  {
+    cfmakeraw(&settings);
+    cfsetispeed(&settings, B115200);
+    cfsetospeed(&settings, B115200);
+    settings.c_cflag |= CLOCAL | CREAD;
+    tcsetattr(fd, TCSANOW, &settings);
+    tcflush(fd, TCIOFLUSH);
+  }
+  attach(fd);
+  return true;
+}
+
+void robotLink::attach(int fd)
+{
+  close();
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  _fd = fd;
+}
+
+void robotLink::close()
+{
+  if (_fd >= 0) ::close(_fd);
+  _fd = -1;
+  _pending.clear();
+  _out.clear();
+  _lineLength = 0;
+  _frameCount = 0;
+}
+
+long robotLink::send(const char* command)
+{
+  if (_fd < 0 || !canSend()) return -1;
+  pending p;
+  p.sequence = _nextSequence++;
+  for (const char* c = command; *c && p.text.size() < ROBOT_LINK_MAX_COMMAND; c++)
+  {
+    if (*c != '\r' && *c != '\n' && *c != ' ' && *c != '#') p.text += *c;  // what the robot will echo
+  }
+  p.sentMicros = micros();
+  _out += p.text;
+  _out += '#';
+  _pending.push_back(p);
+  flush();
+  return p.sequence;
+}
+
+bool robotLink::emergencyStop()
+{
+  if (_fd < 0) return false;
+  char stop = ROBOT_LINK_EMERGENCY_STOP;
+  return write(_fd, &stop, 1) == 1;  // straight out, not behind the queued commands
+}
+
+bool robotLink::flush()
+{
+  while (!_out.empty())
+  {
+    ssize_t written = write(_fd, _out.data(), _out.size());
+    if (written < 0 && errno == EINTR) continue;
+    if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+    if (written <= 0) return false;
+    _out.erase(0, written);
+  }
+  return true;
+}
+
+bool robotLink::receive()
+{
+  if (_fd < 0) return false;
+  uint8_t buffer[512];
+  while (true)
+  {
+    ssize_t count = read(_fd, buffer, sizeof(buffer));
+    if (count < 0 && errno == EINTR) continue;
+    if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+    if (count <= 0) return false;  // a pty whose other end closed reads EIO
+    for (ssize_t i = 0; i < count; i++)
+    {
+      uint8_t c = buffer[i];
+      if (takeFrameByte(c)) continue;
+      if (c == '\n') takeLine();
+      else if (c != '\r' && _lineLength < ROBOT_LINK_MAX_LINE - 1) _line[_lineLength++] = c;
+    }
+  }
+}
+
+bool robotLink::wait(int timeoutMsec)
+{
+  if (_fd < 0) return false;
+  pollfd p = { _fd, (short) (POLLIN | (wantsWrite() ? POLLOUT : 0)), 0 };
+  int ready = poll(&p, 1, timeoutMsec);
+  if (ready <= 0) return false;
+  if ((p.revents & POLLOUT) && !flush()) return false;
+  if (p.revents & (POLLIN | POLLHUP | POLLERR)) return receive();
+  return true;
+}
+
+bool robotLink::nextReply(robotReply& reply)
+{
+  if (_replies.empty()) return false;
+  reply = _replies.front();
+  _replies.pop_front();
+  return true;
+}
+
+int robotLink::expire(long timeoutMicros)
+{
+  int lost = 0;
+  int64_t now = micros();
+  while (!_pending.empty() && now - _pending.front().sentMicros > timeoutMicros)
+  {
+    robotReply reply;
+    reply.type = ROBOT_REPLY_LOST;
+    reply.sequence = _pending.front().sequence;
+    reply.roundTripMicros = 0;
+    reply.text = _pending.front().text;
+    reply.frameLength = 0;
+    _replies.push_back(reply);
+    _pending.pop_front();
+    lost++;
+  }
+  return lost;
+}
+
+// an echo completes the oldest command in flight, or it is a stray one (the commands before it
+// were lost, or someone else is talking to the robot) and goes back as a line
+void robotLink::takeLine()
+{
+  robotReply reply;
+  reply.text.assign(_line, _lineLength);
+  reply.roundTripMicros = 0;
+  reply.frameLength = 0;
+  _lineLength = 0;
+  reply.type = ROBOT_REPLY_LINE;
+  if (!_pending.empty())
+  {
+    const pending& oldest = _pending.front();
+    bool commCheck = oldest.text.empty() || oldest.text[0] == 'c';  // the robot takes an empty command as one too
+    if ((commCheck && reply.text[0] == 'c') ||
+        (!commCheck && reply.text[0] == 'e' && reply.text.compare(1, std::string::npos, oldest.text) == 0))
+    {
+      reply.type = ROBOT_REPLY_ECHO;
+      reply.roundTripMicros = micros() - oldest.sentMicros;
+      _lastEchoed = oldest.sequence;
+      if (!commCheck) reply.text = oldest.text;
+      _pending.pop_front();
+    }
+  }
+  reply.sequence = _lastEchoed;
+  if (reply.type == ROBOT_REPLY_ECHO || !reply.text.empty()) _replies.push_back(reply);
+}
+
+// the same framing as hostTools/telemetryDecoder; returns true if the byte belongs to a frame
+bool robotLink::takeFrameByte(uint8_t c)
+{
+  if (_frameCount == 0)
+  {
+    if (c != TELEMETRY_SYNC_0) return false;
+    _frame[_frameCount++] = c;
+    return true;
+  }
+  if (_frameCount == 1)
+  {
+    if (c == TELEMETRY_SYNC_0) return true;  // still waiting for sync1
+    _frameCount = 0;
+    if (c != TELEMETRY_SYNC_1) return false;  // the sync byte is dropped, c is read as text
+    _frame[_frameCount++] = TELEMETRY_SYNC_0;
+    _frame[_frameCount++] = c;
+    return true;
+  }
+  if (_frameCount == 2)
+  {
+    if (c == 0 || (c & ~TELEMETRY_ALL_CHANNELS))  // not a mask we know, so not a frame
+    {
+      _frameCount = 0;
+      return false;
+    }
+    _frameExpected = telemetryFrameLength(c);
+  }
+  _frame[_frameCount++] = c;
+  if (_frameCount < _frameExpected) return true;
+
+  _frameCount = 0;
+  uint16_t checksum = telemetryChecksum(&_frame[2], _frameExpected - 2 - TELEMETRY_CHECKSUM_LENGTH);
+  const uint8_t* sent = &_frame[_frameExpected - TELEMETRY_CHECKSUM_LENGTH];
+  if (checksum != (sent[0] | (sent[1] << 8)))
+  {
+    _badChecksums++;
+    return true;
+  }
+  uint8_t sequence = _frame[3];
+  if (_haveFrameSequence) _framesLost += (uint8_t) (sequence - _lastFrameSequence - 1);
+  _lastFrameSequence = sequence;
+  _haveFrameSequence = true;
+
+  robotReply reply;
+  reply.type = ROBOT_REPLY_FRAME;
+  reply.sequence = _lastEchoed;
+  reply.roundTripMicros = 0;
+  memcpy(reply.frame, _frame, _frameExpected);
+  reply.frameLength = _frameExpected;
+  _replies.push_back(reply);
+  return true;
+}
@@ -0,0 +1,108 @@
+#ifndef robotLink_h
+#define robotLink_h
+
+// robotLink - the host side of the RobotComm link, for the host tools
+//
+// A command is its text followed by '#'.  The robot runs the commands one at a time, in the order
+// they came, and answers each with its echo, 'e' and the text as it read it (blanks and line ends
+// dropped), before anything the command itself sends back.  A comm check, any command starting with
+// 'c', is answered with 'c' and the battery percent instead of an echo.  Replies are text lines
+// ending in "\r\n"; binary telemetry frames (libraries/RobotTelemetry) can come between them.
+//
+// robotLink keeps up to a window of commands in flight (pipelining, so the robot never sits idle
+// waiting for the next one), matches each echo with the oldest command not yet echoed, and times
+// the round trip.  Everything else that arrives is handed back as a line or a frame; a line carries
+// the sequence number of the command echoed last, which is the command it answers unless it is one
+// of the robot's own reports (mF, mK, mS ...).
+//
+// Nothing here blocks except wait(): an event loop can hand fd() to poll or epoll, call receive()
+// when it is readable and flush() when it is writable and wantsWrite().
+//
+// The default window keeps the commands in flight well inside the robot's receive buffer
+// (BLUETOOTH_RX_BUFFER_SIZE in p_handleCommands); past that the robot raises RTS and the link stalls.
+
+#include <stdint.h>
+#include <deque>
+#include <string>
+#include "RobotTelemetry.h"
+
+#define ROBOT_LINK_WINDOW 8             // commands in flight
+#define ROBOT_LINK_MAX_COMMAND 254      // the robot cuts longer ones off (INPUT_BUFFER_SIZE - 1)
+#define ROBOT_LINK_MAX_LINE 256
+#define ROBOT_LINK_EMERGENCY_STOP '!'  // needs no '#', and is not echoed
+
+// what receive() hands back
+#define ROBOT_REPLY_ECHO 0   // a command was echoed; text is the command, roundTripMicros is set
+#define ROBOT_REPLY_LINE 1   // any other text line
+#define ROBOT_REPLY_FRAME 2  // a telemetry frame with a good checksum, in frame
+#define ROBOT_REPLY_LOST 3   // a command that was never echoed, see expire()
+
+struct robotReply
+{
+  int type;
+  long sequence;         // the command echoed or lost, or the one echoed last before a line or frame
+  long roundTripMicros;  // ROBOT_REPLY_ECHO only
+  std::string text;
+  uint8_t frame[TELEMETRY_MAX_FRAME_LENGTH];
+  int frameLength;
+};
+
+class robotLink
+{
+  public:
+    // CONSTRUCTOR
+    robotLink();
+    ~robotLink();
+
+    // PUBLIC METHODS
+    bool open(const char* path);  // a serial device (raw, 115200) or a pty; prints why when it fails
+    void attach(int fd);          // an already open descriptor, made non blocking
+    void close();
+    int fd() const { return _fd; }
+
+    void setWindow(int commands) { _window = commands > 0 ? commands : 1; }
+    bool canSend() const { return (int) _pending.size() < _window; }
+    int inFlight() const { return _pending.size(); }
+
+    long send(const char* command);  // sequence number, or -1 if the window is full or the link is down
+    bool emergencyStop();            // goes ahead of anything not yet written
+    bool wantsWrite() const { return !_out.empty(); }
+    bool flush();                    // writes what it can, false when the link is down
+
+    bool receive();                  // reads what is there, false at end of file or on an error
+    bool wait(int timeoutMsec);      // waits for something to read, then receive(); false on timeout or error
+    bool nextReply(robotReply& reply);
+    int expire(long timeoutMicros);  // gives up on commands in flight for longer, reporting them lost
+
+    unsigned long framesLost() const { return _framesLost; }
+    unsigned long badChecksums() const { return _badChecksums; }
+
+    static int64_t micros();         // monotonic
+
+  private:
+    struct pending
+    {
+      long sequence;
+      std::string text;
+      int64_t sentMicros;
+    };
+
+    void takeLine();
+    bool takeFrameByte(uint8_t c);
+
+    int _fd;
+    int _window;
+    long _nextSequence, _lastEchoed;
+    std::deque<pending> _pending;
+    std::deque<robotReply> _replies;
+    std::string _out;
+    char _line[ROBOT_LINK_MAX_LINE];
+    int _lineLength;
+    uint8_t _frame[TELEMETRY_MAX_FRAME_LENGTH];
+    int _frameCount, _frameExpected;
+    bool _haveFrameSequence;
+    uint8_t _lastFrameSequence;
+    unsigned long _framesLost, _badChecksums;
+};
+
+#endif
@@ -0,0 +1,442 @@
+// robotSim - simulated RobotComm robots on ptys, for the host tools and their benchmarks
+//
+// Each robot is a pty that behaves like the firmware's loop() on the bluetooth link: commands end
+// in '#' and are run one at a time, each echoed ('e' and the text) before its replies, a comm check
+// ('c') answered with 'c' and the battery percent, and binary telemetry frames sent at the T# rate.
+// The timing follows the firmware: an idle robot only looks for a command every 20 msec (the
+// backgroundDelay(20) in loop()), a waiting command is taken as soon as the last one is done, and
+// both directions of the link run at the serial rate.
+// It answers G, V, C (libraries/RobotParameters), Z, z, T, M, P, E and A; everything else is only echoed.
+// Robot n has bluetooth address 00:06:66:00:00:<n>, so a fleet of them can be told apart.
+//
+// build:
+//   g++ -O2 -I../../libraries/RobotParameters -I../../libraries/RobotTelemetry -o robotSim robotSim.cpp
+// use:
+//   robotSim [-n robots] [-b baud] [-i idle msec] [-s service usec] [-l link prefix]
+//     -n  robots, each on its own pty (1)
+//     -b  serial rate in bits/sec, 0 for no limit (115200)
+//     -i  how often an idle robot looks for a command, 0 for at once (20)
+//     -s  time to run a command (300)
+//     -l  also make links prefix0, prefix1 ... to the ptys, removed on exit
+//   The pty of every robot is printed as "robot <n> <path>", then the robots run until killed.
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE  // ppoll
+#endif
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include <deque>
+#include <string>
+#include <vector>
+#include "RobotParameters.h"
+#include "RobotTelemetry.h"
+
+#define MAX_ROBOTS 256
+#define RX_BUFFER_SIZE 512  // BLUETOOTH_RX_BUFFER_SIZE, what does not fit is thrown away
+#define EEPROM_WRITE_MICROS 3400
+#define TELEMETRY_DEFAULT_RATE 50
+#define TELEMETRY_MAX_RATE 200
+
+struct chunk
+{
+  int64_t due;  // when its last byte has gone over the link
+  std::string bytes;
+};
+
+struct robot
+{
+  int master, slave;
+  char path[64];
+  std::string partial;                                  // a command still coming in
+  std::deque<std::pair<std::string, int64_t> > frames;  // complete commands, and when their '#' arrived
+  int received;                                         // bytes in the receive buffer
+  int64_t rxFree, txFree;                               // when the link is next idle, each way
+  int64_t busyUntil, idleSince;
+  std::deque<chunk> out;
+  std::deque<chunk> later;                              // reports the robot sends when something finishes
+  long parameter[ROBOT_PARAMETER_COUNT];
+  bool eepromEnabled, stopped;
+  int telemetryRate, telemetryMask;
+  uint8_t telemetrySequence;
+  int64_t nextFrame;
+  int battery;
+  char address[18];                                     // the bluetooth address at EEPROM 300 - 316
+};
+
+static const long parameterMinimum[] = {
+#define PARAMETER_MINIMUM(id, name, variable, kind, minimum, maximum, scale, address, fallback) minimum,
+  ROBOT_PARAMETERS(PARAMETER_MINIMUM)
+};
+static const long parameterMaximum[] = {
+#define PARAMETER_MAXIMUM(id, name, variable, kind, minimum, maximum, scale, address, fallback) maximum,
+  ROBOT_PARAMETERS(PARAMETER_MAXIMUM)
+};
+static const long parameterScale[] = {
+#define PARAMETER_SCALE(id, name, variable, kind, minimum, maximum, scale, address, fallback) scale,
+  ROBOT_PARAMETERS(PARAMETER_SCALE)
+};
+static const long parameterDefault[] = {
+#define PARAMETER_DEFAULT(id, name, variable, kind, minimum, maximum, scale, address, fallback) fallback,
+  ROBOT_PARAMETERS(PARAMETER_DEFAULT)
+};
+
+static robot robots[MAX_ROBOTS];
+static int robotCount = 1;
+static long byteMicros = 87;  // 10 bits at 115200
+static int64_t idleMicros = 20000, serviceMicros = 300, startMicros;
+static const char* linkPrefix = 0;
+static volatile sig_atomic_t stopping = 0;
+
+static int64_t micros()
+{
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (int64_t) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+static void onSignal(int)
+{
+  stopping = 1;
+}
+
+// queued behind whatever is already going out, at the serial rate
+static void transmit(robot& r, int64_t now, const std::string& bytes)
+{
+  if (r.txFree < now) r.txFree = now;
+  r.txFree += (int64_t) bytes.size() * byteMicros;
+  chunk c = { r.txFree, bytes };
+  r.out.push_back(c);
+}
+
+static void reply(robot& r, int64_t now, const char* format, ...) __attribute__((format(printf, 3, 4)));
+static void reply(robot& r, int64_t now, const char* format, ...)
+{
+  char line[160];
+  va_list arguments;
+  va_start(arguments, format);
+  vsnprintf(line, sizeof(line) - 2, format, arguments);
+  va_end(arguments);
+  strcat(line, "\r\n");
+  transmit(r, now, line);
+}
+
+static void answerParameter(robot& r, int64_t now, char opcode, long id, int status)
+{
+  reply(r, now, "m%c%ld,%ld,%d", opcode, id, status == 1 ? 0 : r.parameter[id], status);
+}
+
+// the numbers after the opcode, as parseParameters() reads them; the rest are -1
+static int numbers(const std::string& command, long* value, int most)
+{
+  int count = 0;
+  const char* p = command.c_str() + 1;
+  for (int i = 0; i < most; i++) value[i] = -1;
+  while (*p && count < most)
+  {
+    char* end;
+    value[count++] = strtol(p, &end, 10);
+    p = *end == ',' ? end + 1 : end + strlen(end);
+  }
+  return count;
+}
+
+static void run(robot& r, int64_t now, const std::string& command)
+{
+  if (command.empty() || command[0] == 'c')  // an empty command is taken as a comm check too
+  {
+    reply(r, now, "c%d", r.battery);
+    return;
+  }
+  reply(r, now, "e%s", command.c_str());
+  long value[3];
+  switch (command[0])
+  {
+    case 'G':
+      numbers(command, value, 1);
+      if (value[0] >= 0) answerParameter(r, now, 'G', value[0], value[0] < ROBOT_PARAMETER_COUNT ? 0 : 1);
+      else for (int id = 0; id < ROBOT_PARAMETER_COUNT; id++) answerParameter(r, now, 'G', id, 0);
+      break;
+    case 'V':
+    {
+      numbers(command, value, 2);
+      int status = 0;
+      if (value[0] < 0 || value[0] >= ROBOT_PARAMETER_COUNT)
+      {
+        value[0] = ROBOT_PARAMETER_COUNT;
+        status = 1;
+      }
+      else if (value[1] < parameterMinimum[value[0]] || value[1] > parameterMaximum[value[0]]) status = 2;
+      else r.parameter[value[0]] = value[1] / parameterScale[value[0]] * parameterScale[value[0]];
+      answerParameter(r, now, 'V', value[0], status);
+      break;
+    }
+    case 'C':
+    {
+      if (!r.eepromEnabled) break;
+      char line[32];
+      snprintf(line, sizeof(line), "mC%d,0\r\n", ROBOT_PARAMETER_COUNT);
+      chunk c = { now + (ROBOT_PARAMETER_COUNT + 6) * EEPROM_WRITE_MICROS, line };
+      r.later.push_back(c);
+      break;
+    }
+    case 'Z':
+      r.eepromEnabled = true;
+      reply(r, now, "EEPROM writing enabled.");
+      break;
+    case 'z':
+      r.eepromEnabled = false;
+      reply(r, now, "EEPROM writing disabled.");
+      break;
+    case 'T':
+      if (numbers(command, value, 2) < 1) value[0] = TELEMETRY_DEFAULT_RATE;
+      if (value[1] < 0) value[1] = TELEMETRY_ALL_CHANNELS;
+      r.telemetryRate = value[0] > TELEMETRY_MAX_RATE ? TELEMETRY_MAX_RATE : value[0];
+      r.telemetryMask = value[1] & TELEMETRY_ALL_CHANNELS;
+      if (r.telemetryRate <= 0 || r.telemetryMask == 0) r.telemetryRate = 0;
+      r.nextFrame = now;
+      break;
+    case 'M':
+      reply(r, now, "mM1480,4210,4630");
+      break;
+    case 'P':
+      reply(r, now, "mP%d,12150,48", r.battery);
+      break;
+    case 'E':
+      numbers(command, value, 1);
+      reply(r, now, "MESSAGE_EEPROM_VALUE%d", value[0] >= 300 && value[0] < 317 ? r.address[value[0] - 300] : 255);
+      break;
+    case 'A':
+    case 'a':
+      reply(r, now, "mA0,%s", r.address);
+      break;
+    case 'x':
+    case 'X':
+      r.stopped = false;
+      break;
+  }
+}
+
+static void put16(uint8_t* p, unsigned int value)
+{
+  p[0] = value & 0xFF;
+  p[1] = (value >> 8) & 0xFF;
+}
+
+static void sendFrame(robot& r, int64_t now)
+{
+  uint8_t frame[TELEMETRY_MAX_FRAME_LENGTH];
+  memset(frame, 0, sizeof(frame));
+  frame[0] = TELEMETRY_SYNC_0;
+  frame[1] = TELEMETRY_SYNC_1;
+  frame[2] = r.telemetryMask;
+  frame[3] = r.telemetrySequence++;
+  uint8_t* p = &frame[TELEMETRY_HEADER_LENGTH];
+  for (uint8_t channelBit = 1; channelBit <= TELEMETRY_ALL_CHANNELS; channelBit <<= 1)
+  {
+    if (!(r.telemetryMask & channelBit)) continue;
+    if (channelBit == TELEMETRY_TIMESTAMP)
+    {
+      uint32_t millis = (now - startMicros) / 1000;
+      put16(p, millis & 0xFFFF);
+      put16(p + 2, millis >> 16);
+    }
+    else if (channelBit == TELEMETRY_BATTERY) put16(p, 700 + r.battery);
+    else if (channelBit == TELEMETRY_POWER) put16(p, 12150);
+    p += telemetryChannelLength(channelBit);
+  }
+  int length = p - frame;
+  put16(p, telemetryChecksum(&frame[2], length - 2));
+  transmit(r, now, std::string((const char*) frame, length + TELEMETRY_CHECKSUM_LENGTH));
+}
+
+// what the robot does up to now
+static void step(robot& r, int64_t now)
+{
+  while (!r.frames.empty() && r.busyUntil <= now)
+  {
+    int64_t start = r.frames.front().second;
+    if (start < r.busyUntil) start = r.busyUntil;  // waiting already, taken at once
+    else if (idleMicros > 0 && start > r.idleSince)  // idle, seen at the end of the current wait
+      start = r.idleSince + ((start - r.idleSince + idleMicros - 1) / idleMicros) * idleMicros;
+    if (start > now) break;
+    std::string command = r.frames.front().first;
+    r.received -= command.size() + 1;
+    r.frames.pop_front();
+    run(r, start + serviceMicros, command);
+    r.busyUntil = start + serviceMicros;
+    r.idleSince = r.busyUntil;
+  }
+  while (r.telemetryRate > 0 && r.nextFrame <= now)
+  {
+    sendFrame(r, r.nextFrame);
+    r.nextFrame += 1000000 / r.telemetryRate;
+  }
+  while (!r.later.empty() && r.later.front().due <= now)
+  {
+    transmit(r, r.later.front().due, r.later.front().bytes);
+    r.later.pop_front();
+  }
+  while (!r.out.empty() && r.out.front().due <= now)
+  {
+    const std::string& bytes = r.out.front().bytes;
+    if (write(r.master, bytes.data(), bytes.size()) < 0 && errno == EAGAIN) break;  // the host is not reading
+    r.out.pop_front();
+  }
+}
+
+static void take(robot& r, int64_t now)
+{
+  char buffer[512];
+  ssize_t count = read(r.master, buffer, sizeof(buffer));
+  if (count <= 0) return;  // EIO until the host opens the pty
+  if (r.rxFree < now) r.rxFree = now;
+  for (ssize_t i = 0; i < count; i++)
+  {
+    r.rxFree += byteMicros;
+    char c = buffer[i];
+    if (c == '!')  // the emergency stop byte, taken by the receive interrupt
+    {
+      r.stopped = true;
+      continue;
+    }
+    if (r.received >= RX_BUFFER_SIZE) continue;  // overrun, the firmware raises RTS well before this
+    r.received++;
+    if (c == '#')
+    {
+      r.frames.push_back(std::make_pair(r.partial, r.rxFree));
+      r.partial.clear();
+    }
+    else if (c != '\r' && c != '\n' && c != ' ' && c != 0) r.partial += c;
+  }
+}
+
+static int64_t nextEvent(const robot& r, int64_t now)
+{
+  int64_t next = now + 100000;
+  if (!r.frames.empty())
+  {
+    int64_t start = r.frames.front().second > r.busyUntil ? r.frames.front().second : r.busyUntil;
+    if (idleMicros > 0 && start > r.idleSince)
+      start = r.idleSince + ((start - r.idleSince + idleMicros - 1) / idleMicros) * idleMicros;
+    if (start < next) next = start;
+  }
+  if (r.telemetryRate > 0 && r.nextFrame < next) next = r.nextFrame;
+  if (!r.later.empty() && r.later.front().due < next) next = r.later.front().due;
+  if (!r.out.empty() && r.out.front().due < next) next = r.out.front().due;
+  return next;
+}
+
+static bool openRobot(robot& r, int n)
+{
+  r.master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+  if (r.master < 0 || grantpt(r.master) < 0 || unlockpt(r.master) < 0)
+  {
+    perror("pty");
+    return false;
+  }
+  snprintf(r.path, sizeof(r.path), "%s", ptsname(r.master));
+  r.slave = open(r.path, O_RDWR | O_NOCTTY);  // held open, so the pty lives on between hosts
+  termios settings;
+  if (r.slave >= 0 && tcgetattr(r.slave, &settings) == 0)
+  {
+    cfmakeraw(&settings);
+    tcsetattr(r.slave, TCSANOW, &settings);
+  }
+  if (linkPrefix)
+  {
+    char link[256];
+    snprintf(link, sizeof(link), "%s%d", linkPrefix, n);
+    unlink(link);
+    if (symlink(r.path, link) < 0) perror(link);
+  }
+  for (int id = 0; id < ROBOT_PARAMETER_COUNT; id++) r.parameter[id] = parameterDefault[id];
+  r.battery = 72 + n % 20;
+  snprintf(r.address, sizeof(r.address), "00:06:66:%02X:%02X:%02X", (n >> 16) & 0xFF, (n >> 8) & 0xFF, n & 0xFF);
+  r.received = 0;
+  r.rxFree = r.txFree = r.busyUntil = r.idleSince = startMicros;
+  r.eepromEnabled = r.stopped = false;
+  r.telemetryRate = r.telemetryMask = 0;
+  r.telemetrySequence = 0;
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  int option;
+  while ((option = getopt(argc, argv, "n:b:i:s:l:")) != -1)
+  {
+    switch (option)
+    {
+      case 'n': robotCount = atoi(optarg); break;
+      case 'b': byteMicros = atol(optarg) > 0 ? 10000000L / atol(optarg) : 0; break;
+      case 'i': idleMicros = atol(optarg) * 1000; break;
+      case 's': serviceMicros = atol(optarg); break;
+      case 'l': linkPrefix = optarg; break;
+      default:
+        fprintf(stderr, "use: robotSim [-n robots] [-b baud] [-i idle msec] [-s service usec] [-l link prefix]\n");
+        return 1;
+    }
+  }
+  if (robotCount < 1 || robotCount > MAX_ROBOTS)
+  {
+    fprintf(stderr, "1 to %d robots\n", MAX_ROBOTS);
+    return 1;
+  }
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+  startMicros = micros();
+  for (int n = 0; n < robotCount; n++)
+  {
+    if (!openRobot(robots[n], n)) return 1;
+    printf("robot %d %s\n", n, robots[n].path);
+  }
+  fflush(stdout);
+
+  std::vector<pollfd> fds(robotCount);
+  while (!stopping)
+  {
+    int64_t now = micros(), next = now + 100000;
+    for (int n = 0; n < robotCount; n++)
+    {
+      step(robots[n], now);
+      int64_t event = nextEvent(robots[n], now);
+      if (event < next) next = event;
+      fds[n].fd = robots[n].master;
+      fds[n].events = POLLIN;
+      fds[n].revents = 0;
+    }
+    timespec timeout = { 0, 0 };
+    if (next > now)
+    {
+      timeout.tv_sec = (next - now) / 1000000;
+      timeout.tv_nsec = (next - now) % 1000000 * 1000;
+    }
+    if (ppoll(fds.data(), robotCount, &timeout, 0) < 0 && errno != EINTR) break;
+    now = micros();
+    for (int n = 0; n < robotCount; n++)
+    {
+      if (fds[n].revents & POLLIN) take(robots[n], now);
+    }
+  }
+
+  if (linkPrefix)
+  {
+    for (int n = 0; n < robotCount; n++)
+    {
+      char link[256];
+      snprintf(link, sizeof(link), "%s%d", linkPrefix, n);
+      unlink(link);
+    }
+  }
+  return 0;
+}
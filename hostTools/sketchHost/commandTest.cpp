@@ -0,0 +1,310 @@
+// commandTest - the commands RobotComm knew before the command table (p_handleCommands), sent over
+// the bluetooth port one by one and checked by what the robot logs, answers, and does to the motors.
+// The host board has no gyro (its L3G finds none), so turns are timed, as on a robot without one.
+//
+// build and run with sketchHost.sh:
+//   hostTools/sketchHost/sketchHost.sh commandTest.cpp [test name ...]
+
+#include "RobotComm_v0_81.cpp"
+#include "sketchHost.h"
+
+static void send(const char *command, unsigned long msec)
+{
+  robotForget();
+  robotSend(command);
+  robotRun(msec);
+}
+
+static bool moving() { return Moving; }
+static bool stillMoving() { return !Moving; }
+static bool turning() { return Turning; }
+static bool stillTurning() { return !Turning; }
+static bool tilting() { return Tilting; }
+
+// ---- moves ----
+
+static void checkMove(const char *command, int speed, int msec)
+{
+  send(command, 20);
+  expect(robotSaid("e"), "%s not echoed", command);
+  expect(robotLogged("moving, speed = %d\r\nmove time = %d", speed, msec), "%s: not moving at %d for %d msec", command, speed, msec);
+  expect(robotRunUntil(moving, 200), "%s: not moving", command);
+  expect((commandedLeftSpeed > 0) == (speed > 0) && commandedLeftSpeed != 0, "%s: left wheel at %d", command, commandedLeftSpeed);
+  expect(robotRunUntil(stillMoving, msec + 200), "%s: still moving after %d msec", command, msec);
+}
+
+static void forward() { robotStart(); checkMove("f200#", 200, move_time_default); }
+static void forwardDefaultSpeed() { robotStart(); checkMove("f#", speed_default, move_time_default); }
+static void backward() { robotStart(); checkMove("b150#", -150, move_time_default); }
+static void nudgeForward() { robotStart(); checkMove("t#", speed_default, nudge_move_time_default); }
+static void nudgeBackward() { robotStart(); checkMove("g#", -speed_default, nudge_move_time_default); }
+
+static void checkMoveForever(const char *command, int speed)
+{
+  send(command, 300);
+  expect(robotLogged("moving, speed = %d\r\nmove time = -1", speed), "%s: not moving forever at %d", command, speed);
+  expect(Moving && movingForever, "%s: not moving forever", command);
+  send("x#", 20);
+  expect(!Moving && brakesOn, "x# did not stop %s", command);
+}
+
+static void forwardForever() { robotStart(); checkMoveForever("F180#", 180); }
+static void backwardForever() { robotStart(); checkMoveForever("B#", -speed_default); }
+
+// ---- turns ----
+
+static void checkTurn(const char *command, int speed, int msec)
+{
+  send(command, 20);
+  expect(robotLogged("turning, speed, msec = %d, %d", speed, msec), "%s: not turning at %d for %d msec", command, speed, msec);
+  expect(robotRunUntil(turning, 100), "%s: not turning", command);
+  expect((commandedLeftSpeed > 0) == (speed > 0) && (commandedRightSpeed > 0) == (speed < 0),
+         "%s: wheels at %d, %d", command, commandedLeftSpeed, commandedRightSpeed);
+  expect(robotRunUntil(stillTurning, msec + 200), "%s: still turning after %d msec", command, msec);
+}
+
+// with only a speed, r and l turn the default amount (they turned 0 before the command table)
+static void rightDefaultTurn() { robotStart(); checkTurn("r220#", 220, turn_time_default); }
+static void leftDefaultTurn() { robotStart(); checkTurn("l220#", -220, turn_time_default); }
+static void rightDefaultSpeed() { robotStart(); checkTurn("r#", speed_default, turn_time_default); }
+static void rightGiven() { robotStart(); checkTurn("r200,300#", 200, 300); }
+static void leftGiven() { robotStart(); checkTurn("l200,300#", -200, 300); }
+static void nudgeRight() { robotStart(); checkTurn("y#", speed_default, nudge_turn_time_default); }
+static void nudgeLeft() { robotStart(); checkTurn("h180#", -180, nudge_turn_time_default); }
+
+// with a gyro the default is in degrees (the turn itself needs the gyro, see hostTools/turnSim)
+static void turnDefaultWithGyro()
+{
+  robotStart();
+  gyroPresent = true;
+  expect(parameterDefault(FROM_TURN_DEFAULT) == degrees_default, "the default turn with a gyro is not degrees_default");
+  gyroPresent = false;
+  expect(parameterDefault(FROM_TURN_DEFAULT) == turn_time_default, "the default turn without a gyro is not turn_time_default");
+}
+
+// without a gyro R and L turn until something stops them
+static void checkTurnForever(const char *command, int speed)
+{
+  send(command, 500);
+  expect(robotLogged("turning, speed, msec = %d, -1", speed), "%s: not turning forever at %d", command, speed);
+  expect(Turning, "%s: not turning", command);
+  send("!", 20);
+  expect(!Turning && commandedLeftSpeed == 0 && commandedRightSpeed == 0, "%s: still turning after an emergency stop", command);
+  send("x#", 20);
+  expect(robotLogged("emergency stop acknowledged"), "x# did not acknowledge the emergency stop");
+}
+
+static void rightForever() { robotStart(); checkTurnForever("R#", speed_default); }
+static void leftForever() { robotStart(); checkTurnForever("L200#", -200); }
+
+// ---- tilts ----
+
+static void checkTilt(const char *command, int speed, int msec)
+{
+  send(command, 20);
+  expect(robotLogged("tilting, speed = %d", speed), "%s: not tilting at %d", command, speed);
+  expect(robotRunUntil(tilting, 100) && commandedTopSpeed == speed, "%s: top motor at %d", command, commandedTopSpeed);
+  if (msec < 0)
+  {
+    robotRun(1000);
+    expect(Tilting, "%s: stopped tilting", command);
+  }
+  else
+  {
+    robotRun(msec + 100);
+    expect(!Tilting && commandedTopSpeed == 0, "%s: top motor still driven after %d msec", command, msec);
+  }
+}
+
+static void tiltUp() { robotStart(); checkTilt("u#", tilt_up_speed_default, tilt_time_default); }
+static void tiltDown() { robotStart(); checkTilt("n#", -tilt_down_speed_default, tilt_time_default); }
+static void nudgeTiltUp() { robotStart(); checkTilt("i#", tilt_up_speed_default, nudge_tilt_time_default); }
+static void nudgeTiltDown() { robotStart(); checkTilt("k#", -tilt_down_speed_default, nudge_tilt_time_default); }
+static void tiltUpForever() { robotStart(); checkTilt("U#", tilt_up_speed_default, -1); }
+static void tiltDownForever() { robotStart(); checkTilt("N#", -tilt_down_speed_default, -1); }
+
+// ---- stops ----
+
+// the motor pins as setCoastAB() and setBrakesAB() leave them, learned from the driver itself
+static int coastPins[NUM_DIGITAL_PINS], brakePins[NUM_DIGITAL_PINS];
+static int *learning;
+static int sequence, coastAt, brakeAt;
+
+static bool pinsAre(const int *levels)
+{
+  for (int pin = 0; pin < NUM_DIGITAL_PINS; pin++)
+    if (levels[pin] != -1 && levels[pin] != (hostPWM(pin) >= 0 ? hostPWM(pin) : hostPin(pin))) return false;
+  return true;
+}
+
+static void watchMotorPins(uint8_t pin, int value, bool pwm)
+{
+  if (learning)
+  {
+    learning[pin] = value;
+    return;
+  }
+  sequence++;
+  if (!coastAt && pinsAre(coastPins)) coastAt = sequence;
+  if (!brakeAt && pinsAre(brakePins)) brakeAt = sequence;
+}
+
+static void learnMotorPins()
+{
+  for (int pin = 0; pin < NUM_DIGITAL_PINS; pin++) coastPins[pin] = brakePins[pin] = -1;
+  hostWatchPins(watchMotorPins);
+  learning = brakePins;
+  motorDriver.setBrakesAB();
+  learning = coastPins;
+  motorDriver.setCoastAB();
+  learning = 0;
+  hostWatchPins(0);
+}
+
+// x and X take over the wheels, so a moving robot coasts before it brakes
+static void checkStopWhileMoving(const char *command)
+{
+  learnMotorPins();
+  robotStart();
+  send("F200#", 300);
+  expect(Moving && commandedLeftSpeed != 0, "not moving before %s", command);
+  sequence = coastAt = brakeAt = 0;
+  hostWatchPins(watchMotorPins);
+  send(command, 20);
+  hostWatchPins(0);
+  expect(robotLogged("stopping"), "%s did not stop", command);
+  expect(coastAt > 0, "%s did not coast first", command);
+  expect(brakeAt > coastAt, "%s did not brake after coasting (coast at write %d, brake at %d)", command, coastAt, brakeAt);
+  expect(pinsAre(brakePins) && brakesOn && !Moving, "%s did not leave the brakes on", command);
+}
+
+static void stopWhileMoving() { checkStopWhileMoving("x#"); }
+static void stopForeverWhileMoving() { checkStopWhileMoving("X#"); }
+
+static void stopStanding()
+{
+  learnMotorPins();
+  robotStart();
+  send("x#", 20);
+  expect(robotLogged("stopping") && brakesOn && pinsAre(brakePins), "x# did not brake");
+}
+
+// ---- EEPROM ----
+
+// E reads the address as given; the old switch split it into address * 1000 + value, like v
+static void readEEPROM()
+{
+  hostEEPROM[1234] = 77;
+  robotStart();
+  send("E1234#", 20);
+  expect(robotLogged("address, value = 1234, 77"), "E1234# did not read address 1234");
+  // the answer still leads with the text the switch sent (see commandReadEEPROM)
+  expect(robotSaid("MESSAGE_EEPROM_VALUE77"), "E1234# answered something else");
+}
+
+static void writeEEPROMDisabled()
+{
+  robotStart();
+  send("v300066#", 100);
+  expect(robotLogged("EEPROM write requested when writing not enabled"), "v without Z# was not refused");
+  expect(hostEEPROM[300] == 0xFF, "v without Z# wrote the EEPROM");
+}
+
+static void writeEEPROM()
+{
+  robotStart();
+  send("Z#", 20);
+  expect(robotSaid("EEPROM writing enabled."), "Z# did not answer");
+  send("v300066#", 100);
+  expect(robotLogged("EEPROM written, value, address = 66, 300"), "v300066# did not write 66 to 300");
+  expect(hostEEPROM[300] == 66, "v300066# left %d at address 300", hostEEPROM[300]);
+  send("z#", 20);
+  expect(robotSaid("EEPROM writing disabled."), "z# did not answer");
+  send("v300067#", 100);
+  expect(hostEEPROM[300] == 66, "v after z# wrote the EEPROM");
+}
+
+// v on a parameter's byte makes it live at once, as W does
+static void writeEEPROMParameter()
+{
+  robotStart();
+  send("Z#", 20);
+  send("v109030#", 100);  // turn_time, in 10s of msec
+  expect(turn_time_default == 300, "turn_time_default is %d after v109030#", turn_time_default);
+}
+
+// ---- reports ----
+
+static void batteryPercent()
+{
+  robotStart();
+  send("p#", 20);
+  expect(robotSaid("MESSAGE_BATTERY_PERCENT"), "p# did not answer");  // as the switch sent it
+}
+
+static void checkAddress(const char *command)
+{
+  const char *address = "00:06:66:46:5A:60";
+  hostEEPROM[0] = 3;
+  memcpy(hostEEPROM + 300, address, strlen(address));
+  robotStart();
+  send(command, 20);
+  expect(robotSaid("mA3,00:06:66:46:5A:60"), "%s did not answer with the customer number and address", command);
+}
+
+static void address() { checkAddress("a#"); }
+static void addressUpper() { checkAddress("A#"); }
+
+// c is answered in loop() with the battery percent, and not echoed
+static void commCheck()
+{
+  robotStart();
+  send("c#", 20);
+  expect(robotSaid("c") && !robotSaid("e"), "c# was not answered as a comm check");
+}
+
+static void unknown()
+{
+  robotStart();
+  send("j#", 20);
+  expect(robotLogged("did not recognize command, character code = 106"), "j# was not refused");
+  expect(robotLogged("stopping") && brakesOn, "j# did not stop the robot");
+}
+
+SKETCH_TESTS(
+  TEST(forward)
+  TEST(forwardDefaultSpeed)
+  TEST(backward)
+  TEST(nudgeForward)
+  TEST(nudgeBackward)
+  TEST(forwardForever)
+  TEST(backwardForever)
+  TEST(rightDefaultTurn)
+  TEST(leftDefaultTurn)
+  TEST(rightDefaultSpeed)
+  TEST(rightGiven)
+  TEST(leftGiven)
+  TEST(nudgeRight)
+  TEST(nudgeLeft)
+  TEST(turnDefaultWithGyro)
+  TEST(rightForever)
+  TEST(leftForever)
+  TEST(tiltUp)
+  TEST(tiltDown)
+  TEST(nudgeTiltUp)
+  TEST(nudgeTiltDown)
+  TEST(tiltUpForever)
+  TEST(tiltDownForever)
+  TEST(stopWhileMoving)
+  TEST(stopForeverWhileMoving)
+  TEST(stopStanding)
+  TEST(readEEPROM)
+  TEST(writeEEPROMDisabled)
+  TEST(writeEEPROM)
+  TEST(writeEEPROMParameter)
+  TEST(batteryPercent)
+  TEST(address)
+  TEST(addressUpper)
+  TEST(commCheck)
+  TEST(unknown)
+)
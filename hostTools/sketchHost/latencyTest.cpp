@@ -0,0 +1,153 @@
+// latencyTest - how long the emergency stop byte (k_motorControl) takes to reach the brakes while the
+// timer tick (l_timerTick) is at its busiest, on the board model with the Arduino core's pin calls
+// and the interrupts' entry and exit counted (see hostArduino.h).
+// Each test gets the robot into one busy state and then sends the byte at every point of 10 msec,
+// one msec of every tick job, a few usec apart, each in a process of its own from the same state.  The
+// latency is from the byte's stop bit to the last of the brakes emergencyStop() puts on, all three
+// motors; the worst has to stay under LATENCY_BOUND once UNCOUNTED_USEC is added for the arithmetic
+// the model does not count.
+// The battery reads a full 12.5 V and the drive wheels draw a steady 900 mA, so the power governor and
+// the stall detector run as they would on the floor, and the safety monitor is on over flat ground.
+// The worst latency of each state is printed, with where in the 10 msec it was; -v prints every byte.
+//
+// build and run with sketchHost.sh:
+//   hostTools/sketchHost/sketchHost.sh latencyTest.cpp [test name ...]
+
+#include "RobotComm_v0_81.cpp"
+#include "sketchHost.h"
+
+#define LATENCY_BOUND 100   // usec
+#define UNCOUNTED_USEC 20   // inside the windows with interrupts off: the receive interrupt's checks, the
+                            // latch and speeds emergencyStop() clears, a ramp step or governor.limit()
+                            // twice, about 150 cycles counted by hand, doubled
+#define SWEEP_USEC 10000    // every tick job's msec
+#define STEP_USEC 3
+#define GROUND 528
+#define CLIFF 100
+#define BATTERY_PIN 4       // the battery_monitor_pin fallback
+#define BATTERY_FULL 800    // 12.5 V through the 3.2 divider
+#define DRIVE_MILLIAMPS 900
+
+static uint64_t lastBrake;  // the last pin written before the emergency stop latched
+
+static void watchBrakes(uint8_t pin, int value, bool pwm)
+{
+  if (!emergencyStopLatched) lastBrake = hostCycles();
+}
+
+static uint64_t byteCycles()
+{
+  uint64_t ubrr = ((uint64_t) UBRR2H << 8 | UBRR2L) + 1;
+  return 10 * ubrr * (UCSR2A & (1 << U2X2) ? 8 : 16);
+}
+
+// powered on with everything the tick does turned on, the wheels drawing current and the ground flat
+static void start()
+{
+  hostSetAnalog(BATTERY_PIN, BATTERY_FULL);
+  hostSetAnalog(ROBOT_SAFETY_PIN_LEFT, GROUND);
+  hostSetAnalog(ROBOT_SAFETY_PIN_RIGHT, GROUND);
+  hostSetAnalog(FBA, DRIVE_MILLIAMPS / ROBOT_MILLIAMPS_PER_COUNT);
+  hostSetAnalog(FBB, DRIVE_MILLIAMPS / ROBOT_MILLIAMPS_PER_COUNT);
+  robotStart();
+  robotSend("S1#");
+  expect(robotRunUntilSaid("mS?1,0", 100), "the safety monitor did not turn on");
+  robotRun(100);  // the battery estimate starts
+  robotForget();
+}
+
+// the byte sent now, in a process of its own; its latency in usec, 255 if the brakes never went on
+static int sendStop()
+{
+  fflush(stdout);
+  pid_t child = fork();
+  if (child == 0)
+  {
+    lastBrake = 0;
+    hostWatchPins(watchBrakes);
+    uint64_t arrives = hostCycles() + byteCycles();
+    robotSend("!");
+    robotRunUntil([] { return emergencyStopLatched; }, 5);
+    long usec = emergencyStopLatched && lastBrake >= arrives ? (long) ((lastBrake - arrives) / 16) : 255;
+    _exit(usec > 255 ? 255 : usec);
+  }
+  int status = 0;
+  waitpid(child, &status, 0);
+  return WIFEXITED(status) ? WEXITSTATUS(status) : 255;
+}
+
+// sends the byte at every point of SWEEP_USEC from the state the robot is in now; the sweep starts on
+// the safety poll's msec, the others are 2 (battery), 4 (power governor) and 7 (stall detector)
+static void sweep(const char *name)
+{
+  robotRunUntil([] { return safetyPollTicks == 0; }, 20);
+  uint64_t from = hostCycles();
+  int worst = -1, bytes = 0;
+  unsigned long worstAt = 0;
+  long sum = 0;
+  while (hostCycles() - from < SWEEP_USEC * 16ULL)
+  {
+    int usec = sendStop();
+    unsigned long at = (unsigned long) ((hostCycles() - from) / 16);
+    if (testVerbose) printf("    %s: at %5lu usec, %d usec\n", name, at, usec);
+    if (usec > worst)
+    {
+      worst = usec;
+      worstAt = at;
+    }
+    sum += usec;
+    bytes++;
+    hostRun(STEP_USEC);
+  }
+  printf("    %s: %d bytes, mean %ld usec, worst %d usec sent %lu usec into the 10 msec, %d with the arithmetic\n",
+         name, bytes, sum / bytes, worst, worstAt, worst + UNCOUNTED_USEC);
+  expect(worst + UNCOUNTED_USEC < LATENCY_BOUND, "%s: the byte took up to %d usec to reach the brakes, %d with the arithmetic",
+         name, worst, worst + UNCOUNTED_USEC);
+}
+
+// standing still, only the polls
+static void standing()
+{
+  start();
+  sweep("standing");
+}
+
+// starting at full speed, the power governor slewing the wheels up every 10 msec
+static void drivingOff()
+{
+  start();
+  robotSend("F255#");
+  expect(robotRunUntil([] { return commandedLeftSpeed > 0; }, 100), "the wheels did not start");
+  sweep("driving off");
+  expect(commandedLeftSpeed < 255, "the governor was done slewing before the sweep ended");
+}
+
+// the link lost while driving and tilting, the watchdog ramping the wheels and the tilt motor down
+static void linkRamp()
+{
+  start();
+  timed_out_default = 500;
+  robotSend("F255#");
+  robotSend("U#");
+  expect(robotRunUntil([] { return (bool) linkLost; }, 1000), "the link was never lost");
+  sweep("link ramp");
+  expect(commandedLeftSpeed > 0 && commandedTopSpeed != 0, "the ramp was over before the sweep ended");
+}
+
+// a cliff at full speed, the safety monitor ramping the wheels down
+static void safetyRamp()
+{
+  start();
+  robotSend("F255#");
+  robotRun(300);
+  hostSetAnalog(ROBOT_SAFETY_PIN_LEFT, CLIFF);
+  expect(robotRunUntil([] { return (bool) safetyStopping; }, 100), "the cliff did not stop the robot");
+  sweep("safety ramp");
+}
+
+SKETCH_TESTS(
+  TEST(standing)
+  TEST(drivingOff)
+  TEST(linkRamp)
+  TEST(safetyRamp)
+)
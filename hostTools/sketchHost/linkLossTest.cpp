@@ -0,0 +1,154 @@
+// linkLossTest - the link watchdog (l_timerTick): the bluetooth link going quiet while the robot
+// moves, on its own and in the middle of a queued maneuver, and coming back.  Nothing is sent after
+// the commands unless a test says so, as if the laptop or tablet had gone out of range.
+//
+// build and run with sketchHost.sh:
+//   hostTools/sketchHost/sketchHost.sh linkLossTest.cpp [test name ...]
+
+#include "RobotComm_v0_81.cpp"
+#include "sketchHost.h"
+
+#define SLACK 60  // msec a command may take to arrive and start
+
+// a maneuver longer than timed_out_default, sent at once, runs to the end with nothing more sent
+static void maneuverOutlastsTimeout()
+{
+  robotStart();
+  int steps = timed_out_default / move_time_default + 2;
+  for (int i = 0; i < steps; i++) robotSend("qf200#");
+  char last[16];
+  snprintf(last, sizeof(last), "mq%d", steps);
+  expect(robotRunUntilSaid(last, steps * (move_time_default + SLACK) + 500), "the maneuver did not finish");
+  expect(robotMillis() > (unsigned long) timed_out_default + 1000, "the maneuver took %lu msec, no longer than the timeout", robotMillis());
+  expect(!robotLogged("bluetooth link lost"), "the link watchdog stopped the maneuver");
+  expect(robotLogged("running queued command: f200") && commandQueueCount == 0, "not every step ran");
+}
+
+// so do waits between the steps, however long
+static void timedStepsOutlastTimeout()
+{
+  robotStart();
+  robotSend("qf200#");
+  char step[24];
+  snprintf(step, sizeof(step), "w%d,f200#", timed_out_default + 1500);
+  robotSend(step);
+  expect(robotRunUntilSaid("mq2", timed_out_default + 1500 + move_time_default + 500), "the timed step did not finish");
+  expect(!robotLogged("bluetooth link lost"), "the link watchdog stopped the maneuver");
+}
+
+// a step that moves forever is watched from when it started: the robot ramps down and brakes, and
+// what is still queued is cancelled
+static void lostInForeverStep()
+{
+  robotStart();
+  robotSend("qf200#");
+  robotSend("qF200#");
+  robotSend("qr200,200#");
+  expect(robotRunUntil([] { return robotLogged("running queued command: F200"); }, move_time_default + 200),
+         "the forever step did not start");
+  unsigned long started = robotMillis();
+  expect(robotRunUntil([] { return (bool) linkLost; }, timed_out_default + 500), "the link was never lost");
+  unsigned long lost = robotMillis() - started;
+  expect(lost + 2 >= (unsigned long) timed_out_default && lost < (unsigned long) timed_out_default + SLACK,
+         "the link was lost %lu msec into the forever step, not %d", lost, timed_out_default);
+  expect(robotRunUntil([] { return commandedLeftSpeed == 0 && commandedRightSpeed == 0; }, 200),
+         "the wheels did not ramp down");
+  robotRun(100);
+  expect(robotLogged("bluetooth link lost") && brakesOn && !Moving, "the robot is not braked");
+  expect(robotSaid("mo3"), "the step after the forever one was not cancelled");
+  robotRun(1000);
+  expect(!Turning && !robotLogged("running queued command: r"), "a step ran after the link was lost");
+}
+
+// a bounded step can't run longer than the timeout, queued or not
+static void stepLongerThanTimeout()
+{
+  robotStart();
+  timed_out_default = move_time_default / 2;
+  robotSend("qf200#");
+  expect(robotRunUntil([] { return (bool) linkLost; }, move_time_default), "the link was not lost in a step longer than the timeout");
+  robotRun(300);
+  expect(brakesOn && !Moving && robotSaid("mq1"), "the step was not stopped");
+}
+
+// the ramp down, LINK_DECEL_STEP every LINK_DECEL_INTERVAL msec and then the brakes
+static void rampDown()
+{
+  robotStart();
+  robotSend("F255#");
+  robotRun(timed_out_default - 100);
+  expect(Moving && commandedLeftSpeed > 0, "not moving before the timeout");
+  expect(robotRunUntil([] { return (bool) linkLost; }, 200), "the link was never lost");
+  unsigned long lost = robotMillis();
+  int previous = commandedLeftSpeed;
+  unsigned long ramp = (previous + LINK_DECEL_STEP - 1) / LINK_DECEL_STEP * LINK_DECEL_INTERVAL;
+  bool falling = true;
+  while (commandedLeftSpeed != 0 && robotMillis() - lost < 500)
+  {
+    robotRun(1);
+    falling = falling && commandedLeftSpeed <= previous;
+    previous = commandedLeftSpeed;
+  }
+  unsigned long stopped = robotMillis() - lost;
+  expect(falling, "the speed did not only fall");
+  expect(commandedLeftSpeed == 0 && stopped <= ramp + 2, "down after %lu msec, not %lu", stopped, ramp);
+  robotRun(50);
+  expect(robotLogged("bluetooth link lost") && brakesOn, "not braked after the ramp");
+}
+
+// a tilt that ends during the ramp leaves motor C to it; a frame arriving before the ramp is over
+// must not leave the motor running where the ramp got to
+static void restoredDuringRamp()
+{
+  robotStart();
+  timed_out_default = 300;
+  tilt_time_default = timed_out_default + 30;
+  robotSend("u#");
+  expect(robotRunUntil([] { return (bool) linkLost; }, timed_out_default + 100), "the link was never lost");
+  expect(robotRunUntil([] { return !Tilting; }, 100), "the tilt did not end");
+  expect(commandedTopSpeed != 0, "the ramp was over before the tilt ended");
+  robotSend("c#");
+  expect(robotRunUntil([] { return !linkLost; }, 50), "a frame did not restore the link");
+  robotRun(200);
+  expect(commandedTopSpeed == 0 && !Tilting, "motor C still runs at %d after the link came back", commandedTopSpeed);
+  expect(commandedLeftSpeed == 0 && commandedRightSpeed == 0 && !Moving, "the wheels still run");
+}
+
+// any frame keeps the link alive, and one after a loss restores it
+static void keptAliveAndRestored()
+{
+  robotStart();
+  robotSend("F200#");
+  for (int i = 0; i < 5; i++)
+  {
+    robotRun(timed_out_default / 2);
+    robotSend("c#");
+  }
+  expect(Moving && !linkLost, "comm checks did not keep the link alive");
+  robotRun(timed_out_default + 300);
+  expect(linkLost && !Moving, "the link was not lost once the comm checks stopped");
+  robotSend("c#");
+  robotRun(50);
+  expect(!linkLost && robotLogged("bluetooth link restored"), "a frame did not restore the link");
+  robotSend("f200#");
+  expect(robotRunUntil([] { return Moving; }, 200), "the robot did not move again after the link came back");
+}
+
+// standing still, silence is not a lost link
+static void quietWhileStanding()
+{
+  robotStart();
+  robotRun(timed_out_default * 2);
+  expect(!linkLost && !robotLogged("bluetooth link lost"), "the link was lost while standing still");
+}
+
+SKETCH_TESTS(
+  TEST(maneuverOutlastsTimeout)
+  TEST(timedStepsOutlastTimeout)
+  TEST(lostInForeverStep)
+  TEST(stepLongerThanTimeout)
+  TEST(rampDown)
+  TEST(restoredDuringRamp)
+  TEST(keptAliveAndRestored)
+  TEST(quietWhileStanding)
+)
@@ -0,0 +1,158 @@
+// queueTest - the command queue (n_commandQueue) against the board model's clock: chained and
+// timed starts, cancelling, stop emptying the queue, a full queue, and the mQ, mq and mo replies.
+// The host board has no gyro, so f moves for move_time_default and r200,200 turns for 200 msec.
+//
+// build and run with sketchHost.sh:
+//   hostTools/sketchHost/sketchHost.sh queueTest.cpp [test name ...]
+
+#include "RobotComm_v0_81.cpp"
+#include "sketchHost.h"
+
+#define SLACK 60  // msec a command may take to arrive and start, at 115200 baud and a 20 msec loop
+
+// msec from now until the robot sends a line starting with reply, or 0 if it does not in msec
+static unsigned long timeUntil(const char *reply, unsigned long msec)
+{
+  unsigned long start = robotMillis();
+  return robotRunUntilSaid(reply, msec) ? robotMillis() - start : 0;
+}
+
+// each queued command runs when the one before it completes
+static void chained()
+{
+  robotStart();
+  robotSend("qf200#");
+  robotSend("qr200,200#");
+  robotSend("qi#");
+  expect(robotRunUntilSaid("mQ3", 100) && robotSaid("mQ1") && robotSaid("mQ2"), "not all three queued");
+  unsigned long first = timeUntil("mq1", move_time_default + 500);
+  expect(first >= (unsigned long) move_time_default && first < (unsigned long) move_time_default + SLACK + 100,
+         "the move completed after %lu msec, not %d", first, move_time_default);
+  expect(!robotSaid("mq2") && robotLogged("running queued command: r200,200"), "the turn did not start when the move completed");
+  unsigned long second = timeUntil("mq2", 500);
+  expect(second >= 190 && second < 200 + SLACK, "the turn completed %lu msec after the move, not 200", second);
+  unsigned long third = timeUntil("mq3", nudge_tilt_time_default + 500);
+  expect(third >= (unsigned long) nudge_tilt_time_default && third < (unsigned long) nudge_tilt_time_default + SLACK,
+         "the tilt completed %lu msec after the turn, not %d", third, nudge_tilt_time_default);
+  expect(robotLogged("running queued command: f200\r\n") && robotLogged("running queued command: i\r\n"), "not every command ran");
+}
+
+// w waits the time given from when it was received
+static void timedStart()
+{
+  robotStart();
+  robotSend("w500,r200,200#");
+  robotRun(400);
+  expect(robotSaid("mQ1") && !Turning, "the turn started before 500 msec");
+  robotRun(150 + SLACK);
+  expect(Turning, "the turn did not start at 500 msec");
+  expect(robotRunUntilSaid("mq1", 300), "the timed turn did not complete");
+}
+
+// but never before the command ahead of it completes
+static void timedAfterChained()
+{
+  robotStart();
+  robotSend("qf200#");
+  robotSend("w200,r200,200#");
+  robotRun(200 + SLACK);
+  expect(Moving && !Turning, "the timed turn cut in ahead of the move");
+  expect(robotRunUntilSaid("mq1", move_time_default + 100), "the move did not complete");
+  robotRun(SLACK);
+  expect(Turning, "the timed turn, already due, did not start once the move completed");
+}
+
+// o# cancels what is waiting, not what is running
+static void cancelAll()
+{
+  robotStart();
+  robotSend("qF200#");  // holds up the queue until stopped
+  robotSend("qr#");
+  robotSend("qu#");
+  expect(robotRunUntilSaid("mQ3", 100), "not all three queued");
+  robotRun(200);
+  expect(Moving && movingForever, "the forever move is not running");
+  robotSend("o#");
+  expect(robotRunUntilSaid("mo3", 100) && robotSaid("mo2") && !robotSaid("mo1"), "o# did not cancel just the waiting two");
+  expect(Moving, "o# stopped the running command");
+  robotForget();
+  robotSend("x#");
+  expect(robotRunUntilSaid("mq1", 100), "the stopped move did not complete");
+  robotRun(500);
+  expect(!Turning && !robotLogged("running queued command"), "a cancelled command ran");
+}
+
+static void cancelOne()
+{
+  robotStart();
+  robotSend("qf200#");
+  robotSend("qr200,200#");
+  robotSend("qi#");
+  expect(robotRunUntilSaid("mQ3", 100), "not all three queued");
+  robotSend("o2#");  // handled as soon as the move lets loop() read it, before the turn is due
+  expect(robotRunUntilSaid("mo2", move_time_default + 100) && !robotSaid("mo3"), "o2# did not cancel just the turn");
+  expect(robotRunUntilSaid("mq1", 50), "the move did not complete");  // its reply may still be on the way
+  expect(robotRunUntilSaid("mq3", nudge_tilt_time_default + 200), "the tilt after the cancelled turn did not run");
+  expect(!robotLogged("running queued command: r"), "the cancelled turn ran");
+}
+
+// x stops the running command and empties the queue
+static void stopEmpties()
+{
+  robotStart();
+  robotSend("qF200#");
+  robotSend("qr#");
+  robotSend("w100,u#");
+  expect(robotRunUntilSaid("mQ3", 100), "not all three queued");
+  robotRun(100);
+  robotSend("x#");
+  expect(robotRunUntilSaid("mo3", 100) && robotSaid("mo2"), "x# did not cancel the waiting commands");
+  expect(robotRunUntilSaid("mq1", 100), "the stopped move did not complete");
+  robotRun(500);
+  expect(!Turning && !Tilting, "a command ran after x#");
+}
+
+// the queue takes COMMAND_QUEUE_LENGTH entries, and refuses a command too long to hold
+static void full()
+{
+  robotStart();
+  robotSend("qF200#");
+  robotRun(100);  // running, so it is out of the queue
+  for (int i = 0; i < COMMAND_QUEUE_LENGTH; i++) robotSend("qu#");
+  robotSend("qu#");
+  robotRun(300);
+  expect(robotSaid("mQ9") && robotSaid("mQ-1"), "the queue did not take %d and refuse one more", COMMAND_QUEUE_LENGTH);
+  expect(commandQueueCount == COMMAND_QUEUE_LENGTH, "%d queued", commandQueueCount);
+  robotSend("o#");
+  robotRun(50);
+  robotForget();
+  robotSend("qr200,200,123456789#");  // 19 characters
+  expect(robotRunUntilSaid("mQ-1", 100) && robotLogged("command not queued"), "a command too long to hold was queued");
+  robotSend("x#");
+  robotRun(50);
+}
+
+// a command sent without q or w runs at once, ahead of the queue
+static void unqueuedRunsAtOnce()
+{
+  robotStart();
+  robotSend("qF200#");
+  robotSend("w2000,u#");
+  robotRun(200);
+  robotSend("i#");
+  robotRun(50);
+  expect(Tilting && Moving, "an unqueued command waited for the queue");
+  robotSend("x#");
+  robotRun(50);
+}
+
+SKETCH_TESTS(
+  TEST(chained)
+  TEST(timedStart)
+  TEST(timedAfterChained)
+  TEST(cancelAll)
+  TEST(cancelOne)
+  TEST(stopEmpties)
+  TEST(full)
+  TEST(unqueuedRunsAtOnce)
+)
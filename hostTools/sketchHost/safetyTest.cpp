@@ -0,0 +1,166 @@
+// safetyTest - the cliff and obstacle monitor (o_safetyMonitor) against the board model's ADC and
+// clock: how long after a sensor sees danger the robot is braked, what it reports, and the debounce.
+// The sensors look at flat ground 185 mm away (a reading of 528) until a test puts something in the way
+// (100 mm, 715) or takes the ground away (a cliff, out of range, 100).  The battery reads a full 12.5 V,
+// so the power governor lets the wheels up to full speed, and the stall detector is off, since the
+// motor current sense reads nothing on the host.
+// With -v each stop's latency is printed.
+//
+// build and run with sketchHost.sh:
+//   hostTools/sketchHost/sketchHost.sh safetyTest.cpp [test name ...]
+
+#include "RobotComm_v0_81.cpp"
+#include "sketchHost.h"
+
+#define GROUND 528
+#define OBSTACLE 715
+#define CLIFF 100
+#define BATTERY_PIN 4  // the battery_monitor_pin fallback
+#define BATTERY_FULL 800  // 12.5 V through the 3.2 divider
+
+// the documented bound, from the poll that first sees the danger
+#define STOP_BOUND ((SAFETY_DEBOUNCE - 1 + (255 + SAFETY_DECEL_STEP - 1) / SAFETY_DECEL_STEP - 1) * SAFETY_POLL_INTERVAL)
+
+static unsigned long lastWriteWhileStopping;  // usec
+
+static void watchStop(uint8_t pin, int value, bool pwm)
+{
+  if (safetyStopping) lastWriteWhileStopping = hostCycles() / 16;
+}
+
+// powered on with the monitor on and both sensors on flat ground
+static void start()
+{
+  hostSetAnalog(BATTERY_PIN, BATTERY_FULL);
+  hostSetAnalog(ROBOT_SAFETY_PIN_LEFT, GROUND);
+  hostSetAnalog(ROBOT_SAFETY_PIN_RIGHT, GROUND);
+  robotStart();
+  robotSend("K0#");
+  robotSend("S1#");
+  expect(robotRunUntilSaid("mS?1,0", 100), "the monitor did not turn on");
+  robotRun(100);
+  expect(safetyTripped == 0, "tripped on flat ground (%d)", safetyTripped);
+  robotForget();
+}
+
+// moving forward at speed, the sensor reading changes to reading; checks when the robot is braked and
+// what it reports, against the bound in o_safetyMonitor
+static void checkStop(int speed, uint8_t pin, int reading, int mask)
+{
+  start();
+  char command[16];
+  snprintf(command, sizeof(command), "F%d#", speed);
+  robotSend(command);
+  robotRun(400);
+  expect(Moving && commandedLeftSpeed == speed, "not moving at %d (%d)", speed, commandedLeftSpeed);
+  robotRun(3);  // somewhere between two polls
+  lastWriteWhileStopping = 0;
+  hostWatchPins(watchStop);
+  unsigned long changed = hostCycles() / 16;
+  hostSetAnalog(pin, reading);
+  expect(robotRunUntil([] { return safetyDangerCount[0] + safetyDangerCount[1] > 0; }, 50), "the danger was never seen");
+  unsigned long seen = hostCycles() / 16;
+  char reply[16];
+  snprintf(reply, sizeof(reply), "mS%d,", mask);
+  expect(robotRunUntilSaid(reply, 200), "the stop was not reported");
+  hostWatchPins(0);
+  unsigned long braked = lastWriteWhileStopping;
+  expect(brakesOn && !Moving && commandedLeftSpeed == 0 && commandedRightSpeed == 0, "not braked");
+
+  unsigned long reported = 0;
+  const char *line = strstr(robotReplies, reply);
+  if (line) reported = strtoul(line + strlen(reply), 0, 10);
+  long fromSeen = (long) (braked - seen) / 1000, fromChange = (long) (braked - changed) / 1000;
+  if (testVerbose) printf("    braked %ld msec after the reading changed, %ld after the first dangerous poll, reported %lu\n",
+                          fromChange, fromSeen, reported);
+  expect(fromSeen <= STOP_BOUND, "braked %ld msec after the first dangerous poll, over %d", fromSeen, STOP_BOUND);
+  expect(fromChange <= STOP_BOUND + SAFETY_POLL_INTERVAL, "braked %ld msec after the reading changed, over %d",
+         fromChange, STOP_BOUND + SAFETY_POLL_INTERVAL);
+  expect(labs((long) reported - fromSeen) <= 1, "reported %lu msec, the brakes went on %ld after the first dangerous poll",
+         reported, fromSeen);
+}
+
+static void obstacleFullSpeed() { checkStop(255, ROBOT_SAFETY_PIN_LEFT, OBSTACLE, 1); }
+static void cliffFullSpeed() { checkStop(255, ROBOT_SAFETY_PIN_RIGHT, CLIFF, 2); }
+static void obstacleSlow() { checkStop(100, ROBOT_SAFETY_PIN_RIGHT, OBSTACLE, 2); }
+
+// a reading that is bad for less than SAFETY_DEBOUNCE polls is ignored
+static void glitchIgnored()
+{
+  start();
+  robotSend("F200#");
+  robotRun(400);
+  for (int i = 0; i < 5; i++)
+  {
+    hostSetAnalog(ROBOT_SAFETY_PIN_LEFT, OBSTACLE);
+    robotRun(SAFETY_POLL_INTERVAL * (SAFETY_DEBOUNCE - 1) - 5);
+    hostSetAnalog(ROBOT_SAFETY_PIN_LEFT, GROUND);
+    robotRun(100);
+  }
+  expect(Moving && commandedLeftSpeed == 200 && !robotSaid("mS"), "a short glitch stopped the robot");
+  robotSend("x#");
+  robotRun(50);
+}
+
+// while tripped, forward is refused but backing up and turning are not
+static void backOutOfDanger()
+{
+  start();
+  hostSetAnalog(ROBOT_SAFETY_PIN_LEFT, CLIFF);
+  robotRun(SAFETY_POLL_INTERVAL * (SAFETY_DEBOUNCE + 1));
+  expect(safetyTripped == 1, "the cliff did not trip the left sensor (%d)", safetyTripped);
+  robotSend("F200#");
+  robotRun(100);
+  expect(!Moving && robotLogged("cliff or obstacle ahead, not moving forward"), "moved forward toward the cliff");
+  robotSend("B200#");
+  robotRun(200);
+  expect(Moving && commandedLeftSpeed < 0, "did not back up");
+  hostSetAnalog(ROBOT_SAFETY_PIN_LEFT, GROUND);
+  robotRun(SAFETY_POLL_INTERVAL * 2);
+  expect(Moving && safetyTripped == 0, "did not clear once back on the ground");
+  robotSend("x#");
+  robotRun(50);
+}
+
+// a stop in the middle of a queued maneuver cancels the rest of it, turns and back-ups too
+static void stopCancelsQueue()
+{
+  start();
+  robotSend("qF200#");
+  robotSend("qr200,200#");
+  robotSend("qB200#");
+  expect(robotRunUntil([] { return Moving; }, 200), "the maneuver did not start");
+  robotRun(300);
+  hostSetAnalog(ROBOT_SAFETY_PIN_LEFT, CLIFF);
+  expect(robotRunUntilSaid("mS1,", 200), "the stop was not reported");
+  robotRun(50);
+  expect(robotSaid("mo2") && robotSaid("mo3") && commandQueueCount == 0, "the rest of the maneuver was not cancelled");
+  hostSetAnalog(ROBOT_SAFETY_PIN_LEFT, GROUND);
+  robotRun(1000);
+  expect(!Turning && !Moving && !robotLogged("running queued command: r"), "a step ran after the safety stop");
+}
+
+// off, the monitor leaves the robot alone
+static void offIgnoresDanger()
+{
+  start();
+  robotSend("S0#");
+  robotRun(50);
+  robotSend("F200#");
+  robotRun(300);
+  hostSetAnalog(ROBOT_SAFETY_PIN_LEFT, OBSTACLE);
+  robotRun(200);
+  expect(Moving && !robotSaid("mS1") && safetyTripped == 0, "stopped with the monitor off");
+  robotSend("x#");
+  robotRun(50);
+}
+
+SKETCH_TESTS(
+  TEST(obstacleFullSpeed)
+  TEST(cliffFullSpeed)
+  TEST(obstacleSlow)
+  TEST(glitchIgnored)
+  TEST(backOutOfDanger)
+  TEST(stopCancelsQueue)
+  TEST(offIgnoresDanger)
+)
@@ -0,0 +1,217 @@
+// sketchHost.h - what the tests in this folder share.  A test includes the joined sketch
+// (sketchHost.sh makes it) and then this, so both can see the sketch's globals:
+//
+//   #include "RobotComm_v0_81.cpp"
+//   #include "sketchHost.h"
+//
+//   static void forwardStops()
+//   {
+//     robotStart();
+//     robotSend("f200,500#");
+//     robotRun(700);
+//     expect(!Moving, "still moving after the move");
+//   }
+//   SKETCH_TESTS(TEST(forwardStops))
+//
+// Every test runs in a child process of its own, on a board just powered on (hostReset()), so the
+// sketch starts from its initialized globals each time.  The sketch runs under hostRun(), and between
+// runs the test looks at it, changes its inputs and sends it commands.
+
+#ifndef sketchHost_h
+#define sketchHost_h
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "hostArduino.h"
+
+// the stack is not painted on the host (stackCanary.cpp is AVR assembler), M# reports 0s
+unsigned int stackHighWater() { return 0; }
+unsigned int stackNeverUsed() { return 0; }
+unsigned int stackFree() { return 0; }
+
+static int testFailures;
+static bool testVerbose;
+static char robotReplies[16384];  // what the robot sent on the bluetooth port since robotForget()
+static size_t robotReplied;
+static char *robotSerialText;  // what the sketch logged on Serial, see robotLogged()
+static size_t robotSerialSize, robotSerialFrom;
+static FILE *robotSerial;
+
+// what the robot sent since the last look is added to robotReplies
+inline void robotListen()
+{
+  if (robotReplied + 1 >= sizeof(robotReplies)) return;
+  robotReplied += hostTransmitted2(robotReplies + robotReplied, sizeof(robotReplies) - robotReplied);
+}
+
+inline unsigned long robotMillis()
+{
+  return (unsigned long) (hostCycles() / 16000);
+}
+
+// the sketch runs for msec, then stops wherever it is
+inline void robotRun(unsigned long msec)
+{
+  hostRun(msec * 1000);
+  robotListen();
+}
+
+// runs the sketch until ready() or msec have gone by, checking every msec; true if ready() came first
+inline bool robotRunUntil(bool (*ready)(), unsigned long msec)
+{
+  for (unsigned long t = 0; t < msec; t++)
+  {
+    if (ready()) return true;
+    robotRun(1);
+  }
+  return ready();
+}
+
+// robotSaid() and robotLogged() only look at what comes after this
+inline void robotForget()
+{
+  robotListen();
+  robotReplied = 0;
+  robotReplies[0] = 0;
+  fflush(robotSerial);
+  robotSerialFrom = robotSerialSize;
+}
+
+// the motor drivers' status pins, which their carriers pull up while the bridges are healthy; an
+// input nothing drives reads low on the model, and the sketch would take that for a fault (the PCB
+// driver turns on the pins' own pull-ups)
+#if ROBOT_BOARD == ROBOT_BOARD_ORIGINAL || ROBOT_BOARD == ROBOT_BOARD_REVERSE
+static const uint8_t robotDriverStatusPins[] = { 26, 34, 38 };
+#elif ROBOT_BOARD == ROBOT_BOARD_CALYPSO || ROBOT_BOARD == ROBOT_BOARD_POLOLU_BIG
+static const uint8_t robotDriverStatusPins[] = { 26, 36, 46 };
+#else
+static const uint8_t robotDriverStatusPins[] = { };
+#endif
+
+// powers on and lets setup() finish, with nothing logged or answered yet
+inline void robotStart()
+{
+  for (uint8_t pin : robotDriverStatusPins) hostSetPin(pin, HIGH);
+  robotRun(50);
+  robotForget();
+}
+
+// a command arriving on the bluetooth port, byte after byte at the port's speed from now
+inline void robotSend(const char *command)
+{
+  if (testVerbose) printf("%8lu  -> %s\n", robotMillis(), command);
+  hostReceive2(command);
+}
+
+// true if the robot sent a line starting with text since robotForget()
+inline bool robotSaid(const char *text)
+{
+  robotListen();
+  for (const char *line = robotReplies; *line; )
+  {
+    if (strncmp(line, text, strlen(text)) == 0) return true;
+    line = strchr(line, '\n');
+    if (!line) break;
+    line++;
+  }
+  return false;
+}
+
+// true if the sketch logged text (printf style) on Serial since robotForget(); the logger's lines
+// are its message text and then the arguments, see libraries/RobotLog
+inline bool robotLogged(const char *format, ...)
+{
+  char text[200];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(text, sizeof(text), format, args);
+  va_end(args);
+  fflush(robotSerial);
+  return robotSerialText && strstr(robotSerialText + robotSerialFrom, text) != 0;
+}
+
+// runs the sketch until it sends a line starting with text, or msec have gone by; true if it sent it
+inline bool robotRunUntilSaid(const char *text, unsigned long msec)
+{
+  for (unsigned long t = 0; t < msec; t++)
+  {
+    if (robotSaid(text)) return true;
+    robotRun(1);
+  }
+  return robotSaid(text);
+}
+
+// a failed expectation is reported with the time it was found at, and fails the test
+inline void expect(bool ok, const char *format, ...)
+{
+  if (ok) return;
+  va_list args;
+  va_start(args, format);
+  printf("    FAIL at %lu msec: ", robotMillis());
+  vprintf(format, args);
+  printf("\n");
+  va_end(args);
+  testFailures++;
+}
+
+struct sketchTest
+{
+  const char *name;
+  void (*run)();
+};
+
+#define TEST(name) { #name, name },
+
+// the tests named on the command line, or all of them; each in a process of its own.
+// -v also prints the commands as they are sent, and after each test what it logged and was answered
+inline int runSketchTests(const sketchTest *tests, size_t count, int argc, char **argv)
+{
+  int failed = 0, ran = 0;
+  if (argc > 1 && strcmp(argv[1], "-v") == 0)
+  {
+    testVerbose = true;
+    argc--;
+    argv++;
+  }
+  for (size_t i = 0; i < count; i++)
+  {
+    bool named = argc == 1;
+    for (int a = 1; a < argc; a++) named = named || strcmp(argv[a], tests[i].name) == 0;
+    if (!named) continue;
+    fflush(stdout);
+    pid_t child = fork();
+    if (child == 0)
+    {
+      hostReset();
+      robotSerial = open_memstream(&robotSerialText, &robotSerialSize);
+      Serial.echo(robotSerial);
+      tests[i].run();
+      if (testVerbose)
+      {
+        fflush(robotSerial);
+        printf("logged:\n%sreplied since the last robotForget():\n%s", robotSerialText, robotReplies);
+      }
+      fflush(stdout);
+      _exit(testFailures ? 1 : 0);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    printf("  %-40s %s\n", tests[i].name, ok ? "pass" : "FAIL");
+    failed += !ok;
+    ran++;
+  }
+  printf("%d of %d passed\n", ran - failed, ran);
+  return failed ? 1 : 0;
+}
+
+#define SKETCH_TESTS(...) \
+  int main(int argc, char **argv) \
+  { \
+    static const sketchTest tests[] = { __VA_ARGS__ }; \
+    return runSketchTests(tests, sizeof(tests) / sizeof(tests[0]), argc, argv); \
+  }
+
+#endif
@@ -0,0 +1,88 @@
+#!/bin/sh
+# sketchHost - build RobotComm for the host, on the board model in hostTools/arduino, and run the
+# tests in this folder against it (see sketchHost.h for how a test is written)
+#
+# The sketch's tabs are joined the way the IDE joins them (sketchJoin.cpp), and compiled with g++
+# together with the libraries it uses and the motor driver of the board asked for.  This checks
+# what the code does, not what it costs: timing is the model's (see hostArduino.h), and flash, SRAM
+# and stack sizes need the real build (hostTools/buildMatrix, hostTools/stackDepth).
+#
+# needs g++
+# use (from anywhere in the repository):
+#   hostTools/sketchHost/sketchHost.sh [-D flags] [-v] [-c] [test file [test name ...]]
+#     -c  build the tests but do not run them
+#     e.g. hostTools/sketchHost/sketchHost.sh                      every *Test.cpp here
+#          hostTools/sketchHost/sketchHost.sh -DROBOT_BOARD=4 -v commandTest.cpp turnDefault
+# exits with status 1 if anything fails to build or a test fails.
+# the builds are kept in $TMPDIR/robotSketchHost
+
+REPO=$(cd "$(dirname "$0")/../.." && pwd)
+HERE=$REPO/hostTools/sketchHost
+SKETCH=RobotComm_v0_81
+BUILD=${TMPDIR:-/tmp}/robotSketchHost
+BOARD=1
+FLAGS=
+VERBOSE=
+BUILD_ONLY=
+STATUS=0
+
+while [ $# -gt 0 ]; do
+  case $1 in
+    -DROBOT_BOARD=*) BOARD=${1#-DROBOT_BOARD=}; FLAGS="$FLAGS $1" ;;
+    -D*) FLAGS="$FLAGS $1" ;;
+    -v) VERBOSE=-v ;;
+    -c) BUILD_ONLY=1 ;;
+    *) break ;;
+  esac
+  shift
+done
+TESTS=${1:-$(cd "$HERE" && ls *Test.cpp)}
+[ $# -gt 0 ] && shift
+
+# the motor driver each ROBOT_BOARD uses, see libraries/RobotCommCore/RobotCommCore.h
+case $BOARD in
+  1) DRIVER=threeMotorsDriverPCB ;;
+  2) DRIVER=threeMotorsDriver ;;
+  3) DRIVER=threeMotorsDriverReverse ;;
+  4) DRIVER=threeMotorsDriverCalypso ;;
+  5) DRIVER=threeMotorsPololuBigDriver ;;
+  *) echo "no ROBOT_BOARD $BOARD"; exit 1 ;;
+esac
+
+INCLUDES="-I$REPO/hostTools/arduino -I$HERE -I$BUILD"
+for library in "$REPO"/libraries/*/; do INCLUDES="$INCLUDES -I$library"; done
+CXX="g++ -std=gnu++11 -O1 -g -Wall -DARDUINO=100 -Wno-unused-variable -Wno-unused-but-set-variable $FLAGS $INCLUDES"
+
+# the libraries' code the sketch links with; stackCanary.cpp is AVR assembler, sketchHost.h stands in
+SOURCES="$REPO/hostTools/arduino/hostArduino.cpp
+$REPO/libraries/BufferedUART/BufferedUART.cpp
+$REPO/libraries/backgroundADC/backgroundADC.cpp
+$REPO/libraries/irLibrary/irSensor.cpp
+$REPO/libraries/RobotCommCore/backgroundEEPROM.cpp
+$REPO/libraries/RobotCommCore/batteryEstimator.cpp
+$REPO/libraries/RobotCommCore/powerGovernor.cpp
+$REPO/libraries/RobotCommCore/turnController.cpp
+$REPO/libraries/MotorDriverLibrary9thSense/$DRIVER.cpp"
+
+mkdir -p "$BUILD" || exit 1
+g++ -O2 -o "$BUILD/sketchJoin" "$HERE/sketchJoin.cpp" || exit 1
+"$BUILD/sketchJoin" "$REPO/$SKETCH" "$BUILD/$SKETCH.cpp" || exit 1
+OBJECTS=
+for source in $SOURCES; do
+  object=$BUILD/$(basename "$source" .cpp).o
+  $CXX -c -o "$object" "$source" || exit 1
+  OBJECTS="$OBJECTS $object"
+done
+
+for test in $TESTS; do
+  name=$(basename "$test" .cpp)
+  echo "$name"
+  if ! $CXX -o "$BUILD/$name" "$HERE/$name.cpp" $OBJECTS; then
+    echo "  FAILED to build"
+    STATUS=1
+    continue
+  fi
+  [ -n "$BUILD_ONLY" ] && continue
+  "$BUILD/$name" $VERBOSE "$@" || STATUS=1
+done
+exit $STATUS
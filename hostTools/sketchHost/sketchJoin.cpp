@@ -0,0 +1,194 @@
+// sketchJoin - a sketch's tabs as one C++ file, the way the Arduino IDE builds them
+//
+// The tab named after the sketch folder comes first, then the others in alphabetical order, with
+// #include <Arduino.h> at the top and a prototype for every function ahead of the first function, so
+// a tab can call a function defined in a later one.  As in the IDE, a global is only seen by the tabs
+// after the one it is in.  #line directives keep the compiler's messages on the tabs.
+// A function is found the way the IDE's prototype pass finds it: a header on one line at the top
+// level (not in braces), followed by its {.  Templates, and anything the IDE would miss, need their
+// own declarations in the sketch, as they do there.
+//
+// build:
+//   g++ -O2 -o sketchJoin sketchJoin.cpp
+// use:
+//   sketchJoin <sketch folder> <output .cpp>
+
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct sourceLine
+{
+  std::string text;
+  std::string file;
+  int line;
+};
+
+static bool readTab(const std::string& path, std::vector<sourceLine>& lines)
+{
+  std::ifstream in(path.c_str());
+  if (!in) return false;
+  std::string text;
+  for (int n = 1; std::getline(in, text); n++)
+  {
+    if (!text.empty() && text[text.size() - 1] == '\r') text.erase(text.size() - 1);
+    sourceLine line = { text, path, n };
+    lines.push_back(line);
+  }
+  return true;
+}
+
+// the code on a line, without comments and the insides of strings and character constants
+static std::string codeOnly(const std::string& text, bool& inComment)
+{
+  std::string code;
+  for (size_t i = 0; i < text.size(); i++)
+  {
+    if (inComment)
+    {
+      if (text.compare(i, 2, "*/") == 0)
+      {
+        inComment = false;
+        i++;
+      }
+      continue;
+    }
+    if (text.compare(i, 2, "//") == 0) break;
+    if (text.compare(i, 2, "/*") == 0)
+    {
+      inComment = true;
+      i++;
+      continue;
+    }
+    if (text[i] == '"' || text[i] == '\'')
+    {
+      char quote = text[i];
+      for (i++; i < text.size() && text[i] != quote; i++)
+        if (text[i] == '\\') i++;
+      code += quote;
+      code += quote;
+      continue;
+    }
+    code += text[i];
+  }
+  return code;
+}
+
+int main(int argc, char **argv)
+{
+  if (argc != 3)
+  {
+    fprintf(stderr, "use: sketchJoin <sketch folder> <output .cpp>\n");
+    return 1;
+  }
+  std::string folder = argv[1];
+  while (folder.size() > 1 && folder[folder.size() - 1] == '/') folder.erase(folder.size() - 1);
+  std::string name = folder.substr(folder.find_last_of('/') + 1);
+
+  std::vector<std::string> tabs;
+  DIR *dir = opendir(folder.c_str());
+  if (!dir)
+  {
+    perror(folder.c_str());
+    return 1;
+  }
+  while (dirent *entry = readdir(dir))
+  {
+    std::string file = entry->d_name;
+    if (file.size() > 4 && file.compare(file.size() - 4, 4, ".ino") == 0 && file != name + ".ino") tabs.push_back(file);
+  }
+  closedir(dir);
+  std::sort(tabs.begin(), tabs.end());
+  tabs.insert(tabs.begin(), name + ".ino");
+
+  std::vector<sourceLine> lines;
+  for (size_t i = 0; i < tabs.size(); i++)
+  {
+    if (!readTab(folder + "/" + tabs[i], lines))
+    {
+      perror(tabs[i].c_str());
+      return 1;
+    }
+  }
+
+  // return type (with the qualifiers that can come before it), name, parameters, then { or nothing
+  std::regex header("^\\s*((?:static\\s+|inline\\s+|unsigned\\s+|const\\s+|volatile\\s+)*[A-Za-z_][\\w:<>]*[\\s*&]+)"
+                    "([A-Za-z_]\\w*)\\s*\\(([^;{}]*)\\)\\s*(\\{.*)?$");
+  std::regex defaultValue("\\s*=\\s*[^,]+");
+  const char *keywords[] = { "if", "while", "for", "switch", "else", "return", "ISR", "sizeof", "do", "case", "new", "delete" };
+  std::vector<std::string> prototypes;
+  size_t first = lines.size();
+  int depth = 0;
+  bool inComment = false;
+  for (size_t i = 0; i < lines.size(); i++)
+  {
+    bool startsInComment = inComment;
+    std::string code = codeOnly(lines[i].text, inComment);
+    std::smatch match;
+    if (depth == 0 && !startsInComment && code.find('#') == std::string::npos && std::regex_match(code, match, header))
+    {
+      std::string type = match[1].str(), function = match[2].str();
+      std::string typeWord = type.substr(type.find_first_not_of(" \t"));
+      typeWord = typeWord.substr(0, typeWord.find_first_of(" \t*&"));
+      bool keyword = false;
+      for (size_t k = 0; k < sizeof(keywords) / sizeof(keywords[0]); k++)
+        keyword = keyword || function == keywords[k] || typeWord == keywords[k];
+      // the { may be on a later line, after blank lines and comments
+      bool body = match[4].matched;
+      bool comment = inComment;
+      for (size_t j = i + 1; !body && j < lines.size(); j++)
+      {
+        std::string next = codeOnly(lines[j].text, comment);
+        size_t start = next.find_first_not_of(" \t");
+        if (start == std::string::npos) continue;
+        body = next[start] == '{';
+        break;
+      }
+      bool templated = i > 0 && lines[i - 1].text.find("template") != std::string::npos;
+      if (!keyword && body && !templated && type.find("::") == std::string::npos && type.find("operator") == std::string::npos)
+      {
+        std::string type = match[1].str();
+        type = type.substr(type.find_first_not_of(" \t"));
+        prototypes.push_back(type + function + "(" + std::regex_replace(match[3].str(), defaultValue, "") + ");");
+        if (first == lines.size()) first = i;
+      }
+    }
+    for (size_t c = 0; c < code.size(); c++)
+    {
+      if (code[c] == '{') depth++;
+      if (code[c] == '}') depth--;
+    }
+  }
+
+  std::ostringstream out;
+  out << "#include <Arduino.h>\n";
+  std::string file;
+  int expected = 0;
+  for (size_t i = 0; i < lines.size(); i++)
+  {
+    if (i == first)
+    {
+      out << "#line 1 \"prototypes\"\n";
+      for (size_t p = 0; p < prototypes.size(); p++) out << prototypes[p] << "\n";
+      file.clear();
+    }
+    if (lines[i].file != file || lines[i].line != expected) out << "#line " << lines[i].line << " \"" << lines[i].file << "\"\n";
+    file = lines[i].file;
+    expected = lines[i].line + 1;
+    out << lines[i].text << "\n";
+  }
+  std::ofstream output(argv[2]);
+  output << out.str();
+  if (!output)
+  {
+    perror(argv[2]);
+    return 1;
+  }
+  return 0;
+}
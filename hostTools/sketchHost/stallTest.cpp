@@ -0,0 +1,202 @@
+// stallTest - the stall and stuck wheel detector (q_stallDetector) fed with made up current and gyro
+// traces, to see how often its thresholds are fooled and how quickly it finds a real fault.
+// Each trace is the drive wheels' current with noise on every sample, an inrush as the wheels start
+// and load bumps shorter than the debounce, and for a turn the rate the gyro would report.  A fault
+// trace changes the left wheel (or the turn rate) at FAULT_AT msec into the move; a clean trace runs
+// CLEAN_MSEC and any stop in it is a false positive.  Every trace is run TRIALS times with different
+// noise.  The thresholds are the EEPROM fallbacks: stalled over 2500 mA, free under 100 mA, at a PWM of
+// 100 or more, slipping under 10 degrees/sec.
+// With -v the false positive and negative counts and the detection times are printed.
+//
+// build and run with sketchHost.sh:
+//   hostTools/sketchHost/sketchHost.sh stallTest.cpp [test name ...]
+
+#include "RobotComm_v0_81.cpp"
+#include "sketchHost.h"
+
+#define TRIALS 20
+#define FAULT_AT 400        // msec into the move
+#define CLEAN_MSEC 2000
+#define INRUSH_MSEC 80      // the wheels draw inrushMilliAmps as they start
+#define BUMP_EVERY 200      // msec between load bumps
+#define BUMP_MSEC 30        // shorter than the debounce
+#define BATTERY_PIN 4       // the battery_monitor_pin fallback
+#define BATTERY_FULL 800    // 12.5 V through the 3.2 divider, so the power governor lets the wheels up to speed
+#define FIND_BOUND ((STALL_DEBOUNCE + 1) * STALL_INTERVAL + 5)  // a sample to see it, the debounce, the ADC filter
+
+struct stallTrace
+{
+  const char *command;
+  int milliAmps, noise;          // both wheels, every msec, noise is the most a sample is off by
+  int inrushMilliAmps;
+  int bumpMilliAmps;             // 0 for none
+  int yawTenths;                 // what the gyro reports while turning, 0 for no gyro
+  int faultMilliAmps;            // the left wheel from FAULT_AT on, -1 to leave it alone
+  int faultYawTenths;            // the gyro from FAULT_AT on, -1 to leave it alone
+};
+
+static unsigned long noiseState;
+
+// about -range..range, more often near 0: four uniform draws added up
+static int noise(int range)
+{
+  int sum = 0;
+  for (int i = 0; i < 4; i++)
+  {
+    noiseState = noiseState * 1103515245 + 12345;
+    sum += (int) ((noiseState >> 16) % (2 * range + 1)) - range;
+  }
+  return sum / 4;
+}
+
+static void setCurrent(uint8_t pin, int milliAmps)
+{
+  hostSetAnalog(pin, constrain(milliAmps / ROBOT_MILLIAMPS_PER_COUNT, 0, 1023));
+}
+
+// runs trace once; the msec from the fault until the detector stopped the robot, or -1 if it did not,
+// and the kind it found
+static int runTrace(const stallTrace& trace, unsigned long seed, int *kind)
+{
+  noiseState = seed;
+  stallKind = STALL_NONE;
+  stallMask = 0;
+  robotSend(trace.command);
+  robotRunUntil([] { return Moving || Turning; }, 100);
+  bool fault = trace.faultMilliAmps >= 0 || trace.faultYawTenths >= 0;
+  int length = fault ? FAULT_AT + 500 : CLEAN_MSEC;
+  int found = -1;
+  for (int t = 0; t < length && found < 0; t++)
+  {
+    int left = trace.milliAmps, right = trace.milliAmps, yaw = trace.yawTenths;
+    if (t < INRUSH_MSEC) left = right = trace.inrushMilliAmps;
+    else if (trace.bumpMilliAmps && t % BUMP_EVERY < BUMP_MSEC) left = trace.bumpMilliAmps;
+    if (t >= FAULT_AT && trace.faultMilliAmps >= 0) left = trace.faultMilliAmps;
+    if (t >= FAULT_AT && trace.faultYawTenths >= 0) yaw = trace.faultYawTenths;
+    setCurrent(FBA, left + noise(trace.noise));
+    setCurrent(FBB, right + noise(trace.noise));
+    if (yaw)
+    {
+      yawRateTenths = yaw + noise(30);
+      yawRateMillis = millis();
+    }
+    robotRun(1);
+    if (stallMask) found = t - (fault ? FAULT_AT : 0);
+  }
+  *kind = stallKind;
+  robotSend("x#");
+  setCurrent(FBA, 0);
+  setCurrent(FBB, 0);
+  robotRun(100);
+  return found;
+}
+
+// runs trace TRIALS times; a fault must be found every time as the kind expected, within FIND_BOUND
+// msec, and a clean trace must never stop the robot
+static void checkTrace(const char *name, const stallTrace& trace, int expectKind)
+{
+  hostSetAnalog(BATTERY_PIN, BATTERY_FULL);
+  robotStart();
+  int found = 0, wrongKind = 0, fastest = 0x7FFF, slowest = 0;
+  for (int i = 0; i < TRIALS; i++)
+  {
+    int kind;
+    int msec = runTrace(trace, 1234567 + i * 7919, &kind);
+    if (msec < 0) continue;
+    found++;
+    if (kind != expectKind) wrongKind++;
+    if (msec < fastest) fastest = msec;
+    if (msec > slowest) slowest = msec;
+  }
+  bool fault = expectKind != STALL_NONE;
+  if (testVerbose)
+  {
+    if (fault) printf("    %s: found %d of %d, %d as another kind, in %d to %d msec\n", name, found, TRIALS, wrongKind, fastest, slowest);
+    else printf("    %s: %d false stops in %d msec of driving\n", name, found, TRIALS * CLEAN_MSEC);
+  }
+  if (!fault)
+  {
+    expect(found == 0, "%s: %d false stops in %d trials", name, found, TRIALS);
+    return;
+  }
+  expect(found == TRIALS, "%s: missed %d of %d", name, TRIALS - found, TRIALS);
+  expect(wrongKind == 0, "%s: %d found as another kind than %d", name, wrongKind, expectKind);
+  expect(found == 0 || slowest <= FIND_BOUND, "%s: took up to %d msec, over %d", name, slowest, FIND_BOUND);
+}
+
+// command, mA and noise, inrush, bump, gyro, left wheel fault, gyro fault
+static const stallTrace driving =  { "F200#", 900, 600, 5000, 3500, 0, -1, -1 };
+static const stallTrace turning =  { "R200#", 1200, 600, 5000, 3500, 900, -1, -1 };
+static const stallTrace slowDrive = { "F90#", 60, 40, 3000, 0, 0, -1, -1 };  // under stall_min_pwm
+
+static void cleanDriving() { checkTrace("driving", driving, STALL_NONE); }
+static void cleanTurning() { checkTrace("turning", turning, STALL_NONE); }
+static void cleanSlowDrive() { checkTrace("slow driving", slowDrive, STALL_NONE); }
+
+static void stalled()
+{
+  stallTrace trace = driving;
+  trace.faultMilliAmps = 3500;
+  checkTrace("stalled", trace, STALL_STALLED);
+}
+
+static void freeSpinning()
+{
+  stallTrace trace = driving;
+  trace.faultMilliAmps = 40;
+  trace.noise = 30;
+  checkTrace("free spinning", trace, STALL_FREE_SPINNING);
+}
+
+static void slipping()
+{
+  stallTrace trace = turning;
+  trace.faultYawTenths = 20;
+  checkTrace("slipping", trace, STALL_SLIPPING);
+}
+
+// a stall in the middle of a queued maneuver cancels the rest of it
+static void stallCancelsQueue()
+{
+  hostSetAnalog(BATTERY_PIN, BATTERY_FULL);
+  robotStart();
+  robotSend("qF200#");
+  robotSend("qr200,200#");
+  robotSend("qB200#");
+  expect(robotRunUntil([] { return Moving; }, 200), "the maneuver did not start");
+  setCurrent(FBA, driving.milliAmps);
+  setCurrent(FBB, driving.milliAmps);
+  robotRun(300);
+  setCurrent(FBA, 3500);
+  expect(robotRunUntilSaid("mK", FIND_BOUND + 50), "the stall was not found");
+  setCurrent(FBA, 0);
+  setCurrent(FBB, 0);
+  robotRun(50);
+  expect(robotSaid("mo2") && robotSaid("mo3") && commandQueueCount == 0, "the rest of the maneuver was not cancelled");
+  robotRun(1000);
+  expect(!Turning && !Moving && !robotLogged("running queued command: r"), "a step ran after the stall");
+}
+
+// the detector turned off leaves a stalled wheel alone
+static void turnedOff()
+{
+  hostSetAnalog(BATTERY_PIN, BATTERY_FULL);
+  robotStart();
+  robotSend("K0#");
+  robotRun(20);
+  stallTrace trace = driving;
+  trace.faultMilliAmps = 3500;
+  int kind;
+  expect(runTrace(trace, 1, &kind) < 0 && !robotSaid("mK1"), "stopped with the detector off");
+}
+
+SKETCH_TESTS(
+  TEST(cleanDriving)
+  TEST(cleanTurning)
+  TEST(cleanSlowDrive)
+  TEST(stalled)
+  TEST(freeSpinning)
+  TEST(slipping)
+  TEST(stallCancelsQueue)
+  TEST(turnedOff)
+)
@@ -0,0 +1,214 @@
+// sramReport - SRAM budget of a RobotComm build, by module
+//
+// Lists, for each source file (sketch tab, library or Arduino core file), the bytes it takes in
+// .data (initialized globals, which also take flash) and .bss (zeroed globals), and its largest
+// stack frame, then the totals against the 8 KB of the Mega:
+//   static   .data + .bss, from avr-size; what the symbols don't account for is alignment
+//   heap     only in use when malloc is linked in (String, new); its size depends on the run
+//   free     what is left for the stack and the heap
+// The largest frame is only a lower bound on the stack a module needs; the deepest call chain
+// needs a call graph.
+//
+// The module of a symbol comes from its debug line information, which the Arduino build has (-g),
+// and which follows the #line directives, so the sketch's globals are listed under their tabs.
+// Frames come from the .su files that gcc writes with -fstack-usage; hostTools/buildMatrix builds
+// with it, and without them the frame column is empty.
+//
+// build:
+//   g++ -O2 -o sramReport sramReport.cpp
+// use:
+//   sramReport sketch.elf [build directory]
+// e.g. after buildMatrix:
+//   sramReport /tmp/robotBuildMatrix/pcb/RobotComm_v0_81.ino.elf /tmp/robotBuildMatrix/pcb
+// avr-nm and avr-size are taken from the path, or from AVR_NM and AVR_SIZE.
+// hostTools/avrFixture/fixtureTest.sh runs the report against a small AVR symbol table and .su set.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SRAM_BYTES 8192
+#define MAX_MODULES 200
+#define NAME_LENGTH 64
+
+struct Module
+{
+  char name[NAME_LENGTH];
+  long data, bss;
+  long frame;                       // largest stack frame, -1 when there is no .su entry
+  char frameFunction[NAME_LENGTH];
+};
+
+static Module modules[MAX_MODULES];
+static int moduleCount;
+
+// "path/to/k_motorControl.ino:123" -> "k_motorControl.ino"
+static void moduleName(const char* location, char* name)
+{
+  const char* start = strrchr(location, '/');
+  start = start ? start + 1 : location;
+  size_t length = strcspn(start, ":\n");
+  if (length >= NAME_LENGTH) length = NAME_LENGTH - 1;
+  memcpy(name, start, length);
+  name[length] = 0;
+}
+
+static Module* findModule(const char* name)
+{
+  for (int i = 0; i < moduleCount; i++)
+    if (!strcmp(modules[i].name, name)) return &modules[i];
+  if (moduleCount == MAX_MODULES) return &modules[MAX_MODULES - 1];  // lumped in with the last one
+  Module* module = &modules[moduleCount++];
+  strcpy(module->name, name);
+  module->frame = -1;
+  return module;
+}
+
+static FILE* run(const char* tool, const char* fallback, const char* arguments, const char* file)
+{
+  char command[1024];
+  const char* path = getenv(tool);
+  snprintf(command, sizeof(command), "%s %s '%s'", path ? path : fallback, arguments, file);
+  FILE* pipe = popen(command, "r");
+  if (!pipe) perror(command);
+  return pipe;
+}
+
+// avr-nm -S -l lines: address size type name [tab file:line]; false when there are no symbols.
+// nm types weak objects (vtables of classes with only inline virtual methods, and the like) V or v
+// whichever section they are in, so they go by their address: from bssStart on they are .bss
+static bool readSymbols(const char* elf, long bssStart, bool* heap)
+{
+  FILE* pipe = run("AVR_NM", "avr-nm", "-S -l -t d", elf);
+  if (!pipe) return false;
+  char line[1024];
+  int symbols = 0;
+  *heap = false;
+  while (fgets(line, sizeof(line), pipe))
+  {
+    long address, size;
+    char type, name[512];
+    if (sscanf(line, "%ld %ld %c %511s", &address, &size, &type, name) != 4)
+    {
+      // symbols without a size, like malloc on some toolchains: address type name
+      if (sscanf(line, "%ld %c %511s", &address, &type, name) == 3 && !strcmp(name, "malloc")) *heap = true;
+      continue;
+    }
+    symbols++;
+    if (!strcmp(name, "malloc")) *heap = true;
+    bool weak = type == 'v' || type == 'V';
+    bool data = type == 'd' || type == 'D' || (weak && address < bssStart);
+    bool bss = type == 'b' || type == 'B' || (weak && address >= bssStart);
+    if (!data && !bss) continue;
+    char module[NAME_LENGTH] = "(no line info)";
+    const char* location = strchr(line, '\t');
+    if (location) moduleName(location + 1, module);
+    Module* m = findModule(module);
+    if (data) m->data += size;
+    else m->bss += size;
+  }
+  pclose(pipe);
+  return symbols > 0;
+}
+
+// avr-size -A: "name size address" per section
+static void readSections(const char* elf, long* data, long* bss, long* bssStart)
+{
+  *data = *bss = 0;
+  *bssStart = 0x7fffffff;  // no avr-size, no weak objects in .bss
+  FILE* pipe = run("AVR_SIZE", "avr-size", "-A", elf);
+  if (!pipe) return;
+  char line[256], section[64];
+  long size, address;
+  while (fgets(line, sizeof(line), pipe))
+    if (sscanf(line, "%63s %ld %ld", section, &size, &address) == 3)
+    {
+      if (!strcmp(section, ".data")) *data = size;
+      else if (!strcmp(section, ".bss") || !strcmp(section, ".noinit")) *bss += size;
+      if (!strcmp(section, ".bss")) *bssStart = address;
+    }
+  pclose(pipe);
+}
+
+// .su lines: file:line:column:function <tab> bytes <tab> static|dynamic|bounded; the function's own
+// name has colons in it when it is a method
+static void readFrames(const char* directory)
+{
+  char command[1024], path[1024], line[1024];
+  snprintf(command, sizeof(command), "find '%s' -name '*.su'", directory);
+  FILE* files = popen(command, "r");
+  if (!files) return;
+  while (fgets(path, sizeof(path), files))
+  {
+    path[strcspn(path, "\n")] = 0;
+    FILE* su = fopen(path, "r");
+    if (!su) continue;
+    while (fgets(line, sizeof(line), su))
+    {
+      char* tab = strchr(line, '\t');
+      if (!tab) continue;
+      *tab = 0;
+      long bytes = atol(tab + 1);
+      char* function = line;
+      for (int i = 0; i < 3 && function; i++) function = strchr(function + 1, ':');
+      char module[NAME_LENGTH];
+      moduleName(line, module);
+      Module* m = findModule(module);
+      if (bytes > m->frame)
+      {
+        m->frame = bytes;
+        snprintf(m->frameFunction, NAME_LENGTH, "%s", function ? function + 1 : "");
+      }
+    }
+    fclose(su);
+  }
+  pclose(files);
+}
+
+static int byStatic(const void* a, const void* b)
+{
+  const Module* x = (const Module*) a;
+  const Module* y = (const Module*) b;
+  long difference = (y->data + y->bss) - (x->data + x->bss);
+  if (difference) return difference > 0 ? 1 : -1;
+  return y->frame > x->frame ? 1 : (y->frame < x->frame ? -1 : 0);
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 2 || argc > 3)
+  {
+    fprintf(stderr, "use: sramReport sketch.elf [build directory]\n");
+    return 1;
+  }
+  bool heap;
+  long data, bss, bssStart;
+  readSections(argv[1], &data, &bss, &bssStart);
+  if (!readSymbols(argv[1], bssStart, &heap))
+  {
+    fprintf(stderr, "no symbols read from %s\n", argv[1]);
+    return 1;
+  }
+  if (argc == 3) readFrames(argv[2]);
+
+  qsort(modules, moduleCount, sizeof(Module), byStatic);
+  long symbolData = 0, symbolBss = 0;
+  printf("%-32s %7s %7s %7s  %s\n", "module", ".data", ".bss", "frame", "largest frame in");
+  for (int i = 0; i < moduleCount; i++)
+  {
+    Module* m = &modules[i];
+    symbolData += m->data;
+    symbolBss += m->bss;
+    if (m->frame >= 0) printf("%-32s %7ld %7ld %7ld  %s\n", m->name, m->data, m->bss, m->frame, m->frameFunction);
+    else printf("%-32s %7ld %7ld\n", m->name, m->data, m->bss);
+  }
+  if (data + bss == 0)  // no avr-size, go by the symbols
+  {
+    data = symbolData;
+    bss = symbolBss;
+  }
+  printf("%-32s %7ld %7ld\n", "(alignment, unnamed)", data - symbolData, bss - symbolBss);
+  printf("\nstatic %ld bytes (.data %ld, .bss %ld), heap %s, free for stack and heap %ld of %d\n",
+         data + bss, data, bss, heap ? "in use (malloc linked)" : "not used", SRAM_BYTES - data - bss, SRAM_BYTES);
+  return 0;
+}
@@ -0,0 +1,384 @@
+// stackDepth - worst case stack depth of a RobotComm build, from its call graph
+//
+// The call graph comes from the disassembly of the ELF (avr-objdump -d -C): every call, rcall, and
+// jmp or rjmp to the start of another function is an edge.  The frame of each function comes from
+// the .su files gcc writes with -fstack-usage.  avr-gcc's frames include the return address, 3 bytes
+// on the Mega 2560 (its prologue adds INCOMING_FRAME_SP_OFFSET to the size it reports), and an
+// interrupt's include the interrupted PC the same way; a function with no .su entry counts as just its
+// return address.  A tail jump is counted as a call, which overstates it by those 3 bytes.  The tool
+// walks the graph from main() and from every interrupt vector, and reports the deepest chain from
+// each of them.  The worst case is main() plus the deepest single interrupt, or, for an interrupt
+// named with -n, which turns interrupts back on part way, main() plus that interrupt plus the deepest
+// of the others, as if they nested at its deepest point (which overstates it).
+//
+// The disassembly can't show where a call through a function pointer or a virtual method goes
+// (icall/eicall).  -i caller:callees gives the answer: an indirect call in any function whose name
+// contains caller may go to any function whose name contains callees.  The indirect calls no rule
+// covers are listed, and they count as nothing, as does a loop back into a function that is already
+// on the chain (recursion).  A function with no .su entry (libgcc and libc assembly) pushes nothing
+// as far as the tool knows.
+// hostTools/avrFixture/fixtureTest.sh runs the tool against a small AVR disassembly and .su set.
+//
+// build:
+//   g++ -O2 -o stackDepth stackDepth.cpp
+// use:
+//   stackDepth [-i caller:callees]... [-n vector]... [-r return address bytes] sketch.elf build_directory
+// or stackDepth.sh in this directory, which builds the sketch and this tool first.
+// -r is the return address a function with no .su entry counts as, 3 bytes unless given.
+// avr-objdump and avr-size are taken from the path, or from AVR_OBJDUMP and AVR_SIZE.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#define SRAM_BYTES 8192
+
+struct Function
+{
+  long frame;                  // -1 when there is no .su entry
+  bool dynamic;                // the frame also has alloca or variable length arrays
+  bool indirect;               // has an icall or eicall
+  std::set<std::string> callees;
+  // filled in by the walk
+  bool visiting, done;
+  long depth;                  // deepest stack from entry to this function, including its own frame
+  std::string next;            // the callee on the deepest chain
+};
+
+struct IndirectRule
+{
+  std::string caller, callees;
+};
+
+static std::map<std::string, Function> functions;
+static std::map<std::string, long> frames;  // .su frames by normalized name
+static std::map<std::string, bool> dynamicFrames;
+static std::vector<IndirectRule> rules;
+static std::set<std::string> unresolved, noFrame, recursive;
+static std::set<std::string> nesting;  // interrupts that turn interrupts back on part way, -n
+static int returnBytes = 3;
+
+// drops the return type, which gcc's .su names and objdump's template names carry:
+// "void robotLog::message<int>(unsigned char, int)" -> "robotLog::message<int>(unsigned char, int)"
+static std::string normalize(const std::string& name)
+{
+  int depth = 0;
+  size_t start = 0;
+  for (size_t i = 0; i < name.size(); i++)
+  {
+    char c = name[i];
+    if (c == '<') depth++;
+    else if (c == '>') depth--;
+    else if (c == '(' && depth == 0 && name.compare(start, 8, "operator") != 0) break;
+    else if (c == ' ' && depth == 0) start = i + 1;
+  }
+  return name.substr(start);
+}
+
+// "move(int, int)" -> "move", for C functions that .su names with "()" and objdump without, and
+// "robotLog::message<int>(unsigned char, int)" -> "robotLog::message", for templates, which .su
+// names as "robotLog::message(uint8_t, Args ...) [with Args = {int}]"; all the instances of a
+// template share the largest frame of any of them
+static std::string bareName(const std::string& name)
+{
+  std::string bare = name.substr(0, name.find('('));
+  if (!bare.empty() && bare[bare.size() - 1] == '>')
+  {
+    int depth = 0;
+    for (size_t i = bare.size(); i-- > 0; )
+    {
+      if (bare[i] == '>') depth++;
+      else if (bare[i] == '<' && --depth == 0) return bare.substr(0, i);
+    }
+  }
+  return bare;
+}
+
+static void readFrames(const char* directory)
+{
+  char command[1024], path[1024], line[2048];
+  snprintf(command, sizeof(command), "find '%s' -name '*.su'", directory);
+  FILE* files = popen(command, "r");
+  if (!files) return;
+  while (fgets(path, sizeof(path), files))
+  {
+    path[strcspn(path, "\n")] = 0;
+    FILE* su = fopen(path, "r");
+    if (!su) continue;
+    // file:line:column:function <tab> bytes <tab> static|dynamic|dynamic,bounded
+    while (fgets(line, sizeof(line), su))
+    {
+      char* tab = strchr(line, '\t');
+      if (!tab) continue;
+      *tab = 0;
+      long bytes = atol(tab + 1);
+      bool dynamic = strstr(tab + 1, "dynamic") != 0;
+      char* colon = line;
+      for (int i = 0; i < 3 && colon; i++) colon = strchr(colon + 1, ':');
+      if (!colon) continue;
+      std::string name = normalize(colon + 1);
+      for (int key = 0; key < 2; key++, name = bareName(name))
+      {
+        std::map<std::string, long>::iterator f = frames.find(name);
+        if (f != frames.end() && f->second >= bytes) continue;  // static functions of the same name
+        frames[name] = bytes;
+        dynamicFrames[name] = dynamic;
+      }
+    }
+    fclose(su);
+  }
+  pclose(files);
+}
+
+static FILE* run(const char* tool, const char* fallback, const char* arguments, const char* file)
+{
+  char command[1024];
+  const char* path = getenv(tool);
+  snprintf(command, sizeof(command), "%s %s '%s'", path ? path : fallback, arguments, file);
+  FILE* pipe = popen(command, "r");
+  if (!pipe) perror(command);
+  return pipe;
+}
+
+// "00000abc <move(int, int)>:" starts a function; instructions are
+// "     ac0:	0e 94 12 34 	call	0x6824	; 0x6824 <turn(int, int)>"
+static bool readCallGraph(const char* elf)
+{
+  FILE* pipe = run("AVR_OBJDUMP", "avr-objdump", "-d -C", elf);
+  if (!pipe) return false;
+  char buffer[4096];
+  Function* current = 0;
+  while (fgets(buffer, sizeof(buffer), pipe))
+  {
+    std::string line(buffer);
+    line.erase(line.find_last_not_of("\r\n") + 1);
+    size_t open = line.find(" <");
+    if (line.size() > 3 && line[0] != ' ' && open != std::string::npos && line.compare(line.size() - 2, 2, ">:") == 0)
+    {
+      std::string name = normalize(line.substr(open + 2, line.size() - open - 4));
+      current = &functions[name];
+      continue;
+    }
+    if (!current) continue;
+    if (line.find("\ticall") != std::string::npos || line.find("\teicall") != std::string::npos)
+    {
+      current->indirect = true;
+      continue;
+    }
+    bool call = line.find("\tcall\t") != std::string::npos || line.find("\trcall\t") != std::string::npos;
+    bool jump = line.find("\tjmp\t") != std::string::npos || line.find("\trjmp\t") != std::string::npos;
+    size_t target = line.find("; 0x");
+    if ((!call && !jump) || target == std::string::npos) continue;
+    target = line.find('<', target);
+    if (target == std::string::npos) continue;
+    std::string callee = line.substr(target + 1, line.rfind('>') - target - 1);
+    if (callee.find("+0x") != std::string::npos) continue;  // a branch inside a function
+    current->callees.insert(normalize(callee));
+  }
+  pclose(pipe);
+  return !functions.empty();
+}
+
+static long frameOf(const std::string& name, bool* dynamic)
+{
+  std::map<std::string, long>::iterator f = frames.find(name);
+  if (f == frames.end()) f = frames.find(bareName(name));
+  if (f == frames.end())
+  {
+    *dynamic = false;
+    return -1;
+  }
+  *dynamic = dynamicFrames[f->first];
+  return f->second;
+}
+
+static void resolve()
+{
+  for (std::map<std::string, Function>::iterator f = functions.begin(); f != functions.end(); ++f)
+  {
+    f->second.frame = frameOf(f->first, &f->second.dynamic);
+    if (!f->second.indirect) continue;
+    bool covered = false;
+    for (size_t r = 0; r < rules.size(); r++)
+    {
+      if (f->first.find(rules[r].caller) == std::string::npos) continue;
+      covered = true;
+      for (std::map<std::string, Function>::iterator g = functions.begin(); g != functions.end(); ++g)
+        if (g->first.find(rules[r].callees) != std::string::npos) f->second.callees.insert(g->first);
+    }
+    if (!covered) unresolved.insert(f->first);
+  }
+}
+
+// deepest stack below and including this function
+static long walk(const std::string& name)
+{
+  std::map<std::string, Function>::iterator found = functions.find(name);
+  if (found == functions.end()) return 0;
+  Function& f = found->second;
+  if (f.done) return f.depth;
+  if (f.visiting)
+  {
+    recursive.insert(name);
+    return 0;
+  }
+  f.visiting = true;
+  long deepest = 0;
+  for (std::set<std::string>::iterator c = f.callees.begin(); c != f.callees.end(); ++c)
+  {
+    if (*c == name)
+    {
+      recursive.insert(name);
+      continue;
+    }
+    long depth = walk(*c);
+    if (depth > deepest)
+    {
+      deepest = depth;
+      f.next = *c;
+    }
+  }
+  if (f.frame < 0) noFrame.insert(name);
+  f.depth = (f.frame >= 0 ? f.frame : returnBytes) + deepest;
+  f.visiting = false;
+  f.done = true;
+  return f.depth;
+}
+
+static void printChain(const std::string& entry)
+{
+  std::string name = entry;
+  for (int hops = 0; !name.empty() && hops < 64; hops++)
+  {
+    Function& f = functions[name];
+    if (f.frame < 0) printf("  %6s  ", "?");
+    else printf("  %6ld  ", f.frame);
+    printf("%s%s%s\n", name.c_str(), f.dynamic ? "  (dynamic)" : "",
+           unresolved.count(name) ? "  (unresolved indirect call)" : "");
+    name = f.next;
+  }
+}
+
+static long staticBytes(const char* elf)
+{
+  long total = 0, size;
+  FILE* pipe = run("AVR_SIZE", "avr-size", "-A", elf);
+  if (!pipe) return 0;
+  char line[256], section[64];
+  while (fgets(line, sizeof(line), pipe))
+    if (sscanf(line, "%63s %ld", section, &size) == 2 &&
+        (!strcmp(section, ".data") || !strcmp(section, ".bss") || !strcmp(section, ".noinit")))
+      total += size;
+  pclose(pipe);
+  return total;
+}
+
+static void usage()
+{
+  fprintf(stderr, "use: stackDepth [-i caller:callees]... [-n vector]... [-r return address bytes] sketch.elf build_directory\n");
+  exit(1);
+}
+
+int main(int argc, char** argv)
+{
+  int a = 1;
+  for (; a < argc && argv[a][0] == '-'; a++)
+  {
+    if (a + 1 == argc) usage();
+    if (!strcmp(argv[a], "-r")) returnBytes = atoi(argv[++a]);
+    else if (!strcmp(argv[a], "-n")) nesting.insert(argv[++a]);
+    else if (!strcmp(argv[a], "-i"))
+    {
+      const char* rule = argv[++a];
+      const char* colon = strchr(rule, ':');
+      if (!colon) usage();
+      IndirectRule r;
+      r.caller.assign(rule, colon - rule);
+      r.callees = colon + 1;
+      rules.push_back(r);
+    }
+    else usage();
+  }
+  if (argc - a != 2) usage();
+  const char* elf = argv[a];
+
+  readFrames(argv[a + 1]);
+  if (frames.empty()) fprintf(stderr, "no .su files in %s, build with -fstack-usage\n", argv[a + 1]);
+  if (!readCallGraph(elf))
+  {
+    fprintf(stderr, "no functions read from %s\n", elf);
+    return 1;
+  }
+  resolve();
+
+  std::vector<std::string> entries;
+  entries.push_back("main");
+  for (std::map<std::string, Function>::iterator f = functions.begin(); f != functions.end(); ++f)
+    if (f->first.compare(0, 9, "__vector_") == 0 && f->first != "__vector_default") entries.push_back(f->first);
+
+  long mainDepth = 0, interruptDepth = 0;
+  std::string deepestInterrupt;
+  std::map<std::string, long> depths;
+  for (size_t e = 0; e < entries.size(); e++)
+  {
+    long depth = walk(entries[e]);
+    if (e == 0) mainDepth = depth;
+    else
+    {
+      depths[entries[e]] = depth;
+      if (depth > interruptDepth)
+      {
+        interruptDepth = depth;
+        deepestInterrupt = entries[e];
+      }
+    }
+    printf("%-24s %6ld bytes\n", entries[e].c_str(), depth);
+  }
+
+  // an interrupt that lets the others in, with the deepest of them on top
+  std::string nestedInterrupt;
+  for (std::map<std::string, long>::iterator n = depths.begin(); n != depths.end(); ++n)
+  {
+    if (!nesting.count(n->first)) continue;
+    for (std::map<std::string, long>::iterator o = depths.begin(); o != depths.end(); ++o)
+    {
+      if (o->first == n->first || n->second + o->second <= interruptDepth) continue;
+      interruptDepth = n->second + o->second;
+      deepestInterrupt = n->first;
+      nestedInterrupt = o->first;
+    }
+  }
+  for (std::set<std::string>::iterator n = nesting.begin(); n != nesting.end(); ++n)
+    if (!depths.count(*n)) printf("no interrupt %s to nest in\n", n->c_str());
+
+  printf("\ndeepest chain from main (frame, function):\n");
+  printChain("main");
+  if (!deepestInterrupt.empty())
+  {
+    printf("deepest interrupt:\n");
+    printChain(deepestInterrupt);
+  }
+  if (!nestedInterrupt.empty())
+  {
+    printf("nested in it:\n");
+    printChain(nestedInterrupt);
+    deepestInterrupt += " + " + nestedInterrupt;
+  }
+
+  long worst = mainDepth + interruptDepth;
+  long available = SRAM_BYTES - staticBytes(elf);
+  printf("\nworst case %ld bytes (main %ld + %s %ld)", worst, mainDepth,
+         deepestInterrupt.empty() ? "no interrupt" : deepestInterrupt.c_str(), interruptDepth);
+  if (available < SRAM_BYTES) printf(", %ld bytes free for the stack, %ld to spare", available, available - worst);
+  printf("\n");
+
+  std::set<std::string>::iterator s;
+  for (s = unresolved.begin(); s != unresolved.end(); ++s) printf("unresolved indirect call in %s\n", s->c_str());
+  for (s = recursive.begin(); s != recursive.end(); ++s) printf("recursion through %s, not counted\n", s->c_str());
+  if (!noFrame.empty()) printf("%d functions reached have no .su entry and count as their return address\n", (int) noFrame.size());
+  return worst > available ? 2 : 0;
+}
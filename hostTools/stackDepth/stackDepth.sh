@@ -0,0 +1,45 @@
+#!/bin/sh
+# stackDepth - build RobotComm with -fstack-usage and report its worst case stack depth
+# (see stackDepth.cpp for how it is worked out).  The M# command reports what the stack has really
+# used since reset, to compare against.
+#
+# needs arduino-cli with the arduino:avr core installed, and g++ for the tool
+# use (from anywhere in the repository):
+#   hostTools/stackDepth/stackDepth.sh [-D flags]     e.g. -DROBOT_BOARD=4 -DROBOT_ENCODERS=1
+#   hostTools/stackDepth/stackDepth.sh -e sketch.elf build_directory
+# -e reports on a build that is already there, one of hostTools/buildMatrix's for instance, which
+# only needs avr-objdump and avr-size; hostTools/avrFixture/fixtureTest.sh uses it.
+# exits with status 2 when the worst case does not fit in the SRAM left over by the globals.
+
+REPO=$(cd "$(dirname "$0")/../.." && pwd)
+SKETCH=RobotComm_v0_81
+FQBN=arduino:avr:mega:cpu=atmega2560
+BUILD=${TMPDIR:-/tmp}/robotStackDepth
+ELF=$BUILD/sketch/$SKETCH.ino.elf
+SU=$BUILD/sketch
+
+mkdir -p "$BUILD" || exit 1
+g++ -O2 -o "$BUILD/stackDepth" "$REPO/hostTools/stackDepth/stackDepth.cpp" || exit 1
+if [ "$1" = "-e" ]; then
+  [ $# -eq 3 ] || { echo "use: stackDepth.sh -e sketch.elf build_directory" >&2; exit 1; }
+  ELF=$2
+  SU=$3
+else
+  FLAGS="$* -fstack-usage"
+  arduino-cli compile --fqbn "$FQBN" --libraries "$REPO/libraries" --build-path "$BUILD/sketch" \
+    --build-property "compiler.cpp.extra_flags=$FLAGS" --build-property "compiler.c.extra_flags=$FLAGS" \
+    "$REPO/$SKETCH" > "$BUILD/compile.log" 2>&1 || { cat "$BUILD/compile.log"; exit 1; }
+fi
+
+# where the calls through function pointers and virtual methods can go:
+#   the command table handlers, Print and Stream's virtual methods, the attachInterrupt handlers, and
+#   the emergency stop the bluetooth receive interrupt (USART2_RX, vector 51) calls through BufferedUART
+# and the timer tick (TIMER5_COMPA, vector 47) lets the other interrupts in for all its jobs, see l_timerTick
+"$BUILD/stackDepth" \
+  -i HandleCommand:command \
+  -i 'Print:::write(' \
+  -i 'Stream:::read(' -i 'Stream:::peek(' \
+  -i __vector_:EncoderTick \
+  -i __vector_51:emergencyStop \
+  -n __vector_47 \
+  "$ELF" "$SU"
@@ -0,0 +1,190 @@
+// telemetryDecoder - host side decoder for the RobotComm binary telemetry stream
+//
+// Reads a raw capture of the robot link (a file, or stdin when no input is named), picks out the
+// telemetry frames described in libraries/RobotTelemetry/RobotTelemetry.h, and writes them as a
+// plain binary log of fixed size records that a plotting script can map straight into an array.
+// Anything on the link that is not a frame (command echoes, 'c' replies) can be passed through to
+// stdout with -t so nothing is lost.
+//
+// build:
+//   g++ -O2 -I../../libraries/RobotTelemetry -o telemetryDecoder telemetryDecoder.cpp
+// use:
+//   telemetryDecoder [-t] capture.bin log.bin
+//
+// log format, all little endian:
+//   header:  "RTLM", uint16 version (2), uint16 record length (32)
+//   record:  uint32 millis, int16 left/right/top PWM, uint16 left/right/top current (mA),
+//            int16 yaw (0.1 deg), int16 yaw rate (0.1 deg/s), uint16 battery ADC,
+//            uint8 state flags, uint8 channel mask, uint8 sequence, uint8 frames lost before this one,
+//            uint16 bus voltage (mV), uint8 drive PWM cap, uint8 power limit flags, 2 bytes of padding
+// version 1 logs are the same without the power fields, 28 byte records
+// fields whose channel was not in the mask are written as 0; check the mask byte.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "RobotTelemetry.h"
+
+#define LOG_VERSION 2
+#define RECORD_LENGTH 32
+
+struct Decoder
+{
+  uint8_t frame[TELEMETRY_MAX_FRAME_LENGTH];
+  int count;          // bytes of the current frame collected so far, 0 when between frames
+  int expected;       // full length of the current frame, once the mask byte is in
+  bool haveSequence;
+  uint8_t lastSequence;
+  unsigned long frames, badChecksums, lost;
+};
+
+static void put16(uint8_t* p, unsigned int value)
+{
+  p[0] = value & 0xFF;
+  p[1] = (value >> 8) & 0xFF;
+}
+
+static unsigned int get16(const uint8_t* p)
+{
+  return p[0] | (p[1] << 8);
+}
+
+static void writeRecord(Decoder& d, FILE* out)
+{
+  uint8_t record[RECORD_LENGTH];
+  memset(record, 0, sizeof(record));
+  uint8_t mask = d.frame[2], sequence = d.frame[3];
+  const uint8_t* p = &d.frame[TELEMETRY_HEADER_LENGTH];
+  if (mask & TELEMETRY_TIMESTAMP)
+  {
+    memcpy(&record[0], p, 4);
+    p += 4;
+  }
+  if (mask & TELEMETRY_WHEEL_PWM)
+  {
+    memcpy(&record[4], p, 6);
+    p += 6;
+  }
+  if (mask & TELEMETRY_CURRENTS)
+  {
+    memcpy(&record[10], p, 6);
+    p += 6;
+  }
+  if (mask & TELEMETRY_YAW)
+  {
+    memcpy(&record[16], p, 4);
+    p += 4;
+  }
+  if (mask & TELEMETRY_BATTERY)
+  {
+    memcpy(&record[20], p, 2);
+    p += 2;
+  }
+  if (mask & TELEMETRY_STATE) record[22] = *p++;
+  if (mask & TELEMETRY_POWER)
+  {
+    memcpy(&record[26], p, 4);
+    p += 4;
+  }
+  record[23] = mask;
+  record[24] = sequence;
+  uint8_t gap = 0;
+  if (d.haveSequence) gap = (uint8_t) (sequence - d.lastSequence - 1);
+  record[25] = gap;
+  d.lost += gap;
+  d.lastSequence = sequence;
+  d.haveSequence = true;
+  fwrite(record, 1, sizeof(record), out);
+}
+
+// returns true if the byte was part of a frame
+static bool decodeByte(Decoder& d, uint8_t c, FILE* out)
+{
+  if (d.count == 0)
+  {
+    if (c != TELEMETRY_SYNC_0) return false;
+    d.frame[d.count++] = c;
+    return true;
+  }
+  if (d.count == 1)
+  {
+    if (c != TELEMETRY_SYNC_1)
+    {
+      d.count = 0;
+      return false;
+    }
+    d.frame[d.count++] = c;
+    return true;
+  }
+  if (d.count == 2)
+  {
+    if (c == 0 || (c & ~TELEMETRY_ALL_CHANNELS))  // not a mask we know, so not a frame
+    {
+      d.count = 0;
+      return false;
+    }
+    d.expected = telemetryFrameLength(c);
+  }
+  d.frame[d.count++] = c;
+  if (d.count < d.expected) return true;
+
+  uint16_t checksum = telemetryChecksum(&d.frame[2], d.expected - 2 - TELEMETRY_CHECKSUM_LENGTH);
+  if (checksum == get16(&d.frame[d.expected - TELEMETRY_CHECKSUM_LENGTH]))
+  {
+    writeRecord(d, out);
+    d.frames++;
+  }
+  else d.badChecksums++;
+  d.count = 0;
+  return true;
+}
+
+int main(int argc, char** argv)
+{
+  bool passText = false;
+  int arg = 1;
+  if (arg < argc && strcmp(argv[arg], "-t") == 0)
+  {
+    passText = true;
+    arg++;
+  }
+  if (argc - arg < 1 || argc - arg > 2)
+  {
+    fprintf(stderr, "usage: telemetryDecoder [-t] [capture.bin] log.bin\n");
+    return 2;
+  }
+  FILE* in = stdin;
+  if (argc - arg == 2)
+  {
+    in = fopen(argv[arg], "rb");
+    if (!in)
+    {
+      perror(argv[arg]);
+      return 1;
+    }
+    arg++;
+  }
+  FILE* out = fopen(argv[arg], "wb");
+  if (!out)
+  {
+    perror(argv[arg]);
+    return 1;
+  }
+
+  uint8_t header[8] = { 'R', 'T', 'L', 'M' };
+  put16(&header[4], LOG_VERSION);
+  put16(&header[6], RECORD_LENGTH);
+  fwrite(header, 1, sizeof(header), out);
+
+  Decoder d;
+  memset(&d, 0, sizeof(d));
+  int c;
+  while ((c = getc(in)) != EOF)
+  {
+    if (!decodeByte(d, (uint8_t) c, out) && passText) putchar(c);
+  }
+
+  fclose(out);
+  fprintf(stderr, "%lu frames, %lu bad checksums, %lu frames lost\n", d.frames, d.badChecksums, d.lost);
+  return 0;
+}
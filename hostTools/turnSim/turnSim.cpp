@@ -0,0 +1,279 @@
+// turnSim - gyro turns on a model robot: the old full speed turn and coast against turnController
+//
+// The robot spins at a rate that follows the PWM through a first order lag above a dead band, and
+// coasts down under dry and viscous friction once the motors are cut.  The gyro is read the way
+// gyroTurnDelay() reads it, every 20 msec or so with some jitter from the background jobs, with noise
+// and a little baseline error, and the yaw is the firmware's sum of rate times time.  Each model robot
+// (a seed) gets its own dead band, gain, lag and friction, and its battery runs down over the run, so
+// the gain drops by TURN_SAG.  It is given a long mix of turns, right and left, 5 to 180 degrees at
+// speeds 100 to 255, once the old way and once through turnController (libraries/RobotCommCore) with
+// the overshoot table learning as it goes.
+//
+// Reported per speed bin, for the turns after the first TURN_WARMUP of each bin: the mean and worst
+// error of where the robot really ended up, the share within 1 degree, and the mean time from the
+// command to the robot standing still.  Exits 1 if a learned turn is off by more than 1 degree.
+//
+// build:
+//   g++ -O2 -I../../libraries/RobotCommCore -I../../libraries/RobotParameters -o turnSim turnSim.cpp
+//     ../../libraries/RobotCommCore/turnController.cpp
+// use:
+//   turnSim [-n robots] [-t turns] [-s seed] [-f floor pwm] [-v]
+//     -n  model robots (20)
+//     -t  turns per robot (400)
+//     -s  first seed (1)
+//     -f  min_decel_speed, the floor of the slow down (60)
+//     -v  a line per robot
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "turnController.h"
+#include "RobotParameters.h"
+
+#define PHYSICS_USEC 250
+#define GYRO_STEP 20          // msec, backgroundDelay(20) in gyroTurnDelay()
+#define GYRO_COUNT 0.07       // degrees/sec per count
+#define TURN_TIMEOUT 5000     // msec
+#define OLD_SETTLE_STEPS 10   // the old turn watched the coast for 10 reads
+#define TURN_WARMUP 8         // turns per bin before the learned numbers count
+#define TURN_SAG 0.12         // share of the gain lost to the battery over a run
+#define TURN_GOAL 10          // tenths of a degree
+
+// the parameter defaults, for the overshoot table a robot starts with
+static const long parameterDefault[ROBOT_PARAMETER_COUNT] =
+{
+#define PARAMETER_DEFAULT(id, name, variable, kind, minimum, maximum, scale, address, fallback) fallback,
+  ROBOT_PARAMETERS(PARAMETER_DEFAULT)
+#undef PARAMETER_DEFAULT
+};
+
+static unsigned long state;
+static double uniform()  // 0 .. 1, the same everywhere for a seed
+{
+  state = state * 1103515245UL + 12345UL;
+  return ((state >> 8) & 0xFFFFFF) / (double) 0x1000000;
+}
+static double between(double low, double high) { return low + (high - low) * uniform(); }
+
+struct robotModel
+{
+  double deadBand, gain, lag, dryFriction, coastLag, gyroNoise, gyroBias;
+  double sag;      // 1 at a full battery
+  double yaw, rate;  // the truth, degrees and degrees/sec
+  long clock;      // usec
+
+  void randomize()
+  {
+    deadBand = between(35, 70);
+    gain = between(0.9, 1.4);         // degrees/sec per PWM over the dead band
+    lag = between(0.05, 0.12);        // sec
+    dryFriction = between(250, 700);  // degrees/sec^2 while coasting
+    coastLag = between(0.15, 0.4);    // sec, the viscous part of the coast
+    gyroNoise = between(1, 6);        // counts
+    gyroBias = between(-1.5, 1.5);    // counts the baseline is off by
+    sag = 1;
+    yaw = rate = 0;
+    clock = 0;
+  }
+
+  // pwm is signed, positive turns the yaw up
+  void run(int pwm, long usec)
+  {
+    for (long t = 0; t < usec; t += PHYSICS_USEC)
+    {
+      double dt = (usec - t < PHYSICS_USEC ? usec - t : PHYSICS_USEC) / 1e6, magnitude = fabs((double) pwm);
+      if (magnitude > deadBand)
+      {
+        double target = (pwm > 0 ? 1 : -1) * gain * sag * (magnitude - deadBand);
+        rate += (target - rate) * dt / lag;
+      }
+      else
+      {
+        double slow = dryFriction * dt + fabs(rate) * dt / coastLag;
+        if (fabs(rate) <= slow) rate = 0;
+        else rate -= rate > 0 ? slow : -slow;
+      }
+      yaw += rate * dt;
+    }
+    clock += usec;
+  }
+
+  double readGyro()  // degrees/sec, the way gyroRate() sees it
+  {
+    double counts = rate / GYRO_COUNT + gyroBias + between(-gyroNoise, gyroNoise);
+    return floor(counts + 0.5) * GYRO_COUNT;
+  }
+
+  long jitter() { return (long) (between(0, 3) * 1000); }  // telemetry and the rest of backgroundDelay()
+};
+
+struct result
+{
+  long turns, withinGoal, timedOut;
+  double sumError, worstError, sumMsec;
+  void add(double errorTenths, double msec, bool finished)
+  {
+    if (!finished)
+    {
+      timedOut++;
+      return;
+    }
+    turns++;
+    sumError += fabs(errorTenths);
+    if (fabs(errorTenths) > worstError) worstError = fabs(errorTenths);
+    if (fabs(errorTenths) <= TURN_GOAL) withinGoal++;
+    sumMsec += msec;
+  }
+};
+
+// waits out the coast, the way the firmware does; returns the msec it took
+static double settle(robotModel& robot, double& measured, bool untilStill, int steps, int pwm)
+{
+  long start = robot.clock;
+  for (int i = 0; i < steps; i++)
+  {
+    long usec = GYRO_STEP * 1000L + robot.jitter();
+    robot.run(pwm, usec);
+    double rate = robot.readGyro();
+    measured += rate * usec / 1e6;
+    if (untilStill && fabs(rate) * 10 < TURN_SETTLED_RATE) break;
+  }
+  // the robot is still once the model says so, whatever the firmware thought
+  while (robot.rate != 0) robot.run(pwm, 1000);
+  return (robot.clock - start) / 1000.0;
+}
+
+// the turn before turnController: full speed until the gyro says it is there, then coast
+static double oldTurn(robotModel& robot, int degrees, int speed, double& msec, bool& finished)
+{
+  double start = robot.yaw, measured = 0;
+  long begin = robot.clock, elapsed = 0;
+  int sign = speed > 0 ? 1 : -1;
+  while (fabs(measured) < degrees && elapsed < TURN_TIMEOUT * 1000L)
+  {
+    long usec = GYRO_STEP * 1000L + robot.jitter();
+    robot.run(speed, usec);
+    measured += robot.readGyro() * usec / 1e6;
+    elapsed += usec;
+  }
+  finished = fabs(measured) >= degrees;
+  settle(robot, measured, false, OLD_SETTLE_STEPS, 0);
+  msec = (robot.clock - begin) / 1000.0;
+  return (sign * (robot.yaw - start) - degrees) * 10;
+}
+
+// gyroTurnDelay() as it is now
+static double newTurn(robotModel& robot, turnController& control, int degrees, int speed, int floorSpeed,
+                      double& msec, bool& finished)
+{
+  double start = robot.yaw, measured = 0;
+  long begin = robot.clock, elapsed = 0;
+  int sign = speed > 0 ? 1 : -1, pwm = sign * control.begin(degrees * 10L, speed, floorSpeed);
+  unsigned int step = GYRO_STEP;
+  while (elapsed < TURN_TIMEOUT * 1000L)
+  {
+    long usec = step * 1000L + robot.jitter();
+    robot.run(pwm, usec);
+    double rate = robot.readGyro();
+    measured += rate * usec / 1e6;
+    elapsed += usec;
+    int next = control.update(lround(fabs(measured) * 10), lround(fabs(rate) * 10));
+    if (next == 0) break;
+    pwm = sign * next;
+    step = control.nextStep(GYRO_STEP);
+  }
+  finished = control.cut();
+  settle(robot, measured, true, TURN_SETTLE_STEPS, 0);
+  control.learn(lround(fabs(measured) * 10));
+  msec = (robot.clock - begin) / 1000.0;
+  return (sign * (robot.yaw - start) - degrees) * 10;
+}
+
+static const int speeds[] = { 100, 130, 160, 190, 220, 255 };
+#define SPEED_COUNT (int) (sizeof(speeds) / sizeof(speeds[0]))
+static const int angles[] = { 5, 10, 15, 30, 45, 60, 90, 120, 180 };
+#define ANGLE_COUNT (int) (sizeof(angles) / sizeof(angles[0]))
+
+int main(int argc, char** argv)
+{
+  int robots = 20, turns = 400, floorSpeed = 60, option;
+  unsigned long seed = 1;
+  bool verbose = false;
+  while ((option = getopt(argc, argv, "n:t:s:f:v")) != -1)
+  {
+    switch (option)
+    {
+      case 'n': robots = atoi(optarg); break;
+      case 't': turns = atoi(optarg); break;
+      case 's': seed = strtoul(optarg, 0, 10); break;
+      case 'f': floorSpeed = atoi(optarg); break;
+      case 'v': verbose = true; break;
+      default:
+        fprintf(stderr, "use: turnSim [-n robots] [-t turns] [-s seed] [-f floor pwm] [-v]\n");
+        return 1;
+    }
+  }
+
+  result oldResults[SPEED_COUNT], newResults[SPEED_COUNT];
+  memset(oldResults, 0, sizeof(oldResults));
+  memset(newResults, 0, sizeof(newResults));
+  for (int r = 0; r < robots; r++)
+  {
+    // the same robot and the same turns for both, so the only difference is the controller
+    robotModel oldRobot, newRobot;
+    state = seed + r;
+    oldRobot.randomize();
+    newRobot = oldRobot;
+    uint8_t overshoot[TURN_RATE_BINS];
+    for (int b = 0; b < TURN_RATE_BINS; b++) overshoot[b] = parameterDefault[PARAM_TURN_OVERSHOOT_0 + b];
+    turnController control(overshoot);
+    int seen[SPEED_COUNT] = { 0 };
+    unsigned long turnState = seed * 7919 + r;
+    for (int t = 0; t < turns; t++)
+    {
+      state = turnState;
+      int s = (int) (uniform() * SPEED_COUNT), degrees = angles[(int) (uniform() * ANGLE_COUNT)];
+      int speed = uniform() < 0.5 ? speeds[s] : -speeds[s];
+      turnState = state;
+      oldRobot.sag = newRobot.sag = 1 - TURN_SAG * t / turns;
+
+      double oldMsec, newMsec;
+      bool oldFinished, newFinished;
+      unsigned long robotState = turnState * 31 + 17;
+      state = robotState;
+      double oldError = oldTurn(oldRobot, degrees, speed, oldMsec, oldFinished);
+      state = robotState;
+      double newError = newTurn(newRobot, control, degrees, speed, floorSpeed, newMsec, newFinished);
+      if (++seen[s] <= TURN_WARMUP) continue;
+      oldResults[s].add(oldError, oldMsec, oldFinished);
+      newResults[s].add(newError, newMsec, newFinished);
+    }
+    if (verbose)
+    {
+      printf("robot %lu: dead band %.0f, gain %.2f, lag %.0f msec, friction %.0f/s^2, coast %.0f msec; overshoot",
+             seed + r, oldRobot.deadBand, oldRobot.gain, oldRobot.lag * 1000, oldRobot.dryFriction,
+             oldRobot.coastLag * 1000);
+      for (int b = 0; b < TURN_RATE_BINS; b++) printf(" %d", overshoot[b]);
+      printf("\n");
+    }
+  }
+
+  bool pass = true;
+  printf("%d robots, %d turns each, floor %d; errors in degrees of where the robot stopped\n", robots, turns,
+         floorSpeed);
+  printf("speed   old: mean   worst  in 1deg  msec  timed out  |  new: mean   worst  in 1deg  msec  timed out\n");
+  for (int s = 0; s < SPEED_COUNT; s++)
+  {
+    result& o = oldResults[s];
+    result& n = newResults[s];
+    if (!n.turns || !o.turns) continue;
+    printf("%5d  %10.2f %7.2f %7.1f%% %5.0f %10ld  | %10.2f %7.2f %7.1f%% %5.0f %10ld\n", speeds[s],
+           o.sumError / o.turns / 10, o.worstError / 10, 100.0 * o.withinGoal / o.turns, o.sumMsec / o.turns, o.timedOut,
+           n.sumError / n.turns / 10, n.worstError / 10, 100.0 * n.withinGoal / n.turns, n.sumMsec / n.turns, n.timedOut);
+    if (n.worstError > TURN_GOAL) pass = false;
+  }
+  printf("%s\n", pass ? "every learned turn within 1 degree" : "FAIL: a learned turn was off by more than 1 degree");
+  return pass ? 0 : 1;
+}
@@ -0,0 +1,311 @@
+#include "BufferedUART.h"
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+// round a buffer size down to a power of 2 and return the index mask for it
+static uint16_t ringMask(uint16_t size)
+{
+  uint16_t powerOf2 = 1;
+  while (powerOf2 <= size / 2) powerOf2 <<= 1;
+  return powerOf2 - 1;
+}
+
+BufferedUART::BufferedUART(volatile uint8_t *ubrrh, volatile uint8_t *ubrrl,
+                           volatile uint8_t *ucsra, volatile uint8_t *ucsrb,
+                           volatile uint8_t *ucsrc, volatile uint8_t *udr) :
+    _ubrrh(ubrrh), _ubrrl(ubrrl), _ucsra(ucsra), _ucsrb(ucsrb), _ucsrc(ucsrc), _udr(udr)
+{
+  _rxBuffer = 0;
+  _txBuffer = 0;
+  _rxMask = 0;
+  _txMask = 0;
+  _rxHead = _rxTail = _txHead = _txTail = 0;
+  _frames = 0;
+  _overruns = 0;
+  _framesReceived = 0;
+  _frameEnd = '#';
+  _skipWhitespace = false;
+  _rtsPort = 0;
+  _rtsBit = 0;
+  _xonXoff = false;
+  _throttled = false;
+  _flowChar = 0;
+  _emergencyByte = 0;
+  _emergencyHandler = 0;
+}
+
+void BufferedUART::begin(unsigned long baud, uint8_t *rxBuffer, uint16_t rxSize, uint8_t *txBuffer, uint16_t txSize)
+{
+  _rxBuffer = rxBuffer;
+  _txBuffer = txBuffer;
+  _rxMask = ringMask(rxSize);
+  _txMask = ringMask(txSize);
+  _rxHead = _rxTail = _txHead = _txTail = 0;
+  _frames = 0;
+  _throttled = false;
+
+  // double speed mode, same divisor as HardwareSerial so the baud rate error matches
+  uint16_t baudSetting = (F_CPU / 4 / baud - 1) / 2;
+  *_ucsra = 1 << U2X0;
+  *_ubrrh = baudSetting >> 8;
+  *_ubrrl = baudSetting;
+  *_ucsrc = (1 << UCSZ01) | (1 << UCSZ00);  // 8 data bits, no parity, 1 stop bit
+  *_ucsrb = (1 << RXEN0) | (1 << TXEN0) | (1 << RXCIE0);
+}
+
+void BufferedUART::end()
+{
+  flush();
+  *_ucsrb &= ~((1 << RXEN0) | (1 << TXEN0) | (1 << RXCIE0) | (1 << UDRIE0));
+  _rxHead = _rxTail;
+  _frames = 0;
+}
+
+void BufferedUART::setFrameEnd(uint8_t frameEnd)
+{
+  _frameEnd = frameEnd;
+}
+
+void BufferedUART::setRTSpin(uint8_t pin)
+{
+  if (pin == BUFFERED_UART_NO_PIN)
+  {
+    _rtsPort = 0;
+    return;
+  }
+  pinMode(pin, OUTPUT);
+  digitalWrite(pin, LOW);  // clear to send
+  // keep the port and bit so the receive interrupt can raise it without a digitalWrite()
+  _rtsBit = digitalPinToBitMask(pin);
+  _rtsPort = portOutputRegister(digitalPinToPort(pin));
+}
+
+void BufferedUART::setXonXoff(bool enable)
+{
+  _xonXoff = enable;
+}
+
+void BufferedUART::setEmergencyByte(uint8_t code, void (*handler)(void))
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    _emergencyByte = code;
+    _emergencyHandler = handler;
+  }
+}
+
+void BufferedUART::setSkipWhitespace(bool skip)
+{
+  _skipWhitespace = skip;
+}
+
+int BufferedUART::available(void)
+{
+  uint16_t head;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    head = _rxHead;
+  }
+  return (head - _rxTail) & _rxMask;
+}
+
+uint16_t BufferedUART::framesAvailable()
+{
+  uint16_t frames;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    frames = _frames;
+  }
+  return frames;
+}
+
+bool BufferedUART::peekFrame(BufferedFrame &frame)
+{
+  if (!framesAvailable()) return false;
+  // the interrupt only writes past the frame end, so the frame can be read without blocking it
+  uint16_t length = 0;
+  while (_rxBuffer[(_rxTail + length) & _rxMask] != _frameEnd) length++;
+  frame = BufferedFrame(_rxBuffer, _rxMask, _rxTail, length);
+  return true;
+}
+
+void BufferedUART::dropFrame()
+{
+  if (!framesAvailable()) return;
+  uint16_t end = _rxTail;
+  while (_rxBuffer[end] != _frameEnd) end = (end + 1) & _rxMask;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    _rxTail = (end + 1) & _rxMask;
+    _frames--;
+  }
+  if (_throttled && available() <= (_rxMask + 1) / 4) releaseFlowControl();
+}
+
+int BufferedUART::peek(void)
+{
+  if (!available()) return -1;
+  return _rxBuffer[_rxTail];
+}
+
+int BufferedUART::read(void)
+{
+  if (!available()) return -1;
+  uint8_t c = _rxBuffer[_rxTail];
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    _rxTail = (_rxTail + 1) & _rxMask;
+    if (c == _frameEnd && _frames) _frames--;
+  }
+  if (_throttled && available() <= (_rxMask + 1) / 4) releaseFlowControl();
+  return c;
+}
+
+void BufferedUART::releaseFlowControl()
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    _throttled = false;
+    if (_rtsPort) *_rtsPort &= ~_rtsBit;
+    if (_xonXoff)
+    {
+      _flowChar = BUFFERED_UART_XON;
+      *_ucsrb |= 1 << UDRIE0;
+    }
+  }
+}
+
+int BufferedUART::availableForWrite(void)
+{
+  uint16_t head, tail;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    head = _txHead;
+    tail = _txTail;
+  }
+  return _txMask - ((head - tail) & _txMask);
+}
+
+size_t BufferedUART::write(uint8_t c)
+{
+  uint16_t next = (_txHead + 1) & _txMask;
+  while (availableForWrite() == 0)
+  {
+    // buffer full; if interrupts are off (we were called from an ISR) nobody else will drain it
+    if (!(SREG & (1 << SREG_I)) && (*_ucsra & (1 << UDRE0))) txInterrupt();
+  }
+  _txBuffer[_txHead] = c;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    _txHead = next;
+    *_ucsrb |= 1 << UDRIE0;
+  }
+  return 1;
+}
+
+void BufferedUART::flush(void)
+{
+  while (availableForWrite() < _txMask || _flowChar)
+  {
+    if (!(SREG & (1 << SREG_I)) && (*_ucsra & (1 << UDRE0))) txInterrupt();
+  }
+}
+
+inline void BufferedUART::rxInterrupt(void)
+{
+  if (*_ucsra & (1 << UPE0))
+  {
+    (void) *_udr;  // parity error, throw the byte away
+    return;
+  }
+  uint8_t c = *_udr;
+  if (c == _emergencyByte && _emergencyHandler)
+  {
+    _emergencyHandler();  // first thing, before any buffering
+    return;
+  }
+  if (_skipWhitespace && (c == '\r' || c == '\n' || c == ' ' || c == 0)) return;
+  uint16_t head = _rxHead;
+  uint16_t next = (head + 1) & _rxMask;
+  if (next == _rxTail)
+  {
+    _overruns++;
+    // keep the framing intact: a frame end replaces the last byte we stored, so the
+    // damaged command is still separated from the next one
+    if (c == _frameEnd && head != _rxTail)
+    {
+      uint16_t last = (head - 1) & _rxMask;
+      if (_rxBuffer[last] != _frameEnd)
+      {
+        _rxBuffer[last] = c;
+        _frames++;
+        _framesReceived++;
+      }
+    }
+    return;
+  }
+  _rxBuffer[head] = c;
+  _rxHead = next;
+  if (c == _frameEnd)
+  {
+    _frames++;
+    _framesReceived++;
+  }
+
+  if (!_throttled && ((next - _rxTail) & _rxMask) >= (_rxMask + 1) / 4 * 3)
+  {
+    _throttled = true;
+    if (_rtsPort) *_rtsPort |= _rtsBit;
+    if (_xonXoff)
+    {
+      _flowChar = BUFFERED_UART_XOFF;
+      *_ucsrb |= 1 << UDRIE0;
+    }
+  }
+}
+
+inline void BufferedUART::txInterrupt(void)
+{
+  if (_flowChar)
+  {
+    *_udr = _flowChar;
+    _flowChar = 0;
+  }
+  else if (_txHead != _txTail)
+  {
+    *_udr = _txBuffer[_txTail];
+    _txTail = (_txTail + 1) & _txMask;
+  }
+  if (_txHead == _txTail && !_flowChar) *_ucsrb &= ~(1 << UDRIE0);
+}
+
+uint16_t BufferedFrame::copyTo(char *text, uint16_t from, uint16_t size) const
+{
+  uint16_t n = 0;
+  for (uint16_t i = from; i < _length && n < size - 1; i++) text[n++] = (*this)[i];
+  text[n] = 0;
+  return n;
+}
+
+size_t BufferedFrame::printTo(Print &p) const
+{
+  uint16_t first = _length;  // the part before the wrap, then the rest from the start of the buffer
+  if ((uint32_t) _start + _length > (uint32_t) _mask + 1) first = _mask + 1 - _start;
+  size_t n = p.write(_buffer + _start, first);
+  if (first < _length) n += p.write(_buffer, _length - first);
+  return n;
+}
+
+#if defined(UBRR2H)
+BufferedUART BufferedSerial2(&UBRR2H, &UBRR2L, &UCSR2A, &UCSR2B, &UCSR2C, &UDR2);
+
+ISR(USART2_RX_vect)
+{
+  BufferedSerial2.rxInterrupt();
+}
+
+ISR(USART2_UDRE_vect)
+{
+  BufferedSerial2.txInterrupt();
+}
+#endif
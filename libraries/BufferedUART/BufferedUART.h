@@ -0,0 +1,120 @@
+#ifndef BufferedUART_h
+#define BufferedUART_h
+
+#include <Arduino.h>
+
+// Interrupt driven UART with receive and transmit ring buffers supplied by the sketch,
+// so their sizes can be picked per robot instead of the fixed 64 bytes of HardwareSerial.
+// It also counts complete command frames as they arrive (bytes ending in the frame end
+// character), so the command loop can leave queued commands in the buffer and run them
+// one after another instead of throwing them away.
+//
+// When the receive buffer gets 3/4 full the sender is asked to pause, either by raising
+// an RTS output (wire it to the bluetooth module's CTS input) or by sending XOFF, and is
+// released again once the sketch has read it down to 1/4 full.
+//
+// A complete frame can be read in place with peekFrame(): it comes back as a BufferedFrame, a span
+// of the receive buffer that indexes across the wrap, so the command can be parsed and echoed without
+// copying it anywhere, and dropFrame() releases its bytes once the sketch is done with it.  With
+// setSkipWhitespace() the receive interrupt drops CR, LF, space and NUL, so a frame holds only the command.
+//
+// One byte value can be reserved as an emergency code: it is never buffered, instead the
+// receive interrupt calls the sketch's handler the moment it arrives, ahead of anything queued.
+//
+// Buffer sizes must be powers of 2; anything else is rounded down.
+// This replaces the core Serial2 on the Mega (BufferedSerial2), so a sketch that includes
+// this library must not use Serial2 as well, since both want the USART2 interrupts.
+
+#define BUFFERED_UART_NO_PIN 0xFF
+#define BUFFERED_UART_XON 0x11
+#define BUFFERED_UART_XOFF 0x13
+
+// a frame, without its frame end, where it lies in a ring buffer (or any char array)
+class BufferedFrame : public Printable
+{
+  public:
+    // CONSTRUCTOR
+    BufferedFrame() : _buffer(0), _mask(0), _start(0), _length(0) {}
+    BufferedFrame(const uint8_t *buffer, uint16_t mask, uint16_t start, uint16_t length) :
+        _buffer(buffer), _mask(mask), _start(start), _length(length) {}
+    BufferedFrame(const char *text, uint16_t length) :  // a plain array, the mask never wraps
+        _buffer((const uint8_t *) text), _mask(0xFFFF), _start(0), _length(length) {}
+
+    // PUBLIC METHODS
+    char operator[](uint16_t i) const { return _buffer[(_start + i) & _mask]; }
+    uint16_t length() const { return _length; }
+    uint16_t copyTo(char *text, uint16_t from, uint16_t size) const;  // from..end, cut to size - 1, 0 terminated
+    virtual size_t printTo(Print &p) const;  // writes straight out of the buffer
+
+  private:
+    const uint8_t *_buffer;
+    uint16_t _mask, _start, _length;
+};
+
+class BufferedUART : public Stream
+{
+  public:
+    // CONSTRUCTOR
+    BufferedUART(volatile uint8_t *ubrrh, volatile uint8_t *ubrrl,
+                 volatile uint8_t *ucsra, volatile uint8_t *ucsrb,
+                 volatile uint8_t *ucsrc, volatile uint8_t *udr);
+
+    // PUBLIC METHODS
+    void begin(unsigned long baud, uint8_t *rxBuffer, uint16_t rxSize, uint8_t *txBuffer, uint16_t txSize);
+    void end();
+    void setFrameEnd(uint8_t frameEnd); // byte that ends a command, frames are counted as they arrive
+    void setRTSpin(uint8_t pin);        // hardware flow control output, high means stop sending
+    void setXonXoff(bool enable);       // software flow control
+    void setEmergencyByte(uint8_t code, void (*handler)(void)); // handler runs inside the receive interrupt
+    void setSkipWhitespace(bool skip);  // CR, LF, space and NUL are dropped as they arrive
+
+    virtual int available(void);
+    virtual int peek(void);
+    virtual int read(void);
+    virtual int availableForWrite(void);
+    virtual void flush(void);           // waits until everything has been sent
+    virtual size_t write(uint8_t);
+    using Print::write;
+
+    uint16_t framesAvailable();         // complete frames waiting in the receive buffer
+    bool peekFrame(BufferedFrame &frame); // the oldest complete frame, in place; false if there is none
+    void dropFrame();                   // done with the oldest frame, its bytes can be reused
+    uint16_t framesReceived() { return _framesReceived; } // running count of frames, read it with interrupts off
+    uint16_t overruns() { return _overruns; } // bytes dropped because the receive buffer was full
+
+    // called from the interrupt service routines
+    void rxInterrupt(void);
+    void txInterrupt(void);
+
+  private:
+    void releaseFlowControl();
+
+    volatile uint8_t * const _ubrrh;
+    volatile uint8_t * const _ubrrl;
+    volatile uint8_t * const _ucsra;
+    volatile uint8_t * const _ucsrb;
+    volatile uint8_t * const _ucsrc;
+    volatile uint8_t * const _udr;
+
+    uint8_t *_rxBuffer;
+    uint8_t *_txBuffer;
+    uint16_t _rxMask, _txMask;
+    volatile uint16_t _rxHead, _rxTail, _txHead, _txTail;
+    volatile uint16_t _frames, _overruns, _framesReceived;
+    uint8_t _frameEnd;
+    bool _skipWhitespace;
+
+    volatile uint8_t *_rtsPort;
+    uint8_t _rtsBit;
+    bool _xonXoff;
+    volatile bool _throttled;
+    volatile uint8_t _flowChar;        // XON or XOFF waiting to go out ahead of the transmit buffer
+    uint8_t _emergencyByte;
+    void (*_emergencyHandler)(void);
+};
+
+#if defined(UBRR2H)
+extern BufferedUART BufferedSerial2;
+#endif
+
+#endif
@@ -219,17 +219,19 @@ void threeMotorsDriver::setSpeedAB(int speedA, int speedB)
     analogWrite(PWMB, speedB);
 }
 
+// the PWM pins are already outputs, so digitalWrite() cuts them the way analogWrite(pin, 0) would,
+// without its pinMode(); the emergency stop brakes from the receive interrupt
 void threeMotorsDriver::setBrakesAB()
 {
     digitalWrite(ENABLEAB, LOW);
-    analogWrite(PWMA, 0);
-    analogWrite(PWMB, 0);
+    digitalWrite(PWMA, LOW);
+    digitalWrite(PWMB, LOW);
 }
 
 void threeMotorsDriver::setBrakesC()
 {
     digitalWrite(ENABLEC, LOW);
-    analogWrite(PWMC, 0);
+    digitalWrite(PWMC, LOW);
 }
 
 void threeMotorsDriver::setCoastA()
@@ -22,7 +22,9 @@ class threeMotorsDriver
     void setBrakesAB();
     void setBrakesC();
     void setCoastAB();
-	void setCoastC();
+    void setCoastA();
+    void setCoastB();
+    void setCoastC();
     int getCurrentA();
     int getCurrentB();
     int getCurrentC();
@@ -42,6 +44,7 @@ class threeMotorsDriver
 	
     
   private:
+    unsigned char ENABLEAB;
     unsigned char IN1A;
     unsigned char IN2A;
     unsigned char STATUSA;
@@ -52,6 +55,7 @@ class threeMotorsDriver
     unsigned char STATUSB;
     unsigned char PWMB;
     
+    unsigned char ENABLEC;
     unsigned char IN1C;
     unsigned char IN2C;
     unsigned char STATUSC;
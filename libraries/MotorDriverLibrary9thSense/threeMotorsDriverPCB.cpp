@@ -1,5 +1,17 @@
 #include "threeMotorsDriverPCB.h"
 threeMotorsDriverPCB::threeMotorsDriverPCB()
+{
+    // the status lines of the left and right bridges share pin 28, so a fault on either one
+    // shows up on both, and neither 28 nor 36 has a pin change interrupt
+    init(28, 28, 36);
+}
+
+threeMotorsDriverPCB::threeMotorsDriverPCB(unsigned char statusA, unsigned char statusB, unsigned char statusC)
+{
+    init(statusA, statusB, statusC);
+}
+
+void threeMotorsDriverPCB::init(unsigned char statusA, unsigned char statusB, unsigned char statusC)
 {
     // designed for use with the VNH2SP30 motor driver boards from pololu
 	// and our custom 9th Sense PCB
@@ -11,15 +23,15 @@ threeMotorsDriverPCB::threeMotorsDriverPCB()
     // available for I2C are pins 20 and 21 (these are also interrupt pins)
     IN1A = 22;
     IN2A = 24;
-    STATUSA = 28;
+    STATUSA = statusA;
     PWMA = 4;  // PWM: 0 to 13. Provide 8-bit PWM output with the analogWrite() function.
     IN1B = 32;
     IN2B = 30;
-    STATUSB = 28;
+    STATUSB = statusB;
     PWMB = 5;
     IN1C = 40;
     IN2C = 42;
-    STATUSC = 36;
+    STATUSC = statusC;
     PWMC = 6;
     // interrupt pins on the mega are:
     // 2 (interrupt 0), 3 (interrupt 1), 18 (interrupt 5), 19 (4), 20 (3), and 21 (2)
@@ -34,17 +46,17 @@ threeMotorsDriverPCB::threeMotorsDriverPCB()
 
     pinMode(IN1A,OUTPUT);
     pinMode(IN2A,OUTPUT);
-    pinMode(STATUSA,INPUT);
+    pinMode(STATUSA,INPUT_PULLUP);  // the status lines are open drain, low on a fault
     pinMode(PWMA,OUTPUT);  // PWM: 0 to 13. Provide 8-bit PWM output with the analogWrite() function.
     
     pinMode(IN1B,OUTPUT);
     pinMode(IN2B,OUTPUT);
-    pinMode(STATUSB,INPUT);
+    pinMode(STATUSB,INPUT_PULLUP);
     pinMode(PWMB,OUTPUT);
     
     pinMode(IN1C,OUTPUT);
     pinMode(IN2C,OUTPUT);
-    pinMode(STATUSC,INPUT);
+    pinMode(STATUSC,INPUT_PULLUP);
     pinMode(PWMC,OUTPUT);
     
     // interrupt pins on the mega are:
@@ -122,15 +134,17 @@ void threeMotorsDriverPCB::setSpeedAB(int speedA, int speedB)
 
 void threeMotorsDriverPCB::setBrakesC()
 {
-    analogWrite(PWMC, 0);
+    digitalWrite(PWMC, LOW);
 	digitalWrite(IN1C, LOW);
     digitalWrite(IN2C, LOW);
 }
 
+// the PWM pins are already outputs, so digitalWrite() cuts them the way analogWrite(pin, 0) would,
+// without its pinMode(); the emergency stop brakes from the receive interrupt
 void threeMotorsDriverPCB::setBrakesAB()
 {
-    analogWrite(PWMA, 0); 
-	analogWrite(PWMB, 0); 
+    digitalWrite(PWMA, LOW);
+	digitalWrite(PWMB, LOW);
     digitalWrite(IN1A, LOW);
     digitalWrite(IN2A, LOW);
 	digitalWrite(IN1B, LOW);
@@ -185,5 +199,18 @@ unsigned char threeMotorsDriverPCB::getStatusC()
     return(digitalRead(STATUSC));
 }
 
-
-
+// the sketch supplies the ISR for the pin change vector(s) and reads the status lines from it
+bool threeMotorsDriverPCB::enableFaultInterrupts()
+{
+    unsigned char pins[3] = { STATUSA, STATUSB, STATUSC };
+    for (int i = 0; i < 3; i++)
+    {
+        if (digitalPinToPCICR(pins[i]) == 0) return false;
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        *digitalPinToPCMSK(pins[i]) |= 1 << digitalPinToPCMSKbit(pins[i]);
+        *digitalPinToPCICR(pins[i]) |= 1 << digitalPinToPCICRbit(pins[i]);
+    }
+    return true;
+}
@@ -13,6 +13,8 @@ class threeMotorsDriverPCB
   public:  
     // CONSTRUCTOR
     threeMotorsDriverPCB(); // pin selection an initial config
+    // for boards with a status line per bridge, e.g. moved to pin change interrupt pins A10 - A12
+    threeMotorsDriverPCB(unsigned char statusA, unsigned char statusB, unsigned char statusC);
     
     // PUBLIC METHODS
     void setSpeedA(int speed); // Set speed for left motor
@@ -29,6 +31,7 @@ class threeMotorsDriverPCB
     unsigned char getStatusA(); // Get status of left motor
     unsigned char getStatusB(); // Get status of right motor
     unsigned char getStatusC(); // Get status of top motor
+    bool enableFaultInterrupts(); // pin change interrupts on the status lines, false if a line has none
 	
 	// interrupt pins on the mega are:
     // 2 (interrupt 0), 3 (interrupt 1), 18 (interrupt 5), 19 (4), 20 (3), and 21 (2)
@@ -42,6 +45,8 @@ class threeMotorsDriverPCB
 	
     
   private:
+    void init(unsigned char statusA, unsigned char statusB, unsigned char statusC);
+    
     unsigned char IN1A;
     unsigned char IN2A;
     unsigned char STATUSA;
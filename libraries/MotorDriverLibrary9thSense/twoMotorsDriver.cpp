@@ -163,11 +163,13 @@ void twoMotorsDriver::setSpeedAB(int speedA, int speedB)
     analogWrite(PWMB, speedB);
 }
 
+// the PWM pins are already outputs, so digitalWrite() cuts them the way analogWrite(pin, 0) would,
+// without its pinMode(); the emergency stop brakes from the receive interrupt
 void twoMotorsDriver::setBrakesAB()
 {
     digitalWrite(ENABLEAB, LOW);
-    analogWrite(PWMA, 0);
-    analogWrite(PWMB, 0);
+    digitalWrite(PWMA, LOW);
+    digitalWrite(PWMB, LOW);
 }
 
 void twoMotorsDriver::setCoastA()
@@ -0,0 +1,165 @@
+#ifndef RobotCommCore_h
+#define RobotCommCore_h
+
+// Shared core of the RobotComm firmware.
+// A robot variant is the RobotComm sketch built with a different ROBOT_BOARD, so a fix reaches every
+// board.  The forked sketches that each carried their own copy of the motor and battery code are gone
+// from the tree; git history has them, and hostTools/buildMatrix still builds a few from there to
+// compare sizes.  What replaces each one:
+//   RobotComm_v0_80, threeMotorsRobotCommPCB, threeMotorsRobotCommPCBsimple (and _v_071 - _v_074)
+//                                               ROBOT_BOARD_PCB
+//   threeMotorsRobotComm (and _v0_5 - _v0_62)   ROBOT_BOARD_ORIGINAL
+//   threeMotorsRobotCommCalypso_v0_60           ROBOT_BOARD_CALYPSO
+//   threeMotorsRobotCommDemobot, threeMotorsPololuBigDriver
+//                                               ROBOT_BOARD_POLOLU_BIG
+// write_robot_defaults_to_EEPROM_v_072 and _v_074 went with the PCBsimple versions they matched;
+// write_robot_defaults_to_EEPROM_v_080 writes this sketch's EEPROM.
+//
+// This header picks the board at compile time: the motor driver class (robotMotorDriver), its current
+// sense scale and the pins that differ between boards, plus the optional features.  Set ROBOT_BOARD,
+// and any ROBOT_ feature to override, before including it, either at the top of the sketch's first tab
+// or with -D (see hostTools/buildMatrix).  Only the sketch includes this header; the library's own .cpp
+// files don't depend on the board, since the Arduino IDE compiles them without the sketch's #defines.
+//
+// The board independent pieces are classes of their own:
+//   batteryEstimator  load compensated battery charge and runtime estimate
+//   powerGovernor     slew and cap limits between the motion routines and the drive wheels
+//   stackCanary       the deepest the stack has been since reset
+//   backgroundEEPROM  EEPROM writes queued and done from the EEPROM ready interrupt
+//   Fixed, robotMath  fixed point numbers and the gyro and heading arithmetic, for the float free build
+
+#include <Arduino.h>
+
+// boards
+#define ROBOT_BOARD_PCB 1          // 9th Sense PCB, VNH2SP30 carriers, threeMotorsDriverPCB
+#define ROBOT_BOARD_ORIGINAL 2     // first robots, threeMotorsDriver
+#define ROBOT_BOARD_REVERSE 3      // first robots with the motors wired the other way, threeMotorsDriverReverse
+#define ROBOT_BOARD_CALYPSO 4      // threeMotorsDriverCalypso
+#define ROBOT_BOARD_POLOLU_BIG 5   // Demobot, Pololu high power drivers, threeMotorsPololuBigDriver
+
+#ifndef ROBOT_BOARD
+#define ROBOT_BOARD ROBOT_BOARD_PCB
+#endif
+
+// features, 0 or 1:
+//   ROBOT_FAULT_INTERRUPTS  a status line per bridge, on pin change interrupt pins A10 - A12 (a rework of
+//                           the PCB, off by default); otherwise the shared status lines on 28 and 36 are polled
+//   ROBOT_ENCODERS          encoders on the drive motors, at ROBOT_ENCODER_PIN_A and _B (external interrupts)
+//   ROBOT_SAFETY_SENSORS    IR cliff and obstacle sensors at ROBOT_SAFETY_PIN_LEFT and _RIGHT
+//   ROBOT_FIXED_POINT       robotReal, the type of the yaw, the gyro baseline and the battery settings, is
+//                           Fixed<int32_t, 16> instead of double, so no float code is linked in
+
+#if ROBOT_BOARD == ROBOT_BOARD_PCB
+#include <threeMotorsDriverPCB.h>
+typedef threeMotorsDriverPCB robotMotorDriver;
+#define ROBOT_MILLIAMPS_PER_COUNT 38  // same as getCurrentA()
+#define ROBOT_SAFETY_PIN_LEFT A8
+#define ROBOT_SAFETY_PIN_RIGHT A9
+#define ROBOT_ENCODER_PIN_A 18
+#define ROBOT_ENCODER_PIN_B 19
+#ifndef ROBOT_FAULT_INTERRUPTS
+#define ROBOT_FAULT_INTERRUPTS 0  // a stock PCB has nothing on A10 - A12, their pullups would hide every fault
+#endif
+#define ROBOT_FAULT_PIN_A A10  // pin change interrupts 18 - 20, only with ROBOT_FAULT_INTERRUPTS
+#define ROBOT_FAULT_PIN_B A11
+#define ROBOT_FAULT_PIN_C A12
+#define ROBOT_FAULT_vect PCINT2_vect
+
+#elif ROBOT_BOARD == ROBOT_BOARD_ORIGINAL
+#include <threeMotorsDriver.h>
+typedef threeMotorsDriver robotMotorDriver;
+#define ROBOT_MILLIAMPS_PER_COUNT 10
+#define ROBOT_SAFETY_PIN_LEFT A8
+#define ROBOT_SAFETY_PIN_RIGHT A9
+#define ROBOT_ENCODER_PIN_A 18
+#define ROBOT_ENCODER_PIN_B 19
+
+#elif ROBOT_BOARD == ROBOT_BOARD_REVERSE
+#include <threeMotorsDriverReverse.h>
+typedef threeMotorsDriverReverse robotMotorDriver;
+#define ROBOT_MILLIAMPS_PER_COUNT 10
+#define ROBOT_SAFETY_PIN_LEFT A8
+#define ROBOT_SAFETY_PIN_RIGHT A9
+#define ROBOT_ENCODER_PIN_A 18
+#define ROBOT_ENCODER_PIN_B 19
+
+#elif ROBOT_BOARD == ROBOT_BOARD_CALYPSO
+#include <threeMotorsDriverCalypso.h>
+typedef threeMotorsDriverCalypso robotMotorDriver;
+#define ROBOT_MILLIAMPS_PER_COUNT 10
+#define ROBOT_SAFETY_PIN_LEFT A9   // A8 is the top motor current sense
+#define ROBOT_SAFETY_PIN_RIGHT A10
+#define ROBOT_ENCODER_PIN_A 3
+#define ROBOT_ENCODER_PIN_B 18
+
+#elif ROBOT_BOARD == ROBOT_BOARD_POLOLU_BIG
+#include <threeMotorsPololuBigDriver.h>
+typedef threeMotorsPololuBigDriver robotMotorDriver;
+#define ROBOT_MILLIAMPS_PER_COUNT 10
+#define ROBOT_SAFETY_PIN_LEFT A8
+#define ROBOT_SAFETY_PIN_RIGHT A9
+#define ROBOT_ENCODER_PIN_A 20  // shared with I2C SDA, so not with the gyro
+#define ROBOT_ENCODER_PIN_B 18
+
+#else
+#error "unknown ROBOT_BOARD"
+#endif
+
+#ifndef ROBOT_FAULT_INTERRUPTS
+#define ROBOT_FAULT_INTERRUPTS 0
+#endif
+#if ROBOT_FAULT_INTERRUPTS && ROBOT_BOARD != ROBOT_BOARD_PCB
+#error "ROBOT_FAULT_INTERRUPTS needs a driver with a status pin per bridge"
+#endif
+#ifndef ROBOT_ENCODERS
+#define ROBOT_ENCODERS 0
+#endif
+#ifndef ROBOT_SAFETY_SENSORS
+#define ROBOT_SAFETY_SENSORS 1
+#endif
+#ifndef ROBOT_FIXED_POINT
+#define ROBOT_FIXED_POINT 0
+#endif
+
+#include "batteryEstimator.h"
+#include "powerGovernor.h"
+#include "stackCanary.h"
+#include "backgroundEEPROM.h"
+#include "fixedPoint.h"
+#include "robotMath.h"
+#include "turnController.h"
+
+#if ROBOT_FIXED_POINT
+typedef Fixed<int32_t, 16> robotReal;
+#else
+typedef double robotReal;
+#endif
+
+// numerator / denominator and rounding to a whole number, in whichever robotReal is built
+static inline robotReal realRatio(long numerator, long denominator) { return realOps<robotReal>::ratio(numerator, denominator); }
+static inline long realRound(robotReal value) { return realOps<robotReal>::nearest(value); }
+
+// bits returned by readMotorFaults()
+#define MOTOR_FAULT_A 0x01  // left
+#define MOTOR_FAULT_B 0x02  // right
+#define MOTOR_FAULT_C 0x04  // top
+
+// every driver reports through getStatusA/B/C, low on a fault; short enough for an interrupt
+template <class Driver> uint8_t readMotorFaults(Driver& driver)
+{
+  uint8_t faults = 0;
+  if (!driver.getStatusA()) faults |= MOTOR_FAULT_A;
+  if (!driver.getStatusB()) faults |= MOTOR_FAULT_B;
+  if (!driver.getStatusC()) faults |= MOTOR_FAULT_C;
+  return faults;
+}
+
+// one step of a ramp down to a stop
+static inline int rampTowardZero(int speed, int step)
+{
+  if (speed > step) return speed - step;
+  if (speed < -step) return speed + step;
+  return 0;
+}
+
+#endif
@@ -0,0 +1,94 @@
+#include "backgroundEEPROM.h"
+#include <util/atomic.h>
+
+#define QUEUE_MASK (BACKGROUND_EEPROM_QUEUE - 1)
+
+backgroundEEPROMWriter::backgroundEEPROMWriter()
+{
+  _head = 0;
+  _tail = 0;
+  _checkAddress = -1;
+  _checkValue = 0;
+  _failures = 0;
+}
+
+bool backgroundEEPROMWriter::write(int address, uint8_t value)
+{
+  if (address < 0 || address >= BACKGROUND_EEPROM_SIZE) return false;
+  uint8_t next = (_head + 1) & QUEUE_MASK;
+  if (next == _tail) return false;
+  _queue[_head].address = address;
+  _queue[_head].value = value;
+  _head = next;
+  EECR |= 1 << EERIE;
+  return true;
+}
+
+uint8_t backgroundEEPROMWriter::space()
+{
+  return (_tail - _head - 1) & QUEUE_MASK;
+}
+
+bool backgroundEEPROMWriter::busy()
+{
+  bool busy;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { busy = _head != _tail || _checkAddress >= 0; }
+  return busy;
+}
+
+int backgroundEEPROMWriter::read(int address)
+{
+  if (address < 0 || address >= BACKGROUND_EEPROM_SIZE) return -1;
+  while (true)
+  {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+      for (uint8_t i = _head; i != _tail; )  // newest first
+      {
+        i = (i - 1) & QUEUE_MASK;
+        if (_queue[i].address == address) return _queue[i].value;
+      }
+      if (_checkAddress == address) return _checkValue;
+      if (!(EECR & (1 << EEPE)))  // the EEPROM can't be read during a write, come back with interrupts on
+      {
+        EEAR = address;
+        EECR |= 1 << EERE;
+        return EEDR;
+      }
+    }
+  }
+}
+
+// the EEPROM is idle: check the byte just written, then start the next one that differs
+void backgroundEEPROMWriter::readyInterrupt()
+{
+  if (_checkAddress >= 0)
+  {
+    EEAR = _checkAddress;
+    EECR |= 1 << EERE;
+    if (EEDR != _checkValue) _failures++;
+    _checkAddress = -1;
+  }
+  while (_tail != _head)
+  {
+    entry next = _queue[_tail];
+    _tail = (_tail + 1) & QUEUE_MASK;
+    EEAR = next.address;
+    EECR |= 1 << EERE;
+    if (EEDR == next.value) continue;
+    EEDR = next.value;
+    EECR = (1 << EEMPE) | (1 << EERIE);  // erase and write; EEPE has to follow within 4 cycles
+    EECR |= 1 << EEPE;
+    _checkAddress = next.address;
+    _checkValue = next.value;
+    return;
+  }
+  EECR &= ~(1 << EERIE);
+}
+
+backgroundEEPROMWriter backgroundEEPROM;
+
+ISR(EE_READY_vect)
+{
+  backgroundEEPROM.readyInterrupt();
+}
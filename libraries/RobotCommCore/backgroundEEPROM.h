@@ -0,0 +1,54 @@
+#ifndef backgroundEEPROM_h
+#define backgroundEEPROM_h
+
+#include <Arduino.h>
+
+// EEPROM writes that don't block.
+// A byte takes about 3.4 msec to write, and EEPROM.write() waits out the one before it, so a run of
+// writes holds up the loop (and the motors) for tens of msec.  write() queues the byte instead and
+// returns at once; the EEPROM ready interrupt writes the queued bytes one after another, skips any
+// that already hold the value (no wear, no wait), and reads each one back once it is written, so a
+// byte that didn't take is counted in verifyFailures().
+//
+// Every EEPROM access in the sketch has to go through this while it is in use, since a plain
+// EEPROM.read() or write() can be interrupted between setting the address and starting the access.
+// read() returns the newest queued value for an address, so a value reads back the moment it is
+// queued.
+//
+// The instance is backgroundEEPROM; it owns the EE_READY interrupt.
+
+#define BACKGROUND_EEPROM_QUEUE 64  // bytes waiting to be written, a power of 2
+#define BACKGROUND_EEPROM_SIZE 4096
+
+class backgroundEEPROMWriter
+{
+  public:
+    // CONSTRUCTOR
+    backgroundEEPROMWriter();
+
+    // PUBLIC METHODS
+    bool write(int address, uint8_t value);  // false when the queue is full or the address is out of range
+    int read(int address);                   // -1 when the address is out of range
+    uint8_t space();                         // bytes that can be queued right now
+    bool busy();                             // bytes queued, or the last one not written and checked yet
+    uint16_t verifyFailures() { return _failures; }  // running count, read it with interrupts off
+
+    // called from the interrupt service routine
+    void readyInterrupt();
+
+  private:
+    struct entry
+    {
+      uint16_t address;
+      uint8_t value;
+    };
+    entry _queue[BACKGROUND_EEPROM_QUEUE];
+    volatile uint8_t _head, _tail;
+    volatile int16_t _checkAddress;   // written, to be read back; -1 when none
+    volatile uint8_t _checkValue;
+    volatile uint16_t _failures;
+};
+
+extern backgroundEEPROMWriter backgroundEEPROM;
+
+#endif
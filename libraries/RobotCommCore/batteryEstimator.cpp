@@ -0,0 +1,116 @@
+#include "batteryEstimator.h"
+#include <util/atomic.h>  // the readers are called from the timer interrupt too
+#include <avr/pgmspace.h>
+
+// the resting voltage at every 10% of charge, in hundredths of the way from the empty voltage to the
+// full one: steep at both ends and flat in between, as NiMH and lithium packs are (hostTools/batterySim)
+const uint8_t batteryCurve[11] PROGMEM = { 0, 28, 40, 46, 51, 55, 59, 64, 71, 82, 100 };
+
+batteryEstimator::batteryEstimator(unsigned int capacityMilliAmpHours, unsigned int resistanceMilliOhms,
+                                   unsigned int idleMilliAmps, unsigned int restMilliAmps)
+{
+  _capacity = capacityMilliAmpHours * 3600L;
+  _resistance = resistanceMilliOhms;
+  _idleCurrent = idleMilliAmps;
+  _restCurrent = restMilliAmps;
+  _emptyMilliVolts = 0;
+  _fullMilliVolts = 1;
+  _microVoltsPerCount = 0;
+  _remaining = -1;
+  _filteredMilliVolts16 = 0;
+  _averageCurrent4096 = 0;
+  _averagedUpdates = 0;
+  _chargeRemainder = 0;
+}
+
+void batteryEstimator::begin(long emptyMilliVolts, long fullMilliVolts, unsigned long microVoltsPerCount)
+{
+  if (fullMilliVolts <= emptyMilliVolts) fullMilliVolts = emptyMilliVolts + 1;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    _emptyMilliVolts = emptyMilliVolts;
+    _fullMilliVolts = fullMilliVolts;
+    _microVoltsPerCount = microVoltsPerCount;
+    _remaining = -1;
+  }
+}
+
+long batteryEstimator::chargeFromVoltage(long milliVolts)
+{
+  long span = (milliVolts - _emptyMilliVolts) * 10000 / (_fullMilliVolts - _emptyMilliVolts);  // 0.01% of the way to full
+  if (span <= 0) return 0;
+  if (span >= 10000) return _capacity;
+  int below = 0;
+  while (below < 9 && span >= pgm_read_byte(&batteryCurve[below + 1]) * 100L) below++;
+  long low = pgm_read_byte(&batteryCurve[below]) * 100L, high = pgm_read_byte(&batteryCurve[below + 1]) * 100L;
+  long hundredthsOfPercent = below * 1000L + (span - low) * 1000 / (high - low);
+  return _capacity / 10000 * hundredthsOfPercent;
+}
+
+void batteryEstimator::update(int batteryCount, long motorMilliAmps, int intervalMillis)
+{
+  if (_microVoltsPerCount == 0) return;
+
+  long current = motorMilliAmps + _idleCurrent;
+  long milliVolts = batteryCount * _microVoltsPerCount / 1000 + current * _resistance / 1000;
+  if (_remaining < 0)  // first reading
+  {
+    _filteredMilliVolts16 = milliVolts << 4;
+    _averageCurrent4096 = current << 12;
+    _averagedUpdates = 1;
+    _remaining = chargeFromVoltage(milliVolts);
+    return;
+  }
+  _filteredMilliVolts16 += ((milliVolts << 4) - _filteredMilliVolts16) / BATTERY_ESTIMATOR_VOLTAGE_FILTER;
+  if (_averagedUpdates < BATTERY_ESTIMATOR_CURRENT_FILTER) _averagedUpdates++;  // the plain mean until then
+  _averageCurrent4096 += ((current << 12) - _averageCurrent4096) / (long) _averagedUpdates;
+
+  _chargeRemainder += current * intervalMillis;
+  long remaining = _remaining - _chargeRemainder / 1000;
+  _chargeRemainder %= 1000;
+  if (motorMilliAmps < _restCurrent)
+    remaining += (chargeFromVoltage(_filteredMilliVolts16 >> 4) - remaining) / BATTERY_ESTIMATOR_VOLTAGE_PULL;
+  if (remaining < 0) remaining = 0;
+  if (remaining > _capacity) remaining = _capacity;
+  _remaining = remaining;
+}
+
+long batteryEstimator::remaining()
+{
+  long remaining;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { remaining = _remaining; }
+  return remaining;
+}
+
+int batteryEstimator::percent(int batteryCount)
+{
+  long charge = remaining();
+  if (charge < 0) charge = chargeFromVoltage(busMilliVolts(batteryCount));  // no update yet
+  return (charge * 100 + _capacity / 2) / _capacity;
+}
+
+unsigned int batteryEstimator::milliVolts()
+{
+  long milliVolts;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { milliVolts = _filteredMilliVolts16 >> 4; }
+  return milliVolts;
+}
+
+unsigned int batteryEstimator::busMilliVolts(int batteryCount)
+{
+  return batteryCount * _microVoltsPerCount / 1000;
+}
+
+unsigned int batteryEstimator::runtimeMinutes()
+{
+  long charge = remaining();
+  long current;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { current = _averageCurrent4096 >> 12; }
+  if (charge < 0 || current <= 0) return 0;
+  return charge / current / 60;
+}
+
+long batteryEstimator::headroomMilliVolts()
+{
+  return (long) milliVolts() - _emptyMilliVolts;
+}
@@ -0,0 +1,150 @@
+#ifndef fixedPoint_h
+#define fixedPoint_h
+
+// Fixed point numbers for the float free build (ROBOT_FIXED_POINT, see RobotCommCore.h).
+// Fixed<Int, FracBits> keeps a value times 2^FracBits in an Int; Fixed<int32_t, 16> holds +-32767
+// with a resolution of 1/65536.  Every operation saturates at the ends of the range instead of
+// wrapping, so a yaw or a bias that runs away pins at the limit with the right sign, the way a float
+// would keep growing.  There is deliberately no conversion from float or double: a constant is made
+// with ratio(), e.g. ratio(7, 100) for 0.07, which the compiler works out when its arguments are
+// constants.  Conversions to an integer truncate toward zero, like a cast from double; nearest() rounds.
+// (Not round(): the Arduino core defines round() as a macro.)
+//
+// realOps<Real> gives the same few helpers for double and for a Fixed, so code written as a template
+// on its number type (robotMath.h) builds either way, and hostTools/fixedPointCheck can run both side
+// by side.  Nothing here needs Arduino.h except the printing, so the header builds on the host too.
+
+#include <stdint.h>
+
+template <class Int> struct fixedWide;
+template <> struct fixedWide<int16_t> { typedef int32_t type; };
+template <> struct fixedWide<int32_t> { typedef int64_t type; };
+
+template <class Int, uint8_t FracBits> class Fixed
+{
+  public:
+    typedef typename fixedWide<Int>::type Wide;
+    static const Int MAX_RAW = (Int) (((typename fixedWide<Int>::type) 1 << (sizeof(Int) * 8 - 1)) - 1);
+    static const Int MIN_RAW = (Int) (-MAX_RAW - 1);
+
+    // CONSTRUCTOR
+    Fixed() : _raw(0) {}
+    Fixed(int value) : _raw(fromWhole(value)) {}
+    Fixed(unsigned int value) : _raw(fromWhole((Wide) value)) {}
+    Fixed(long value) : _raw(fromWhole(value)) {}
+    Fixed(unsigned long value) : _raw(fromWhole((Wide) value)) {}
+
+    // PUBLIC METHODS
+    static Fixed fromRaw(Int raw) { Fixed f; f._raw = raw; return f; }
+    static Fixed ratio(long numerator, long denominator);  // numerator / denominator, rounded to nearest
+    Int raw() const { return _raw; }
+    long nearest() const;  // to the nearest whole number, halves away from zero
+    explicit operator long() const { return _raw >= 0 ? (long) (_raw >> FracBits) : -(long) ((-(Wide) _raw) >> FracBits); }
+    explicit operator int() const { return (int) (long) *this; }
+
+    Fixed operator-() const { return fromRaw(saturate(-(Wide) _raw)); }
+    Fixed& operator+=(const Fixed& b) { _raw = saturate((Wide) _raw + b._raw); return *this; }
+    Fixed& operator-=(const Fixed& b) { _raw = saturate((Wide) _raw - b._raw); return *this; }
+    Fixed& operator*=(const Fixed& b) { _raw = saturate(((Wide) _raw * b._raw) >> FracBits); return *this; }
+    Fixed& operator/=(const Fixed& b);
+
+    // friends, so an int on either side converts
+    friend Fixed operator+(Fixed a, const Fixed& b) { return a += b; }
+    friend Fixed operator-(Fixed a, const Fixed& b) { return a -= b; }
+    friend Fixed operator*(Fixed a, const Fixed& b) { return a *= b; }
+    friend Fixed operator/(Fixed a, const Fixed& b) { return a /= b; }
+    friend bool operator<(const Fixed& a, const Fixed& b) { return a._raw < b._raw; }
+    friend bool operator>(const Fixed& a, const Fixed& b) { return a._raw > b._raw; }
+    friend bool operator<=(const Fixed& a, const Fixed& b) { return a._raw <= b._raw; }
+    friend bool operator>=(const Fixed& a, const Fixed& b) { return a._raw >= b._raw; }
+    friend bool operator==(const Fixed& a, const Fixed& b) { return a._raw == b._raw; }
+    friend bool operator!=(const Fixed& a, const Fixed& b) { return a._raw != b._raw; }
+
+  private:
+    static Int saturate(Wide value) { return value > MAX_RAW ? MAX_RAW : value < MIN_RAW ? MIN_RAW : (Int) value; }
+    static Int fromWhole(Wide value)
+    {
+      if (value > (Wide) (MAX_RAW >> FracBits)) return MAX_RAW;
+      if (value < -(Wide) (MAX_RAW >> FracBits) - 1) return MIN_RAW;
+      return (Int) (value * ((Wide) 1 << FracBits));
+    }
+
+    Int _raw;
+};
+
+template <class Int, uint8_t FracBits> const Int Fixed<Int, FracBits>::MAX_RAW;
+template <class Int, uint8_t FracBits> const Int Fixed<Int, FracBits>::MIN_RAW;
+
+template <class Int, uint8_t FracBits>
+Fixed<Int, FracBits> Fixed<Int, FracBits>::ratio(long numerator, long denominator)
+{
+  if (denominator == 0) return fromRaw(numerator >= 0 ? MAX_RAW : MIN_RAW);
+  if (denominator < 0)
+  {
+    numerator = -numerator;
+    denominator = -denominator;
+  }
+  // small numerators, msec and tenths, stay in a long, which is much cheaper on the AVR than a Wide
+  if (sizeof(Int) <= sizeof(long) && FracBits < 30 && numerator > -(1L << (30 - FracBits)) && numerator < (1L << (30 - FracBits)))
+  {
+    long scaled = numerator * (1L << FracBits);
+    long half = denominator / 2;
+    return fromRaw(saturate((scaled >= 0 ? scaled + half : scaled - half) / denominator));
+  }
+  Wide scaled = (Wide) numerator * ((Wide) 1 << FracBits);
+  Wide half = denominator / 2;
+  return fromRaw(saturate((scaled >= 0 ? scaled + half : scaled - half) / denominator));
+}
+
+template <class Int, uint8_t FracBits>
+long Fixed<Int, FracBits>::nearest() const
+{
+  Wide half = (Wide) 1 << (FracBits - 1);
+  return _raw >= 0 ? (long) (((Wide) _raw + half) >> FracBits) : -(long) ((-(Wide) _raw + half) >> FracBits);
+}
+
+template <class Int, uint8_t FracBits>
+Fixed<Int, FracBits>& Fixed<Int, FracBits>::operator/=(const Fixed& b)
+{
+  if (b._raw == 0) _raw = _raw >= 0 ? MAX_RAW : MIN_RAW;
+  else _raw = saturate(((Wide) _raw * ((Wide) 1 << FracBits)) / b._raw);
+  return *this;
+}
+
+// the helpers robotMath.h uses, for double and for Fixed
+template <class Real> struct realOps
+{
+  static Real ratio(long numerator, long denominator) { return (Real) numerator / denominator; }
+  static long nearest(Real value) { return value >= 0 ? (long) (value + 0.5) : -(long) (-value + 0.5); }
+};
+
+template <class Int, uint8_t FracBits> struct realOps<Fixed<Int, FracBits> >
+{
+  static Fixed<Int, FracBits> ratio(long numerator, long denominator) { return Fixed<Int, FracBits>::ratio(numerator, denominator); }
+  static long nearest(Fixed<Int, FracBits> value) { return value.nearest(); }
+};
+
+#ifdef ARDUINO
+#include <Print.h>
+
+// two decimals, like Print::print(double); robotLog prints its arguments through printArgument()
+template <class Int, uint8_t FracBits> size_t printArgument(Print& port, const Fixed<Int, FracBits>& value)
+{
+  typedef typename Fixed<Int, FracBits>::Wide Wide;
+  Wide raw = value.raw();
+  size_t n = 0;
+  if (raw < 0)
+  {
+    n += port.print('-');
+    raw = -raw;
+  }
+  Wide hundredths = (raw * 100 + ((Wide) 1 << (FracBits - 1))) >> FracBits;
+  n += port.print((unsigned long) (hundredths / 100));
+  n += port.print('.');
+  if (hundredths % 100 < 10) n += port.print('0');
+  n += port.print((unsigned int) (hundredths % 100));
+  return n;
+}
+#endif
+
+#endif
@@ -0,0 +1,58 @@
+#include "powerGovernor.h"
+#include <RobotTelemetry.h>  // for the flag values
+
+powerGovernor::powerGovernor(unsigned int busMinMilliVolts, long currentLimitMilliAmps)
+{
+  _busMin = busMinMilliVolts;
+  _currentLimit = currentLimitMilliAmps;
+  _cap = 255;
+  _flags = 0;
+  _busMilliVolts = 0;
+  _slewStep = POWER_SLEW_STEP;
+}
+
+void powerGovernor::update(unsigned int busMilliVolts, long batteryHeadroomMilliVolts, long driveMilliAmps,
+                           int requestedA, int requestedB)
+{
+  uint8_t flags = 0;
+  _busMilliVolts = busMilliVolts;
+
+  int ceiling = 255;
+  if (batteryHeadroomMilliVolts < POWER_DERATE_MARGIN)
+  {
+    if (batteryHeadroomMilliVolts < 0) batteryHeadroomMilliVolts = 0;
+    ceiling = POWER_LOW_BATTERY_CAP + (255 - POWER_LOW_BATTERY_CAP) * batteryHeadroomMilliVolts / POWER_DERATE_MARGIN;
+    flags |= TELEMETRY_POWER_LOW_BATTERY;
+  }
+  int cap = _cap;
+  if (busMilliVolts < _busMin)
+  {
+    cap -= POWER_CAP_CUT;
+    flags |= TELEMETRY_POWER_SAG;
+  }
+  else if (busMilliVolts > _busMin + POWER_BUS_HYSTERESIS) cap += POWER_CAP_RECOVER;
+  if (cap > ceiling) cap = ceiling;
+  if (cap < POWER_MIN_CAP) cap = POWER_MIN_CAP;
+  _cap = cap;
+  if (abs(requestedA) > cap || abs(requestedB) > cap) flags |= TELEMETRY_POWER_CAPPED;
+
+  _slewStep = POWER_SLEW_STEP;
+  if (driveMilliAmps > _currentLimit)
+  {
+    _slewStep = 0;
+    flags |= TELEMETRY_POWER_CURRENT;
+  }
+  _flags = flags;
+}
+
+int powerGovernor::limit(int current, int requested)
+{
+  int target = constrain(requested, -_cap, _cap);
+  if (current >= 0 && target >= 0 && target <= current) return target;  // slowing down
+  if (current <= 0 && target <= 0 && target >= current) return target;
+  // turning round: down to 0 is slowing down, beyond it a start like any other, so over the current
+  // limit (a step of 0) the wheel stops rather than keeps pushing the way it was going
+  if ((current > 0 && target < 0) || (current < 0 && target > 0)) return constrain(target, -(int) _slewStep, (int) _slewStep);
+  if (target > current) return min(target, current + _slewStep);
+  return max(target, current - _slewStep);
+}
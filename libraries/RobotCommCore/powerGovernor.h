@@ -0,0 +1,52 @@
+#ifndef powerGovernor_h
+#define powerGovernor_h
+
+#include <Arduino.h>
+
+// Drive wheel power limits.
+// A hard start on a tired pack pulls the bus low enough to reset the Mega or drop the bluetooth link,
+// so the motion routines' requested speeds go through limit() before they reach the driver:
+//   slew: the PWM magnitude may rise by at most POWER_SLEW_STEP per update, and not at all while the
+//     drive current is over the current limit; slowing down is never held back, and turning round
+//     goes to 0 at once and starts the other way from there
+//   cap: the PWM magnitude is capped at cap().  Each update with the bus under the minimum voltage
+//     drops the cap by POWER_CAP_CUT, and it creeps back up by POWER_CAP_RECOVER once the bus is clear
+//     of the minimum by POWER_BUS_HYSTERESIS.  The cap is also held down as the load compensated battery
+//     voltage nears empty.
+// update() takes the measurements, every 10 msec or so; flags() says why the wheels are held back, as
+// TELEMETRY_POWER_* bits (see RobotTelemetry.h).  Both update() and limit() are meant for the timer
+// interrupt, or to be called with interrupts off.  hostTools/powerSim runs it against a sagging pack.
+
+#define POWER_SLEW_STEP 20             // PWM per update, 0 to full in 13 updates
+#define POWER_BUS_HYSTERESIS 300       // mV
+#define POWER_CAP_CUT 25
+#define POWER_CAP_RECOVER 2            // back to full in about 100 updates
+#define POWER_MIN_CAP 80               // lowest cap, below this the wheels barely turn
+#define POWER_LOW_BATTERY_CAP 150      // cap at the empty battery voltage
+#define POWER_DERATE_MARGIN 1000       // mV above empty where the low battery cap starts
+#define POWER_HEADROOM_UNKNOWN 0x7FFFFFFFL  // for update() before the battery estimate is ready
+
+class powerGovernor
+{
+  public:
+    // CONSTRUCTOR
+    powerGovernor(unsigned int busMinMilliVolts, long currentLimitMilliAmps);
+
+    // PUBLIC METHODS
+    void update(unsigned int busMilliVolts, long batteryHeadroomMilliVolts, long driveMilliAmps,
+                int requestedA, int requestedB);
+    int limit(int current, int requested);  // one step from the current PWM toward the requested one
+    int cap() { return _cap; }
+    uint8_t flags() { return _flags; }
+    unsigned int busMilliVolts() { return _busMilliVolts; }
+
+  private:
+    unsigned int _busMin;
+    long _currentLimit;
+    volatile int _cap;
+    volatile uint8_t _flags;
+    volatile unsigned int _busMilliVolts;
+    uint8_t _slewStep;
+};
+
+#endif
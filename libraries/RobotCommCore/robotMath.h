@@ -0,0 +1,88 @@
+#ifndef robotMath_h
+#define robotMath_h
+
+// The gyro and heading arithmetic of the RobotComm sketch, written once as templates on the number type
+// so the sketch can build it with robotReal (double, or Fixed<int32_t, 16> with ROBOT_FIXED_POINT) and
+// hostTools/fixedPointCheck can run the two side by side on the same gyro readings.  Constants are made
+// with realOps<Real>::ratio() rather than written as float literals, which a Fixed can't take.
+// Like fixedPoint.h this builds on the host.
+
+#include "fixedPoint.h"
+
+#define GYRO_MDPS_PER_COUNT 70   // L3G at 2000 dps full scale
+#define STRAIGHT_DELTA_LIMIT 2   // tenths of a degree per step before goStraight corrects the rate
+#define STRAIGHT_DRIFT_LIMIT 2   // degrees off the heading before goStraight steers back
+
+// degrees/sec for a gyro reading, in counts
+template <class Real> Real gyroDegrees(Real counts)
+{
+  return counts * realOps<Real>::ratio(GYRO_MDPS_PER_COUNT, 1000);
+}
+
+template <class Real> Real gyroRate(int raw, Real baseline)
+{
+  return gyroDegrees(Real(raw) - baseline);
+}
+
+// degrees turned in msec at rate
+template <class Real> Real yawStep(Real rate, unsigned long msec)
+{
+  return rate * realOps<Real>::ratio(msec, 1000);
+}
+
+// the gyro baseline after numPoints more readings adding up to sum, weighted against the points it had
+template <class Real> Real foldBaseline(Real baseline, int points, long sum, int numPoints)
+{
+  long total = (long) points + numPoints;
+  return realOps<Real>::ratio(sum, total) + baseline * realOps<Real>::ratio(points, total);
+}
+
+template <class Real> bool oppositeSigns(Real a, Real b) { return (a > 0 && b < 0) || (a < 0 && b > 0); }
+
+// goStraight's bias changes for one step: deltaYaw is the yaw since the last step, integratedYaw since the
+// start of the move.  Returns true when the turn changed direction, so the caller lets the changes settle.
+template <class Real> bool straightCorrection(Real deltaYaw, Real previousDeltaYaw, Real integratedYaw,
+                                              Real& deltaLeft, Real& deltaRight)
+{
+  deltaLeft = 0;
+  deltaRight = 0;
+  if (oppositeSigns(deltaYaw, previousDeltaYaw)) // sign change-- we are getting near the right numbers
+  {
+    if (deltaYaw > 0)  // we want to dampen the last few changes
+    {
+      deltaLeft = -10;
+      deltaRight = 10;
+    }
+    return true;
+  }
+
+  Real deltaLimit = realOps<Real>::ratio(STRAIGHT_DELTA_LIMIT, 10);
+  bool sameSignBias = (deltaYaw > 0 && integratedYaw > 0) || (deltaYaw < 0 && integratedYaw < 0);  // double the bias change
+
+  //derivative, fast immediate correction
+  if (deltaYaw > deltaLimit || (sameSignBias && deltaYaw > 0)) // this means we have turn to the left, so make right motor stronger, left motor weaker
+  {
+    deltaLeft = -4 - deltaYaw * 10;
+    deltaRight = 4 + deltaYaw * 10;
+  }
+  if (deltaYaw < -deltaLimit || (sameSignBias && deltaYaw < 0))  // we have turn to the right, so make left motor stronger, right motor weaker
+  {
+    deltaLeft = 4 - deltaYaw * 10;
+    deltaRight = -4 + deltaYaw * 10;
+  }
+
+  //integrative, slowly come back to original heading
+  if (integratedYaw > STRAIGHT_DRIFT_LIMIT || (sameSignBias && integratedYaw > 0))
+  {
+    deltaLeft -= 1 + integratedYaw;
+    deltaRight += 1 + integratedYaw;
+  }
+  if (integratedYaw < -STRAIGHT_DRIFT_LIMIT || (sameSignBias && integratedYaw < 0))
+  {
+    deltaLeft += 1 - integratedYaw;
+    deltaRight -= 1 - integratedYaw;
+  }
+  return false;
+}
+
+#endif
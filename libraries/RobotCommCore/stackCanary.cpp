@@ -0,0 +1,53 @@
+#include "stackCanary.h"
+
+extern uint8_t __heap_start;  // set by the linker, just past .bss
+extern uint8_t __stack;       // top of SRAM
+extern char* __brkval;        // top of the heap, 0 until malloc is first called
+
+// runs from .init1, before __zero_reg__ is cleared and the stack pointer is set, so it is naked
+// and in assembly: no stack, no registers the C runtime relies on
+void stackPaint() __attribute__((naked, used, section(".init1")));
+void stackPaint()
+{
+  __asm volatile (
+    "    ldi r30, lo8(__heap_start)\n"
+    "    ldi r31, hi8(__heap_start)\n"
+    "    ldi r24, %0\n"
+    "    ldi r25, hi8(__stack)\n"
+    "    rjmp 2f\n"
+    "1:  st Z+, r24\n"
+    "2:  cpi r30, lo8(__stack)\n"
+    "    cpc r31, r25\n"
+    "    brlo 1b\n"
+    "    breq 1b\n"
+    : : "M" (STACK_CANARY));
+}
+
+static uint8_t* heapTop()
+{
+  return __brkval ? (uint8_t*) __brkval : &__heap_start;
+}
+
+// lowest address the stack has written
+static uint8_t* stackLowWater()
+{
+  uint8_t* p = heapTop();
+  uint8_t* sp = (uint8_t*) SP;
+  while (p <= sp && *p == STACK_CANARY) p++;
+  return p;
+}
+
+unsigned int stackHighWater()
+{
+  return &__stack - stackLowWater() + 1;
+}
+
+unsigned int stackNeverUsed()
+{
+  return stackLowWater() - heapTop();
+}
+
+unsigned int stackFree()
+{
+  return (uint8_t*) SP - heapTop();
+}
@@ -0,0 +1,22 @@
+#ifndef stackCanary_h
+#define stackCanary_h
+
+#include <Arduino.h>
+
+// Stack high water mark.
+// Before the C runtime sets anything up (.init1), the SRAM from the end of the globals to the top
+// of memory is painted with STACK_CANARY.  The stack grows down from the top and the heap, if
+// anything uses malloc, up from the bottom; whatever is still painted in between has never been
+// touched, so the deepest the stack has been since reset can be read back at any time.
+// Nothing needs to be called at startup, linking this in is enough.
+//
+// A few bytes could happen to be written with the canary value, so the high water mark is a lower
+// bound, but off by a few bytes at most.  Reading it scans the untouched gap, about a msec.
+
+#define STACK_CANARY 0xC5
+
+unsigned int stackHighWater();  // most bytes the stack has used since reset
+unsigned int stackNeverUsed();  // painted bytes still untouched between the heap and the stack
+unsigned int stackFree();       // bytes between the heap and the stack right now
+
+#endif
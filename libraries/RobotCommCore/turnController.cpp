@@ -0,0 +1,98 @@
+#include "turnController.h"
+
+turnController::turnController(uint8_t* overshootTenths)
+{
+  _overshoot = overshootTenths;
+  _target = 0;
+  _turned = 0;
+  _rate = 0;
+  _cutTurned = 0;
+  _cutRate = 0;
+  _speed = 0;
+  _floor = 0;
+  _learnedBin = 0;
+  _cut = false;
+}
+
+int turnController::begin(long targetTenths, int speed, int floorSpeed)
+{
+  if (speed < 0) speed = -speed;
+  if (speed > 255) speed = 255;
+  if (floorSpeed > speed) floorSpeed = speed;
+  _target = targetTenths;
+  _speed = speed;
+  _floor = floorSpeed;
+  _turned = 0;
+  _rate = 0;
+  _cutTurned = 0;
+  _cutRate = 0;
+  _cut = false;
+  long pwm = _floor + targetTenths * TURN_RAMP_PWM_PER_DEGREE / 10;  // a short turn starts on the ramp
+  return pwm > _speed ? _speed : (int) pwm;
+}
+
+long turnController::predictedOvershoot(long rateTenths)
+{
+  if (rateTenths < 0) rateTenths = -rateTenths;
+  long bin = rateTenths / TURN_RATE_STEP;
+  if (bin >= TURN_RATE_BINS - 1) return _overshoot[TURN_RATE_BINS - 1];
+  long fraction = rateTenths % TURN_RATE_STEP;
+  return (_overshoot[bin] * (TURN_RATE_STEP - fraction) + _overshoot[bin + 1] * fraction) / TURN_RATE_STEP;
+}
+
+int turnController::update(long turnedTenths, long rateTenths)
+{
+  _turned = turnedTenths;
+  _rate = rateTenths;
+  long left = _target - turnedTenths - predictedOvershoot(rateTenths);  // to where a cut now would stop
+  if (left <= rateTenths * TURN_CUT_LEAD_MSEC / 1000)
+  {
+    _cut = true;
+    _cutTurned = turnedTenths;
+    _cutRate = rateTenths;
+    return 0;
+  }
+  long pwm = _floor + left * TURN_RAMP_PWM_PER_DEGREE / 10;
+  if (pwm < _speed && rateTenths < TURN_CREEP_RATE)  // on the ramp and not getting anywhere
+  {
+    _floor += TURN_CREEP_STEP;
+    if (_floor > _speed) _floor = _speed;
+  }
+  if (pwm > _speed) pwm = _speed;
+  return (int) pwm;
+}
+
+unsigned int turnController::nextStep(unsigned int msec)
+{
+  if (_rate <= 0) return msec;
+  long toCut = (_target - _turned - predictedOvershoot(_rate)) * 1000 / _rate;
+  if (toCut < 1) return 1;
+  return toCut < (long) msec ? (unsigned int) toCut : msec;
+}
+
+bool turnController::learn(long finalTenths)
+{
+  if (!_cut) return false;  // timed out or stopped, the coast says nothing
+  long miss = (finalTenths - _cutTurned) - predictedOvershoot(_cutRate);
+  if (miss > TURN_LEARN_LIMIT) miss = TURN_LEARN_LIMIT;  // a bump moves the table only so far
+  if (miss < -TURN_LEARN_LIMIT) miss = -TURN_LEARN_LIMIT;
+  long bin = _cutRate / TURN_RATE_STEP, fraction = _cutRate % TURN_RATE_STEP;
+  if (bin >= TURN_RATE_BINS - 1)
+  {
+    bin = TURN_RATE_BINS - 2;
+    fraction = TURN_RATE_STEP;
+  }
+  // half the miss, shared between the two entries by how near the rate was to each
+  long change[2] = { miss * (TURN_RATE_STEP - fraction) / (2 * TURN_RATE_STEP), miss * fraction / (2 * TURN_RATE_STEP) };
+  bool changed = false;
+  for (uint8_t i = 0; i < 2; i++)
+  {
+    long overshoot = _overshoot[bin + i] + change[i];
+    if (overshoot < 0) overshoot = 0;
+    if (overshoot > TURN_MAX_OVERSHOOT) overshoot = TURN_MAX_OVERSHOOT;
+    if (overshoot != _overshoot[bin + i]) changed = true;
+    _overshoot[bin + i] = (uint8_t) overshoot;
+  }
+  _learnedBin = (uint8_t) bin;
+  return changed;
+}
@@ -0,0 +1,61 @@
+#ifndef turnController_h
+#define turnController_h
+
+#include <stdint.h>
+
+// Gyro turns to a number of degrees.
+// A turn used to run at full speed until the gyro said it was there and then coast, so it overshot by
+// however far the robot coasts from that speed, several degrees at full speed.  Now every update predicts
+// where the robot would stop if the motors were cut then: the yaw so far plus the overshoot for the rate
+// it is turning at.  The speed comes down along a ramp, TURN_RAMP_PWM_PER_DEGREE for every degree between
+// that predicted stop and the target, to no less than the floor given to begin() (min_decel_speed), and
+// the motors are cut once the predicted stop reaches the target.  A robot that stalls on the ramp (carpet,
+// a low battery) has the floor raised until it moves again.
+//
+// The overshoot is learned: once the robot has stopped, learn() compares how far it really coasted with
+// the prediction and moves the two table entries either side of the rate at the cut halfway to it.  The
+// entries are bytes, in tenths of a degree, at turning rates 0, 40, 80 ... 280 degrees/sec, with the
+// overshoot in between worked out along a straight line; the caller keeps them (the sketch has them in
+// the parameter registry, which puts them in the EEPROM), so a robot, its floor and its battery settle
+// in over a few turns and stay settled.
+//
+// Everything is in tenths of a degree and integers, like batteryEstimator, so it works the same in the
+// double and the ROBOT_FIXED_POINT builds.  It doesn't use Arduino.h, so hostTools/turnSim can run it
+// against a model of the robot.
+
+#define TURN_RATE_BINS 8
+#define TURN_RATE_STEP 400             // tenths of a degree/sec between table entries
+#define TURN_RAMP_PWM_PER_DEGREE 4     // slope of the slow down
+#define TURN_CREEP_RATE 200            // tenths of a degree/sec; slower than this on the ramp counts as stalled
+#define TURN_CREEP_STEP 10             // PWM the floor rises each update while stalled
+#define TURN_CUT_LEAD_MSEC 2           // cut this early rather than take another tiny step
+#define TURN_LEARN_LIMIT 100           // tenths; a bigger miss is learned as this much, in case it was a bump
+#define TURN_MAX_OVERSHOOT 254         // tenths, 255 is an erased EEPROM byte
+#define TURN_SETTLED_RATE 20           // tenths of a degree/sec, stopped for learn()
+#define TURN_SETTLE_STEPS 25           // gyro reads to wait for that after the cut, at most
+
+class turnController
+{
+  public:
+    // CONSTRUCTOR
+    turnController(uint8_t* overshootTenths);  // TURN_RATE_BINS of them
+
+    // PUBLIC METHODS
+    int begin(long targetTenths, int speed, int floorSpeed);  // PWM to start at
+    int update(long turnedTenths, long rateTenths);  // PWM to turn at, 0 once the motors should be cut
+    unsigned int nextStep(unsigned int msec);        // msec to the next update, shortened to land on the cut
+    bool learn(long finalTenths);                    // after the robot has stopped; true if the table changed
+    long predictedOvershoot(long rateTenths);
+    bool cut() { return _cut; }
+    long cutRateTenths() { return _cutRate; }
+    uint8_t learnedBin() { return _learnedBin; }  // the lower of the entries learn() changed
+
+  private:
+    uint8_t* _overshoot;
+    long _target, _turned, _rate, _cutTurned, _cutRate;
+    int _speed, _floor;
+    uint8_t _learnedBin;
+    bool _cut;
+};
+
+#endif
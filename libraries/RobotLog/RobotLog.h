@@ -0,0 +1,70 @@
+#ifndef RobotLog_h
+#define RobotLog_h
+
+// Diagnostic log for the RobotComm firmware.
+// message(id, args...) prints one line: the text of the message from RobotLogMessages.h, kept in
+// flash, then the arguments separated by ", ".  Any type Print can print will do as an argument, and
+// a type it can't can bring a printArgument(Print&, const T&) of its own (fixedPoint.h does).
+//
+// With ROBOT_LOG_IDS set to 1 the line is '~', the id number and the arguments, separated by ',',
+// and the message text is left out of the image altogether, which saves most of the flash the
+// diagnostics take and a good part of the time the prints hold up the loop.  Pipe the monitor
+// output through hostTools/logExpander to read it.
+//
+// Like RobotCommCore.h this header is only included by the sketch, so ROBOT_LOG_IDS is seen either
+// from the top of the sketch's first tab or from -D.
+
+#include <Arduino.h>
+#include "RobotLogMessages.h"
+
+#ifndef ROBOT_LOG_IDS
+#define ROBOT_LOG_IDS 0
+#endif
+
+#if !ROBOT_LOG_IDS
+#define ROBOT_LOG_TEXT(id, text) static const char id##_text[] PROGMEM = text;
+ROBOT_LOG_MESSAGES(ROBOT_LOG_TEXT)
+#undef ROBOT_LOG_TEXT
+#define ROBOT_LOG_TABLE(id, text) id##_text,
+static const char* const robotLogText[] PROGMEM = { ROBOT_LOG_MESSAGES(ROBOT_LOG_TABLE) };
+#undef ROBOT_LOG_TABLE
+#endif
+
+template <typename T> static inline size_t printArgument(Print& port, const T& value) { return port.print(value); }
+
+class robotLog
+{
+  public:
+    // CONSTRUCTOR
+    robotLog(Print& port) : _port(port) {}
+
+    // PUBLIC METHODS
+    template <typename... Args> void message(uint8_t id, Args... args)
+    {
+#if ROBOT_LOG_IDS
+      _port.print(ROBOT_LOG_ID_MARK);
+      _port.print(id);
+#else
+      if (id < ROBOT_LOG_MESSAGE_COUNT)
+        _port.print((const __FlashStringHelper*) pgm_read_ptr(&robotLogText[id]));
+#endif
+      _separator = ROBOT_LOG_IDS;
+      arguments(args...);
+      _port.println();
+    }
+
+  private:
+    void arguments() {}
+    template <typename T, typename... Rest> void arguments(T first, Rest... rest)
+    {
+      if (_separator) _port.print(ROBOT_LOG_IDS ? F(",") : F(", "));
+      _separator = true;
+      printArgument(_port, first);
+      arguments(rest...);
+    }
+
+    Print& _port;
+    bool _separator;
+};
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef RobotLogMessages_h
+#define RobotLogMessages_h
+
+// Diagnostic messages of the RobotComm firmware, shared by the firmware (RobotLog.h) and the host
+// tools in hostTools/ (logExpander), so the two can never drift apart.
+//
+// Each message is X(id, text).  The firmware logs a message as its text followed by its arguments,
+// separated by ", ", so the text ends with the argument names when there are any.  Built with
+// ROBOT_LOG_IDS the firmware sends only the id number and the arguments, and none of the text is
+// in the image; logExpander puts the text back.
+//
+// The id is the position in the list: add new messages at the end, and rebuild the host tools
+// along with the firmware when the list changes.
+
+#define ROBOT_LOG_MESSAGES(X) \
+  X(LOG_READY,                  "Serial ports initialized, ready for commands") \
+  X(LOG_MOTOR_BIASES,           "left_motor_bias_default, right_motor_bias_default = ") \
+  X(LOG_DEFAULT_DEGREES,        "website does not yet support specifying turn degrees, so we just use degrees_default = ") \
+  X(LOG_COMMANDED,              "commanded: ") \
+  X(LOG_UNKNOWN_COMMAND,        "did not recognize command, character code = ") \
+  X(LOG_TOO_MANY_PARAMETERS,    "***ERROR:  Maximum number of parameters exceeded") \
+  X(LOG_EEPROM_READ,            "EEPROM requested:  address, value = ") \
+  X(LOG_EEPROM_WRITE_ENABLED,   "EEPROM writing enabled.") \
+  X(LOG_EEPROM_WRITE_DISABLED,  "EEPROM writing disabled.") \
+  X(LOG_EEPROM_WRITTEN,         "EEPROM written, value, address = ") \
+  X(LOG_EEPROM_NOT_ENABLED,     "EEPROM write requested when writing not enabled") \
+  X(LOG_GYRO_MISSING,           "Gyro not present") \
+  X(LOG_GYRO_BASELINE,          "Gyro baseline yaw in degrees, positive is to the right = ") \
+  X(LOG_GYRO_TURN,              "in gyro turn delay for degrees = ") \
+  X(LOG_GYRO_COAST_YAW,         "When coast command issued, yaw was = ") \
+  X(LOG_GYRO_TURN_YAW,          "Yaw this turn, totalYaw = ") \
+  X(LOG_GYRO_YAW_BASELINE,      "Yaw baseline = ") \
+  X(LOG_EMERGENCY_STOP,         "EMERGENCY STOP, send x# to acknowledge") \
+  X(LOG_EMERGENCY_STOP_ACK,     "emergency stop acknowledged") \
+  X(LOG_MOTOR_FAULT,            "motor driver fault, braked, fault mask = ") \
+  X(LOG_MOTOR_FAULTS_CLEARED,   "motor driver faults cleared") \
+  X(LOG_STOPPING,               "stopping") \
+  X(LOG_SAFETY_BLOCKED,         "cliff or obstacle ahead, not moving forward") \
+  X(LOG_MOVING_SPEEDS,          "moving, L, R speeds = ") \
+  X(LOG_MOVING,                 "moving, speed = ") \
+  X(LOG_MOVE_TIME,              "move time = ") \
+  X(LOG_UNBIASED_SPEED,         "unbiased command speed = ") \
+  X(LOG_UNBIASED_UNSIGNED_SPEED,"unbiased, unsigned command speed = ") \
+  X(LOG_BIASES_NOT_LEARNED,     "stuck wheel, motor biases not learned this move") \
+  X(LOG_MOVE_YAW,               "delta Yaw during move = ") \
+  X(LOG_TURNING_DEGREES,        "turning, speed, degrees = ") \
+  X(LOG_TURNING_MSEC,           "turning, speed, msec = ") \
+  X(LOG_TILTING,                "tilting, speed = ") \
+  X(LOG_INITIAL_BIASES,         "initial left_motor_bias_default, right_motor_bias_default = ") \
+  X(LOG_DAMPEN_COUNTER,         "dampenChangesCounter = ") \
+  X(LOG_STRAIGHT_YAW,           "integratedYaw, deltaYaw, deltaTime, left_motor_bias_default, right_motor_bias_default = ") \
+  X(LOG_STRAIGHT_DELTAS,        "speed, deltaLeft, deltaRight = ") \
+  X(LOG_OVER_CURRENT,           "Excessive motor current detected = ") \
+  X(LOG_TILT_OVER_CURRENT,      "Excessive tilt motor current detected = ") \
+  X(LOG_MOTOR_CURRENTS,         "Motor current Left, Right, Top = ") \
+  X(LOG_LINK_LOST,              "bluetooth link lost, stopping") \
+  X(LOG_LINK_RESTORED,          "bluetooth link restored") \
+  X(LOG_TELEMETRY_OFF,          "telemetry off") \
+  X(LOG_TELEMETRY_RATE,         "telemetry rate, mask = ") \
+  X(LOG_QUEUE_REJECTED,         "command not queued, queue full or bad command") \
+  X(LOG_QUEUED,                 "queued command, text, id = ") \
+  X(LOG_QUEUE_RUNNING,          "running queued command: ") \
+  X(LOG_SAFETY_STOP,            "cliff or obstacle, stopped, sensor mask, msec = ") \
+  X(LOG_SAFETY_ENABLED,         "safety monitor enabled, tripped = ") \
+  X(LOG_SAFETY_NO_ADC_SLOT,     "no ADC slot left for an IR sensor") \
+  X(LOG_STALL,                  "stuck wheel, stopped, kind, wheel mask = ") \
+  X(LOG_STALL_ENABLED,          "stall detector enabled = ") \
+  X(LOG_PARAMETER_BATCH,        "parameter batch, pairs, crc, status = ") \
+  X(LOG_PARAMETER_SET,          "parameter set, id, value, status = ") \
+  X(LOG_PARAMETERS_COMMITTED,   "parameters committed, count, status = ") \
+  X(LOG_TURN_LEARNED,           "turn overshoot learned, rate at the cut, overshoot table entry, tenths = ")
+
+#define ROBOT_LOG_ENUM(id, text) id,
+enum { ROBOT_LOG_MESSAGES(ROBOT_LOG_ENUM) ROBOT_LOG_MESSAGE_COUNT };
+#undef ROBOT_LOG_ENUM
+
+#define ROBOT_LOG_ID_MARK '~'  // leads a line sent as an id, never the first character of a text message
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef RobotParameters_h
+#define RobotParameters_h
+
+// The tunable parameters of the RobotComm firmware, shared by the firmware (u_parameters) and the
+// host tools in hostTools/ (parameterTool), so the two can never drift apart.
+//
+// Each parameter is X(id, name, variable, kind, minimum, maximum, scale, address, default):
+//   id        PARAM_ constant, the number it goes by over the link
+//   name      for the host tools
+//   variable  the firmware global that holds the live value
+//   minimum, maximum, default
+//             in the units of the variable (msec, mA, PWM ...); tenths for PARAM_TENTHS
+//   scale     the EEPROM holds the value divided by this, to fit in a byte
+//   address   EEPROM address of the byte (of the whole part for PARAM_TENTHS, the tenths follow)
+// The turn_overshoot_ entries are the table turnController learns, in tenths of a degree at turning
+// rates 0, 40 ... 280 degrees/sec (libraries/RobotCommCore/turnController.h); they follow each other,
+// so the one for entry n is PARAM_TURN_OVERSHOOT_0 + n.
+// The default is used when the EEPROM has never been written (see loadParameters()).
+//
+// The id is the position in the list: add new parameters at the end.
+
+// kinds
+#define PARAM_UNSIGNED 0  // byte * scale
+#define PARAM_SIGNED 1    // byte * scale, bytes over 128 count back from 256
+#define PARAM_TENTHS 2    // whole part and tenths in two bytes, the variable is a robotReal
+#define PARAM_OPTIONAL 3  // like PARAM_UNSIGNED, but an erased byte (255) reads as the default;
+                          // for the parameters added after many robots were set up
+
+#define ROBOT_PARAMETERS(X) \
+  X(PARAM_TIMED_OUT,              "timed_out",              timed_out_default,              PARAM_UNSIGNED, 0, 25500, 100, 101, 3000) \
+  X(PARAM_SPEED,                  "speed",                  speed_default,                  PARAM_UNSIGNED, 0, 255, 1, 102, 220) \
+  X(PARAM_BW_REDUCTION,           "bw_reduction",           bw_reduction_default,           PARAM_UNSIGNED, 0, 255, 1, 103, 50) \
+  X(PARAM_TILT_UP_SPEED,          "tilt_up_speed",          tilt_up_speed_default,          PARAM_UNSIGNED, 0, 255, 1, 104, 180) \
+  X(PARAM_TILT_DOWN_SPEED,        "tilt_down_speed",        tilt_down_speed_default,        PARAM_UNSIGNED, 0, 255, 1, 105, 135) \
+  X(PARAM_DEGREES,                "degrees",                degrees_default,                PARAM_UNSIGNED, 0, 255, 1, 106, 5) \
+  X(PARAM_TICKS_PER_DEGREE_OF_TILT, "ticks_per_degree_of_tilt", ticks_per_degree_of_tilt_default, PARAM_UNSIGNED, 0, 255, 1, 107, 30) \
+  X(PARAM_TURN_FOREVER_SPEED,     "turn_forever_speed",     turn_forever_speed_default,     PARAM_UNSIGNED, 0, 255, 1, 108, 150) \
+  X(PARAM_TURN_TIME,              "turn_time",              turn_time_default,              PARAM_UNSIGNED, 0, 2550, 10, 109, 500) \
+  X(PARAM_MOVE_TIME,              "move_time",              move_time_default,              PARAM_UNSIGNED, 0, 2550, 10, 110, 1000) \
+  X(PARAM_TILT_TIME,              "tilt_time",              tilt_time_default,              PARAM_UNSIGNED, 0, 2550, 10, 111, 500) \
+  X(PARAM_NUDGE_TURN_TIME,        "nudge_turn_time",        nudge_turn_time_default,        PARAM_UNSIGNED, 0, 2550, 10, 201, 200) \
+  X(PARAM_NUDGE_MOVE_TIME,        "nudge_move_time",        nudge_move_time_default,        PARAM_UNSIGNED, 0, 2550, 10, 202, 300) \
+  X(PARAM_NUDGE_TILT_TIME,        "nudge_tilt_time",        nudge_tilt_time_default,        PARAM_UNSIGNED, 0, 255, 1, 203, 200) \
+  X(PARAM_MIN_ACCEL_SPEED,        "min_accel_speed",        min_accel_speed_default,        PARAM_UNSIGNED, 0, 255, 1, 112, 120) \
+  X(PARAM_MIN_DECEL_SPEED,        "min_decel_speed",        min_decel_speed_default,        PARAM_UNSIGNED, 0, 255, 1, 113, 60) \
+  X(PARAM_DELTA_SPEED,            "delta_speed",            delta_speed_default,            PARAM_UNSIGNED, 0, 255, 1, 114, 60) \
+  X(PARAM_ACCEL_DELAY,            "accel_delay",            accel_delay_default,            PARAM_UNSIGNED, 0, 2550, 10, 115, 200) \
+  X(PARAM_LEFT_MOTOR_BIAS,        "left_motor_bias",        left_motor_bias_default,        PARAM_SIGNED, -127, 128, 1, 116, 0) \
+  X(PARAM_LEFT_MOTOR_BW_BIAS,     "left_motor_bw_bias",     left_motor_bw_bias_default,     PARAM_UNSIGNED, 0, 255, 1, 117, 23) \
+  X(PARAM_LEFT_MOTOR_STOP_DELAY,  "left_motor_stop_delay",  left_motor_stop_delay_default,  PARAM_UNSIGNED, 0, 2550, 10, 118, 0) \
+  X(PARAM_RIGHT_MOTOR_BIAS,       "right_motor_bias",       right_motor_bias_default,       PARAM_SIGNED, -127, 128, 1, 210, 0) \
+  X(PARAM_RIGHT_MOTOR_BW_BIAS,    "right_motor_bw_bias",    right_motor_bw_bias_default,    PARAM_UNSIGNED, 0, 255, 1, 211, 0) \
+  X(PARAM_RIGHT_MOTOR_STOP_DELAY, "right_motor_stop_delay", right_motor_stop_delay_default, PARAM_UNSIGNED, 0, 2550, 10, 212, 0) \
+  X(PARAM_CURRENT_LIMIT_TOP_MOTOR, "current_limit_top_motor", current_limit_top_motor_default, PARAM_UNSIGNED, 0, 25500, 100, 119, 2000) \
+  X(PARAM_CURRENT_LIMIT_DRIVE_MOTORS, "current_limit_drive_motors", current_limit_drive_motors_default, PARAM_UNSIGNED, 0, 25500, 100, 120, 4000) \
+  X(PARAM_CURRENT_LIMIT_ENABLED,  "current_limit_enabled",  current_limit_enabled_default,  PARAM_UNSIGNED, 0, 1, 1, 204, 1) \
+  X(PARAM_ENCODER_TICKS_PER_CM,   "encoder_ticks_per_cm",   encoder_ticks_per_cm_default,   PARAM_UNSIGNED, 0, 255, 1, 121, 0) \
+  X(PARAM_ZERO_PERCENT_BATTERY_VOLTAGE, "zero_percent_battery_voltage", zero_percent_battery_voltage_default, PARAM_TENTHS, 0, 2559, 1, 122, 105) \
+  X(PARAM_FULL_BATTERY_VOLTAGE,   "full_battery_voltage",   full_battery_voltage_default,   PARAM_TENTHS, 0, 2559, 1, 124, 130) \
+  X(PARAM_VOLTAGE_DIVIDER_RATIO,  "voltage_divider_ratio",  voltage_divider_ratio_default,  PARAM_TENTHS, 0, 2559, 1, 126, 32) \
+  X(PARAM_BATTERY_MONITOR_PIN,    "battery_monitor_pin",    battery_monitor_pin_default,    PARAM_UNSIGNED, 0, 15, 1, 128, 4) \
+  X(PARAM_MODIFY_MOTOR_BIASES,    "modify_motor_biases",    modify_motor_biases_default,    PARAM_UNSIGNED, 0, 1, 1, 129, 1) \
+  X(PARAM_STALL_CURRENT,          "stall_current",          stall_current_default,          PARAM_OPTIONAL, 0, 25400, 100, 130, 2500) \
+  X(PARAM_STALL_FREE_CURRENT,     "stall_free_current",     stall_free_current_default,     PARAM_OPTIONAL, 0, 2540, 10, 131, 100) \
+  X(PARAM_STALL_MIN_PWM,          "stall_min_pwm",          stall_min_pwm_default,          PARAM_OPTIONAL, 0, 254, 1, 132, 100) \
+  X(PARAM_STALL_MIN_TURN_RATE,    "stall_min_turn_rate",    stall_min_turn_rate_default,    PARAM_OPTIONAL, 0, 254, 1, 133, 10) \
+  X(PARAM_STALL_DETECT_ENABLED,   "stall_detect_enabled",   stall_detect_enabled_default,   PARAM_OPTIONAL, 0, 1, 1, 134, 1) \
+  X(PARAM_LEARN_TURN_OVERSHOOT,   "learn_turn_overshoot",   learn_turn_overshoot_default,   PARAM_OPTIONAL, 0, 1, 1, 135, 1) \
+  X(PARAM_TURN_OVERSHOOT_0,       "turn_overshoot_0",       turnOvershootTenths[0],         PARAM_OPTIONAL, 0, 254, 1, 136, 0) \
+  X(PARAM_TURN_OVERSHOOT_1,       "turn_overshoot_1",       turnOvershootTenths[1],         PARAM_OPTIONAL, 0, 254, 1, 137, 12) \
+  X(PARAM_TURN_OVERSHOOT_2,       "turn_overshoot_2",       turnOvershootTenths[2],         PARAM_OPTIONAL, 0, 254, 1, 138, 30) \
+  X(PARAM_TURN_OVERSHOOT_3,       "turn_overshoot_3",       turnOvershootTenths[3],         PARAM_OPTIONAL, 0, 254, 1, 139, 55) \
+  X(PARAM_TURN_OVERSHOOT_4,       "turn_overshoot_4",       turnOvershootTenths[4],         PARAM_OPTIONAL, 0, 254, 1, 140, 85) \
+  X(PARAM_TURN_OVERSHOOT_5,       "turn_overshoot_5",       turnOvershootTenths[5],         PARAM_OPTIONAL, 0, 254, 1, 141, 120) \
+  X(PARAM_TURN_OVERSHOOT_6,       "turn_overshoot_6",       turnOvershootTenths[6],         PARAM_OPTIONAL, 0, 254, 1, 142, 160) \
+  X(PARAM_TURN_OVERSHOOT_7,       "turn_overshoot_7",       turnOvershootTenths[7],         PARAM_OPTIONAL, 0, 254, 1, 143, 200)
+
+#define ROBOT_PARAMETER_ENUM(id, name, variable, kind, minimum, maximum, scale, address, fallback) id,
+enum { ROBOT_PARAMETERS(ROBOT_PARAMETER_ENUM) ROBOT_PARAMETER_COUNT };
+#undef ROBOT_PARAMETER_ENUM
+
+// the bytes at 10 - 12 hold these once the parameters have been written
+#define PARAM_EEPROM_MARK_ADDRESS 10
+#define PARAM_EEPROM_MARK_0 2
+#define PARAM_EEPROM_MARK_1 4
+#define PARAM_EEPROM_MARK_2 8
+
+#endif
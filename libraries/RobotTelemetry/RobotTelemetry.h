@@ -0,0 +1,92 @@
+#ifndef RobotTelemetry_h
+#define RobotTelemetry_h
+
+// Binary telemetry frame layout shared by the RobotComm firmware (encoder side)
+// and the host tools in hostTools/ (decoder side), so the two can never drift apart.
+//
+// A frame is:
+//   sync0, sync1, channel mask, sequence number, <channel fields>, checksum A, checksum B
+// Channel fields appear in bit order of the mask, all multi-byte values little endian
+// (which is the native byte order of the AVR, so the firmware can copy them straight in).
+// The checksum is an 8 bit Fletcher sum over mask, sequence and fields; it costs a couple of
+// adds per byte, so a full frame encodes in a few hundred cycles with no buffers beyond the frame itself.
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <stdint.h>
+#endif
+
+#define TELEMETRY_SYNC_0 0xA5  // neither sync byte is printable ASCII, so frames can share
+#define TELEMETRY_SYNC_1 0x5A  // the link with the normal text replies
+
+// channel mask bits
+#define TELEMETRY_TIMESTAMP  0x01  // uint32 millis()
+#define TELEMETRY_WHEEL_PWM  0x02  // int16 left, right, top commanded PWM (-255 to 255)
+#define TELEMETRY_CURRENTS   0x04  // uint16 left, right, top motor current in mA
+#define TELEMETRY_YAW        0x08  // int16 total yaw in 0.1 degrees, int16 yaw rate in 0.1 degrees/sec
+#define TELEMETRY_BATTERY    0x10  // uint16 raw battery monitor ADC reading (0 - 1023)
+#define TELEMETRY_STATE      0x20  // uint8 controller state flags, see below
+#define TELEMETRY_POWER      0x40  // uint16 bus voltage in mV, uint8 drive PWM cap, uint8 power limit flags, see below
+#define TELEMETRY_ALL_CHANNELS 0x7F
+
+// controller state flags sent in the TELEMETRY_STATE channel
+#define TELEMETRY_STATE_MOVING  0x01
+#define TELEMETRY_STATE_TURNING 0x02
+#define TELEMETRY_STATE_TILTING 0x04
+#define TELEMETRY_STATE_BRAKES  0x08
+#define TELEMETRY_STATE_GYRO    0x10
+#define TELEMETRY_STATE_FOREVER 0x20  // moving until told to stop
+#define TELEMETRY_STATE_SAFETY  0x40  // a cliff or obstacle sensor is tripped
+#define TELEMETRY_STATE_STALL   0x80  // a drive wheel looks stalled, free spinning or slipping
+
+// power governor flags sent in the TELEMETRY_POWER channel, why the drive wheels are being held back
+#define TELEMETRY_POWER_SAG         0x01  // bus voltage under the threshold, the cap is coming down
+#define TELEMETRY_POWER_LOW_BATTERY 0x02  // battery close to empty, the cap is held lower
+#define TELEMETRY_POWER_CURRENT     0x04  // drive current over the limit, speeds may not rise
+#define TELEMETRY_POWER_CAPPED      0x08  // a wheel is asking for more than the cap
+
+#define TELEMETRY_HEADER_LENGTH 4  // sync0, sync1, mask, sequence
+#define TELEMETRY_CHECKSUM_LENGTH 2
+#define TELEMETRY_MAX_FRAME_LENGTH (TELEMETRY_HEADER_LENGTH + 4 + 6 + 6 + 4 + 2 + 1 + 4 + TELEMETRY_CHECKSUM_LENGTH)
+
+// number of field bytes for each channel bit, in mask bit order
+static inline uint8_t telemetryChannelLength(uint8_t channelBit)
+{
+  switch (channelBit)
+  {
+    case TELEMETRY_TIMESTAMP: return 4;
+    case TELEMETRY_WHEEL_PWM: return 6;
+    case TELEMETRY_CURRENTS:  return 6;
+    case TELEMETRY_YAW:       return 4;
+    case TELEMETRY_BATTERY:   return 2;
+    case TELEMETRY_STATE:     return 1;
+    case TELEMETRY_POWER:     return 4;
+  }
+  return 0;
+}
+
+// total frame length, including sync and checksum, for a given channel mask
+static inline uint8_t telemetryFrameLength(uint8_t mask)
+{
+  uint8_t length = TELEMETRY_HEADER_LENGTH + TELEMETRY_CHECKSUM_LENGTH;
+  for (uint8_t channelBit = 1; channelBit != 0 && channelBit <= TELEMETRY_ALL_CHANNELS; channelBit <<= 1)
+  {
+    if (mask & channelBit) length += telemetryChannelLength(channelBit);
+  }
+  return length;
+}
+
+// 8 bit Fletcher checksum; covers everything after the two sync bytes
+static inline uint16_t telemetryChecksum(const uint8_t* data, uint8_t length)
+{
+  uint8_t sumA = 0, sumB = 0;
+  for (uint8_t i = 0; i < length; i++)
+  {
+    sumA += data[i];
+    sumB += sumA;
+  }
+  return ((uint16_t) sumB << 8) | sumA;
+}
+
+#endif
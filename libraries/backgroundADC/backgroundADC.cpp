@@ -0,0 +1,136 @@
+#include "backgroundADC.h"
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+#define REFERENCE_AVCC (1 << REFS0)  // same reference analogRead() uses by default
+
+backgroundADC::backgroundADC()
+{
+  _count = 0;
+  _current = 0;
+  _running = false;
+}
+
+int8_t backgroundADC::slotForPin(uint8_t pin)
+{
+  if (pin >= A0) pin -= A0;
+  for (uint8_t i = 0; i < _count; i++)
+  {
+    if (_channel[i] == pin) return i;
+  }
+  return BACKGROUND_ADC_NO_SLOT;
+}
+
+int8_t backgroundADC::addChannel(uint8_t pin)
+{
+  int8_t slot = slotForPin(pin);
+  if (slot != BACKGROUND_ADC_NO_SLOT) return slot;
+  if (pin >= A0) pin -= A0;
+  if (pin > 15 || _count >= BACKGROUND_ADC_CHANNELS) return BACKGROUND_ADC_NO_SLOT;
+  bool wasRunning = _running;
+  stop();
+  slot = _count;
+  _channel[slot] = pin;
+  _raw[slot] = 0;
+  _filtered[slot] = 0;
+  _samples[slot] = 0;
+  _count++;
+  if (wasRunning) start();
+  return slot;
+}
+
+void backgroundADC::selectChannel(uint8_t channel)
+{
+#if defined(MUX5)
+  ADCSRB = (ADCSRB & ~(1 << MUX5)) | (((channel >> 3) & 0x01) << MUX5);
+#endif
+  ADMUX = REFERENCE_AVCC | (channel & 0x07);
+}
+
+void backgroundADC::start()
+{
+  if (_count == 0 || _running) return;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    _current = 0;
+    _running = true;
+    selectChannel(_channel[0]);
+    // prescaler stays at 128 as set up by the core, interrupt on every conversion
+    ADCSRA |= (1 << ADEN) | (1 << ADIE) | (1 << ADSC);
+  }
+}
+
+void backgroundADC::stop()
+{
+  if (!_running) return;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    ADCSRA &= ~(1 << ADIE);
+    _running = false;
+  }
+  while (ADCSRA & (1 << ADSC));  // let a conversion in progress finish
+  ADCSRA |= 1 << ADIF;           // and throw its result away
+}
+
+uint16_t backgroundADC::read(int8_t slot)
+{
+  if (slot < 0 || slot >= _count) return 0;
+  uint16_t value;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    value = _raw[slot];
+  }
+  return value;
+}
+
+uint16_t backgroundADC::readFiltered(int8_t slot)
+{
+  if (slot < 0 || slot >= _count) return 0;
+  uint16_t value;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    value = _filtered[slot];
+  }
+  return (value + 8) >> 4;
+}
+
+uint8_t backgroundADC::sampleCount(int8_t slot)
+{
+  if (slot < 0 || slot >= _count) return 0;
+  return _samples[slot];
+}
+
+int backgroundADC::analogRead(uint8_t pin)
+{
+  int8_t slot = slotForPin(pin);
+  if (slot != BACKGROUND_ADC_NO_SLOT && _running) return read(slot);
+  bool wasRunning = _running;
+  stop();
+  int value = ::analogRead(pin);
+  if (wasRunning) start();
+  return value;
+}
+
+inline void backgroundADC::conversionComplete(uint16_t value)
+{
+  uint8_t slot = _current;
+  _raw[slot] = value;
+  if (_samples[slot] == 0 && _filtered[slot] == 0) _filtered[slot] = value << 4;  // first sample, no history
+  else _filtered[slot] += ((int16_t) (value << 4) - (int16_t) _filtered[slot]) >> 2;
+  _samples[slot]++;
+  if (++slot >= _count) slot = 0;
+  _current = slot;
+  // the next conversion samples on its second ADC clock, well after the multiplexer has settled
+  selectChannel(_channel[slot]);
+  ADCSRA |= 1 << ADSC;
+}
+
+backgroundADC backgroundAnalog;
+
+ISR(ADC_vect)
+{
+  uint16_t value = ADCL;
+  value |= ADCH << 8;
+  if (!backgroundAnalog.running()) return;
+  backgroundAnalog.conversionComplete(value);
+}
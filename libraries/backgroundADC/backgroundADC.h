@@ -0,0 +1,56 @@
+#ifndef backgroundADC_h
+#define backgroundADC_h
+
+#include <Arduino.h>
+
+// Interrupt driven analog scanner.  The ADC conversion complete interrupt stores each result,
+// switches to the next registered channel and starts the next conversion, so the sketch just
+// reads the latest value instead of waiting ~110 usec in analogRead() for every sample.
+// With the default ADC clock (16 MHz / 128) a full conversion takes 104 usec, so each of
+// n registered channels is sampled about 9600/n times a second.
+//
+// Every channel also keeps a smoothed value (exponential average, 1/4 weight on the new sample)
+// and a sample counter, so a reader can tell whether anything new came in since it last looked.
+//
+// Code that still needs a one-off analogRead() on an unregistered pin should call
+// backgroundAnalog.analogRead() instead, which pauses the scan around the conversion.
+
+#define BACKGROUND_ADC_CHANNELS 8
+#define BACKGROUND_ADC_NO_SLOT -1
+
+class backgroundADC
+{
+  public:
+    // CONSTRUCTOR
+    backgroundADC();
+
+    // PUBLIC METHODS
+    int8_t addChannel(uint8_t pin);       // A0..A15 or 0..15, returns the slot or BACKGROUND_ADC_NO_SLOT
+    int8_t slotForPin(uint8_t pin);       // slot already scanning this pin, or BACKGROUND_ADC_NO_SLOT
+    void start();
+    void stop();
+    bool running() { return _running; }
+
+    uint16_t read(int8_t slot);           // latest raw conversion, 0..1023
+    uint16_t readFiltered(int8_t slot);   // smoothed, same scale as read()
+    uint8_t sampleCount(int8_t slot);     // bumped on every conversion, wraps around
+    int analogRead(uint8_t pin);          // blocking single conversion that does not upset the scan
+
+    // called from the interrupt service routine
+    void conversionComplete(uint16_t value);
+
+  private:
+    void selectChannel(uint8_t channel);
+
+    uint8_t _channel[BACKGROUND_ADC_CHANNELS];
+    volatile uint16_t _raw[BACKGROUND_ADC_CHANNELS];
+    volatile uint16_t _filtered[BACKGROUND_ADC_CHANNELS];  // 4 fraction bits
+    volatile uint8_t _samples[BACKGROUND_ADC_CHANNELS];
+    uint8_t _count;
+    volatile uint8_t _current;
+    volatile bool _running;
+};
+
+extern backgroundADC backgroundAnalog;
+
+#endif
@@ -1,67 +1,126 @@
 #include "Arduino.h"
 #include "irSensor.h"
 #include "math.h"
+#include <avr/pgmspace.h>
+
+// distance in mm for ADC readings 0, 16, 32 ... 1024, from the calibration curve
+// d(cm) = V^-2.0202 / 0.0079566725761, V = raw * 5 / 1024, clipped at IR_MAX_MM
+#define IR_TABLE_SHIFT 4
+const uint16_t irDistanceTable[65] PROGMEM =
+{
+  2000, 2000, 2000, 2000, 2000, 2000, 2000, 2000,
+  2000, 2000, 2000, 1707, 1432, 1218, 1049,  912,
+   801,  708,  631,  566,  510,  462,  421,  385,
+   353,  325,  300,  278,  259,  241,  225,  210,
+   197,  186,  175,  165,  156,  147,  140,  132,
+   126,  120,  114,  109,  104,   99,   95,   91,
+    87,   83,   80,   77,   74,   71,   69,   66,
+    64,   61,   59,   57,   55,   54,   52,   50,
+    49
+};
+
+// sin(IR_MIN_GROUND_ANGLE) * 10000
+#define IR_MIN_GROUND_SIN 1564
+
+uint16_t irRawToMM(uint16_t raw)
+{
+  if (raw > 1023) raw = 1023;
+  uint8_t index = raw >> IR_TABLE_SHIFT;
+  uint8_t fraction = raw & ((1 << IR_TABLE_SHIFT) - 1);
+  int16_t low = pgm_read_word(&irDistanceTable[index]);
+  int16_t high = pgm_read_word(&irDistanceTable[index + 1]);
+  return low + (((high - low) * fraction) >> IR_TABLE_SHIFT);
+}
 
 irSensor::irSensor(int sensorPin, float sensorHeight, float sensorAngle)
+{
+  init(sensorPin, (int32_t) (sensorHeight * 10 * sin(sensorAngle) * 10000));
+}
+
+irSensor::irSensor(int sensorPin, irMounting mounting)
+{
+  init(sensorPin, (int32_t) mounting.heightMM * mounting.sinAngle);
+}
+
+void irSensor::init(int sensorPin, int32_t groundLimit)
 {
   _sensorPin = sensorPin;
-  _height    = sensorHeight;
-  _theta     = sensorAngle;
+  _slot      = BACKGROUND_ADC_NO_SLOT;
+  _lastSample = 0;
+  _sensorRawData = 0;
+  _distance = IR_MAX_MM;
+  _oldDistance = IR_MAX_MM;
+  _sampled = false;
+  _danger = false;
+  // the ground angle thetaPrime satisfies sin(thetaPrime) = h sin(theta) / d, so it is too shallow
+  // when h sin(theta) < sin(IR_MIN_GROUND_ANGLE) d; keep the left side scaled to compare in integers
+  _groundLimit = groundLimit;
+}
+
+bool irSensor::begin()
+{
+  _slot = backgroundAnalog.addChannel(_sensorPin);
+  if (_slot == BACKGROUND_ADC_NO_SLOT) return false;
+  backgroundAnalog.start();
+  return true;
+}
+
+bool irSensor::update()
+{
+  if (_slot == BACKGROUND_ADC_NO_SLOT) return false;
+  uint8_t sample = backgroundAnalog.sampleCount(_slot);
+  if (sample == _lastSample) return false;
+  _lastSample = sample;
+  _sensorRawData = backgroundAnalog.readFiltered(_slot);
+  _oldDistance = _distance;
+  _distance = irRawToMM(_sensorRawData);
+  if (!_sampled) _oldDistance = _distance;  // nothing to have dropped from on the first sample
+  _sampled = true;
+  _danger = (int16_t) (_oldDistance - _distance) > IR_DROP_MM
+         || _distance < IR_NEAR_MM
+         || _groundLimit < (int32_t) IR_MIN_GROUND_SIN * _distance;
+  return true;
+}
+
+uint16_t irSensor::rawData()
+{
+  return _sensorRawData;
+}
+
+uint16_t irSensor::distanceMM()
+{
+  return _distance;
 }
 
 float irSensor::senseRawData()
 {
-  for (int i = 0; i<100; i++)
-    {
-      _sensorPing    = analogRead(_sensorPin);
-      _sensorRawData = (_sensorPing + _sensorRawData)/2;                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                                  
-    }
-  
-  return _sensorRawData; 
+  if (_slot == BACKGROUND_ADC_NO_SLOT) begin();
+  update();
+  return _sensorRawData;
 }
 
 float irSensor::senseVoltage()
 {
-    _voltage = senseRawData()*5/1024;
-  
-    return _voltage;
+  return senseRawData() * 5 / 1024;
 }
 
 float irSensor::senseDistance()
 {
-	_oldDistance=_distance;
-  _distance = pow(senseVoltage(), -2.0202)/.0079566725761;
-  
-  return _distance;
+  senseRawData();
+  return _distance / 10.0;
 }
 
 float irSensor::senseSlope()
 {
-  _thetaPrime=asin((_height*sin(_theta)/senseDistance()));
-  
-  return _thetaPrime;
+  float ratio = _groundLimit / (10000.0 * senseDistance() * 10);
+  if (ratio > 1) ratio = 1;
+  return asin(ratio);
 }
 
-
 boolean irSensor:: senseDanger()
 {
-	_danger        = false;
-	senseSlope();
-	senseDistance();
-   if((_oldDistance - _distance)> 5)
-   {
-     _danger = true;
-   }
-   else if (_distance < 15)
-   {
-     _danger = true;
-   }
-   else if (_thetaPrime>(3.14/2)||_thetaPrime<(3.14/20))
-   {
-	 _danger = true;
-   }
-
-    return _danger;
+  senseRawData();
+  return _danger;
 }
 
 void irSensor:: printData()
@@ -70,12 +129,12 @@ void irSensor:: printData()
 	Serial.print("Raw data: ");
 	Serial.println(_sensorRawData);
 	Serial.print("Voltage: ");
-	Serial.println(_voltage);
+	Serial.println(_sensorRawData * 5.0 / 1024);
 	Serial.print("Distance: ");
-	Serial.println(_distance);
+	Serial.println(_distance / 10.0);
 	Serial.print("Ground Angle: ");
-	Serial.println(_thetaPrime);
+	Serial.println(senseSlope());
 	Serial.print("Are we in danger?: ");
 	Serial.println(_danger);
 	Serial.println("----------------------");
-}
\ No newline at end of file
+}
@@ -3,11 +3,46 @@
 
 #include "Arduino.h"
 #include "math.h"
+#include <backgroundADC.h>
+
+// Sharp IR distance sensor looking down and ahead at the ground.
+// Samples come from the background ADC scanner, so nothing here waits for a conversion:
+// update() converts the latest smoothed reading to mm through a calibration table in flash
+// and runs the danger checks in integer math, which takes a few usec per sensor.
+// Call begin() from setup(), then update() at whatever rate the sketch polls the sensors.
+// hostTools/irSensorCheck checks the table against the curve and runs the danger checks on the host.
+//
+// danger means any of
+//   the distance dropped by more than IR_DROP_MM since the previous update (something in the way); the
+//   first update has no previous one, so it only runs the other two checks
+//   the distance is under IR_NEAR_MM
+//   the ground angle seen by the sensor is under IR_MIN_GROUND_ANGLE (edge, step down or hole)
+// the old float methods are kept for printing and for older sketches.
+// The float free build of RobotComm (ROBOT_FIXED_POINT) gives the mounting as an irMounting, in mm and
+// the sine of the beam angle times 10000, so no sin() is linked in just to work out _groundLimit.
+
+#define IR_DROP_MM 50
+#define IR_NEAR_MM 150
+#define IR_MAX_MM 2000
+#define IR_MIN_GROUND_ANGLE (3.14 / 20)
+
+struct irMounting
+{
+  uint16_t heightMM;             // height of the sensor above the ground
+  uint16_t sinAngle;             // sin(angle between the beam and the vertical) * 10000
+};
 
 class irSensor
 {
 public:
-  irSensor(int sensorPin, float sensorHeight, float sensorAngle);
+  irSensor(int sensorPin, float sensorHeight, float sensorAngle);  // height in cm, angle in radians
+  irSensor(int sensorPin, irMounting mounting);
+  bool begin();                  // registers the pin with the ADC scanner and starts it
+  bool update();                 // returns true if a new sample came in since the last call
+  uint16_t rawData();            // smoothed ADC reading, 0..1023
+  uint16_t distanceMM();
+  bool danger() { return _danger; }
+
   float senseRawData();
   float senseVoltage();
   float senseDistance();
@@ -16,17 +51,19 @@ public:
   void printData();
  
 private:
-  int   _sensorPin;
-  float _theta;
-  float _thetaPrime;
-  float _distance;
-  float _sensorPing;
-  float _sensorRawData;
-  float _voltage;
-  float _oldDistance;
-  float _height;
-  bool  _danger;
+  int     _sensorPin;
+  int8_t  _slot;
+  uint8_t _lastSample;
+  int32_t _groundLimit;          // h sin(theta) in mm, scaled by 10000 for the angle test
+
+  void init(int sensorPin, int32_t groundLimit);
+  uint16_t _sensorRawData;
+  uint16_t _distance;            // mm
+  uint16_t _oldDistance;
+  bool    _sampled;              // update() has had a sample, so _oldDistance is a real reading
+  bool    _danger;
 };
 
-#endif
+uint16_t irRawToMM(uint16_t raw);
 
+#endif
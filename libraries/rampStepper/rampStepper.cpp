@@ -0,0 +1,272 @@
+#include "rampStepper.h"
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+#define MIN_STEP_DELAY 100  // timer counts, 50 usec, leaves the interrupt time to finish
+
+static rampStepper *activeStepper = 0;
+
+rampStepper::rampStepper(uint8_t stepPin, uint8_t dirPin, uint8_t disablePin)
+{
+  _stepPin = stepPin;
+  _dirPin = dirPin;
+  _disablePin = disablePin;
+  _stepPort = 0;
+  _stepBit = 0;
+  _maxSpeed = 500;
+  _acceleration = 2000;
+  _firstDelay = 0xFFFF;
+  _minDelay = 0xFFFF;
+  _holdTorque = false;
+  _state = STATE_STOP;
+  _restart = false;
+  _position = 0;
+  _target = 0;
+  _direction = 1;
+  _stepDelay = 0;
+  _stepCount = _decelStart = _decelSteps = _accelCount = _rest = 0;
+}
+
+void rampStepper::begin()
+{
+  pinMode(_stepPin, OUTPUT);
+  pinMode(_dirPin, OUTPUT);
+  pinMode(_disablePin, OUTPUT);
+  digitalWrite(_disablePin, HIGH);  // start with the driver off
+  digitalWrite(_dirPin, LOW);
+  digitalWrite(_stepPin, LOW);
+  // the step pulse is written straight to the port from the interrupt
+  _stepBit = digitalPinToBitMask(_stepPin);
+  _stepPort = portOutputRegister(digitalPinToPort(_stepPin));
+
+  stopTimer();
+  TCCR1A = 0;
+  activeStepper = this;
+  setMaxSpeed(_maxSpeed);
+  setAcceleration(_acceleration);
+}
+
+// takes effect from the next move
+void rampStepper::setMaxSpeed(unsigned int stepsPerSecond)
+{
+  if (stepsPerSecond < RAMP_STEPPER_TIMER_FREQUENCY / 0xFFFF + 1) stepsPerSecond = RAMP_STEPPER_TIMER_FREQUENCY / 0xFFFF + 1;
+  if (stepsPerSecond > RAMP_STEPPER_TIMER_FREQUENCY / MIN_STEP_DELAY) stepsPerSecond = RAMP_STEPPER_TIMER_FREQUENCY / MIN_STEP_DELAY;
+  _maxSpeed = stepsPerSecond;
+  _minDelay = RAMP_STEPPER_TIMER_FREQUENCY / stepsPerSecond;
+}
+
+// takes effect from the next move
+void rampStepper::setAcceleration(unsigned int stepsPerSecondSquared)
+{
+  if (stepsPerSecondSquared < 1) stepsPerSecondSquared = 1;
+  _acceleration = stepsPerSecondSquared;
+  // first step interval, with the 0.676 correction from AVR446 for the error of the incremental formula there
+  float firstDelay = 0.676 * RAMP_STEPPER_TIMER_FREQUENCY * sqrt(2.0 / stepsPerSecondSquared);
+  _firstDelay = firstDelay > 0xFFFF ? 0xFFFF : (uint16_t) firstDelay;
+}
+
+void rampStepper::setHoldTorque(bool hold)
+{
+  _holdTorque = hold;
+  if (!running()) setEnabled(hold);
+}
+
+void rampStepper::setEnabled(bool enabled)
+{
+  digitalWrite(_disablePin, enabled ? LOW : HIGH);
+}
+
+void rampStepper::moveTo(long target)
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    if (target != _target || _state == STATE_STOP)
+    {
+      _target = target;
+      if (_state == STATE_STOP) startMove();
+      else
+      {
+        // slow down and stop first, the interrupt starts the new move from standstill
+        _restart = true;
+        if (_state == STATE_ACCEL) _decelSteps = -_accelCount;
+        if (_state != STATE_DECEL) _decelStart = _stepCount;
+      }
+    }
+  }
+}
+
+void rampStepper::move(long steps)
+{
+  moveTo(_target + steps);
+}
+
+void rampStepper::stop()
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    _restart = false;
+    if (_state == STATE_ACCEL) _decelSteps = -_accelCount;
+    if (_state == STATE_ACCEL || _state == STATE_RUN) _decelStart = _stepCount;
+  }
+}
+
+void rampStepper::hardStop()
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    stopTimer();
+    _state = STATE_STOP;
+    _restart = false;
+    _target = _position;
+  }
+  setEnabled(_holdTorque);
+}
+
+void rampStepper::setPosition(long position)
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    if (running()) return;
+    _position = position;
+    _target = position;
+  }
+}
+
+long rampStepper::position()
+{
+  long position;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    position = _position;
+  }
+  return position;
+}
+
+// called with interrupts off
+void rampStepper::startMove()
+{
+  long steps = _target - _position;
+  if (steps == 0)
+  {
+    setEnabled(_holdTorque);
+    return;
+  }
+  _direction = steps > 0 ? 1 : -1;
+  if (steps < 0) steps = -steps;
+  digitalWrite(_dirPin, _direction < 0 ? HIGH : LOW);  // HIGH is reverse
+  setEnabled(true);
+
+  _stepCount = 0;
+  _rest = 0;
+  _accelCount = 0;
+  _stepDelay = _firstDelay;
+  if (steps == 1)
+  {
+    _decelSteps = -1;
+    _decelStart = 0;
+    _accelCount = -1;
+    _state = STATE_DECEL;
+  }
+  else
+  {
+    // steps to reach top speed, and to get halfway; whichever comes first is where we start slowing down
+    long maxSpeedSteps = (long) ((unsigned long) _maxSpeed * _maxSpeed / (2UL * _acceleration));
+    if (maxSpeedSteps == 0) maxSpeedSteps = 1;
+    long accelLimit = steps / 2;
+    if (accelLimit == 0) accelLimit = 1;
+    if (accelLimit <= maxSpeedSteps) _decelSteps = accelLimit - steps;
+    else _decelSteps = -maxSpeedSteps;
+    if (_decelSteps == 0) _decelSteps = -1;
+    _decelStart = steps + _decelSteps;
+    if (_stepDelay <= _minDelay)  // slow enough to start at top speed
+    {
+      _stepDelay = _minDelay;
+      _state = STATE_RUN;
+    }
+    else _state = STATE_ACCEL;
+  }
+  startTimer(_stepDelay);
+}
+
+void rampStepper::startTimer(uint16_t delay)
+{
+  TCCR1B = 0;
+  TCNT1 = 0;
+  OCR1A = delay;
+  TIFR1 = 1 << OCF1A;
+  TIMSK1 |= 1 << OCIE1A;
+  TCCR1B = (1 << WGM12) | (1 << CS11);  // CTC, prescaler 8
+}
+
+void rampStepper::stopTimer()
+{
+  TIMSK1 &= ~(1 << OCIE1A);
+  TCCR1B = 0;
+}
+
+inline void rampStepper::timerInterrupt()
+{
+  if (_state == STATE_STOP)  // the last step's interval is over
+  {
+    stopTimer();
+    if (_restart)
+    {
+      _restart = false;
+      startMove();
+    }
+    else
+    {
+      _target = _position;
+      setEnabled(_holdTorque);
+    }
+    return;
+  }
+
+  *_stepPort |= _stepBit;  // the driver wants at least 1 usec high, the arithmetic below takes longer
+  _position += _direction;
+  _stepCount++;
+  long newDelay = _stepDelay;
+  if (_state == STATE_RUN)
+  {
+    if (_stepCount >= _decelStart)
+    {
+      // AVR446 goes back to the last interval of the speed up here, but that one is a little shorter
+      // than the top speed's and would put one step over it; the slow down starts from the cruise
+      _accelCount = _decelSteps;
+      _state = STATE_DECEL;
+    }
+  }
+  else  // accelerating or decelerating, _accelCount is negative while slowing down
+  {
+    _accelCount++;
+    long denominator = 4 * _accelCount + 1;
+    long numerator = 2 * (long) _stepDelay + _rest;
+    newDelay = _stepDelay - numerator / denominator;
+    _rest = numerator % denominator;
+    if (_state == STATE_ACCEL)
+    {
+      if (_stepCount >= _decelStart)
+      {
+        _accelCount = _decelSteps;
+        _state = STATE_DECEL;
+      }
+      else if (newDelay <= _minDelay)
+      {
+        newDelay = _minDelay;
+        _rest = 0;
+        _state = STATE_RUN;
+      }
+    }
+    else if (_accelCount >= 0) _state = STATE_STOP;
+  }
+  if (newDelay < MIN_STEP_DELAY) newDelay = MIN_STEP_DELAY;
+  if (newDelay > 0xFFFF) newDelay = 0xFFFF;
+  _stepDelay = newDelay;
+  OCR1A = newDelay;  // the timer restarted from 0 at the match, so this sets the next interval
+  *_stepPort &= ~_stepBit;
+}
+
+ISR(TIMER1_COMPA_vect)
+{
+  if (activeStepper) activeStepper->timerInterrupt();
+}
@@ -0,0 +1,69 @@
+#ifndef rampStepper_h
+#define rampStepper_h
+
+#include <Arduino.h>
+
+// Interrupt driven step/direction stepper driver (Pololu A4988 and friends) with acceleration ramps.
+// Timer1 fires once per step; each step interval is worked out from the previous one with the
+// incremental formula from Atmel's AVR446 application note,
+//   c(n) = c(n-1) - 2 c(n-1) / (4n + 1)
+// which gives a constant acceleration up to the top speed and the same deceleration down to the
+// target, with one integer division per step and no square roots inside the interrupt.
+// Moves run in the background, so the sketch keeps driving and answering commands meanwhile.
+// moveTo() during a move decelerates to a stop and then heads for the new target; stop() just
+// decelerates.  The position is counted in steps from wherever the motor was at begin(), or from
+// the last setPosition().  hostTools/rampStepperSim runs the ramps on the host against the profile.
+//
+// Only one rampStepper can run at a time, since there is one Timer1 (which also drives PWM on
+// pins 11 and 12 of the Mega, 9 and 10 of the Uno, so don't use those with it).
+
+#define RAMP_STEPPER_TIMER_FREQUENCY 2000000UL  // Timer1 with prescaler 8, 0.5 usec per count
+
+class rampStepper
+{
+  public:
+    // CONSTRUCTOR
+    rampStepper(uint8_t stepPin, uint8_t dirPin, uint8_t disablePin);
+
+    // PUBLIC METHODS
+    void begin();
+    void setMaxSpeed(unsigned int stepsPerSecond);
+    void setAcceleration(unsigned int stepsPerSecondSquared);
+    void setHoldTorque(bool hold);    // keep the driver enabled when stopped, default off
+    void moveTo(long target);
+    void move(long steps);            // relative to the current target
+    void stop();                      // decelerate to a stop
+    void hardStop();                  // stop on this step, may lose steps at speed
+    void setPosition(long position);  // only while stopped
+    long position();
+    long target() { return _target; }
+    bool running() { return _state != STATE_STOP || _restart; }  // a moveTo() may be waiting for the stop
+
+    // called from the interrupt service routine
+    void timerInterrupt();
+
+  private:
+    enum { STATE_STOP, STATE_ACCEL, STATE_RUN, STATE_DECEL };
+    void startMove();                 // plan and start a move from standstill toward _target
+    void startTimer(uint16_t delay);
+    void stopTimer();
+    void setEnabled(bool enabled);
+
+    uint8_t _stepPin, _dirPin, _disablePin;
+    volatile uint8_t *_stepPort;
+    uint8_t _stepBit;
+
+    uint16_t _firstDelay;             // c0, timer counts
+    uint16_t _minDelay;               // at top speed
+    unsigned int _maxSpeed, _acceleration;
+    bool _holdTorque;
+
+    volatile uint8_t _state;
+    volatile bool _restart;           // head for _target once stopped
+    volatile long _position, _target;
+    volatile int8_t _direction;
+    volatile uint16_t _stepDelay;
+    volatile long _stepCount, _decelStart, _decelSteps, _accelCount, _rest;
+};
+
+#endif
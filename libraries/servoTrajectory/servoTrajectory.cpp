@@ -0,0 +1,131 @@
+#include "servoTrajectory.h"
+#include <util/atomic.h>
+
+servoTrajectory::servoTrajectory(Servo &servo) : _servo(servo)
+{
+  _minPulse = MIN_PULSE_WIDTH;
+  _maxPulse = MAX_PULSE_WIDTH;
+  _position = _target = (long) DEFAULT_PULSE_WIDTH << 8;
+  _written = DEFAULT_PULSE_WIDTH;
+  setRate(SERVO_TRAJECTORY_DEFAULT_RATE);
+}
+
+unsigned int servoTrajectory::degreesToMicroseconds(int degrees)
+{
+  return map(degrees, 0, 180, MIN_PULSE_WIDTH, MAX_PULSE_WIDTH);
+}
+
+int servoTrajectory::microsecondsToDegrees(unsigned int pulse)
+{
+  // rounded, so that position() reads back what moveTo() was given
+  return ((long) (pulse - MIN_PULSE_WIDTH) * 180 + (MAX_PULSE_WIDTH - MIN_PULSE_WIDTH) / 2) / (MAX_PULSE_WIDTH - MIN_PULSE_WIDTH);
+}
+
+void servoTrajectory::begin(int degrees)
+{
+  unsigned int pulse = degreesToMicroseconds(degrees);
+  if (pulse < _minPulse) pulse = _minPulse;
+  if (pulse > _maxPulse) pulse = _maxPulse;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    _position = _target = (long) pulse << 8;
+  }
+  _written = pulse;
+  _servo.writeMicroseconds(pulse);
+}
+
+void servoTrajectory::setRate(unsigned int degreesPerSecond)
+{
+  unsigned long step = (unsigned long) degreesPerSecond * (MAX_PULSE_WIDTH - MIN_PULSE_WIDTH) * 256 / 180 / 1000;
+  if (step < 1) step = 1;
+  if (step > 0xFFFF) step = 0xFFFF;
+  _stepPerMsec = step;
+}
+
+void servoTrajectory::setLimits(int minDegrees, int maxDegrees)
+{
+  _minPulse = degreesToMicroseconds(minDegrees);
+  _maxPulse = degreesToMicroseconds(maxDegrees);
+}
+
+void servoTrajectory::moveToMicroseconds(unsigned int pulse)
+{
+  if (pulse < _minPulse) pulse = _minPulse;
+  if (pulse > _maxPulse) pulse = _maxPulse;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    _target = (long) pulse << 8;
+  }
+}
+
+void servoTrajectory::moveTo(int degrees)
+{
+  moveToMicroseconds(degreesToMicroseconds(degrees));
+}
+
+void servoTrajectory::stop()
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    _target = _position;
+  }
+}
+
+unsigned int servoTrajectory::positionMicroseconds()
+{
+  long position;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    position = _position;
+  }
+  return (position + 128) >> 8;
+}
+
+int servoTrajectory::position()
+{
+  return microsecondsToDegrees(positionMicroseconds());
+}
+
+int servoTrajectory::target()
+{
+  long target;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    target = _target;
+  }
+  return microsecondsToDegrees((target + 128) >> 8);
+}
+
+bool servoTrajectory::moving()
+{
+  bool result;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    result = _position != _target;
+  }
+  return result;
+}
+
+void servoTrajectory::update(unsigned int elapsed)
+{
+  long position, target;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    position = _position;
+    target = _target;
+  }
+  if (position == target) return;
+  long step = (long) _stepPerMsec * elapsed;
+  if (target > position) position = target - position > step ? position + step : target;
+  else position = position - target > step ? position - step : target;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    _position = position;
+  }
+  unsigned int pulse = (position + 128) >> 8;
+  if (pulse != _written)  // the servo only picks it up every 20 msec anyway, but there is no point writing the same value
+  {
+    _written = pulse;
+    _servo.writeMicroseconds(pulse);
+  }
+}
@@ -0,0 +1,48 @@
+#ifndef servoTrajectory_h
+#define servoTrajectory_h
+
+#include <Arduino.h>
+#include <Servo.h>
+
+// Moves a hobby servo toward its target at a set speed instead of in one jump, so the servo
+// does not pull a burst of current that browns out the rest of the robot.  The position is kept
+// in 1/256 usec and written with writeMicroseconds(), so even slow moves are smooth.
+// update() does the stepping; call it from a timer tick (it is safe inside an interrupt) or
+// from loop() with the msec since the last call.
+// Angles are in degrees, mapped to pulses the same way Servo::write() does.
+
+#define SERVO_TRAJECTORY_DEFAULT_RATE 60  // degrees per second
+
+class servoTrajectory
+{
+  public:
+    // CONSTRUCTOR
+    servoTrajectory(Servo &servo);
+
+    // PUBLIC METHODS
+    void begin(int degrees);                 // jumps straight to this position, call before Servo::attach()
+    void setRate(unsigned int degreesPerSecond);
+    void setLimits(int minDegrees, int maxDegrees);
+    void moveTo(int degrees);                // clipped to the limits, returns at once
+    void moveToMicroseconds(unsigned int pulse);
+    void stop();                             // stay where it is now
+    int position();                          // degrees
+    unsigned int positionMicroseconds();
+    int target();                            // degrees
+    bool moving();
+
+    void update(unsigned int elapsed);       // msec since the last update
+
+  private:
+    unsigned int degreesToMicroseconds(int degrees);
+    int microsecondsToDegrees(unsigned int pulse);
+
+    Servo &_servo;
+    volatile long _position;                 // usec * 256
+    volatile long _target;                   // usec * 256
+    unsigned int _stepPerMsec;               // usec * 256 per msec
+    unsigned int _minPulse, _maxPulse;
+    unsigned int _written;                   // last pulse sent to the servo
+};
+
+#endif
@@ -28,26 +28,16 @@
 #include "HardwareSerial.h"
 #include "MeetAndroid.h"
 
-extern "C" {
-#include <stdlib.h>
-}
-
 
 // Private methods
 void MeetAndroid::processCommand(){
-    // check to see if the first character is valid ASCII (within the values 48 - 122)
-    // same as saying:  if buffer[0] - 48 < 75
-	if(buffer[0]-FunctionBufferOffset < FunctionBufferLenght){
-	    //  H_FuncPtr is a function pointer, in this case to a length 75 integer array
-	    // where the array index corresponds to the value of the ASCII character in buffer[0]
-	    // this sets up the registration, so that we pick which arduino function to call based
-	    // on the first character we are sent.
-		void (*H_FuncPtr)(uint8_t, uint8_t) = intFunc[buffer[0]-FunctionBufferOffset];
-		// if the first ASCII character is not in our registered list, that corresponds to '/0', the null character
-		// so we don't want to work on that
+	if(bufferCount == 0) return; // an ack on its own, there is no flag to go on
+    // the flag is the first character; anything below '0' or above 'z' would index outside intFunc
+	uint8_t index = buffer[0] - FunctionBufferOffset;
+	if(buffer[0] >= FunctionBufferOffset && index < FunctionBufferLenght){
+	    // intFunc is indexed by the flag, so this is a single lookup whatever the flag
+		void (*H_FuncPtr)(uint8_t, uint8_t) = intFunc[index];
 		if (H_FuncPtr != 0) {
-			// now find out how many data points are coming in with this command
-			// by simply going through it and counting the delimeters (the number of ;)
 			H_FuncPtr(buffer[0], getArrayLength());
 		}
 		else {
@@ -74,15 +64,66 @@ void MeetAndroid::init()
 	abord = 27;
 	delimiter = 59; //';'
 
-	numberOfValues = 0;
+	bufferCount = 0;
+	delimiters = 0;
+	overflowed = false;
 	
-	// fill the function pointer with zeros to start
-	// the index values of intFunc will correspond to the ASCII character values of the first character of the message
+	// the index values of intFunc correspond to the ASCII character values of the first character of the message
 	for(int a = 0;a < FunctionBufferLenght;a++){
 		intFunc[a] = errorFunc;
 	}
 }
 
+// reads one value from position up to the next delimiter or the end of the message, and leaves
+// position just past it.  Leading spaces and anything after the digits are skipped, like atol() does.
+long MeetAndroid::parseLong(uint8_t& position)
+{
+	long value = 0;
+	bool negative = false;
+	while(position < bufferCount && buffer[position] == ' ') position++;
+	if(position < bufferCount && (buffer[position] == '-' || buffer[position] == '+'))
+		negative = buffer[position++] == '-';
+	while(position < bufferCount && buffer[position] >= '0' && buffer[position] <= '9')
+		value = value * 10 + (buffer[position++] - '0');
+	while(position < bufferCount && buffer[position] != delimiter) position++;
+	if(position < bufferCount) position++; // past the delimiter
+	return negative ? -value : value;
+}
+
+// the same for a decimal number, with an optional exponent as Android's Float.toString() writes them
+double MeetAndroid::parseDouble(uint8_t& position)
+{
+	double value = 0;
+	bool negative = false;
+	int exponent = 0;
+	while(position < bufferCount && buffer[position] == ' ') position++;
+	if(position < bufferCount && (buffer[position] == '-' || buffer[position] == '+'))
+		negative = buffer[position++] == '-';
+	while(position < bufferCount && buffer[position] >= '0' && buffer[position] <= '9')
+		value = value * 10 + (buffer[position++] - '0');
+	if(position < bufferCount && buffer[position] == '.'){
+		position++;
+		while(position < bufferCount && buffer[position] >= '0' && buffer[position] <= '9'){
+			value = value * 10 + (buffer[position++] - '0');
+			exponent--;
+		}
+	}
+	if(position + 1 < bufferCount && (buffer[position] == 'e' || buffer[position] == 'E')){
+		position++;
+		bool negativeExponent = false;
+		int e = 0;
+		if(buffer[position] == '-' || buffer[position] == '+') negativeExponent = buffer[position++] == '-';
+		while(position < bufferCount && buffer[position] >= '0' && buffer[position] <= '9')
+			e = e * 10 + (buffer[position++] - '0');
+		exponent += negativeExponent ? -e : e;
+	}
+	for(; exponent > 0; exponent--) value *= 10;
+	for(; exponent < 0; exponent++) value /= 10;
+	while(position < bufferCount && buffer[position] != delimiter) position++;
+	if(position < bufferCount) position++;
+	return negative ? -value : value;
+}
+
 
 // public methods
 MeetAndroid::MeetAndroid()
@@ -90,6 +131,7 @@ MeetAndroid::MeetAndroid()
     // it is hard to use member function pointer together with normal function pointers.
     customErrorFunc = false;
 	errorFunc = 0;
+	port = &Serial;
 	init();
 }
 
@@ -98,47 +140,70 @@ MeetAndroid::MeetAndroid(H_voidFuncPtr err)
 {
     customErrorFunc = true;
 	errorFunc = err;
+	port = &Serial;
 	init();
 }
 
+// talks over any Stream, e.g. MeetAndroid meetAndroid(Serial2);
+MeetAndroid::MeetAndroid(Stream& stream)
+{
+    customErrorFunc = false;
+	errorFunc = 0;
+	port = &stream;
+	init();
+}
+
+MeetAndroid::MeetAndroid(Stream& stream, H_voidFuncPtr err)
+{
+    customErrorFunc = true;
+	errorFunc = err;
+	port = &stream;
+	init();
+}
+
+void MeetAndroid::setPort(Stream& stream){
+	port = &stream;
+	flush();
+}
+
 // corresponds the first character sent in a message with a specific function to run
-// this is the registration process
+// this is the registration process; a flag outside '0'..'z' is ignored
 void MeetAndroid::registerFunction(void(*userfunction)(uint8_t, uint8_t),uint8_t command){
+	if(command < FunctionBufferOffset || command - FunctionBufferOffset >= FunctionBufferLenght) return;
 	intFunc[command-FunctionBufferOffset] = userfunction;
 }
 void MeetAndroid::unregisterFunction(uint8_t command){
+	if(command < FunctionBufferOffset || command - FunctionBufferOffset >= FunctionBufferLenght) return;
 	intFunc[command-FunctionBufferOffset] = errorFunc;
 }
 
+// takes what is already in the port's receive buffer, running the function for each message that
+// completes, and returns without waiting for more.  Call it from loop() as before.
+// returns false if a message was dropped because it did not fit in the buffer
 bool MeetAndroid::receive(){
-	uint8_t lastByte;
-	boolean timeout = false;
-	while(!timeout)
+	bool fitted = true;
+	int count = port->available(); // only these, so a steady stream of bytes cannot keep us here
+	while(count-- > 0)
 	{
-		while(Serial.available() > 0)
-		{
-			lastByte = Serial.read();
-			
-			if(lastByte == abord){
-				flush();
-			}
-			else if(lastByte == ack){
-				processCommand();
-				flush();
-			}
-			else if(bufferCount < ByteBufferLenght){
-				buffer[bufferCount] = lastByte;
-				bufferCount++;
-			}
-			else return false;
-		}
+		int lastByte = port->read();
+		if(lastByte < 0) break;
 		
-		if(Serial.available() <= 0 && !timeout){
-			if(waitTime > 0) delayMicroseconds(waitTime);
-			if(Serial.available() <= 0) timeout = true;
+		if(lastByte == abord){
+			flush();
+		}
+		else if(lastByte == ack){
+			if(overflowed) fitted = false;
+			else processCommand();
+			flush();
+		}
+		else if(bufferCount < ByteBufferLenght){
+			if(lastByte == delimiter && bufferCount > 0) delimiters++;
+			buffer[bufferCount] = lastByte;
+			bufferCount++;
 		}
+		else overflowed = true;
 	}
-	return timeout;
+	return fitted;
 }
 
 
@@ -156,29 +221,18 @@ void MeetAndroid::getString(char string[]){
 	for(int a = 1;a < bufferCount;a++){
 		string[a-1] = buffer[a];
 	}
-	string[bufferCount-1] = '\0';
+	string[bufferCount > 0 ? bufferCount-1 : 0] = '\0';
 }
 
 int MeetAndroid::getInt()
 {
-	uint8_t b[bufferCount];
-	for(int a = 1;a < bufferCount;a++){
-		b[a-1] = buffer[a];
-	}
-
-	b[bufferCount-1] = '\0';
-	return atoi((char*)b);
+	return (int)getLong();
 }
 
 long MeetAndroid::getLong()
 {
-	uint8_t b[bufferCount];
-	for(int a = 1;a < bufferCount;a++){
-		b[a-1] = buffer[a];
-	}
-
-	b[bufferCount-1] = '\0';
-	return atol((char*)b);
+	uint8_t position = 1;
+	return parseLong(position);
 }
 
 float MeetAndroid::getFloat()
@@ -188,164 +242,109 @@ float MeetAndroid::getFloat()
 
 int MeetAndroid::getArrayLength()
 {
-	if (bufferCount == 1) return 0; // only a flag and ack was sent, not data attached
-	numberOfValues = 1;
-	// find the amount of values we got
-	for (int a=1; a<bufferCount;a++){
-		if (buffer[a]==delimiter) numberOfValues++;
-	}
-	return numberOfValues;
+	if (bufferCount <= 1) return 0; // only a flag and ack was sent, not data attached
+	return delimiters + 1;
 }
 
+// values needs room for getArrayLength() numbers, the numOfValues the function was called with
 void MeetAndroid::getFloatValues(float values[])
 {
-	int t = 0; // counter for each char based array
-	int pos = 0;
-
-	int start = 1; // start of first value
-	for (int end=1; end<bufferCount;end++){
-		// find end of value
-		if (buffer[end]==delimiter) {
-			// now we know start and end of a value
-			char b[(end-start)+1]; // create container for one value plus '\0'
-			t = 0;
-			for(int i = start;i < end;i++){
-				b[t++] = (char)buffer[i];
-			}
-			b[t] = '\0';
-			values[pos++] = atof(b);
-			start = end+1;
-		}
+	uint8_t position = 1;
+	int count = getArrayLength();
+	for (int pos = 0; pos < count; pos++){
+		values[pos] = parseDouble(position);
 	}
-	// get the last value
-	char b[(bufferCount-start)+1]; // create container for one value plus '\0'
-	t = 0;
-	for(int i = start;i < bufferCount;i++){
-		b[t++] = (char)buffer[i];
-	}
-	b[t] = '\0';
-	values[pos] = atof(b);
 }
 
-// not tested yet
 void MeetAndroid::getDoubleValues(float values[])
 {
 	getFloatValues(values);
 }
 
-// not tested yet
 void MeetAndroid::getIntValues(int values[])
 {
-	int t = 0; // counter for each char based array
-	int pos = 0;
-
-	int start = 1; // start of first value
-	for (int end=1; end<bufferCount;end++){
-		// find end of value
-		if (buffer[end]==delimiter) {
-			// now we know start and end of a value
-			char b[(end-start)+1]; // create container for one value plus '\0'
-			t = 0;
-			for(int i = start;i < end;i++){
-				b[t++] = (char)buffer[i];
-			}
-			b[t] = '\0';
-			values[pos++] = atoi(b);
-			start = end+1;
-		}
-	}
-	// get the last value
-	char b[(bufferCount-start)+1]; // create container for one value plus '\0'
-	t = 0;
-	for(int i = start;i < bufferCount;i++){
-		b[t++] = (char)buffer[i];
+	uint8_t position = 1;
+	int count = getArrayLength();
+	for (int pos = 0; pos < count; pos++){
+		values[pos] = (int)parseLong(position);
 	}
-	b[t] = '\0';
-	values[pos] = atoi(b);
 }
 
 
 double MeetAndroid::getDouble()
 {
-	char b[bufferCount];
-	for(int a = 1;a < bufferCount;a++){
-		b[a-1] = (char)buffer[a];
-	}
-
-	b[bufferCount-1] = '\0';
-	return atof(b);
-	
+	uint8_t position = 1;
+	return parseDouble(position);
 }
 
 
 #if defined(ARDUINO) && ARDUINO >= 100
 size_t MeetAndroid::write(uint8_t b){
-	return Serial.print(b);
+	return port->write(b);
 }
 #else
 void MeetAndroid::write(uint8_t b){
-	Serial.print(b);
+	port->write(b);
 }
 #endif
 	
 
 
 void MeetAndroid::send(char c ){
-	Serial.print(startFlag);
-	Serial.print(c);
-	Serial.print(ack);
+	port->print(startFlag);
+	port->print(c);
+	port->print(ack);
 }
 
 void MeetAndroid::send(const char str[]){
-	Serial.print(startFlag);
-	Serial.print(str);
-	Serial.print(ack);
+	port->print(startFlag);
+	port->print(str);
+	port->print(ack);
 }
 void MeetAndroid::send(uint8_t n){
-	Serial.print(startFlag);
-	Serial.print(n);
-	Serial.print(ack);
+	port->print(startFlag);
+	port->print(n);
+	port->print(ack);
 }
 void MeetAndroid::send(int n){
-	Serial.print(startFlag);
-	Serial.print(n);
-	Serial.print(ack);
+	port->print(startFlag);
+	port->print(n);
+	port->print(ack);
 }
 void MeetAndroid::send(unsigned int n){
-	Serial.print(startFlag);
-	Serial.print(n);
-	Serial.print(ack);
+	port->print(startFlag);
+	port->print(n);
+	port->print(ack);
 }
 void MeetAndroid::send(long n){
-	Serial.print(startFlag);
-	Serial.print(n);
-	Serial.print(ack);
+	port->print(startFlag);
+	port->print(n);
+	port->print(ack);
 }
 void MeetAndroid::send(unsigned long n){
-	Serial.print(startFlag);
-	Serial.print(n);
-	Serial.print(ack);
+	port->print(startFlag);
+	port->print(n);
+	port->print(ack);
 }
 void MeetAndroid::send(long n, int base){
-	Serial.print(startFlag);
-	Serial.print(n, base);
-	Serial.print(ack);
+	port->print(startFlag);
+	port->print(n, base);
+	port->print(ack);
 }
 void MeetAndroid::send(double n){
-	Serial.print(startFlag);
-	Serial.print(n);
-	Serial.print(ack);
+	port->print(startFlag);
+	port->print(n);
+	port->print(ack);
 }
 void MeetAndroid::sendln(void){
-	Serial.print(startFlag);
-	Serial.println();
-	Serial.print(ack);
+	port->print(startFlag);
+	port->println();
+	port->print(ack);
 }
 
+// the getters only look at bufferCount bytes, so there is nothing to clear
 void MeetAndroid::flush(){
-	for(uint8_t a=0; a < ByteBufferLenght; a++){
-		buffer[a] = 0;
-	}
 	bufferCount = 0;
-	numberOfValues = 0;
+	delimiters = 0;
+	overflowed = false;
 }
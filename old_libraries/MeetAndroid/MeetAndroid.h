@@ -34,6 +34,18 @@
 	  - names of most functions changed
 	  
   last modified by Bonifaz Kaufmann 08 Dec 2011
+
+  Following changes were made since:
+	  - the port is any Stream given to the constructor (Serial by default),
+	    so a Mega can use Serial2 or a BufferedUART without a copy of the library
+	  - receive() never waits: it takes the bytes that are already in the
+	    port's receive buffer and returns, and waitTime is no longer used
+	  - flags outside '0'..'z' and empty messages are refused before the
+	    function table is indexed, and so are registerFunction() calls
+	  - a message longer than the buffer is dropped whole at its ack
+	  - the values are counted as they arrive, and getInt(), getIntValues(),
+	    getFloatValues() etc. parse straight out of the buffer in one pass
+	  - write() writes the byte instead of printing its number
 */
 
 #ifndef MeetAndroid_h
@@ -41,6 +53,7 @@
 
 #include <inttypes.h>
 #include "Print.h"
+#include "Stream.h"
 
 
 /******************************************************************************
@@ -53,13 +66,15 @@ class MeetAndroid : public Print
 #define ByteBufferLenght 64
 #define FunctionBufferLenght 75 // 48-122 (in ascii: 0 - z)
 #define FunctionBufferOffset 48  // offset to calc the position in the function buffer ('0' should be stored in intFunc[0])
-#define _MEET_ANDROID_VERSION 4 // software version of this library
+#define _MEET_ANDROID_VERSION 5 // software version of this library
 private:
 	// per object data
+	Stream* port;
 	uint8_t bufferCount;
 	uint8_t buffer[ByteBufferLenght];
 	
-	int numberOfValues;
+	uint8_t delimiters; // counted as the message comes in, so the number of values is known at its ack
+	bool overflowed;    // the message did not fit in the buffer, it is dropped at its ack
 	
 	char abord;
 	char ack;
@@ -78,11 +93,17 @@ private:
 	void processCommand(void);
 	void init(void);
 	int getArrayLength();
+	long parseLong(uint8_t& position);
+	double parseDouble(uint8_t& position);
 
 public: 
 	// public methods
 	MeetAndroid(H_voidFuncPtr err);
 	MeetAndroid(void);
+	MeetAndroid(Stream& stream);
+	MeetAndroid(Stream& stream, H_voidFuncPtr err);
+	
+	void setPort(Stream& stream);
 	
 	void flush(void);
 	bool receive(void);
@@ -120,7 +141,7 @@ public:
     void sendln(void);
 
 
-	uint16_t waitTime;
+	uint16_t waitTime; // no longer used, receive() does not wait for more bytes
 	
 	static int library_version() { 
 		return _MEET_ANDROID_VERSION;} 
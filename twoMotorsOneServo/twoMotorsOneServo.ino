@@ -35,10 +35,16 @@
 // U2#
 // if there is no number, then the servo will just move by one step (TILT_DELTA or PAN_DELTA)
 // U#
+// I reports the tilt angle, the angle it is heading for, and 1 if it is still moving, e.g. 95,135,1
+//
+// the tilt servo is never written in one jump: a 1 msec timer tick (Timer4) walks it toward its
+// target at TILT_RATE degrees per second (see libraries/servoTrajectory), which keeps the servo from
+// pulling enough current to brown out the bluetooth module.  The commands return at once.
 
 #include <DualVNH5019MotorShield.h>
 #include <Servo.h> 
-#include <amarinoMega.h>
+#include <MeetAndroid.h>
+#include <servoTrajectory.h>
 
 // pins 0 and 1 are used for serial comm with the laptop
 // pins used by the pololu shield are the following:
@@ -66,6 +72,7 @@
 
 #define SERIAL_SPEED 115200
 #define BLUETOOTH_SPEED 115200
+#define SERIAL_PORT_BLUETOOTH Serial2  // the bluetooth module, pins 16 and 17 on the mega
 
 #define TIMED_OUT 8000
 #define DEFAULT_SPEED 140
@@ -83,6 +90,7 @@
 #define TILT_MIN 55
 #define TILT_MAX 165
 #define TILT_DELTA 10
+#define TILT_RATE 60  // degrees per second
 
 #define BATTERY_MONITOR_PIN A0
 #define ZERO_PERCENT_BATTERY_VOLTAGE 10.5
@@ -92,11 +100,12 @@
 #define MOTOR_DRIVER_MAX 400
 #define MOTOR_DRIVER_MIN -400
 
-amarinoMega amarino;
+MeetAndroid amarino(SERIAL_PORT_BLUETOOTH);
 DualVNH5019MotorShield motorDriver;
 
 Servo tiltServo;  // create servo objects to control the servos
-int tiltPos;    // variable to store the servo position 
+servoTrajectory tiltTrajectory(tiltServo);
+int tiltPos;    // where the servo is heading, it gets there at TILT_RATE
 bool Moving, brakesOn;
 long timeOutCheck;
 int batteryMonitorPin;
@@ -401,7 +410,7 @@ void servoUp(byte flag, byte numOfValues)
       int stepsToGo = 1; //amarino.getInt();
       if (tiltPos - (TILT_DELTA *stepsToGo) >= TILT_MIN) tiltPos -= TILT_DELTA * stepsToGo;
       else tiltPos = TILT_MIN;
-      tiltServo.write(tiltPos);
+      tiltTrajectory.moveTo(tiltPos);
       char message = 'u';
       amarino.send(message);
       timeOutCheck = millis();
@@ -413,7 +422,7 @@ void servoDown(byte flag, byte numOfValues)
       int stepsToGo = 1;//amarino.getInt();
       if (tiltPos - (TILT_DELTA * stepsToGo) <= TILT_MAX) tiltPos += TILT_DELTA * stepsToGo;
       else tiltPos = TILT_MAX;
-      tiltServo.write(tiltPos);
+      tiltTrajectory.moveTo(tiltPos);
       char message = 'n';
       amarino.send(message);
       timeOutCheck = millis();
@@ -421,8 +430,8 @@ void servoDown(byte flag, byte numOfValues)
 
 void servoCenter(byte flag, byte numOfValues)
 {
-      tiltServo.write(TILT_CENTER);
       tiltPos = TILT_CENTER;
+      tiltTrajectory.moveTo(tiltPos);
       char message = 'j';
       amarino.send(message);
       timeOutCheck = millis();
@@ -431,12 +440,36 @@ void servoCenter(byte flag, byte numOfValues)
 void servoMaxDown(byte flag, byte numOfValues)
 {
       tiltPos = TILT_MIN;
-      tiltServo.write(tiltPos);
+      tiltTrajectory.moveTo(tiltPos);
       char message = 'm';
       amarino.send(message);
       timeOutCheck = millis();
 }
 
+void tiltStatus(byte flag, byte numOfValues)
+{
+  char message[24];
+  sprintf(message, "%d,%d,%d", tiltTrajectory.position(), tiltTrajectory.target(), tiltTrajectory.moving());
+  amarino.send(message);
+}
+
+// 1 msec tick on Timer4, whose PWM pins (6, 7, 8) are only used as plain digital pins by the motor shield
+void startTimerTick()
+{
+  noInterrupts();
+  TCCR4A = 0;
+  TCCR4B = (1 << WGM42) | (1 << CS41) | (1 << CS40);  // CTC, prescaler 64 = 250 kHz
+  OCR4A = F_CPU / 64 / 1000 - 1;
+  TCNT4 = 0;
+  TIMSK4 |= 1 << OCIE4A;
+  interrupts();
+}
+
+ISR(TIMER4_COMPA_vect)
+{
+  tiltTrajectory.update(1);
+}
+
 void commCheck(byte flag, byte numOfValues)
 {
   //const char message[3] = {'O', 'K', '/0'};
@@ -468,9 +501,12 @@ void setup()
   batteryRange = FULL_BATTERY_VOLTAGE - ZERO_PERCENT_BATTERY_VOLTAGE;
   batteryMonitorPin = BATTERY_MONITOR_PIN;
   
+  tiltTrajectory.setLimits(TILT_MIN, TILT_MAX);
+  tiltTrajectory.setRate(TILT_RATE);
+  tiltTrajectory.begin(TILT_CENTER);  // before attach, so the first pulse is already the center, not 1500 usec
   tiltServo.attach(tiltPin); 
-  tiltServo.write(TILT_CENTER);
   tiltPos = TILT_CENTER;
+  startTimerTick();
   
   
   // register callback functions, which will be called when an associated event occurs.
@@ -488,6 +524,7 @@ void setup()
   amarino.registerFunction(servoDown, 'n');  
   amarino.registerFunction(servoCenter, 'j');
   amarino.registerFunction(servoMaxDown, 'm');
+  amarino.registerFunction(tiltStatus, 'i');
   amarino.registerFunction(stopCallback, 'x');
   amarino.registerFunction(checkBattery, 'p');
   amarino.registerFunction(commCheck, 'c');
@@ -505,7 +542,7 @@ void setup()
 
 void loop()
 {
-  amarino.receive(); // you need to keep this in your loop() to receive events
+  amarino.receive(); // you need to keep this in your loop() to receive events, it takes what has arrived and never waits
   long currentTime = millis();
   if (currentTime - timeOutCheck > TIMED_OUT && Moving) Stop();  //if we are moving and haven't heard anything in a long time, stop moving
   delay(50); // some delay keeps the tablet or phone from getting too busy with this
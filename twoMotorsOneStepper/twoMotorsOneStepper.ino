@@ -30,29 +30,36 @@
 // for servos
 // U, N, K, H = move up, down, right, left
 // J to center and M for max down
+// I reports the tilt position in steps and 1 if it is still moving, e.g. 500,0
 // followed by the number of steps to take, for example, to move 2 steps up:
 // U2#
 // if there is no number, then the servo will just move by one step (TILT_DELTA or PAN_DELTA)
 // U#
 
+// the tilt stepper runs in the background from a timer interrupt (see libraries/rampStepper), so the
+// robot can drive and tilt at the same time and commands are answered while the platform is moving.
+// tilt commands set a new target; sending one while the platform is still moving slows it down and
+// then heads for the new target.  x stops the tilt as well as the wheels.
+
 #include <twoMotorsDriver.h>
-#include <amarinoMega.h>
+#include <MeetAndroid.h>
+#include <rampStepper.h>
 
 #define stepPin 6
 #define stepDirPin 7
 #define stepDisablePin 8
 #define batteryMonitorPin A4
 
-#define STEPPER_STARTUP_DELAY 2000  // microsec between steps, so that the stepper does not stall with starting torque
-#define STEPPER_STARTUP_STEPS 10  // startup steps, we use these to be sure to overcome starting torque
-#define STEPPER_MIN_DELAY 800
-#define STEPPER_DEFAULT_DELAY 1000
+#define STEPPER_MAX_SPEED 500      // steps per second, the old fixed 1000 usec half period
+#define STEPPER_ACCELERATION 2000  // steps per second per second, full speed in a quarter second
+#define TILT_STEPS 500
 #define TILT_MIN -5000
 #define TILT_MAX 5000
 #define DEFAULT_TILT_CENTER 0
 
 #define SERIAL_SPEED 115200
 #define BLUETOOTH_SPEED 115200
+#define SERIAL_PORT_BLUETOOTH Serial2  // the bluetooth module, pins 16 and 17 on the mega
 #define TIMED_OUT 8000
 #define DEFAULT_SPEED 220
 #define BW_REDUCTION 50
@@ -74,13 +81,14 @@
 #define FULL_BATTERY_VOLTAGE 13.0
 #define VOLTAGE_DIVIDER_RATIO 8.21
 
-amarinoMega amarino;
+MeetAndroid amarino(SERIAL_PORT_BLUETOOTH);
 twoMotorsDriver motorDriver;
+rampStepper tiltStepper(stepPin, stepDirPin, stepDisablePin);
 
 bool Moving, brakesOn;
 long timeOutCheck;
 float batteryRange;
-int mySpeed, tiltPos, tiltCenter;
+int mySpeed, tiltCenter;
 
 void checkBattery(byte flag, byte numOfValues)
 {
@@ -131,6 +139,7 @@ void Stop()
 void stopCallback(byte flag, byte numOfValues)
 {
   Stop();
+  tiltStepper.stop();
   char message = 'x';
   amarino.send(message);
 }
@@ -358,39 +367,18 @@ void turnLeft(byte flag, byte numOfValues) // speed goes from 0 to 255
 }
 
 
-// drives the pololu stepper driver.
-void Steps(int numSteps)
+// starts the stepper toward an absolute tilt position, limited to TILT_MIN..TILT_MAX, and returns at once
+void tiltTo(long position)
 {
-  int microDelay = STEPPER_DEFAULT_DELAY;
-  if (numSteps < 0)
-  {
-      numSteps = -numSteps;
-      digitalWrite(stepDirPin, HIGH);  //reverse
-  }
-  else digitalWrite(stepDirPin, LOW); // foward
-    
-  for (int i = 0; i < numSteps; i++)
-  {    
-      digitalWrite(stepPin, HIGH);
-      if (i < STEPPER_STARTUP_STEPS) delayMicroseconds(STEPPER_STARTUP_DELAY); 
-      else delayMicroseconds(microDelay);
-      digitalWrite(stepPin, LOW); // normal operations
-      if (i < STEPPER_STARTUP_STEPS) delayMicroseconds(STEPPER_STARTUP_DELAY); 
-      else delayMicroseconds(microDelay);
-  }
-  digitalWrite(stepDisablePin, HIGH); // stopped
+  if (position < TILT_MIN) position = TILT_MIN;
+  else if (position > TILT_MAX) position = TILT_MAX;
+  tiltStepper.moveTo(position);
 }
 
-
 void stepUp(byte flag, byte numOfValues)
 {
       Serial.println("Moving servo up");
-      int stepsToGo = 500; //amarino.getInt();
-      //if (tiltPos - (TILT_DELTA *stepsToGo) >= TILT_MIN) tiltPos -= TILT_DELTA * stepsToGo;
-      //else tiltPos = TILT_MIN;
-      if (tiltPos + stepsToGo < TILT_MIN) stepsToGo = TILT_MIN - tiltPos;
-      else if (tiltPos + stepsToGo > TILT_MAX) stepsToGo = TILT_MAX - tiltPos;
-      Steps(stepsToGo);
+      tiltTo(tiltStepper.target() + TILT_STEPS);
       char message = 'u';
       amarino.send(message);
       timeOutCheck = millis();
@@ -399,13 +387,7 @@ void stepUp(byte flag, byte numOfValues)
 void stepDown(byte flag, byte numOfValues) 
 {
       Serial.println("Tilting platform down");
-      int stepsToGo = -500; //amarino.getInt();
-      //if (tiltPos - (TILT_DELTA * stepsToGo) <= TILT_MAX) tiltPos += TILT_DELTA * stepsToGo;
-      //else tiltPos = TILT_MAX;
-      if (tiltPos + stepsToGo < TILT_MIN) stepsToGo = TILT_MIN - tiltPos;
-      else if (tiltPos + stepsToGo > TILT_MAX) stepsToGo = TILT_MAX - tiltPos;
-      Steps(stepsToGo);
-      tiltPos += stepsToGo;
+      tiltTo(tiltStepper.target() - TILT_STEPS);
       char message = 'n';
       amarino.send(message);
       timeOutCheck = millis();
@@ -413,9 +395,7 @@ void stepDown(byte flag, byte numOfValues)
 
 void stepToCenter(byte flag, byte numOfValues)
 {
-      int stepsToGo = tiltCenter - tiltPos;
-      Steps(stepsToGo);
-      tiltPos = tiltCenter;
+      tiltTo(tiltCenter);
       char message = 'j';
       amarino.send(message);
       timeOutCheck = millis();
@@ -423,14 +403,20 @@ void stepToCenter(byte flag, byte numOfValues)
 
 void stepToMaxDown(byte flag, byte numOfValues)
 {
-      int stepsToGo = TILT_MAX- tiltPos;
-      Steps(stepsToGo);
-      tiltPos = TILT_MAX;
+      tiltTo(TILT_MAX);
       char message = 'm';
       amarino.send(message);
       timeOutCheck = millis();
 }
 
+// reports the tilt position in steps, and whether it is still moving
+void tiltStatus(byte flag, byte numOfValues)
+{
+  char message[24];
+  sprintf(message, "%ld,%d", tiltStepper.position(), tiltStepper.running());
+  amarino.send(message);
+}
+
 
 void commCheck(byte flag, byte numOfValues)
 {
@@ -461,16 +447,10 @@ void setup()
   
   batteryRange = FULL_BATTERY_VOLTAGE - ZERO_PERCENT_BATTERY_VOLTAGE;
 
-  pinMode(stepPin, OUTPUT);
-  pinMode(stepDirPin, OUTPUT);
-  pinMode(stepDisablePin, OUTPUT);
-       
-  // start with stepper motor disabled
-  digitalWrite(stepDisablePin, HIGH);
-  digitalWrite(stepDirPin,LOW);
-  digitalWrite(stepPin,LOW); 
-  
-  tiltPos = 0;
+  // starts with the stepper motor disabled, and the current position counted as 0
+  tiltStepper.begin();
+  tiltStepper.setMaxSpeed(STEPPER_MAX_SPEED);
+  tiltStepper.setAcceleration(STEPPER_ACCELERATION);
   tiltCenter = DEFAULT_TILT_CENTER;
   
   // register callback functions, which will be called when an associated event occurs.
@@ -488,6 +468,7 @@ void setup()
   amarino.registerFunction(stepDown, 'n');  
   amarino.registerFunction(stepToCenter, 'j');
   amarino.registerFunction(stepToMaxDown, 'm');
+  amarino.registerFunction(tiltStatus, 'i');
   amarino.registerFunction(stopCallback, 'x');
   amarino.registerFunction(checkBattery, 'p');
   amarino.registerFunction(commCheck, 'c');
@@ -495,7 +476,7 @@ void setup()
 
 void loop()
 {
-  amarino.receive(); // you need to keep this in your loop() to receive events
+  amarino.receive(); // you need to keep this in your loop() to receive events, it takes what has arrived and never waits
   long currentTime = millis();
   if (currentTime - timeOutCheck > TIMED_OUT && Moving) Stop();  //if we are moving and haven't heard anything in a long time, stop moving
   delay(50); // some delay keeps the tablet or phone from getting too busy with this
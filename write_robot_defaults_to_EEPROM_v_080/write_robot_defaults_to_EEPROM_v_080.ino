@@ -59,6 +59,11 @@
 #define ENCODER_TICKS_PER_CM 23
 #define BATTERY_MONITOR_PIN 4
 #define MODIFY_MOTOR_BIASES 1  // this is a boolean, setting to true
+#define STALL_CURRENT 25  // this gets multiplied by 100 in actual use, mA
+#define STALL_FREE_CURRENT 10  // this gets multiplied by 10 in actual use, mA
+#define STALL_MIN_PWM 100
+#define STALL_MIN_TURN_RATE 10  // degrees/sec
+#define STALL_DETECT_ENABLED 1  // this is a boolean
 
 //#define ZERO_PERCENT_BATTERY_VOLTAGE 10.5
 //#define FULL_BATTERY_VOLTAGE 13.0
@@ -122,6 +127,11 @@ void setDefaults()
   EEPROM.write(127, DECIMAL_VOLTAGE_DIVIDER_RATIO);
   EEPROM.write(128, BATTERY_MONITOR_PIN);
   EEPROM.write(129, MODIFY_MOTOR_BIASES);
+  EEPROM.write(130, STALL_CURRENT);
+  EEPROM.write(131, STALL_FREE_CURRENT);
+  EEPROM.write(132, STALL_MIN_PWM);
+  EEPROM.write(133, STALL_MIN_TURN_RATE);
+  EEPROM.write(134, STALL_DETECT_ENABLED);
   
   EEPROM.write(201, NUDGE_TURN_TIME);
   EEPROM.write(202, NUDGE_MOVE_TIME);